@@ -1,7 +1,9 @@
 #ifndef ASLAM_BACKEND_MOTION_ERROR_HPP
 #define ASLAM_BACKEND_MOTION_ERROR_HPP
 
-#include <aslam/backend/ErrorTerm.hpp>
+#include <vector>
+#include <algorithm>
+#include <aslam/backend/SegmentQuadraticFormError.hpp>
 
 #include <bsplines/BSplinePose.hpp>
 #include <aslam/splines/BSplinePoseDesignVariable.hpp>
@@ -9,11 +11,14 @@
 namespace aslam {
   namespace backend {
     
-    // An error term implementing our observation model.
-    // This class derives from ErrorTermFs<1> because the
-    // errors are of dimension 1.
+    // The motion (smoothness) error of a spline design variable, i.e. the integral of the weighted squared errorTermOrder's derivative.
+    //
+    // The squared error is c' Q c = sum_s c_s' Q_s c_s = sum_s |R_s c_s|^2 with c the stacked spline coefficients, Q_s the banded Q's contribution of
+    // segment s (acting on the segment's coefficients c_s) and R_s its square root. Every segment is an error term of its own
+    // (see SegmentQuadraticFormError), so the Jacobians and Hessian blocks stay banded; add them to the problem with addErrorTerms.
+    // On a growing or sliding window spline only the affected segments' contributions are recomputed (at most splineOrder per step, see handleAppendedSegment and handleRemovedFrontSegment).
     template<class SPLINE_T>
-    class BSplineMotionError : public ErrorTermFs<1>
+    class BSplineMotionError : public SegmentQuadraticFormErrors
     {
     public:
       // This is important. The superclass holds some fixed-sized Eigen types
@@ -31,34 +36,28 @@ namespace aslam {
       BSplineMotionError(spline_t * splineDV, Eigen::MatrixXd W, unsigned int errorTermOrder);
         
       virtual ~BSplineMotionError();
-        
-    
-      // usefull for debugging / error checking
-      Eigen::MatrixXd Q() { return _Q.toDense(); };
-      Eigen::VectorXd rhs();
-        
-        
-    protected:
-      /// This is the inteface required by ErrorTermFs<>
-      
-      /// \brief evaluate the error term and return the weighted squared error e^T invR e
-      virtual double evaluateErrorImplementation();
 
-      /// \brief evaluate the jacobian
-      virtual void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & J);
-        
-        virtual void buildHessianImplementation(SparseBlockMatrix & outHessian, Eigen::VectorXd & outRhs,bool useMEstimator);
-              
+      /// \brief adds the segment appended to the spline (e.g. by spline_t::addSegment) and returns its term, which has to be added to the problem.
+      /// Appending respaces the knots after the former end, so the last splineOrder segments' contributions are recomputed.
+      SegmentQuadraticFormError::Ptr handleAppendedSegment();
+      /// \brief drops the term of the spline's former first segment (e.g. after spline_t::removeSegment) and returns it for the removal from the problem.
+      /// Its first design variable was removed with the segment, so it must not be evaluated anymore.
+      SegmentQuadraticFormError::Ptr handleRemovedFrontSegment();
+
     private:
    //   ScalarDesignVariable * _x_k;
    //   ScalarDesignVariable * _w;
         spline_t * _splineDV;
         Eigen::MatrixXd _W;
-        sbm_t _Q;
-        unsigned int _coefficientVectorLength;
+        unsigned int _errorTermOrder;
+        int _splineOrder;
+        int _dimension;
 
         void initialize(spline_t * splineDV, Eigen::MatrixXd W, unsigned int errorTermOrder);
 
+        void computeSegment(int segmentIndex);
+        void appendSegment(int segmentIndex);
+
     };
 
   } // namespace backend
@@ -0,0 +1,101 @@
+#ifndef ASLAM_BACKEND_BSPLINE_RS_FRAME_REPROJECTION_ERROR_HPP
+#define ASLAM_BACKEND_BSPLINE_RS_FRAME_REPROJECTION_ERROR_HPP
+
+#include <vector>
+#include <map>
+#include <Eigen/StdVector>
+#include <Eigen/Cholesky>
+#include <aslam/backend/ErrorTerm.hpp>
+#include <aslam/backend/JacobianContainerSparse.hpp>
+#include <aslam/backend/HomogeneousExpression.hpp>
+#include <aslam/backend/CameraDesignVariable.hpp>
+#include <aslam/splines/BSplineRSPoseDesignVariable.hpp>
+#include <sm/kinematics/homogeneous_coordinates.hpp>
+
+namespace aslam {
+  namespace backend {
+
+    // The reprojection errors of all given keypoints of one rolling shutter frame as one error term.
+    //
+    // Keypoint k with row y_k(1) is observed at t_k = keypointTime(k) + y_k(1) * lineDelay and predicted as the projection of T(t_k) * p_k,
+    // with T(t) the spline's transformation (as in aslam::splines::BSplineRSPoseDesignVariable::transformation) and p_k its homogeneous point expression.
+    // As in the CovarianceReprojectionError, the points' and the camera's design variables are estimated as well.
+    // The keypoints are sorted by their observation line, so the spline segment is evaluated once per distinct line instead of once per keypoint.
+    //
+    // The error is the stacked residual (sqrtInvR_k e_k)_k in the order of the given keypoints, with invR_k = sqrtInvR_k^T sqrtInvR_k,
+    // so the squared error is sum_k e_k' invR_k e_k. buildHessianImplementation adds one dense block over the frame's design variables.
+    // With useMEstimator the term's M-estimator weight of the squared error scales the whole contribution.
+    // As for the RSLineDelayTransformationExpressionNode, the design variables are the control vertices relevant at the line delay given at construction.
+    template<typename FRAME_T>
+    class BSplineRSFrameReprojectionError : public ErrorTermDs
+    {
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+      SM_DEFINE_EXCEPTION(Exception, std::runtime_error);
+
+      typedef FRAME_T frame_t;
+      typedef typename frame_t::keypoint_t keypoint_t;
+      typedef typename frame_t::camera_geometry_t camera_geometry_t;
+      typedef aslam::splines::BSplineRSPoseDesignVariable spline_t;
+
+      enum {
+	KeypointDimension = frame_t::KeypointDimension /*!< The dimension of the keypoint associated with this geometry policy */
+      };
+
+      typedef Eigen::Matrix<double, KeypointDimension, 1> measurement_t;
+      typedef Eigen::Matrix<double, KeypointDimension, KeypointDimension> inverse_covariance_t;
+
+      BSplineRSFrameReprojectionError(const frame_t * frame, const std::vector<int> & keypointIndices, const std::vector<HomogeneousExpression> & points, CameraDesignVariable<camera_geometry_t> camera, spline_t * spline);
+      virtual ~BSplineRSFrameReprojectionError();
+
+      size_t numberOfKeypoints() const { return _keypointIndices.size(); }
+      /// \brief the number of spline evaluations per error evaluation
+      size_t numberOfObservationLines() const { return _lines.size(); }
+
+    protected:
+      /// \brief evaluate the error term and return the weighted squared error e^T invR e
+      virtual double evaluateErrorImplementation();
+
+      /// \brief evaluate the jacobian
+      virtual void evaluateJacobiansImplementation(JacobianContainer & J);
+
+      virtual void buildHessianImplementation(SparseBlockMatrix & outHessian, Eigen::VectorXd & outRhs, bool useMEstimator);
+
+    private:
+      /// the keypoints [begin, end) (in the sorted order) observed in the same line at the same keypoint time
+      struct ObservationLine {
+        double keypointTime;
+        double line;
+        size_t begin, end;
+      };
+
+      const frame_t * _frame;
+      std::vector<int> _keypointIndices;
+      /// \brief the homogeneous points in the world frame
+      std::vector<HomogeneousExpression> _points;
+      CameraDesignVariable<camera_geometry_t> _camera;
+      /// the position of the sorted keypoints in the given order, which is the one of the stacked residual
+      std::vector<size_t> _residualIndices;
+      spline_t * _spline;
+      std::vector<ObservationLine> _lines;
+
+      /// the offsets of the design variables' blocks in the frame's Hessian block and gradient
+      std::map<DesignVariable *, int> _offsets;
+      int _parameterDimension;
+      /// one keypoint's Jacobians of the point expression and the camera
+      JacobianContainerSparse<> _keypointJacobians;
+
+      void addDesignVariable(DesignVariable * dv, std::vector<DesignVariable *> & dvs);
+      /// adds the keypoint's Jacobians in _keypointJacobians, weighted with sqrtInvR, to its rows of J
+      void scatterKeypointJacobians(int row, const inverse_covariance_t & sqrtInvR, Eigen::MatrixXd & J);
+
+      /// computes the stacked residual and, if J is given, its Jacobian over the frame's design variables (columns at _offsets) and returns the squared error
+      double evaluateResiduals(Eigen::VectorXd & error, Eigen::MatrixXd * J);
+    };
+
+  } // namespace backend
+} // namespace aslam
+
+#include "implementation/BSplineRSFrameReprojectionError.hpp"
+
+#endif /* ASLAM_BACKEND_BSPLINE_RS_FRAME_REPROJECTION_ERROR_HPP */
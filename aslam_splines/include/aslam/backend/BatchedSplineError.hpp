@@ -0,0 +1,81 @@
+#ifndef ASLAM_BACKEND_BATCHED_SPLINE_ERROR_HPP
+#define ASLAM_BACKEND_BATCHED_SPLINE_ERROR_HPP
+
+#include <vector>
+#include <aslam/backend/ErrorTerm.hpp>
+
+#include <aslam/splines/BSplineDesignVariable.hpp>
+
+namespace aslam {
+  namespace backend {
+    
+    // A batch of SimpleSplineError like measurements y_i of the spline's derivativeOrder's derivative at times t_i with weights w_i >= 0 as one error term.
+    // The error is the stacked residual (sqrt(w_i) (f(t_i) - y_i))_i, so the squared error is sum_i w_i |f(t_i) - y_i|^2.
+    //
+    // The measurements are held in contiguous arrays and the basis function values b_i of every measurement time are computed once at construction,
+    // so an evaluation is one sweep f(t_i) = sum_j b_ij c_(s_i + j) over the spline's coefficients without any expression nodes.
+    // The basis values stay valid as long as the spline's knots do not change (e.g. through spline_t::addSegment).
+    // The measurements are grouped by their window of splineOrder consecutive design variables. buildHessianImplementation adds the Gauss-Newton blocks
+    // window by window, i.e. only the band |i - j| < splineOrder. With useMEstimator the term's M-estimator weight of the squared error scales the whole contribution.
+    // The Jacobian container needs all dimension() rows per design variable, so evaluateJacobians is O(dimension() * numDesignVariables()) and buildHessian the efficient path.
+    template<class SPLINE_T>
+    class BatchedSplineError : public ErrorTermDs
+    {
+    public:
+      // This is important. The superclass holds some fixed-sized Eigen types
+      // For more information, see:
+      // http://eigen.tuxfamily.org/dox-devel/TopicStructHavingEigenMembers.html
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+      typedef SPLINE_T spline_t;
+      typedef Eigen::Matrix<double, spline_t::Dimension, Eigen::Dynamic> measurements_t;
+
+      /// \brief the measurements y (one per column) at the times t with the weights w (all one if empty)
+      BatchedSplineError(spline_t * splineDV, const Eigen::VectorXd & t, const measurements_t & y, const Eigen::VectorXd & w = Eigen::VectorXd(), int derivativeOrder = 0);
+        
+      virtual ~BatchedSplineError();
+
+      size_t numMeasurements() const { return _t.size(); }
+
+      /// \brief the residuals f(t_i) - y_i, one per column
+      measurements_t residuals() const;
+        
+    protected:
+      /// This is the inteface required by ErrorTermDs
+      
+      /// \brief evaluate the error term and return the weighted squared error
+      virtual double evaluateErrorImplementation();
+
+      /// \brief evaluate the jacobian
+      virtual void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & J);
+        
+      virtual void buildHessianImplementation(SparseBlockMatrix & outHessian, Eigen::VectorXd & outRhs, bool useMEstimator);
+        
+    private:
+        spline_t * _splineDV;
+        int _derivativeOrder;
+
+        Eigen::VectorXd _t;
+        measurements_t _y;
+        Eigen::VectorXd _w;
+        /// the basis function values of the measurements' relevant coefficients, one column per measurement
+        Eigen::MatrixXd _basis;
+        /// the measurements' first relevant coefficients, relative to the error term's first design variable
+        Eigen::VectorXi _firstCoefficient;
+        /// the index of the error term's first design variable in the spline's design variables
+        int _firstDesignVariable;
+        /// the measurements of every window of splineOrder design variables, indexed by the window's first design variable
+        std::vector<std::vector<int> > _windowMeasurements;
+
+        /// sums the measurements' weighted gradients over the error term's design variables and their Gauss-Newton Hessians per window
+        /// (splineOrder square scalar factors of the identity in windowH's columns s * splineOrder ...) and returns the squared error
+        double evaluateNormalEquations(Eigen::VectorXd & gradient, Eigen::MatrixXd & windowH);
+    };
+
+  } // namespace backend
+} // namespace aslam
+
+#include "implementation/BatchedSplineError.hpp"
+
+
+#endif /* ASLAM_BACKEND_BATCHED_SPLINE_ERROR_HPP */
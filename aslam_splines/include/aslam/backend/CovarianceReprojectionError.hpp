@@ -32,6 +32,8 @@ namespace aslam {
 
       typedef Eigen::Matrix<double, KeypointDimension, 1> measurement_t;
       typedef Eigen::Matrix<double, KeypointDimension, KeypointDimension> inverse_covariance_t;
+      typedef Eigen::Matrix<double, KeypointDimension, KeypointDimension> covariance_t;
+      typedef Eigen::Matrix<double, KeypointDimension, 4> projection_jacobian_t;
       typedef ErrorTermFs< KeypointDimension > parent_t;
 
       CovarianceReprojectionError();
@@ -45,7 +47,8 @@ namespace aslam {
 
       double observationTime();
 
-      Eigen::MatrixXd covarianceMatrix();
+      /// \brief the rolling shutter's mixing matrix A of the keypoint's covariance, A R A^T
+      covariance_t covarianceMatrix();
 
     protected:
       /// \brief evaluate the error term
@@ -54,6 +57,11 @@ namespace aslam {
       /// \brief evaluate the jacobian
       virtual void evaluateJacobiansImplementation(JacobianContainer & J);
 
+      /// \brief the covariance matrix given the homogeneous point p and the projection's Jacobian Jp at p (see homogeneousToKeypoint)
+      covariance_t covarianceMatrix(const Eigen::Vector4d & p, const projection_jacobian_t & Jp, double lineDelay);
+
+      double lineDelay();
+
       /// \brief the frame that this measurement comes from.
       const frame_t * _frame;
       
@@ -0,0 +1,47 @@
+#ifndef ASLAM_BACKEND_OPT_BSPLINE_MOTION_ERROR_HPP
+#define ASLAM_BACKEND_OPT_BSPLINE_MOTION_ERROR_HPP
+
+#include <vector>
+#include <aslam/backend/SegmentQuadraticFormError.hpp>
+
+#include <bsplines/implementation/SegmentQuadraticIntegral.hpp>
+
+namespace aslam {
+  namespace backend {
+
+    // The motion (smoothness) error of a Euclidean OPTBSpline, i.e. the integral of the weighted squared errorTermOrder's derivative over the spline's time range.
+    //
+    // The squared error is c' Q c = sum_s c_s' Q_s c_s with c the stacked control vertices and Q_s the exact contribution of segment s
+    // (see bsplines::internal::addOrSetSegmentQuadraticIntegralDiag) acting on the segment's relevant control vertices c_s.
+    // As for the BSplineMotionError every segment is a SegmentQuadraticFormError of its own,
+    // so one term per segment replaces the many sampled terms of addQuadraticIntegralExpressionErrorTerms.
+    // The terms cover the segments the spline has at construction. They do not follow a growing spline, so create new terms after adding segments.
+    template<class SPLINE_T>
+    class OPTBSplineMotionError : public SegmentQuadraticFormErrors
+    {
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+      typedef SPLINE_T spline_t;
+      typedef typename spline_t::point_t point_t;
+
+      /// \brief the weights Wdiag are the diagonal of the derivative's weight matrix
+      OPTBSplineMotionError(spline_t * spline, const point_t & Wdiag, unsigned int errorTermOrder = 2);
+
+      virtual ~OPTBSplineMotionError();
+
+    private:
+      spline_t * _spline;
+      point_t _Wdiag;
+      unsigned int _errorTermOrder;
+      int _splineOrder;
+      int _pointSize;
+    };
+
+  } // namespace backend
+} // namespace aslam
+
+#include "implementation/OPTBSplineMotionError.hpp"
+
+
+#endif /* ASLAM_BACKEND_OPT_BSPLINE_MOTION_ERROR_HPP */
@@ -10,6 +10,8 @@
 
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
 #include <boost/shared_ptr.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
 #include <sm/kinematics/rotations.hpp>
@@ -18,11 +20,14 @@
 #include <aslam/backend/Optimizer.hpp>
 #include <aslam/backend/ErrorTerm.hpp>
 #include <aslam/backend/ExpressionErrorTerm.hpp>
+#include <aslam/backend/MEstimatorPolicies.hpp>
+#include <aslam/backend/QuadraticIntegralSegmentError.hpp>
 
 #include <aslam/splines/OPTBSpline.hpp>
 #include <bsplines/BSplinePose.hpp>
 #include <bsplines/UnitQuaternionBSpline.hpp>
 #include <bsplines/NumericIntegrator.hpp>
+#include <bsplines/implementation/DiffManifoldBSplineTools.hpp>
 #include <sm/boost/null_deleter.hpp>
 
 namespace aslam {
@@ -32,6 +37,19 @@ namespace integration {
 namespace algorithms = ::numeric_integrator::algorithms;
 typedef algorithms::Default DefaultAlgorithm;
 
+/**
+ * Creates the Gauss-Legendre rule placing numberOfPoints points in every segment of spline (see numeric_integrator::algorithms::KnotAlignedGaussLegendreRule).
+ * With numberOfPoints = numeric_integrator::internal::getNumberOfGaussLegendrePointsForDegree(d) integrands being polynomials of degree d on every segment are integrated exactly,
+ * e.g. d = 2 * (splineOrder - 1 - derivativeOrder) for the squared derivativeOrder's derivative of a Euclidean spline.
+ */
+template <typename TSpline>
+inline algorithms::KnotAlignedGaussLegendreRule<typename TSpline::time_t> createKnotAlignedAlgorithm(const TSpline & spline){
+	return algorithms::KnotAlignedGaussLegendreRule<typename TSpline::time_t>(spline.getKnots());
+}
+inline algorithms::KnotAlignedGaussLegendreRule<double> createKnotAlignedAlgorithm(const bsplines::BSpline & spline){
+	return algorithms::KnotAlignedGaussLegendreRule<double>(spline.knots());
+}
+
 namespace internal {
 	template <typename ErrorTermReceiver, typename ErrorTerm>
 	inline void addErrorTermToProblem(ErrorTermReceiver & problem, ErrorTerm *et, bool problemOwnsErrorTerms){
@@ -41,6 +59,16 @@ namespace internal {
 	inline void addErrorTermToProblem(ErrorTermReceiver & problem, boost::shared_ptr<ErrorTerm> et, bool /* problemOwnsErrorTerms */){
 		problem.addErrorTerm(et);
 	}
+
+	/// \brief takes the ownership of a factory's error term as addErrorTermToProblem would
+	template <typename ErrorTerm>
+	inline boost::shared_ptr<ErrorTerm> toSharedErrorTerm(ErrorTerm *et, bool problemOwnsErrorTerms){
+		return problemOwnsErrorTerms ? boost::shared_ptr<ErrorTerm>(et) : boost::shared_ptr<ErrorTerm>(et, sm::null_deleter());
+	}
+	template <typename ErrorTerm>
+	inline boost::shared_ptr<ErrorTerm> toSharedErrorTerm(boost::shared_ptr<ErrorTerm> et, bool /* problemOwnsErrorTerms */){
+		return et;
+	}
 }
 
 
@@ -61,13 +89,15 @@ member that returns E(t) with its invR = W * factor.
 So don't forget to take the square root of factor when you use the setSqrtInvR method.
 
 When a shared_ptr is returned the problemOwnsErrorTerms flag is ignored. Otherwise true makes the problem deleting the error terms in its destructor.
+
+The algorithm instance version supports algorithms with state, e.g. the KnotAlignedGaussLegendreRule (see createKnotAlignedAlgorithm).
  */
-template <typename Algorithm = DefaultAlgorithm, typename TTime, typename ErrorTermFactory, typename ErrorTermReceiver>
-void addQuadraticIntegralErrorTerms(ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ErrorTermFactory & errorTermFactory, bool problemOwnsErrorTerms = true)
+template <typename Algorithm, typename TTime, typename ErrorTermFactory, typename ErrorTermReceiver>
+void addQuadraticIntegralErrorTerms(const Algorithm & algorithm, ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ErrorTermFactory & errorTermFactory, bool problemOwnsErrorTerms = true)
 {
 	if(a == b) return;
 
-	auto integrator = Algorithm().template getIntegrator<double>(a, b, numberOfPoints);
+	auto integrator = algorithm.template getIntegrator<double>(a, b, numberOfPoints);
 	SM_ASSERT_TRUE(std::runtime_error, !integrator.isAtEnd(), "too few integration points given : " << numberOfPoints);
 
 	const double commonFactor = integrator.getCommonFactor();
@@ -77,11 +107,59 @@ void addQuadraticIntegralErrorTerms(ErrorTermReceiver & problem, const TTime & a
 	}
 }
 
+template <typename Algorithm = DefaultAlgorithm, typename TTime, typename ErrorTermFactory, typename ErrorTermReceiver>
+void addQuadraticIntegralErrorTerms(ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ErrorTermFactory & errorTermFactory, bool problemOwnsErrorTerms = true)
+{
+	addQuadraticIntegralErrorTerms(Algorithm(), problem, a, b, numberOfPoints, errorTermFactory, problemOwnsErrorTerms);
+}
+
 template <typename TTime, typename ErrorTermFactory, typename ErrorTermReceiver>
 void addQuadraticIntegralErrorTerms(ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ErrorTermFactory & errorTermFactory, bool problemOwnsErrorTerms = true){
 	addQuadraticIntegralErrorTerms(problem, a, b, numberOfPoints, errorTermFactory, problemOwnsErrorTerms);
 }
 
+/**
+The parallel version of addQuadraticIntegralErrorTerms: the errorTermFactory is called on numberOfThreads threads, each filling the slots of a contiguous range of integration points.
+Afterwards the error terms are added to the problem from the calling thread in the order of the integration points, i.e. the problem is the same as the serial version's.
+
+Thread safety: the errorTermFactory's operator() is called concurrently, so it must only read shared state.
+That holds e.g. for factories creating expressions or error terms of a spline that is not modified meanwhile.
+The problem (ErrorTermReceiver) is only used by the calling thread and needs no synchronization.
+ */
+template <typename Algorithm, typename TTime, typename ErrorTermFactory, typename ErrorTermReceiver>
+void addQuadraticIntegralErrorTermsInParallel(const Algorithm & algorithm, ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ErrorTermFactory & errorTermFactory, int numberOfThreads, bool problemOwnsErrorTerms = true)
+{
+	if(a == b) return;
+
+	auto integrator = algorithm.template getIntegrator<double>(a, b, numberOfPoints);
+	SM_ASSERT_TRUE(std::runtime_error, !integrator.isAtEnd(), "too few integration points given : " << numberOfPoints);
+
+	// the integrators are sequential, so collect the points first
+	const double commonFactor = integrator.getCommonFactor();
+	std::vector<TTime> times;
+	std::vector<double> factors;
+	for(; !integrator.isAtEnd(); integrator.next()){
+		times.push_back(integrator.getIntegrationScalar());
+		factors.push_back(commonFactor * integrator.getValueFactor());
+	}
+
+	// the error terms are held by shared pointers right away, so none leaks if a factory call throws
+	std::vector<decltype(internal::toSharedErrorTerm(errorTermFactory(a, 1.0), problemOwnsErrorTerms))> errorTerms(times.size());
+	::bsplines::internal::forEachRangeInParallel(times.size(), [&](size_t begin, size_t end){
+		for(size_t i = begin; i < end; i++) errorTerms[i] = internal::toSharedErrorTerm(errorTermFactory(times[i], factors[i]), problemOwnsErrorTerms);
+	}, numberOfThreads);
+
+	for(auto & et : errorTerms){
+		internal::addErrorTermToProblem(problem, et, problemOwnsErrorTerms);
+	}
+}
+
+template <typename Algorithm = DefaultAlgorithm, typename TTime, typename ErrorTermFactory, typename ErrorTermReceiver>
+void addQuadraticIntegralErrorTermsInParallel(ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ErrorTermFactory & errorTermFactory, int numberOfThreads, bool problemOwnsErrorTerms = true)
+{
+	addQuadraticIntegralErrorTermsInParallel(Algorithm(), problem, a, b, numberOfPoints, errorTermFactory, numberOfThreads, problemOwnsErrorTerms);
+}
+
 /**
 To add an error term of the form
 
@@ -98,22 +176,85 @@ or
 member that returns E(t).
  */
 template <typename Algorithm, typename TTime, typename ExpressionFactory, typename DerivedMatrix, typename ErrorTermReceiver>
-void addQuadraticIntegralExpressionErrorTerms(ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ExpressionFactory & expressionFactory, const Eigen::MatrixBase<DerivedMatrix> & sqrtInvR)
+void addQuadraticIntegralExpressionErrorTerms(const Algorithm & algorithm, ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ExpressionFactory & expressionFactory, const Eigen::MatrixBase<DerivedMatrix> & sqrtInvR)
 {
-	addQuadraticIntegralErrorTerms<Algorithm>(
-			problem, a, b, numberOfPoints,
+	addQuadraticIntegralErrorTerms(
+			algorithm, problem, a, b, numberOfPoints,
 			[&expressionFactory, &sqrtInvR](TTime t, double f){
 				return toErrorTermSqrt(expressionFactory(t), sqrtInvR * sqrt(f));
 			}
 		);
 }
 
+template <typename Algorithm, typename TTime, typename ExpressionFactory, typename DerivedMatrix, typename ErrorTermReceiver>
+void addQuadraticIntegralExpressionErrorTerms(ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ExpressionFactory & expressionFactory, const Eigen::MatrixBase<DerivedMatrix> & sqrtInvR)
+{
+	addQuadraticIntegralExpressionErrorTerms(Algorithm(), problem, a, b, numberOfPoints, expressionFactory, sqrtInvR);
+}
+
 // to specify a default for the algorithm,
 template <typename TTime, typename ExpressionFactory, typename DerivedMatrix, typename ErrorTermReceiver>
 void addQuadraticIntegralExpressionErrorTerms(ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ExpressionFactory & expressionFactory, const Eigen::MatrixBase<DerivedMatrix> & sqrtInvR){
 	addQuadraticIntegralExpressionErrorTerms<DefaultAlgorithm>(problem, a, b, numberOfPoints, expressionFactory, sqrtInvR);
 }
 
+/**
+The parallel version of addQuadraticIntegralExpressionErrorTerms (see addQuadraticIntegralErrorTermsInParallel).
+The expressionFactory's operator() is called concurrently and must only read shared state.
+ */
+template <typename Algorithm, typename TTime, typename ExpressionFactory, typename DerivedMatrix, typename ErrorTermReceiver>
+void addQuadraticIntegralExpressionErrorTermsInParallel(const Algorithm & algorithm, ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ExpressionFactory & expressionFactory, const Eigen::MatrixBase<DerivedMatrix> & sqrtInvR, int numberOfThreads)
+{
+	addQuadraticIntegralErrorTermsInParallel(
+			algorithm, problem, a, b, numberOfPoints,
+			[&expressionFactory, &sqrtInvR](TTime t, double f){
+				return toErrorTermSqrt(expressionFactory(t), sqrtInvR * sqrt(f));
+			},
+			numberOfThreads
+		);
+}
+
+template <typename Algorithm = DefaultAlgorithm, typename TTime, typename ExpressionFactory, typename DerivedMatrix, typename ErrorTermReceiver>
+void addQuadraticIntegralExpressionErrorTermsInParallel(ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ExpressionFactory & expressionFactory, const Eigen::MatrixBase<DerivedMatrix> & sqrtInvR, int numberOfThreads)
+{
+	addQuadraticIntegralExpressionErrorTermsInParallel(Algorithm(), problem, a, b, numberOfPoints, expressionFactory, sqrtInvR, numberOfThreads);
+}
+
+/**
+Adds the same integral as addQuadraticIntegralExpressionErrorTerms(algorithm, ...) but as one QuadraticIntegralSegmentError per knot segment within [a, b]
+owning the expressions of all numberOfPoints integration points of its segment. This saves the per point error terms, their Jacobian containers and the optimizer's per term overhead,
+but not the per point expressions (see the SPEEDMEASURE timings in TestOPTBSpline for the difference).
+
+If mEstimator is given it is applied to every segment's squared error.
+ */
+template <typename TKnot, typename TTime, typename ExpressionFactory, typename DerivedMatrix, typename ErrorTermReceiver>
+void addQuadraticIntegralExpressionSegmentErrorTerms(const algorithms::KnotAlignedGaussLegendreRule<TKnot> & algorithm, ErrorTermReceiver & problem, const TTime & a, const TTime & b, int numberOfPoints, const ExpressionFactory & expressionFactory, const Eigen::MatrixBase<DerivedMatrix> & sqrtInvR, const boost::shared_ptr<MEstimator> & mEstimator = boost::shared_ptr<MEstimator>())
+{
+	if(a == b) return;
+	SM_ASSERT_LT(std::runtime_error, a, b, "the integral's lower bound must be less than its upper bound");
+
+	typedef decltype(expressionFactory(a)) expression_t;
+	typedef QuadraticIntegralSegmentError<expression_t> error_term_t;
+
+	auto integrator = algorithm.template getIntegrator<double>(a, b, numberOfPoints);
+	SM_ASSERT_TRUE(std::runtime_error, !integrator.isAtEnd(), "too few integration points given : " << numberOfPoints);
+
+	const double commonFactor = integrator.getCommonFactor();
+	std::vector<expression_t> expressions;
+	std::vector<double> factors;
+	while(!integrator.isAtEnd()){
+		const int segment = integrator.getPanelIndex();
+		for(; !integrator.isAtEnd() && integrator.getPanelIndex() == segment; integrator.next()){
+			expressions.push_back(expressionFactory(integrator.getIntegrationScalar()));
+			factors.push_back(commonFactor * integrator.getValueFactor());
+		}
+		boost::shared_ptr<error_term_t> et(new error_term_t(expressions, factors, sqrtInvR));
+		if(mEstimator) et->setMEstimatorPolicy(mEstimator);
+		problem.addErrorTerm(et);
+		expressions.clear();
+		factors.clear();
+	}
+}
 
 }
 }
@@ -0,0 +1,63 @@
+#ifndef ASLAM_BACKEND_QUADRATIC_INTEGRAL_SEGMENT_ERROR_HPP
+#define ASLAM_BACKEND_QUADRATIC_INTEGRAL_SEGMENT_ERROR_HPP
+
+#include <vector>
+#include <map>
+#include <boost/shared_ptr.hpp>
+#include <aslam/backend/ErrorTerm.hpp>
+#include <aslam/backend/JacobianContainerSparse.hpp>
+
+namespace aslam {
+  namespace backend {
+
+    // One error term for all integration points of a quadrature of e = Int E(t)^T sqrtInvR^T sqrtInvR E(t) dt, usually the points of one knot segment
+    // (see integration::addQuadraticIntegralExpressionSegmentErrorTerms).
+    //
+    // With the points' expressions E_p and factors f_p >= 0 the error is the stacked residual (sqrt(f_p) sqrtInvR E_p)_p, so the squared error is sum_p f_p |sqrtInvR E_p|^2.
+    // buildHessianImplementation sums the points' Gauss-Newton contributions in one sweep over the points into a block over the term's design variables
+    // and adds that once to the Hessian. With useMEstimator the term's M-estimator weight of the squared error scales the whole contribution.
+    template<class EXPRESSION_T>
+    class QuadraticIntegralSegmentError : public ErrorTermDs
+    {
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+      typedef EXPRESSION_T expression_t;
+
+      QuadraticIntegralSegmentError(const std::vector<expression_t> & expressions, const std::vector<double> & factors, const Eigen::MatrixXd & sqrtInvR);
+
+      virtual ~QuadraticIntegralSegmentError();
+
+      size_t numberOfPoints() const { return _expressions.size(); }
+
+    protected:
+      /// This is the inteface required by ErrorTermDs
+
+      /// \brief evaluate the error term and return the weighted squared error e^T invR e
+      virtual double evaluateErrorImplementation();
+
+      /// \brief evaluate the jacobian
+      virtual void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & J);
+
+      virtual void buildHessianImplementation(SparseBlockMatrix & outHessian, Eigen::VectorXd & outRhs, bool useMEstimator);
+
+    private:
+      std::vector<expression_t> _expressions;
+      std::vector<double> _factors;
+      Eigen::MatrixXd _sqrtInvR;
+      /// the offsets of the design variables' blocks in the term's Hessian block and gradient
+      std::map<DesignVariable *, int> _offsets;
+      int _parameterDimension;
+
+      /// computes point p's Jacobian sqrtInvR dE_p / dx over the term's design variables (columns at _offsets)
+      void evaluatePointJacobian(size_t p, JacobianContainerSparse<> & jacobians, Eigen::MatrixXd & J);
+      /// sums the points' gradients and Gauss-Newton Hessians over the term's design variables and returns the squared error
+      double evaluateNormalEquations(Eigen::VectorXd & gradient, Eigen::MatrixXd & H);
+    };
+
+  } // namespace backend
+} // namespace aslam
+
+#include "implementation/QuadraticIntegralSegmentError.hpp"
+
+#endif /* ASLAM_BACKEND_QUADRATIC_INTEGRAL_SEGMENT_ERROR_HPP */
@@ -0,0 +1,91 @@
+#ifndef ASLAM_BACKEND_SEGMENT_QUADRATIC_FORM_ERROR_HPP
+#define ASLAM_BACKEND_SEGMENT_QUADRATIC_FORM_ERROR_HPP
+
+#include <deque>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <aslam/backend/ErrorTerm.hpp>
+
+namespace aslam {
+  namespace backend {
+
+    // One segment's part of the spline motion errors (BSplineMotionError, OPTBSplineMotionError): the squared error c_s' Q_s c_s = |R_s c_s|^2
+    // of the bandWidth consecutive coefficients c_s (blockSize entries per design variable) the segment acts on.
+    // The residual is R_s c_s, so the term's Jacobians and Hessian blocks only cover its own design variables.
+    class SegmentQuadraticFormError : public ErrorTermDs
+    {
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+      typedef boost::shared_ptr<SegmentQuadraticFormError> Ptr;
+
+      /// \brief the design variables' parameters are the segment's coefficients c_s, each of size blockSize
+      SegmentQuadraticFormError(const std::vector<DesignVariable*> & designVariables, int blockSize);
+      virtual ~SegmentQuadraticFormError();
+
+      /// \brief R_s must be (number of design variables * blockSize) square
+      void setSqrtQ(const Eigen::MatrixXd & sqrtQ);
+      const Eigen::MatrixXd & sqrtQ() const { return _sqrtQ; }
+      Eigen::MatrixXd Q() const { return _sqrtQ.transpose() * _sqrtQ; }
+
+      /// \brief the stacked parameters c_s of the design variables
+      Eigen::VectorXd getCoefficientVector() const;
+
+    protected:
+      /// \brief evaluate the error term and return the weighted squared error e^T invR e
+      virtual double evaluateErrorImplementation();
+
+      /// \brief evaluate the jacobian
+      virtual void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & J);
+
+    private:
+      int _blockSize;
+      Eigen::MatrixXd _sqrtQ;
+    };
+
+    // The segment terms of a spline motion error: c' Q c = sum_s |R_s c_s|^2, with c the stacked coefficients and segment s acting on the
+    // bandWidth design variables s ... s + bandWidth - 1. The terms are added to the problem individually (see addErrorTerms),
+    // Q() and rhs() assemble the banded system of all segments for debugging.
+    class SegmentQuadraticFormErrors
+    {
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+      virtual ~SegmentQuadraticFormErrors();
+
+      size_t numberOfSegments() const { return _segmentErrors.size(); }
+      const SegmentQuadraticFormError::Ptr & segmentError(size_t s) const { return _segmentErrors[s]; }
+
+      /// \brief adds every segment's error term to the problem
+      template <typename ErrorTermReceiver>
+      void addErrorTerms(ErrorTermReceiver & problem) const {
+        for(const auto & e : _segmentErrors) problem.addErrorTerm(e);
+      }
+
+      /// \brief the sum of the segments' squared errors c' Q c
+      double evaluateError();
+
+      // usefull for debugging / error checking
+      Eigen::MatrixXd Q() const;
+      Eigen::VectorXd rhs() const;
+
+    protected:
+      SegmentQuadraticFormErrors(int bandWidth, int blockSize);
+
+      /// \brief appends the term of a segment acting on the given bandWidth design variables, its R_s has to be set with setSegmentSqrtQ
+      const SegmentQuadraticFormError::Ptr & pushBackSegment(const std::vector<DesignVariable*> & designVariables);
+      /// \brief drops the first segment's term and returns it
+      SegmentQuadraticFormError::Ptr popFrontSegment();
+      void setSegmentSqrtQ(size_t s, const Eigen::MatrixXd & sqrtQ) { _segmentErrors[s]->setSqrtQ(sqrtQ); }
+
+    private:
+      int _bandWidth;
+      int _blockSize;
+      std::deque<SegmentQuadraticFormError::Ptr> _segmentErrors;
+    };
+
+  } // namespace backend
+} // namespace aslam
+
+#include "implementation/SegmentQuadraticFormError.hpp"
+
+#endif /* ASLAM_BACKEND_SEGMENT_QUADRATIC_FORM_ERROR_HPP */
@@ -0,0 +1,217 @@
+#include <algorithm>
+
+namespace aslam {
+  namespace backend {
+
+    template<typename F>
+    BSplineRSFrameReprojectionError<F>::BSplineRSFrameReprojectionError(const frame_t * frame, const std::vector<int> & keypointIndices, const std::vector<HomogeneousExpression> & points, CameraDesignVariable<camera_geometry_t> camera, spline_t * spline) :
+      ErrorTermDs(KeypointDimension * keypointIndices.size()), _frame(frame), _camera(camera), _spline(spline), _parameterDimension(0), _keypointJacobians(KeypointDimension)
+    {
+      SM_ASSERT_TRUE(Exception, frame != NULL, "The frame must not be null");
+      SM_ASSERT_TRUE(Exception, spline != NULL, "The spline must not be null");
+      SM_ASSERT_EQ(Exception, keypointIndices.size(), points.size(), "Every keypoint needs a point");
+      SM_ASSERT_FALSE(Exception, keypointIndices.empty(), "There must be at least one keypoint");
+
+      // sort the keypoints by their observation line
+      std::vector<size_t> order(keypointIndices.size());
+      for(size_t i = 0; i < order.size(); ++i) order[i] = i;
+      std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const double ta = _frame->keypointTime(keypointIndices[a]).toSec(), tb = _frame->keypointTime(keypointIndices[b]).toSec();
+        return ta < tb || (ta == tb && _frame->keypoint(keypointIndices[a]).y()(1) < _frame->keypoint(keypointIndices[b]).y()(1));
+      });
+      for(size_t i = 0; i < order.size(); ++i) {
+        _keypointIndices.push_back(keypointIndices[order[i]]);
+        _points.push_back(points[order[i]]);
+        _residualIndices.push_back(order[i]);
+      }
+      for(size_t i = 0; i < _keypointIndices.size(); ++i) {
+        const double keypointTime = _frame->keypointTime(_keypointIndices[i]).toSec(), line = _frame->keypoint(_keypointIndices[i]).y()(1);
+        if(_lines.empty() || _lines.back().keypointTime != keypointTime || _lines.back().line != line) {
+          ObservationLine observationLine = { keypointTime, line, i, i };
+          _lines.push_back(observationLine);
+        }
+        _lines.back().end = i + 1;
+      }
+
+      // the control vertices relevant for any of the lines and the line delay
+      const double lineDelay = _spline->lineDelay();
+      const size_t lineDelayIndex = _spline->numDesignVariables() - 1;
+      std::vector<DesignVariable *> dvs;
+      for(size_t l = 0; l < _lines.size(); ++l) {
+        Eigen::VectorXi dvidxs = _spline->spline().localVvCoefficientVectorIndices(_lines[l].keypointTime + _lines[l].line * lineDelay);
+        for(int i = 0; i < dvidxs.size(); ++i) {
+          addDesignVariable(_spline->designVariable(dvidxs[i]), dvs);
+        }
+      }
+      addDesignVariable(_spline->designVariable(lineDelayIndex), dvs);
+
+      // the points' and the camera's design variables
+      DesignVariable::set_t pointAndCameraDvs;
+      for(size_t k = 0; k < _points.size(); ++k) {
+        _points[k].getDesignVariables(pointAndCameraDvs);
+      }
+      _camera.getDesignVariables(pointAndCameraDvs);
+      for(DesignVariable::set_t::const_iterator it = pointAndCameraDvs.begin(); it != pointAndCameraDvs.end(); ++it) {
+        addDesignVariable(*it, dvs);
+      }
+
+      setDesignVariables(dvs);
+    }
+
+
+    template<typename F>
+    BSplineRSFrameReprojectionError<F>::~BSplineRSFrameReprojectionError()
+    {
+
+    }
+
+
+    template<typename F>
+    void BSplineRSFrameReprojectionError<F>::addDesignVariable(DesignVariable * dv, std::vector<DesignVariable *> & dvs)
+    {
+      if(_offsets.insert(std::make_pair(dv, _parameterDimension)).second) {
+        _parameterDimension += dv->minimalDimensions();
+        dvs.push_back(dv);
+      }
+    }
+
+
+    template<typename F>
+    void BSplineRSFrameReprojectionError<F>::scatterKeypointJacobians(int row, const inverse_covariance_t & sqrtInvR, Eigen::MatrixXd & J)
+    {
+      for(auto it = _keypointJacobians.begin(); it != _keypointJacobians.end(); ++it) {
+        J.block(row, _offsets.find(it->first)->second, KeypointDimension, it->second.cols()) += sqrtInvR * it->second;
+      }
+    }
+
+
+    template<typename F>
+    double BSplineRSFrameReprojectionError<F>::evaluateResiduals(Eigen::VectorXd & error, Eigen::MatrixXd * J)
+    {
+      error.resize(dimension());
+      if(J) J->setZero(dimension(), _parameterDimension);
+
+      const camera_geometry_t & cam = _frame->geometry();
+      const double lineDelay = _spline->lineDelay();
+      const int lineDelayOffset = _offsets.find(_spline->designVariable(_spline->numDesignVariables() - 1))->second;
+
+      Eigen::MatrixXd JS, JT, JTransformation;
+      Eigen::VectorXi coefficientIndices;
+      std::vector<int> offsets;
+      for(size_t l = 0; l < _lines.size(); ++l) {
+        const ObservationLine & line = _lines[l];
+        const double observationTime = line.keypointTime + line.line * lineDelay;
+
+        // one segment evaluation for the curve value, its time derivative and their Jacobians shared by all keypoints of the line
+        const Eigen::MatrixXd c = _spline->spline().evalDsAndJacobian(observationTime, J ? 1 : 0, J ? &JS : NULL, J ? &coefficientIndices : NULL);
+        const Eigen::Matrix4d T = _spline->spline().curveValueToTransformationAndJacobian(c.col(0), J ? &JT : NULL);
+
+        // the Jacobian of the transformation with respect to the relevant control vertices and the line delay
+        if(J) {
+          const int D = c.rows(), splineOrder = coefficientIndices.size() / D;
+          JTransformation.resize(6, JS.cols() + 1);
+          JTransformation.leftCols(JS.cols()) = JT * JS.topRows(D);
+          JTransformation.col(JS.cols()) = JT * c.col(1) * line.line;
+
+          offsets.resize(splineOrder);
+          for(int i = 0; i < splineOrder; ++i) {
+            typename std::map<DesignVariable *, int>::const_iterator it = _offsets.find(_spline->designVariable(coefficientIndices[i * D] / D));
+            SM_ASSERT_TRUE(Exception, it != _offsets.end(), "The line delay moved the observation time to a segment with other control vertices than at construction");
+            offsets[i] = it->second;
+          }
+        }
+
+        for(size_t k = line.begin; k < line.end; ++k) {
+          const keypoint_t & keypoint = _frame->keypoint(_keypointIndices[k]);
+          const Eigen::Vector4d p = _points[k].toHomogeneous();
+          const Eigen::Vector4d Tp = T * p;
+          measurement_t hat_y;
+          Eigen::Matrix<double, KeypointDimension, 4> Jp;
+          cam.homogeneousToKeypoint(Tp, hat_y, Jp);
+
+          // invR = sqrtInvR^T sqrtInvR
+          const inverse_covariance_t sqrtInvR = keypoint.invR().llt().matrixU();
+          const int row = _residualIndices[k] * KeypointDimension;
+          error.template segment<KeypointDimension>(row) = sqrtInvR * (keypoint.y() - hat_y);
+          if(!J) continue;
+
+          // the Jacobian of the residual with respect to the relevant control vertices and the line delay
+          const Eigen::Matrix<double, KeypointDimension, Eigen::Dynamic> Jr = -(sqrtInvR * Jp) * (sm::kinematics::boxMinus(Tp) * JTransformation);
+          const int D = (Jr.cols() - 1) / offsets.size();
+
+          // scatter to the frame's design variables
+          for(size_t i = 0; i <= offsets.size(); ++i) {
+            const int colOffset = i < offsets.size() ? offsets[i] : lineDelayOffset, cols = i < offsets.size() ? D : 1;
+            J->block(row, colOffset, KeypointDimension, cols) += Jr.middleCols(i * D, cols);
+          }
+
+          // the point's and the camera's Jacobians of the unweighted residual, as in the CovarianceReprojectionError
+          _keypointJacobians.clear();
+          _points[k].evaluateJacobians(_keypointJacobians, Eigen::MatrixXd(-Jp * T));
+          _camera.evaluateJacobians(_keypointJacobians, Tp);
+          scatterKeypointJacobians(row, sqrtInvR, *J);
+        }
+      }
+      return error.squaredNorm();
+    }
+
+
+    template<typename F>
+    double BSplineRSFrameReprojectionError<F>::evaluateErrorImplementation()
+    {
+      Eigen::VectorXd error;
+      const double squaredError = evaluateResiduals(error, NULL);
+      setError(error);
+      return squaredError;
+    }
+
+
+    template<typename F>
+    void BSplineRSFrameReprojectionError<F>::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & _jacobians)
+    {
+      Eigen::VectorXd error;
+      Eigen::MatrixXd J;
+      evaluateResiduals(error, &J);
+      for(size_t i = 0; i < numDesignVariables(); i++) {
+        DesignVariable * dv = designVariable(i);
+        _jacobians.add(dv, Eigen::MatrixXd(J.middleCols(_offsets.find(dv)->second, dv->minimalDimensions())));
+      }
+    }
+
+
+    template<typename F>
+    void BSplineRSFrameReprojectionError<F>::buildHessianImplementation(SparseBlockMatrix & outHessian, Eigen::VectorXd & outRhs, bool useMEstimator)
+    {
+      Eigen::VectorXd error;
+      Eigen::MatrixXd J;
+      const double squaredError = evaluateResiduals(error, &J);
+      const double weight = useMEstimator ? _mEstimatorPolicy->getWeight(squaredError) : 1.0;
+      const Eigen::VectorXd gradient = weight * (J.transpose() * error);
+      const Eigen::MatrixXd H = weight * (J.transpose() * J);
+
+      // place the hessian elements in the correct place:
+      for(size_t i = 0; i < numDesignVariables(); i++)
+      {
+        DesignVariable * dvi = designVariable(i);
+        if(!dvi->isActive()) continue;
+
+        // <- this is our column index
+        const int colBlockIndex = dvi->blockIndex();
+        const int colOffset = _offsets.find(dvi)->second, cols = dvi->minimalDimensions();
+        for(size_t j = 0; j < numDesignVariables(); j++)
+        {
+          DesignVariable * dvj = designVariable(j);
+          if (dvj->isActive() && dvj->blockIndex() <= colBlockIndex) { // upper triangle should be sufficient
+            // get the Hessian Block
+            const bool allocateIfMissing = true;
+            Eigen::MatrixXd *Hblock = outHessian.block(dvj->blockIndex(), colBlockIndex, allocateIfMissing);
+            *Hblock += H.block(_offsets.find(dvj)->second, colOffset, dvj->minimalDimensions(), cols);  // insert!
+          }
+        }
+
+        outRhs.segment(outHessian.colBaseOfBlock(colBlockIndex), cols) -= gradient.segment(colOffset, cols);
+      }
+    }
+
+  } // namespace backend
+} // namespace aslam
@@ -0,0 +1,167 @@
+#include <aslam/backend/BatchedSplineError.hpp>
+namespace aslam {
+    namespace backend {
+        
+
+    
+        template<class SPLINE_T>
+        BatchedSplineError<SPLINE_T>::BatchedSplineError(spline_t* splineDV, const Eigen::VectorXd & t, const measurements_t & y, const Eigen::VectorXd & w, int derivativeOrder):
+        ErrorTermDs(spline_t::Dimension * t.size()), _splineDV(splineDV), _derivativeOrder(derivativeOrder), _t(t), _y(y), _w(w.size() ? w : Eigen::VectorXd::Ones(t.size()))
+        {
+            SM_ASSERT_EQ(std::runtime_error, (int)_t.size(), (int)_y.cols(), "Every time needs a measurement");
+            SM_ASSERT_EQ(std::runtime_error, (int)_t.size(), (int)_w.size(), "Every time needs a weight");
+            SM_ASSERT_GT(std::runtime_error, (int)_t.size(), 0, "There must be at least one measurement");
+            SM_ASSERT_GE(std::runtime_error, _w.minCoeff(), 0.0, "The weights must not be negative");
+
+            // the basis function values are the Jacobian's diagonal entries with respect to the relevant coefficients
+            const bsplines::BSpline & spline = _splineDV->spline();
+            const int D = spline_t::Dimension, splineOrder = spline.splineOrder();
+            _basis.resize(splineOrder, _t.size());
+            _firstCoefficient.resize(_t.size());
+            Eigen::MatrixXd J;
+            Eigen::VectorXi coefficientIndices;
+            for(int i = 0; i < _t.size(); ++i) {
+                spline.evalDAndJacobian(_t[i], _derivativeOrder, &J, &coefficientIndices);
+                for(int j = 0; j < splineOrder; ++j) {
+                    _basis(j, i) = J(0, j * D);
+                }
+                _firstCoefficient[i] = coefficientIndices[0] / D;
+            }
+
+            // Add the design variables to the error term:
+            _firstDesignVariable = _firstCoefficient.minCoeff();
+            const int endCoefficient = _firstCoefficient.maxCoeff() + splineOrder;
+            _firstCoefficient.array() -= _firstDesignVariable;
+            // the measurements of every window of splineOrder consecutive design variables
+            _windowMeasurements.resize(endCoefficient - _firstDesignVariable - splineOrder + 1);
+            for(int i = 0; i < _t.size(); ++i) {
+                _windowMeasurements[_firstCoefficient[i]].push_back(i);
+            }
+            std::vector<DesignVariable *> dvV;
+            for(int i = _firstDesignVariable; i < endCoefficient; ++i) {
+                dvV.push_back(_splineDV->designVariable(i));
+            }
+            setDesignVariables(dvV);
+        }
+
+
+        template<class SPLINE_T>
+        BatchedSplineError<SPLINE_T>::~BatchedSplineError()
+        {
+
+        }
+
+
+        template<class SPLINE_T>
+        typename BatchedSplineError<SPLINE_T>::measurements_t BatchedSplineError<SPLINE_T>::residuals() const
+        {
+            const Eigen::MatrixXd & coefficients = _splineDV->spline().coefficients();
+            const int splineOrder = _basis.rows();
+
+            measurements_t r(spline_t::Dimension, _t.size());
+            for(int i = 0; i < _t.size(); ++i) {
+                r.col(i) = coefficients.middleCols(_firstDesignVariable + _firstCoefficient[i], splineOrder) * _basis.col(i) - _y.col(i);
+            }
+            return r;
+        }
+
+
+        template<class SPLINE_T>
+        double BatchedSplineError<SPLINE_T>::evaluateNormalEquations(Eigen::VectorXd & gradient, Eigen::MatrixXd & windowH)
+        {
+            const int D = spline_t::Dimension, splineOrder = _basis.rows();
+            gradient.setZero(D * numDesignVariables());
+            windowH.setZero(splineOrder, splineOrder * _windowMeasurements.size());
+
+            const measurements_t r = residuals();
+            double squaredError = 0;
+            for(size_t s = 0; s < _windowMeasurements.size(); ++s) {
+                for(int i : _windowMeasurements[s]) {
+                    squaredError += _w[i] * r.col(i).squaredNorm();
+
+                    // the Jacobian with respect to the window's coefficient j is b_ij * I
+                    for(int j = 0; j < splineOrder; ++j) {
+                        gradient.segment<D>(D * (s + j)) += (_w[i] * _basis(j, i)) * r.col(i);
+                    }
+                    windowH.middleCols(s * splineOrder, splineOrder).noalias() += _w[i] * _basis.col(i) * _basis.col(i).transpose();
+                }
+            }
+            return squaredError;
+        }
+
+
+        /// \brief evaluate the error term and return the weighted squared error
+        template<class SPLINE_T>
+        double BatchedSplineError<SPLINE_T>::evaluateErrorImplementation()
+        {
+            // the stacked residual (sqrt(w_i) (f(t_i) - y_i))_i
+            const measurements_t r = residuals() * _w.cwiseSqrt().asDiagonal();
+            const Eigen::VectorXd error = Eigen::VectorXd::Map(r.data(), r.size());
+            setError(error);
+            return error.squaredNorm();
+        }
+
+
+        /// \brief evaluate the jacobians
+        template<class SPLINE_T>
+        void BatchedSplineError<SPLINE_T>::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & _jacobians)
+        {
+            // the Jacobian of measurement i's residual with respect to the relevant coefficient j is sqrt(w_i) b_ij * I,
+            // so design variable c only has entries in the rows of the windows c - splineOrder + 1 ... c
+            const int D = spline_t::Dimension, splineOrder = _basis.rows(), numberOfWindows = _windowMeasurements.size();
+            Eigen::MatrixXd J(dimension(), D);
+            for(int c = 0; c < (int)numDesignVariables(); c++) {
+                J.setZero();
+                for(int s = std::max(0, c - splineOrder + 1); s <= std::min(c, numberOfWindows - 1); ++s) {
+                    for(int i : _windowMeasurements[s]) {
+                        J.block<D, D>(i * D, 0).diagonal().setConstant(std::sqrt(_w[i]) * _basis(c - s, i));
+                    }
+                }
+                _jacobians.add(designVariable(c), J);
+            }
+        }
+
+
+        template<class SPLINE_T>
+        void BatchedSplineError<SPLINE_T>::buildHessianImplementation(SparseBlockMatrix & outHessian, Eigen::VectorXd & outRhs, bool useMEstimator)
+        {
+            const int D = spline_t::Dimension, splineOrder = _basis.rows();
+            Eigen::VectorXd gradient;
+            Eigen::MatrixXd windowH;
+            const double squaredError = evaluateNormalEquations(gradient, windowH);
+            const double weight = useMEstimator ? _mEstimatorPolicy->getWeight(squaredError) : 1.0;
+
+            // place the hessian elements in the correct place:
+            // J' J is banded, a window's measurements only couple its splineOrder design variables with blocks that are multiples of the identity
+            for(size_t s = 0; s < _windowMeasurements.size(); s++)
+            {
+                if(_windowMeasurements[s].empty()) continue;
+                for(int a = 0; a < splineOrder; a++)
+                {
+                    DesignVariable * dvi = designVariable(s + a);
+                    if(!dvi->isActive()) continue;
+
+                    for(int b = 0; b <= a; b++)
+                    {
+                        DesignVariable * dvj = designVariable(s + b);
+                        if (dvj->isActive()) {
+                            // get the Hessian Block of the upper triangle
+                            const bool allocateIfMissing = true;
+                            Eigen::MatrixXd *Hblock = outHessian.block(std::min(dvi->blockIndex(), dvj->blockIndex()), std::max(dvi->blockIndex(), dvj->blockIndex()), allocateIfMissing);
+                            Hblock->diagonal().array() += weight * windowH(b, s * splineOrder + a);  // insert!
+                        }
+                    }
+                }
+            }
+
+            for(size_t i = 0; i < numDesignVariables(); i++)
+            {
+                DesignVariable * dvi = designVariable(i);
+                if(dvi->isActive()) {
+                    outRhs.segment<D>(outHessian.colBaseOfBlock(dvi->blockIndex())) -= weight * gradient.segment<D>(i * D);
+                }
+            }
+        }
+
+    } // namespace backend
+} // namespace aslam
@@ -34,39 +34,32 @@ namespace aslam {
     }
 
     template<typename F>
-    Eigen::MatrixXd CovarianceReprojectionError<F>::covarianceMatrix() {
-
-    	const keypoint_t & k = _frame->keypoint(_keypointIndex);
-    	const camera_geometry_t & cam = _frame->geometry();
-
+    typename CovarianceReprojectionError<F>::covariance_t CovarianceReprojectionError<F>::covarianceMatrix() {
     	Eigen::Vector4d p = _point.toHomogeneous();
     	measurement_t hat_y;
-    	Eigen::Matrix<double, 2,4> outJp;
-    	cam.homogeneousToKeypoint(p, hat_y, outJp);
-
+    	projection_jacobian_t outJp;
+    	_frame->geometry().homogeneousToKeypoint(p, hat_y, outJp);
+    	return covarianceMatrix(p, outJp, lineDelay());
+    }
 
-    	double lineDelay;
-    	if(_lineDelayDv)
-    		lineDelay = _lineDelayDv->toScalar();
-    	else
-    		lineDelay = cam.shutter().lineDelay();
+    template<typename F>
+    typename CovarianceReprojectionError<F>::covariance_t CovarianceReprojectionError<F>::covarianceMatrix(const Eigen::Vector4d & p, const projection_jacobian_t & outJp, double lineDelay) {
 
-    	double observationTime = _frame->keypointTime(_keypointIndex).toSec() + k.y()(1) * lineDelay;
+    	double observationTime = _frame->keypointTime(_keypointIndex).toSec() + _frame->keypoint(_keypointIndex).y()(1) * lineDelay;
 
-    	Eigen::VectorXd splinePoint = _spline->spline().evalD(observationTime, 0);
+    	// the curve value and phi_dot * c (t_0) in one evaluation
+    	const Eigen::MatrixXd splineValues = _spline->spline().evalDs(observationTime, 1);
     	// evaluate the covariance:
     	Eigen::MatrixXd JT;
-    	Eigen::VectorXd Phi_dot_c = _spline->spline().evalD(observationTime,1); // phi_dot * c (t_0)
-    	Eigen::MatrixXd T = _spline->spline().curveValueToTransformationAndJacobian(splinePoint, &JT);
-
-    	Eigen::MatrixXd TPboxminus = sm::kinematics::boxMinus(T*p);
+    	const Eigen::Matrix4d T = _spline->spline().curveValueToTransformationAndJacobian(splineValues.col(0), &JT);
 
-    	//std::cout << "TPboxminus:" << std::endl << TPboxminus << std::endl;
+    	const Eigen::Matrix<double, 4, 6> TPboxminus = sm::kinematics::boxMinus(T*p);
 
-    	Eigen::MatrixXd J = outJp * TPboxminus * JT * Phi_dot_c * lineDelay; //outJp * J_t;
-    	//std::cout << "J: " << std::endl << J << std::endl;
+    	// outJp * J_t, multiplied from the right to keep to matrix vector products
+    	const Eigen::Matrix<double, 6, 1> JTPhi_dot_c = JT * splineValues.col(1);
+    	const Eigen::Matrix<double, KeypointDimension, 1> J = outJp * (TPboxminus * JTPhi_dot_c) * lineDelay;
 
-    	Eigen::MatrixXd A = Eigen::MatrixXd::Identity(2,2);
+    	covariance_t A = covariance_t::Identity();
 
     	A(0,1) += J(0);
     	A(1,1) += J(1);
@@ -91,35 +84,37 @@ namespace aslam {
       
       Eigen::Vector4d p = _point.toHomogeneous();
       measurement_t hat_y;
-      Eigen::Matrix<double, 2,4> outJp;
+      projection_jacobian_t outJp;
 	  cam.homogeneousToKeypoint(p, hat_y, outJp);
 
       parent_t::setError(k.y() - hat_y);
 
       if(_spline) {
 
-    	  Eigen::MatrixXd A = covarianceMatrix();
-    	  //std::cout << A << std::endl;
+    	  // reuses the projection's Jacobian
+    	  const covariance_t A = covarianceMatrix(p, outJp, lineDelay());
 
-          parent_t::setInvR ( ((A*_frame->keypoint(_keypointIndex).invR().inverse()*A.transpose()).inverse())); // invert
-    	  // setInvR(A*_frame->keypoint(_keypointIndex).invR()*A.transpose());
-
-    	  // std::cout << "A: " << std::endl << A << std::endl ;
-    	  //std::cout << "ARAT: " << std::endl << A*_frame->keypoint(_keypointIndex).invR()*A.transpose() << std::endl << std::endl;
+    	  // (A R A^T)^-1 = A^-T R^-1 A^-1 needs only the fixed size inverse of A
+    	  const covariance_t invA = A.inverse();
+          parent_t::setInvR(invA.transpose() * k.invR() * invA);
       }
 
       return parent_t::error().dot(parent_t::invR() * parent_t::error());
     }
 
     template<typename F>
-    double CovarianceReprojectionError<F>::observationTime()
+    double CovarianceReprojectionError<F>::lineDelay()
     {
-    	double lineDelay;
     	if(_lineDelayDv)
-    		lineDelay = _lineDelayDv->toScalar();
+    		return _lineDelayDv->toScalar();
     	else
-    		lineDelay = _frame->geometry().shutter().lineDelay();
-    	return _frame->keypointTime(_keypointIndex).toSec() + _frame->keypoint(_keypointIndex).y()(1) * lineDelay;
+    		return _frame->geometry().shutter().lineDelay();
+    }
+
+    template<typename F>
+    double CovarianceReprojectionError<F>::observationTime()
+    {
+    	return _frame->keypointTime(_keypointIndex).toSec() + _frame->keypoint(_keypointIndex).y()(1) * lineDelay();
     }
 
 
@@ -0,0 +1,38 @@
+#include <aslam/backend/OPTBSplineMotionError.hpp>
+#include <Eigen/Eigenvalues>
+
+namespace aslam {
+    namespace backend {
+
+        template<class SPLINE_T>
+        OPTBSplineMotionError<SPLINE_T>::OPTBSplineMotionError(spline_t * spline, const point_t & Wdiag, unsigned int errorTermOrder):
+        SegmentQuadraticFormErrors(spline->getSplineOrder(), spline->getPointSize()),
+        _spline(spline), _Wdiag(Wdiag), _errorTermOrder(errorTermOrder), _splineOrder((int)spline->getSplineOrder()), _pointSize((int)spline->getPointSize())
+        {
+            SM_ASSERT_LT(std::runtime_error, (int)errorTermOrder, _splineOrder, "The spline's derivatives of the spline order and higher vanish");
+            SM_ASSERT_EQ(std::runtime_error, (int)Wdiag.rows(), _pointSize, "Wdiag must be of control point size");
+
+            // the segments' contributions (Q is their sum) and their square roots R_s = diag(sqrt(lambda)) V' from Q_s = V diag(lambda) V'
+            // segment s acts on the design variables s ... s + splineOrder - 1
+            const auto & splineDesignVariables = _spline->getDesignVariables();
+            const std::vector<DesignVariable*> designVariables(splineDesignVariables.begin(), splineDesignVariables.end());
+            const spline_t & constSpline = *_spline;
+            const int segmentLength = _splineOrder * _pointSize;
+            Eigen::MatrixXd Q(segmentLength, segmentLength);
+            size_t s = 0;
+            for(typename spline_t::SegmentConstIterator i = constSpline.begin(), end = constSpline.end(); i != end; ++i) {
+                bsplines::internal::addOrSetSegmentQuadraticIntegralDiag<spline_t, Eigen::MatrixXd &>(constSpline, _Wdiag, i, _errorTermOrder, Q, false);
+                Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigenSolver(Q);
+                this->pushBackSegment(std::vector<DesignVariable*>(designVariables.begin() + s, designVariables.begin() + s + _splineOrder));
+                this->setSegmentSqrtQ(s++, eigenSolver.eigenvalues().cwiseMax(0).cwiseSqrt().asDiagonal() * eigenSolver.eigenvectors().transpose());
+            }
+        }
+
+        template<class SPLINE_T>
+        OPTBSplineMotionError<SPLINE_T>::~OPTBSplineMotionError()
+        {
+
+        }
+
+    } // namespace backend
+} // namespace aslam
@@ -0,0 +1,134 @@
+#include <aslam/backend/QuadraticIntegralSegmentError.hpp>
+
+namespace aslam {
+    namespace backend {
+
+        template<class EXPRESSION_T>
+        QuadraticIntegralSegmentError<EXPRESSION_T>::QuadraticIntegralSegmentError(const std::vector<expression_t> & expressions, const std::vector<double> & factors, const Eigen::MatrixXd & sqrtInvR):
+        ErrorTermDs(expressions.size() * sqrtInvR.rows()), _expressions(expressions), _factors(factors), _sqrtInvR(sqrtInvR), _parameterDimension(0)
+        {
+            SM_ASSERT_EQ(std::runtime_error, expressions.size(), factors.size(), "Every integration point needs a factor");
+            SM_ASSERT_FALSE(std::runtime_error, expressions.empty(), "There must be at least one integration point");
+            for(size_t p = 0; p < factors.size(); ++p) {
+                SM_ASSERT_GE(std::runtime_error, factors[p], 0.0, "The factors must not be negative");
+            }
+
+            // the points of one segment share most of their design variables
+            DesignVariable::set_t designVariables;
+            for(size_t p = 0; p < _expressions.size(); ++p) {
+                _expressions[p].getDesignVariables(designVariables);
+            }
+            for(DesignVariable::set_t::const_iterator it = designVariables.begin(); it != designVariables.end(); ++it) {
+                _offsets[*it] = _parameterDimension;
+                _parameterDimension += (*it)->minimalDimensions();
+            }
+            setDesignVariablesIterator(designVariables.begin(), designVariables.end());
+        }
+
+        template<class EXPRESSION_T>
+        QuadraticIntegralSegmentError<EXPRESSION_T>::~QuadraticIntegralSegmentError()
+        {
+
+        }
+
+
+        template<class EXPRESSION_T>
+        void QuadraticIntegralSegmentError<EXPRESSION_T>::evaluatePointJacobian(size_t p, JacobianContainerSparse<> & jacobians, Eigen::MatrixXd & J)
+        {
+            // the point's Jacobians with respect to the term's (active) design variables
+            jacobians.clear();
+            _expressions[p].evaluateJacobians(jacobians);
+            J.setZero(_sqrtInvR.rows(), _parameterDimension);
+            for(auto it = jacobians.begin(); it != jacobians.end(); ++it) {
+                J.middleCols(_offsets.find(it->first)->second, it->second.cols()) = _sqrtInvR * it->second;
+            }
+        }
+
+
+        template<class EXPRESSION_T>
+        double QuadraticIntegralSegmentError<EXPRESSION_T>::evaluateNormalEquations(Eigen::VectorXd & gradient, Eigen::MatrixXd & H)
+        {
+            gradient.setZero(_parameterDimension);
+            H.setZero(_parameterDimension, _parameterDimension);
+
+            Eigen::MatrixXd J;
+            JacobianContainerSparse<> jacobians(_sqrtInvR.cols());
+            double squaredError = 0;
+            for(size_t p = 0; p < _expressions.size(); ++p) {
+                const Eigen::VectorXd e = _sqrtInvR * _expressions[p].evaluate();
+                squaredError += _factors[p] * e.squaredNorm();
+
+                evaluatePointJacobian(p, jacobians, J);
+                gradient.noalias() += _factors[p] * J.transpose() * e;
+                H.noalias() += _factors[p] * J.transpose() * J;
+            }
+            return squaredError;
+        }
+
+
+        /// \brief evaluate the error term and return the weighted squared error e^T invR e
+        template<class EXPRESSION_T>
+        double QuadraticIntegralSegmentError<EXPRESSION_T>::evaluateErrorImplementation()
+        {
+            // the stacked residual (sqrt(f_p) sqrtInvR E_p)_p
+            const int rows = _sqrtInvR.rows();
+            Eigen::VectorXd error(dimension());
+            for(size_t p = 0; p < _expressions.size(); ++p) {
+                error.segment(p * rows, rows) = std::sqrt(_factors[p]) * (_sqrtInvR * _expressions[p].evaluate());
+            }
+            setError(error);
+            return error.squaredNorm();
+        }
+
+
+        /// \brief evaluate the jacobians
+        template<class EXPRESSION_T>
+        void QuadraticIntegralSegmentError<EXPRESSION_T>::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & _jacobians)
+        {
+            const int rows = _sqrtInvR.rows();
+            Eigen::MatrixXd J, stackedJ(dimension(), _parameterDimension);
+            JacobianContainerSparse<> jacobians(_sqrtInvR.cols());
+            for(size_t p = 0; p < _expressions.size(); ++p) {
+                evaluatePointJacobian(p, jacobians, J);
+                stackedJ.middleRows(p * rows, rows) = std::sqrt(_factors[p]) * J;
+            }
+            for(size_t i = 0; i < numDesignVariables(); i++) {
+                DesignVariable * dv = designVariable(i);
+                _jacobians.add(dv, Eigen::MatrixXd(stackedJ.middleCols(_offsets.find(dv)->second, dv->minimalDimensions())));
+            }
+        }
+
+
+        template<class EXPRESSION_T>
+        void QuadraticIntegralSegmentError<EXPRESSION_T>::buildHessianImplementation(SparseBlockMatrix & outHessian, Eigen::VectorXd & outRhs, bool useMEstimator) {
+            Eigen::VectorXd gradient;
+            Eigen::MatrixXd H;
+            const double squaredError = evaluateNormalEquations(gradient, H);
+            const double weight = useMEstimator ? _mEstimatorPolicy->getWeight(squaredError) : 1.0;
+
+            // place the hessian elements in the correct place:
+            for(size_t i = 0; i < numDesignVariables(); i++)
+            {
+            	DesignVariable * dvi = designVariable(i);
+            	if(!dvi->isActive()) continue;
+
+            	// <- this is our column index
+            	const int colBlockIndex = dvi->blockIndex();
+            	const int colOffset = _offsets.find(dvi)->second, cols = dvi->minimalDimensions();
+            	for(size_t j = 0; j < numDesignVariables(); j++)
+            	{
+            		DesignVariable * dvj = designVariable(j);
+            		if (dvj->isActive() && dvj->blockIndex() <= colBlockIndex) { // upper triangle should be sufficient
+            			// get the Hessian Block
+            			const bool allocateIfMissing = true;
+            			Eigen::MatrixXd *Hblock = outHessian.block(dvj->blockIndex(), colBlockIndex, allocateIfMissing);
+            			*Hblock += weight * H.block(_offsets.find(dvj)->second, colOffset, dvj->minimalDimensions(), cols);  // insert!
+            		}
+            	}
+
+            	outRhs.segment(outHessian.colBaseOfBlock(colBlockIndex), cols) -= weight * gradient.segment(colOffset, cols);
+            }
+        }
+
+    } // namespace backend
+} // namespace aslam
@@ -0,0 +1,119 @@
+#include <aslam/backend/SegmentQuadraticFormError.hpp>
+
+namespace aslam {
+    namespace backend {
+
+        inline SegmentQuadraticFormError::SegmentQuadraticFormError(const std::vector<DesignVariable*> & designVariables, int blockSize):
+        ErrorTermDs(designVariables.size() * blockSize), _blockSize(blockSize)
+        {
+            this->setDesignVariables(designVariables);
+        }
+
+        inline SegmentQuadraticFormError::~SegmentQuadraticFormError()
+        {
+
+        }
+
+
+        inline void SegmentQuadraticFormError::setSqrtQ(const Eigen::MatrixXd & sqrtQ)
+        {
+            const int segmentLength = dimension();
+            SM_ASSERT_TRUE(std::runtime_error, sqrtQ.rows() == segmentLength && sqrtQ.cols() == segmentLength, "R_s must be bandWidth * blockSize square");
+            _sqrtQ = sqrtQ;
+        }
+
+
+        inline Eigen::VectorXd SegmentQuadraticFormError::getCoefficientVector() const
+        {
+            Eigen::VectorXd c(dimension());
+            Eigen::MatrixXd p;
+            for(size_t i = 0; i < numDesignVariables(); ++i) {
+                designVariable(i)->getParameters(p);
+                c.segment(i * _blockSize, _blockSize) = Eigen::Map<const Eigen::VectorXd>(p.data(), _blockSize);
+            }
+            return c;
+        }
+
+
+        /// \brief evaluate the error term and return the weighted squared error e^T invR e
+        inline double SegmentQuadraticFormError::evaluateErrorImplementation()
+        {
+            const Eigen::VectorXd error = _sqrtQ * getCoefficientVector();
+            setError(error);
+            return error.squaredNorm();
+        }
+
+
+        /// \brief evaluate the jacobians
+        inline void SegmentQuadraticFormError::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & _jacobians)
+        {
+            // the residual is linear in c_s: design variable i's Jacobian are its columns of R_s
+            for(size_t i = 0; i < numDesignVariables(); i++) {
+                _jacobians.add(designVariable(i), _sqrtQ.middleCols(i * _blockSize, _blockSize));
+            }
+        }
+
+
+        inline SegmentQuadraticFormErrors::SegmentQuadraticFormErrors(int bandWidth, int blockSize):
+        _bandWidth(bandWidth), _blockSize(blockSize)
+        {
+
+        }
+
+        inline SegmentQuadraticFormErrors::~SegmentQuadraticFormErrors()
+        {
+
+        }
+
+
+        inline const SegmentQuadraticFormError::Ptr & SegmentQuadraticFormErrors::pushBackSegment(const std::vector<DesignVariable*> & designVariables)
+        {
+            SM_ASSERT_EQ(std::runtime_error, (int)designVariables.size(), _bandWidth, "a segment acts on bandWidth design variables");
+            _segmentErrors.push_back(SegmentQuadraticFormError::Ptr(new SegmentQuadraticFormError(designVariables, _blockSize)));
+            return _segmentErrors.back();
+        }
+
+
+        inline SegmentQuadraticFormError::Ptr SegmentQuadraticFormErrors::popFrontSegment()
+        {
+            SegmentQuadraticFormError::Ptr front = _segmentErrors.front();
+            _segmentErrors.pop_front();
+            return front;
+        }
+
+
+        inline double SegmentQuadraticFormErrors::evaluateError()
+        {
+            double error = 0;
+            for(const auto & e : _segmentErrors) {
+                error += e->evaluateError();
+            }
+            return error;
+        }
+
+
+        inline Eigen::MatrixXd SegmentQuadraticFormErrors::Q() const {
+            // segment s acts on the design variables s ... s + bandWidth - 1
+            const int length = _segmentErrors.empty() ? 0 : (_segmentErrors.size() + _bandWidth - 1) * _blockSize;
+            Eigen::MatrixXd Q = Eigen::MatrixXd::Zero(length, length);
+            const int segmentLength = _bandWidth * _blockSize;
+            for(size_t s = 0; s < _segmentErrors.size(); ++s) {
+                Q.block(s * _blockSize, s * _blockSize, segmentLength, segmentLength) += _segmentErrors[s]->Q();
+            }
+            return Q;
+        }
+
+
+        inline Eigen::VectorXd SegmentQuadraticFormErrors::rhs() const {
+            // right hand side: -Q c
+            const int length = _segmentErrors.empty() ? 0 : (_segmentErrors.size() + _bandWidth - 1) * _blockSize;
+            Eigen::VectorXd b_u = Eigen::VectorXd::Zero(length);
+            const int segmentLength = _bandWidth * _blockSize;
+            for(size_t s = 0; s < _segmentErrors.size(); ++s) {
+                b_u.segment(s * _blockSize, segmentLength) -= _segmentErrors[s]->Q() * _segmentErrors[s]->getCoefficientVector();
+            }
+            return b_u;
+        }
+
+    } // namespace backend
+} // namespace aslam
@@ -10,6 +10,7 @@
 #include <aslam/backend/EuclideanExpression.hpp>
 #include <aslam/backend/VectorExpression.hpp>
 #include <aslam/backend/VectorExpressionNode.hpp>
+#include "ExpressionNodeArena.hpp"
 #include "BSplineExpressions.hpp"
 namespace aslam {
     namespace splines {
@@ -43,6 +44,10 @@ namespace aslam {
       
             std::vector<aslam::backend::DesignVariable *> getDesignVariables(double time) const;
 
+            /// \brief allocate the expression nodes created from now on in the arena (NULL: on the heap). The arena must outlive them.
+            void setExpressionNodeArena(ExpressionNodeArena * arena) { _expressionNodeArena = arena; }
+            ExpressionNodeArena * getExpressionNodeArena() const { return _expressionNodeArena; }
+
             // Fabio:
             // add one Segment at the end of the PoseSpline
             void addSegment(double t, const Eigen::VectorXd & p);
@@ -50,11 +55,17 @@ namespace aslam {
             void removeSegment();
 
         protected:
+            /// \brief the design variables of the segment at time tk in a per-thread buffer, valid until the thread's next call
+            const std::vector<aslam::backend::DesignVariable *> & localDesignVariables(double tk);
+
             /// \brief the internal spline.
             bsplines::BSpline _bspline;
 
             /// \brief the vector of design variables.
             boost::ptr_vector< dv_t > _designVariables;
+
+            /// \brief the arena of the expression nodes (or NULL)
+            ExpressionNodeArena * _expressionNodeArena;
       
         };
     
@@ -14,16 +14,21 @@
 #include <aslam/backend/VectorExpressionNode.hpp>
 #include <aslam/backend/DesignVariableVector.hpp>
 #include <aslam/backend/ScalarExpression.hpp>
+#include "ExpressionNodeArena.hpp"
+#include "BSplinePoseEvaluationCache.hpp"
 
 namespace aslam {
     namespace splines {
         class BSplinePoseDesignVariable;
 
+        /// the design variables of a node, allocated from the node's ExpressionNodeArena (if any)
+        typedef std::vector<aslam::backend::DesignVariable *, ExpressionNodeArenaAllocator<aslam::backend::DesignVariable *> > node_design_variables_t;
+
         // aslam::backend::TransformationExpression transformation(double tk);
         class BSplineTransformationExpressionNode : public aslam::backend::TransformationExpressionNode
         {
         public:
-            BSplineTransformationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time);
+            BSplineTransformationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache = NULL, ExpressionNodeArena * arena = NULL);
             virtual ~BSplineTransformationExpressionNode();
 
         protected:
@@ -32,15 +37,16 @@ namespace aslam {
             virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
             bsplines::BSplinePose * _spline;
-            std::vector<aslam::backend::DesignVariable *> _designVariables;
+            node_design_variables_t _designVariables;
             double _time;
+            BSplinePoseEvaluationCache * _cache;
         };
 
         // aslam::backend::TransformationExpression transformation(double tk);
         class BSplineRotationExpressionNode : public aslam::backend::RotationExpressionNode
         {
         public:
-            BSplineRotationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time);
+            BSplineRotationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache = NULL, ExpressionNodeArena * arena = NULL);
             virtual ~BSplineRotationExpressionNode();
 
         protected:
@@ -49,8 +55,9 @@ namespace aslam {
             virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
             bsplines::BSplinePose * _spline;
-            std::vector<aslam::backend::DesignVariable *> _designVariables;
+            node_design_variables_t _designVariables;
             double _time;
+            BSplinePoseEvaluationCache * _cache;
 
         };
 
@@ -60,7 +67,7 @@ namespace aslam {
         class BSplinePositionExpressionNode : public aslam::backend::EuclideanExpressionNode
         {
         public:
-            BSplinePositionExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time);
+            BSplinePositionExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache = NULL, ExpressionNodeArena * arena = NULL);
             virtual ~BSplinePositionExpressionNode();
 
         protected:
@@ -69,8 +76,9 @@ namespace aslam {
             virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
             bsplines::BSplinePose * _spline;
-            std::vector<aslam::backend::DesignVariable *> _designVariables;
+            node_design_variables_t _designVariables;
             double _time;
+            BSplinePoseEvaluationCache * _cache;
 
         };
 
@@ -78,7 +86,7 @@ namespace aslam {
         class BSplineVelocityExpressionNode : public aslam::backend::EuclideanExpressionNode
         {
         public:
-            BSplineVelocityExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time);
+            BSplineVelocityExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache = NULL, ExpressionNodeArena * arena = NULL);
             virtual ~BSplineVelocityExpressionNode();
 
         protected:
@@ -87,8 +95,9 @@ namespace aslam {
             virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
             bsplines::BSplinePose * _spline;
-            std::vector<aslam::backend::DesignVariable *> _designVariables;
+            node_design_variables_t _designVariables;
             double _time;
+            BSplinePoseEvaluationCache * _cache;
 
         };
 
@@ -98,7 +107,7 @@ namespace aslam {
         class BSplineAccelerationExpressionNode : public aslam::backend::EuclideanExpressionNode
         {
         public:
-            BSplineAccelerationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time);
+            BSplineAccelerationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache = NULL, ExpressionNodeArena * arena = NULL);
             virtual ~BSplineAccelerationExpressionNode();
 
         protected:
@@ -107,8 +116,9 @@ namespace aslam {
             virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
             bsplines::BSplinePose * _spline;
-            std::vector<aslam::backend::DesignVariable *> _designVariables;
+            node_design_variables_t _designVariables;
             double _time;
+            BSplinePoseEvaluationCache * _cache;
 
         };
 
@@ -117,7 +127,7 @@ namespace aslam {
     public:
         BSplineAccelerationBodyFrameExpressionNode(bsplines::BSplinePose*
           spline, const std::vector<aslam::backend::DesignVariable*>&
-          designVariables, double time);
+          designVariables, double time, BSplinePoseEvaluationCache * cache = NULL, ExpressionNodeArena * arena = NULL);
         virtual ~BSplineAccelerationBodyFrameExpressionNode();
 
     protected:
@@ -128,15 +138,16 @@ namespace aslam {
           aslam::backend::DesignVariable::set_t& designVariables) const override;
 
         bsplines::BSplinePose* _spline;
-        std::vector<aslam::backend::DesignVariable*> _designVariables;
+        node_design_variables_t _designVariables;
         double _time;
+        BSplinePoseEvaluationCache * _cache;
 
     };
 
         class BSplineAngularVelocityBodyFrameExpressionNode : public aslam::backend::EuclideanExpressionNode
         {
         public:
-            BSplineAngularVelocityBodyFrameExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time);
+            BSplineAngularVelocityBodyFrameExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache = NULL, ExpressionNodeArena * arena = NULL);
             virtual ~BSplineAngularVelocityBodyFrameExpressionNode();
 
         protected:
@@ -145,8 +156,9 @@ namespace aslam {
             virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
             bsplines::BSplinePose * _spline;
-            std::vector<aslam::backend::DesignVariable *> _designVariables;
+            node_design_variables_t _designVariables;
             double _time;
+            BSplinePoseEvaluationCache * _cache;
 
         };
 
@@ -154,7 +166,7 @@ namespace aslam {
         class BSplineAngularAccelerationBodyFrameExpressionNode : public aslam::backend::EuclideanExpressionNode
         {
          public:
-          BSplineAngularAccelerationBodyFrameExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time);
+          BSplineAngularAccelerationBodyFrameExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache = NULL, ExpressionNodeArena * arena = NULL);
           virtual ~BSplineAngularAccelerationBodyFrameExpressionNode();
 
          protected:
@@ -163,8 +175,9 @@ namespace aslam {
           virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
           bsplines::BSplinePose * _spline;
-          std::vector<aslam::backend::DesignVariable *> _designVariables;
+          node_design_variables_t _designVariables;
           double _time;
+          BSplinePoseEvaluationCache * _cache;
         };
 
         template<int DIM>
@@ -172,7 +185,7 @@ namespace aslam {
         {
         public:
             typedef typename aslam::backend::VectorExpressionNode<DIM>::vector_t vector_t;
-            BSplineVectorExpressionNode(bsplines::BSpline * spline, int derivativeOrder, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time);
+            BSplineVectorExpressionNode(bsplines::BSpline * spline, int derivativeOrder, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, ExpressionNodeArena * arena = NULL);
             virtual ~BSplineVectorExpressionNode();
 
         protected:
@@ -182,7 +195,7 @@ namespace aslam {
             virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
             bsplines::BSpline * _spline;
-            std::vector<aslam::backend::DesignVariable *> _designVariables;
+            node_design_variables_t _designVariables;
             double _time;
             int _derivativeOrder;
 
@@ -217,7 +230,7 @@ namespace aslam {
         class BSplineEuclideanExpressionNode : public aslam::backend::EuclideanExpressionNode
         {
         public:
-            BSplineEuclideanExpressionNode(bsplines::BSpline * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, int derivativeOrder);
+            BSplineEuclideanExpressionNode(bsplines::BSpline * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, int derivativeOrder, ExpressionNodeArena * arena = NULL);
             virtual ~BSplineEuclideanExpressionNode();
 
         protected:
@@ -226,7 +239,7 @@ namespace aslam {
             virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override;
 
             bsplines::BSpline * _spline;
-            std::vector<aslam::backend::DesignVariable *> _designVariables;
+            node_design_variables_t _designVariables;
             double _time;
             int _order;
         };
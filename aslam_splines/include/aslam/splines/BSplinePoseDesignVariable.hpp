@@ -10,6 +10,8 @@
 #include <aslam/backend/EuclideanExpression.hpp>
 #include <aslam/backend/VectorExpression.hpp>
 #include <aslam/backend/ScalarExpression.hpp>
+#include "ExpressionNodeArena.hpp"
+#include "BSplinePoseEvaluationCache.hpp"
 
 namespace aslam {
     namespace splines {
@@ -56,6 +58,18 @@ namespace aslam {
             Eigen::VectorXi getActiveDesignVariableIndices(double tk);
             // Fabio:
             std::vector<aslam::backend::DesignVariable *> getDesignVariables(double tk);
+
+            /// \brief allocate the expression nodes created from now on in the arena (NULL: on the heap). The arena must outlive them.
+            void setExpressionNodeArena(ExpressionNodeArena * arena) { _expressionNodeArena = arena; }
+            ExpressionNodeArena * getExpressionNodeArena() const { return _expressionNodeArena; }
+
+            /// \brief let the expressions created from now on share their spline evaluations at the same time (off by default).
+            /// Pays off when several expressions are evaluated at each time; otherwise the nodes evaluate the spline directly.
+            void setUseEvaluationCache(bool useEvaluationCache) { _useEvaluationCache = useEvaluationCache; }
+            bool useEvaluationCache() const { return _useEvaluationCache; }
+
+            /// \brief the evaluations shared by this spline's expressions at the same time
+            BSplinePoseEvaluationCache & evaluationCache() { return _evaluationCache; }
       
 
             // Fabio:
@@ -65,11 +79,41 @@ namespace aslam {
             void removeSegment();
 
         private:
+            /// \brief a control vertex that invalidates the evaluation cache whenever its value changes
+            class ControlVertexDesignVariable : public dv_t
+            {
+            public:
+                ControlVertexDesignVariable(Eigen::Map<Eigen::Matrix<double, 6, 1> > v, BSplinePoseEvaluationCache * cache) : dv_t(v), _cache(cache) {}
+
+            protected:
+                virtual void updateImplementation(const double * dp, int size) { dv_t::updateImplementation(dp, size); _cache->invalidate(); }
+                virtual void revertUpdateImplementation() { dv_t::revertUpdateImplementation(); _cache->invalidate(); }
+                virtual void setParametersImplementation(const Eigen::MatrixXd & value) { dv_t::setParametersImplementation(value); _cache->invalidate(); }
+
+            private:
+                BSplinePoseEvaluationCache * _cache;
+            };
+
+            /// \brief the cache for new expression nodes (NULL if not used)
+            BSplinePoseEvaluationCache * expressionEvaluationCache() { return _useEvaluationCache ? &_evaluationCache : NULL; }
+
+            /// \brief the design variables of the segment at time tk in a per-thread buffer, valid until the thread's next call
+            const std::vector<aslam::backend::DesignVariable *> & localDesignVariables(double tk);
+
             /// \brief the internal spline.
             bsplines::BSplinePose _bsplinePose;
 
             /// \brief the vector of design variables.
             boost::ptr_vector< dv_t > _designVariables;
+
+            /// \brief the arena of the expression nodes (or NULL)
+            ExpressionNodeArena * _expressionNodeArena;
+
+            /// \brief the memoized spline evaluations of the expression nodes, valid for the current coefficients
+            BSplinePoseEvaluationCache _evaluationCache;
+
+            /// \brief whether new expression nodes use _evaluationCache
+            bool _useEvaluationCache;
       
         };
     
@@ -0,0 +1,91 @@
+#ifndef ASLAM_SPLINES_BSPLINE_POSE_EVALUATION_CACHE_HPP
+#define ASLAM_SPLINES_BSPLINE_POSE_EVALUATION_CACHE_HPP
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <bsplines/BSplinePose.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace aslam {
+    namespace splines {
+
+        /// \brief The pose spline evaluated at a time: everything the BSplinePoseDesignVariable's expression nodes need for their values and Jacobians.
+        struct BSplinePoseEvaluation
+        {
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+            enum { MaxDerivativeOrder = 2 };
+
+            /// column d holds the relevant basis functions' d's derivatives; the Jacobian of derivative d with respect to coefficient i is basis(i, d) * I
+            Eigen::MatrixXd basis;
+            /// column d is the curve's d's derivative
+            Eigen::Matrix<double, 6, MaxDerivativeOrder + 1> derivatives;
+            /// the transformation and its Jacobian with respect to the curve value
+            Eigen::Matrix4d T;
+            Eigen::Matrix<double, 6, 6> JT;
+            /// the orientation and its S matrix (see sm::kinematics::RotationalKinematics::parametersToRotationMatrix)
+            Eigen::Matrix3d C;
+            Eigen::Matrix3d S;
+        };
+
+        /// \brief Memoizes the evaluations of a pose spline at the times of its expressions.
+        ///
+        /// Expressions at the same time (e.g. pose, velocity and angular velocity of one measurement) share one evaluation per
+        /// linearization point instead of evaluating the spline segment again for each value and Jacobian.
+        /// The owner invalidates the cache whenever the coefficients change (BSplinePoseDesignVariable does so on every design
+        /// variable update, revert and parameter change). Invalidating only advances a generation counter; evaluations of an older
+        /// generation are recomputed in place when their time is requested again, so a step does not pay for clearing the cache.
+        /// The evaluations are spread over independently locked shards and computed outside the locks, so concurrent error
+        /// term evaluations rarely wait for each other. Evaluations are immutable and stay valid while referenced.
+        class BSplinePoseEvaluationCache
+        {
+        public:
+            typedef boost::shared_ptr<const BSplinePoseEvaluation> EvaluationPtr;
+
+            BSplinePoseEvaluationCache() : _generation(0) {}
+            /// \brief copies start empty (they usually belong to another spline)
+            BSplinePoseEvaluationCache(const BSplinePoseEvaluationCache &) : _generation(0) {}
+            BSplinePoseEvaluationCache & operator = (const BSplinePoseEvaluationCache &) { clear(); return *this; }
+
+            /// \brief the (memoized) evaluation of spline at tk
+            EvaluationPtr evaluate(const bsplines::BSplinePose & spline, double tk);
+
+            /// \brief marks all evaluations as outdated in O(1); necessary whenever the coefficients change
+            void invalidate() { ++_generation; }
+
+            /// \brief drops all evaluations; necessary whenever the knots change
+            void clear();
+
+            /// \brief the number of evaluations that are valid for the current coefficients
+            size_t size() const;
+
+            /// \brief evaluates spline at tk without memoization
+            static EvaluationPtr compute(const bsplines::BSplinePose & spline, double tk);
+
+        private:
+            enum { NumShards = 16 };
+
+            struct Entry
+            {
+                unsigned generation;
+                EvaluationPtr evaluation;
+            };
+
+            struct Shard
+            {
+                mutable std::mutex mutex;
+                std::map<double, Entry> evaluations;
+            };
+
+            Shard & shard(double tk) { return _shards[std::hash<double>()(tk) % NumShards]; }
+
+            std::atomic<unsigned> _generation;
+            Shard _shards[NumShards];
+        };
+
+    } // namespace splines
+} // namespace aslam
+
+#endif /* ASLAM_SPLINES_BSPLINE_POSE_EVALUATION_CACHE_HPP */
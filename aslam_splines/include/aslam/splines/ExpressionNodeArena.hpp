@@ -0,0 +1,111 @@
+#ifndef ASLAM_SPLINES_EXPRESSION_NODE_ARENA_HPP
+#define ASLAM_SPLINES_EXPRESSION_NODE_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace aslam {
+    namespace splines {
+
+        /// \brief A monotonic memory arena for expression nodes (and their shared_ptr control blocks).
+        ///
+        /// Memory is taken from large blocks and only released when the arena is destroyed, so building
+        /// many expressions costs few heap allocations. The arena must outlive every expression allocated from it,
+        /// e.g. by declaring it before the optimization problem holding the error terms.
+        /// Allocations lock a mutex, so the parallel error term builders may create expressions in the same arena concurrently.
+        class ExpressionNodeArena : private boost::noncopyable
+        {
+        public:
+            ExpressionNodeArena(std::size_t blockSize = 1 << 16) : _blockSize(blockSize), _current(NULL), _left(0), _bytesAllocated(0) {}
+            ~ExpressionNodeArena() {
+                for(std::size_t i = 0; i < _blocks.size(); ++i) ::operator delete(_blocks[i]);
+            }
+
+            void * allocate(std::size_t bytes, std::size_t alignment) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                std::size_t padding = (alignment - reinterpret_cast<std::size_t>(_current) % alignment) % alignment;
+                if(_current == NULL || padding + bytes > _left) {
+                    // requests larger than a block get a block of their own
+                    const std::size_t blockSize = std::max(_blockSize, bytes + alignment);
+                    _blocks.push_back(::operator new(blockSize));
+                    _current = static_cast<char *>(_blocks.back());
+                    _left = blockSize;
+                    padding = (alignment - reinterpret_cast<std::size_t>(_current) % alignment) % alignment;
+                }
+                void * p = _current + padding;
+                _current += padding + bytes;
+                _left -= padding + bytes;
+                _bytesAllocated += bytes;
+                return p;
+            }
+
+            std::size_t numBlocks() const { std::lock_guard<std::mutex> lock(_mutex); return _blocks.size(); }
+            std::size_t bytesAllocated() const { std::lock_guard<std::mutex> lock(_mutex); return _bytesAllocated; }
+
+        private:
+            std::size_t _blockSize;
+            std::vector<void *> _blocks;
+            char * _current;
+            std::size_t _left;
+            std::size_t _bytesAllocated;
+            mutable std::mutex _mutex;
+        };
+
+        /// \brief An allocator drawing from an ExpressionNodeArena or, without arena, from the heap.
+        template<typename T>
+        class ExpressionNodeArenaAllocator
+        {
+        public:
+            typedef T value_type;
+            typedef T * pointer;
+            typedef const T * const_pointer;
+            typedef T & reference;
+            typedef const T & const_reference;
+            typedef std::size_t size_type;
+            typedef std::ptrdiff_t difference_type;
+            template<typename U> struct rebind { typedef ExpressionNodeArenaAllocator<U> other; };
+
+            explicit ExpressionNodeArenaAllocator(ExpressionNodeArena * arena = NULL) : _arena(arena) {}
+            template<typename U> ExpressionNodeArenaAllocator(const ExpressionNodeArenaAllocator<U> & other) : _arena(other.arena()) {}
+
+            T * allocate(std::size_t n, const void * = 0) {
+                if(_arena) return static_cast<T *>(_arena->allocate(n * sizeof(T), std::max<std::size_t>(alignof(T), 16)));
+                return static_cast<T *>(::operator new(n * sizeof(T)));
+            }
+            /// memory of an arena is released with the arena
+            void deallocate(T * p, std::size_t) {
+                if(!_arena) ::operator delete(p);
+            }
+
+            template<typename U, typename ... Args> void construct(U * p, Args && ... args) { ::new(static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+            template<typename U> void destroy(U * p) { p->~U(); }
+            std::size_t max_size() const { return std::size_t(-1) / sizeof(T); }
+
+            ExpressionNodeArena * arena() const { return _arena; }
+
+            template<typename U> bool operator == (const ExpressionNodeArenaAllocator<U> & other) const { return _arena == other.arena(); }
+            template<typename U> bool operator != (const ExpressionNodeArenaAllocator<U> & other) const { return _arena != other.arena(); }
+
+        private:
+            ExpressionNodeArena * _arena;
+        };
+
+        /// \brief creates an expression node (with its reference count) in the arena or, if arena is NULL, in one heap allocation
+        template<typename Node, typename ... Args>
+        boost::shared_ptr<Node> allocateExpressionNode(ExpressionNodeArena * arena, Args && ... args)
+        {
+            if(arena) return boost::allocate_shared<Node>(ExpressionNodeArenaAllocator<Node>(arena), std::forward<Args>(args)...);
+            return boost::make_shared<Node>(std::forward<Args>(args)...);
+        }
+
+    } // namespace splines
+} // namespace aslam
+
+#endif /* ASLAM_SPLINES_EXPRESSION_NODE_ARENA_HPP */
@@ -19,6 +19,7 @@
 #include <aslam/backend/DesignVariable.hpp>
 #include <aslam/backend/VectorExpression.hpp>
 #include <aslam/backend/VectorExpressionNode.hpp>
+#include "ExpressionNodeArena.hpp"
 
 #include <bsplines/manifolds/LieGroup.hpp>
 
@@ -81,10 +82,11 @@ namespace internal {
 			_p_v = this->getControlVertex();
 			Eigen::Map<const tangent_vector_t> dpV(dp, size);
 			UpdateTraits::update(_manifold, this->getControlVertex(), dpV);
+			this->accessCache().handleUpdatedValueEvent();
 		};
 
 		/// \brief Revert the last state update.
-		virtual void revertUpdateImplementation() { this->getControlVertex() = _p_v ; }
+		virtual void revertUpdateImplementation() { this->setControlVertex(_p_v); }
 
 		/// Returns the content of the design variable
 		virtual void getParametersImplementation(Eigen::MatrixXd& value) const {
@@ -94,7 +96,7 @@ namespace internal {
 		/// Sets the content of the design variable
 		virtual void setParametersImplementation(const Eigen::MatrixXd& value) {
 			_p_v = this->getControlVertex();
-			this->getControlVertex() = value;
+			this->setControlVertex(value);
 		}
 
 		inline aslam::backend::DesignVariable & getDesignVariable(){ return *this; }
@@ -171,8 +173,15 @@ class DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<TModi
 		for(auto dvp : getDesignVariables(time)) problem.addDesignVariable(dvp, false);
 	}
 
+	/// allocate the expressions (and their factories' data) created from now on in the arena (nullptr: on the heap). The arena must outlive them.
+	void setExpressionNodeArena(aslam::splines::ExpressionNodeArena * arena) { _expressionNodeArena = arena; }
+	aslam::splines::ExpressionNodeArena * getExpressionNodeArena() const { return _expressionNodeArena; }
+
 	// add one Segment at the end of the Spline
 	time_t appendSegments(KnotGenerator<time_t> & knotGenerator, int numSegments, const point_t * value);
+	// remove the segments not relevant for t and their design variables (they must not be part of an optimization problem anymore)
+	size_t removeSegmentsBefore(const time_t & t);
+	// remove the first valid segment
 	void removeSegment();
 
 	template <typename FactoryData_>
@@ -184,7 +193,7 @@ class DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<TModi
 		expression_t getValueExpression(int derivativeOrder = 0) const;
 	 protected:
 		inline const DataSharedPtr & getDataPtr() const { return _dataPtr; }
-		inline ExpressionFactory(const FactoryData_ & factoryData) : _dataPtr(new FactoryData_(factoryData)) {}
+		inline ExpressionFactory(const FactoryData_ & factoryData) : _dataPtr(aslam::splines::allocateExpressionNode<FactoryData_>(factoryData.getSpline().getExpressionNodeArena(), factoryData)) {}
 		friend class DiffManifoldBSpline;
 	 private:
 		DataSharedPtr _dataPtr;
@@ -201,6 +210,9 @@ class DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<TModi
 		inline void getDesignVariables(aslam::backend::DesignVariable::set_t & designVariables) const { for(auto & i : _eval) { designVariables.insert(const_cast<aslam::backend::DesignVariable *>(&i.getDesignVariable())); }}
 		inline bool hasTimeExpression(){ return false; }
 		inline const TimeExpression & getTimeExpression(){ throw std::runtime_error("not implemented"); }
+		/// the segments relevant for the expressions
+		inline SegmentConstIterator begin() const { return _eval.begin(); }
+		inline SegmentConstIterator end() const { return _eval.end(); }
 	 protected:
 		inline ConstTimeFactoryData() = default;
 	 private:
@@ -252,6 +264,7 @@ class DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<TModi
 
 	/// \brief the vector of design variables.
 	std::vector< dv_t * > _designVariables;
+	aslam::splines::ExpressionNodeArena * _expressionNodeArena = nullptr;
 	void updateDesignVariablesVector();
 };
 }
@@ -0,0 +1,204 @@
+/*
+ * OPTCompositeBSpline.hpp
+ *
+ *  Design variable support for the CompositeBSpline : every segment carries one design variable per component.
+ *  The primary component's design variables and expressions are the ones of the primary spline's OPTBSpline, the Euclidean components' are added here.
+ */
+
+#ifndef OPTCOMPOSITEBSPLINE_HPP_
+#define OPTCOMPOSITEBSPLINE_HPP_
+
+#include "OPTBSpline.hpp"
+#include "OPTUnitQuaternionBSpline.hpp"
+#include "bsplines/CompositeBSpline.hpp"
+
+namespace bsplines {
+namespace internal {
+	/// \brief the design variable of a segment's Euclidean control vertex of dimension IDimension
+	template <int IDimension, typename TCache>
+	class EuclideanDesignVariable : public aslam::backend::DesignVariable {
+	public:
+		typedef Eigen::Matrix<double, IDimension, 1> point_t;
+
+		EuclideanDesignVariable() : _point(NULL), _cache(NULL) {}
+		/// a plain copy would point into the source segment's control vertex
+		EuclideanDesignVariable(const EuclideanDesignVariable &) = delete;
+		/// assigns the design variable's state but stays attached to its own segment
+		EuclideanDesignVariable & operator=(const EuclideanDesignVariable & other) {
+			aslam::backend::DesignVariable::operator=(other);
+			_p_v = other._p_v;
+			return *this;
+		}
+
+		/// attaches the design variable to its segment's control vertex and cache
+		void attach(point_t * point, TCache * cache) { _point = point; _cache = cache; }
+
+	protected:
+		virtual int minimalDimensionsImplementation() const { return IDimension; }
+
+		virtual void updateImplementation(const double * dp, int size){
+			SM_ASSERT_EQ_DBG(std::runtime_error, (int)IDimension, size, "");
+			_p_v = *_point;
+			*_point += Eigen::Map<const point_t>(dp);
+			_cache->handleUpdatedValueEvent();
+		}
+
+		virtual void revertUpdateImplementation() { *_point = _p_v; _cache->handleUpdatedValueEvent(); }
+
+		virtual void getParametersImplementation(Eigen::MatrixXd& value) const { value = *_point; }
+
+		virtual void setParametersImplementation(const Eigen::MatrixXd& value) {
+			_p_v = *_point;
+			*_point = value;
+			_cache->handleUpdatedValueEvent();
+		}
+
+		virtual void minimalDifferenceImplementation(const Eigen::MatrixXd& xHat, Eigen::VectorXd& outDifference) const {
+			SM_ASSERT_TRUE(std::runtime_error, (xHat.rows() == IDimension) && (xHat.cols() == 1), "xHat has incompatible dimensions");
+			outDifference = *_point - xHat;
+		}
+
+		virtual void minimalDifferenceAndJacobianImplementation(const Eigen::MatrixXd& xHat, Eigen::VectorXd& outDifference, Eigen::MatrixXd& outJacobian) const {
+			minimalDifferenceImplementation(xHat, outDifference);
+			outJacobian = Eigen::MatrixXd::Identity(IDimension, IDimension);
+		}
+
+	private:
+		point_t * _point;
+		TCache * _cache;
+		point_t _p_v;
+	};
+
+	template <typename TPrimaryBSplineConfiguration, int ... IEuclideanDimensions, typename TDiffManifoldBSplineConfigurationDerived>
+	struct SegmentData< ::aslam::splines::DesignVariableSegmentBSplineConf<CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...>, TDiffManifoldBSplineConfigurationDerived> > : public SegmentData< ::aslam::splines::DesignVariableSegmentBSplineConf<TPrimaryBSplineConfiguration, TDiffManifoldBSplineConfigurationDerived> > {
+	private:
+		typedef SegmentData< ::aslam::splines::DesignVariableSegmentBSplineConf<TPrimaryBSplineConfiguration, TDiffManifoldBSplineConfigurationDerived> > parent_t;
+		typedef typename parent_t::cache_t::PerNodeCache per_node_cache_t;
+
+	public:
+		typedef typename parent_t::Manifold Manifold;
+		typedef typename parent_t::point_t point_t;
+		typedef typename parent_t::time_t time_t;
+		typedef typename CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...>::EuclideanComponents EuclideanComponents;
+		typedef std::tuple<EuclideanDesignVariable<IEuclideanDimensions, per_node_cache_t>...> euclidean_design_variables_t;
+
+		template <typename TConfiguration>
+		SegmentData(const TConfiguration & configuration, const Manifold & manifold, const time_t & time, const point_t & point) : parent_t(configuration, manifold, time, point) { attachEuclideanDesignVariables(typename EuclideanComponents::indices_t()); }
+		/// the Euclidean design variables must stay attached to their own segment's control vertices
+		SegmentData(const SegmentData & other) : parent_t(other), _euclideanDesignVariables() {
+			attachEuclideanDesignVariables(typename EuclideanComponents::indices_t());
+			_euclideanDesignVariables = other._euclideanDesignVariables;
+		}
+
+		template <int IComponent = 0>
+		inline aslam::backend::DesignVariable & getEuclideanDesignVariable(){ return std::get<IComponent>(_euclideanDesignVariables); }
+		template <int IComponent = 0>
+		inline const aslam::backend::DesignVariable & getEuclideanDesignVariable() const { return std::get<IComponent>(_euclideanDesignVariables); }
+
+	private:
+		template <int ... IComponents>
+		void attachEuclideanDesignVariables(IntSequence<IComponents...>) {
+			int expand[] = { (std::get<IComponents>(_euclideanDesignVariables).attach(&std::get<IComponents>(this->_euclideanPoints), &this->accessCache()), 0)... };
+			(void) expand;
+		}
+
+		euclidean_design_variables_t _euclideanDesignVariables;
+	};
+}
+
+template <typename TPrimaryBSplineConfiguration, int ... IEuclideanDimensions, typename TModifiedDerivedConf>
+class DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...>, TModifiedDerivedConf>, aslam::splines::DesignVariableSegmentBSplineConf<TModifiedDerivedConf> >
+	: public DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<TPrimaryBSplineConfiguration, TModifiedDerivedConf>, aslam::splines::DesignVariableSegmentBSplineConf<TModifiedDerivedConf> >{
+protected:
+	typedef DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<TPrimaryBSplineConfiguration, TModifiedDerivedConf>, aslam::splines::DesignVariableSegmentBSplineConf<TModifiedDerivedConf> > parent_t;
+	typedef aslam::splines::DesignVariableSegmentBSplineConf<TModifiedDerivedConf> CONF;
+public:
+	typedef typename parent_t::spline_t spline_t;
+	typedef typename parent_t::TimePolicy TimePolicy;
+	typedef typename parent_t::time_t time_t;
+	typedef typename parent_t::point_t point_t;
+	typedef typename parent_t::dv_t dv_t;
+	typedef typename parent_t::SegmentIterator SegmentIterator;
+	typedef typename parent_t::SegmentConstIterator SegmentConstIterator;
+	typedef typename parent_t::EuclideanComponents EuclideanComponents;
+
+	enum {
+		NumberOfEuclideanComponents = parent_t::NumberOfEuclideanComponents
+	};
+
+	/// the types of the IComponent's Euclidean component
+	template <int IComponent>
+	struct EuclideanComponent : public parent_t::template EuclideanComponent<IComponent> {
+		typedef aslam::backend::VectorExpression<parent_t::template EuclideanComponent<IComponent>::Dimension> expression_t;
+	};
+
+	DiffManifoldBSpline(const CONF & config = CONF()) : parent_t(config){}
+	DiffManifoldBSpline(int splineOrder) : parent_t(typename CONF::ParentConf(splineOrder)){}
+
+	/// \brief the design variables of the IComponent's Euclidean component (in the order of getDesignVariables())
+	template <int IComponent = 0>
+	std::vector<dv_t *> getEuclideanDesignVariables();
+	template <int IComponent = 0>
+	std::vector<dv_t *> getEuclideanDesignVariables(time_t time);
+
+	/// \brief adds the design variables of all components
+	template <typename OptimizationProblem>
+	void addDesignVariables(OptimizationProblem & problem) {
+		parent_t::addDesignVariables(problem);
+		addEuclideanDesignVariables(problem, typename EuclideanComponents::indices_t());
+	}
+	template <typename OptimizationProblem>
+	void addDesignVariables(time_t time, OptimizationProblem & problem) {
+		parent_t::addDesignVariables(time, problem);
+		addEuclideanDesignVariables(time, problem, typename EuclideanComponents::indices_t());
+	}
+
+	template <typename FactoryData_>
+	class ExpressionFactory : public parent_t::template ExpressionFactory<FactoryData_> {
+	public:
+		typedef typename parent_t::template ExpressionFactory<FactoryData_> ParentExpressionFactory;
+		typedef typename ParentExpressionFactory::DataSharedPtr DataSharedPtr;
+		typedef typename FactoryData_::eval_t eval_t;
+
+		/// \brief get an expression for the IComponent's Euclidean component's derivativeOrder's derivative
+		template <int IComponent = 0>
+		typename EuclideanComponent<IComponent>::expression_t getEuclideanValueExpression(int derivativeOrder = 0) const;
+	protected:
+		inline ExpressionFactory(const FactoryData_ & factoryBase) : ParentExpressionFactory(factoryBase) {}
+		friend class DiffManifoldBSpline;
+	};
+
+	template <int IMaxDerivativeOrder> inline ExpressionFactory<typename parent_t::template ConstTimeFactoryData<IMaxDerivativeOrder> > getExpressionFactoryAt(const time_t & t) const {
+		return ExpressionFactory<typename parent_t::template ConstTimeFactoryData<IMaxDerivativeOrder> >(typename parent_t::template ConstTimeFactoryData<IMaxDerivativeOrder>(*this, t));
+	}
+	template <int IMaxDerivativeOrder> inline ExpressionFactory<typename parent_t::template TimeExpressionFactoryData<IMaxDerivativeOrder> > getExpressionFactoryAt(const typename parent_t::TimeExpression & t, time_t lowerBound, time_t upperBound) const {
+		return ExpressionFactory<typename parent_t::template TimeExpressionFactoryData<IMaxDerivativeOrder> >(typename parent_t::template TimeExpressionFactoryData<IMaxDerivativeOrder>(*this, t, lowerBound, upperBound));
+	}
+
+private:
+	template <typename OptimizationProblem, int ... IComponents>
+	void addEuclideanDesignVariables(OptimizationProblem & problem, internal::IntSequence<IComponents...>) {
+		for(const auto & dvs : { getEuclideanDesignVariables<IComponents>()... }) for(auto dvp : dvs) problem.addDesignVariable(dvp, false);
+	}
+	template <typename OptimizationProblem, int ... IComponents>
+	void addEuclideanDesignVariables(time_t time, OptimizationProblem & problem, internal::IntSequence<IComponents...>) {
+		for(const auto & dvs : { getEuclideanDesignVariables<IComponents>(time)... }) for(auto dvp : dvs) problem.addDesignVariable(dvp, false);
+	}
+};
+
+} // namespace bsplines
+
+namespace aslam {
+namespace splines {
+
+#if __cplusplus >= 201103L
+	template <int ISplineOrder = Eigen::Dynamic, int IEuclideanDimension = 3, typename TTimePolicy = ::bsplines::DefaultTimePolicy>
+	using OPTUnitQuaternionEuclideanBSpline = OPTBSpline<typename ::bsplines::UnitQuaternionEuclideanBSpline<ISplineOrder, IEuclideanDimension, TTimePolicy>::CONF>;
+#endif
+
+} // namespace splines
+} // namespace aslam
+
+#include "implementation/OPTCompositeBSplineImpl.hpp"
+
+#endif /* OPTCOMPOSITEBSPLINE_HPP_ */
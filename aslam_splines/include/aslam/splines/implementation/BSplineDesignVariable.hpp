@@ -6,7 +6,7 @@ namespace aslam {
         /// \brief this guy takes a copy.
         template<int D>
         BSplineDesignVariable<D>::BSplineDesignVariable(const bsplines::BSpline & bspline) :
-            _bspline(bspline)
+            _bspline(bspline), _expressionNodeArena(NULL)
         {
             // here is where the magic happens.
 
@@ -44,15 +44,24 @@ namespace aslam {
         }
 
         template<int D>
-        aslam::backend::VectorExpression<D> BSplineDesignVariable<D>::toExpression(double tk, int derivativeOrder)
+        const std::vector<aslam::backend::DesignVariable *> & BSplineDesignVariable<D>::localDesignVariables(double tk)
         {
-            Eigen::VectorXi dvidxs = _bspline.localVvCoefficientVectorIndices(tk);
-            std::vector<aslam::backend::DesignVariable *> dvs;
-            for(int i = 0; i < dvidxs.size(); ++i)
+            // reused by all calls of a thread, so it only allocates while growing
+            static thread_local std::vector<aslam::backend::DesignVariable *> dvs;
+            const int firstIndex = _bspline.segmentIndex(tk);
+            dvs.clear();
+            for(int i = 0; i < _bspline.splineOrder(); ++i)
             {
-                dvs.push_back(&_designVariables[dvidxs[i]]);
+                dvs.push_back(&_designVariables[firstIndex + i]);
             }
-            boost::shared_ptr<aslam::splines::BSplineVectorExpressionNode<D> > root( new aslam::splines::BSplineVectorExpressionNode<D>(&_bspline, derivativeOrder, dvs, tk) );
+            return dvs;
+        }
+
+        template<int D>
+        aslam::backend::VectorExpression<D> BSplineDesignVariable<D>::toExpression(double tk, int derivativeOrder)
+        {
+            const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
+            boost::shared_ptr<aslam::splines::BSplineVectorExpressionNode<D> > root = allocateExpressionNode<aslam::splines::BSplineVectorExpressionNode<D> >(_expressionNodeArena, &_bspline, derivativeOrder, dvs, tk, _expressionNodeArena);
       
             return aslam::backend::VectorExpression<D>(root);
       
@@ -3,8 +3,8 @@ namespace aslam {
     
     
     template<int D>
-    BSplineVectorExpressionNode<D>::BSplineVectorExpressionNode(bsplines::BSpline * spline, int derivativeOrder, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time) :
-      _spline(spline), _designVariables(designVariables), _time(time), _derivativeOrder(derivativeOrder)
+    BSplineVectorExpressionNode<D>::BSplineVectorExpressionNode(bsplines::BSpline * spline, int derivativeOrder, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, ExpressionNodeArena * arena) :
+      _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _derivativeOrder(derivativeOrder)
     {
       SM_ASSERT_EQ(aslam::Exception, spline->coefficients().rows(), D, "The spline dimension should match the expression dimension");
     }
@@ -189,7 +189,7 @@ typename _CLASS::expression_t _CLASS::ExpressionFactory<FactoryData_>::getValueE
 			_dataPtr->getDesignVariables(designVariables);
 		}
 	};
-	return expression_t(boost::shared_ptr<node_t>(static_cast<node_t *> (new ExpressionNode(this->getDataPtr(), derivativeOrder))));
+	return expression_t(boost::shared_ptr<node_t>(aslam::splines::allocateExpressionNode<ExpressionNode>(this->getDataPtr()->getSpline().getExpressionNodeArena(), this->getDataPtr(), derivativeOrder)));
 }
 
 _TEMPLATE
@@ -217,10 +217,17 @@ typename _CLASS::time_t _CLASS::appendSegments(KnotGenerator<time_t> & knotGener
 	return t;
 }
 
+_TEMPLATE
+size_t _CLASS::removeSegmentsBefore(const time_t & t) {
+	const size_t removed = parent_t::removeSegmentsBefore(t);
+	_designVariables.erase(_designVariables.begin(), _designVariables.begin() + removed);
+	return removed;
+}
+
 _TEMPLATE
 void _CLASS::removeSegment() {
-//TODO	_bspline.removeCurveSegment();
-//	_designVariables.erase(_designVariables.begin());
+	SM_ASSERT_GE(aslam::Exception, this->getNumValidTimeSegments(), 2, "The last valid segment cannot be removed.");
+	removeSegmentsBefore(internal::getMovedIterator(this->begin(), this->end(), 1)->getKnot());
 }
 
 #undef _CLASS
@@ -0,0 +1,102 @@
+#ifndef OPTCOMPOSITEBSPLINEIMPL_HPP_
+#define OPTCOMPOSITEBSPLINEIMPL_HPP_
+
+#include "aslam/backend/JacobianContainer.hpp"
+
+namespace bsplines {
+
+#define _TEMPLATE template <typename TPrimaryBSplineConfiguration, int ... IEuclideanDimensions, typename TModifiedDerivedConf>
+#define _CLASS DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...>, TModifiedDerivedConf>, aslam::splines::DesignVariableSegmentBSplineConf<TModifiedDerivedConf> >
+
+_TEMPLATE
+template <int IComponent>
+std::vector<typename _CLASS::dv_t *> _CLASS::getEuclideanDesignVariables() {
+	std::vector<dv_t *> dvs;
+	for(SegmentIterator i = this->firstRelevantSegment(), end = this->end(); i != end; i++)
+	{
+		dvs.push_back(& i->template getEuclideanDesignVariable<IComponent>());
+	}
+	return dvs;
+}
+
+_TEMPLATE
+template <int IComponent>
+std::vector<typename _CLASS::dv_t *> _CLASS::getEuclideanDesignVariables(time_t tk) {
+	std::vector<dv_t *> dvs(this->getSplineOrder());
+
+	int j = 0;
+	for (SegmentIterator back = this->getSegmentIterator(tk), i = this->getFirstRelevantSegmentByLast(back), end=++back; i != end; ++i) {
+		dvs[j++] = &i->template getEuclideanDesignVariable<IComponent>();
+	}
+	return dvs;
+}
+
+_TEMPLATE
+template <typename FactoryData_>
+template <int IComponent>
+typename _CLASS::template EuclideanComponent<IComponent>::expression_t _CLASS::ExpressionFactory<FactoryData_>::getEuclideanValueExpression(const int derivativeOrder) const {
+	enum { Dimension = EuclideanComponent<IComponent>::Dimension };
+	typedef typename EuclideanComponent<IComponent>::jacobian_t jacobian_t;
+	typedef aslam::backend::VectorExpressionNode<Dimension> node_t;
+
+	class ExpressionNode : public node_t {
+		DataSharedPtr _dataPtr;
+		const int _derivativeOrder;
+	public:
+		ExpressionNode(const DataSharedPtr & dataPtr, int derivativeOrder) : _dataPtr(dataPtr), _derivativeOrder(derivativeOrder){}
+		virtual ~ExpressionNode(){}
+	protected:
+		inline void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians, const Eigen::MatrixXd * applyChainRule) const {
+			const int splineOrder = _dataPtr->getSpline().getSplineOrder();
+			jacobian_t J(Dimension, Dimension * splineOrder);
+			auto & eval = _dataPtr->getEvaluator();
+			eval.template evalEuclideanJacobian<IComponent>(_derivativeOrder, J);
+			int col = 0;
+			for(SegmentConstIterator i = eval.begin(), end = eval.end(); i != end; ++i)
+			{
+				internal::AddJac<jacobian_t, Dimension, Dimension>::addJac(J, col, &i->template getEuclideanDesignVariable<IComponent>(), outJacobians, applyChainRule, Dimension, Dimension);
+				col += Dimension;
+			}
+			if(_dataPtr->hasTimeExpression()){
+				// see the value expression of the OPTBSpline
+				const int rows = applyChainRule ? applyChainRule->rows() : Dimension;
+				for(SegmentConstIterator i = _dataPtr->begin(), end = _dataPtr->end(); i != end; ++i)
+				{
+					outJacobians.add(const_cast<aslam::backend::DesignVariable *>(&i->template getEuclideanDesignVariable<IComponent>()), Eigen::MatrixXd::Zero(rows, Dimension));
+				}
+				auto evalJac = eval.template evalEuclideanD<IComponent>(_derivativeOrder + 1);
+				_dataPtr->getTimeExpression().evaluateJacobians(outJacobians, applyChainRule ? Eigen::MatrixXd(*applyChainRule * evalJac) : Eigen::MatrixXd(evalJac));
+			}
+		}
+
+		virtual typename node_t::vector_t evaluateImplementation() const override {
+			return _dataPtr->getEvaluator().template evalEuclideanD<IComponent>(_derivativeOrder);
+		}
+
+		virtual void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const override {
+			evaluateJacobiansImplementation(outJacobians, NULL);
+		}
+
+		virtual void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians, const Eigen::MatrixXd & applyChainRule) const {
+			evaluateJacobiansImplementation(outJacobians, &applyChainRule);
+		}
+
+		virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const override {
+			for(SegmentConstIterator i = _dataPtr->begin(), end = _dataPtr->end(); i != end; ++i)
+			{
+				designVariables.insert(const_cast<aslam::backend::DesignVariable *>(&i->template getEuclideanDesignVariable<IComponent>()));
+			}
+			if(_dataPtr->hasTimeExpression()){
+				_dataPtr->getTimeExpression().getDesignVariables(designVariables);
+			}
+		}
+	};
+	return typename EuclideanComponent<IComponent>::expression_t(boost::shared_ptr<node_t>(aslam::splines::allocateExpressionNode<ExpressionNode>(this->getDataPtr()->getSpline().getExpressionNodeArena(), this->getDataPtr(), derivativeOrder)));
+}
+
+#undef _CLASS
+#undef _TEMPLATE
+
+} // namespace bsplines
+
+#endif /* OPTCOMPOSITEBSPLINEIMPL_HPP_ */
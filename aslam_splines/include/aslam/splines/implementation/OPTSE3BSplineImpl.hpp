@@ -0,0 +1,64 @@
+#ifndef OPTSE3BSPLINEIMPL_HPP_
+#define OPTSE3BSPLINEIMPL_HPP_
+
+#include "aslam/backend/JacobianContainer.hpp"
+
+namespace bsplines {
+
+#define _TEMPLATE template <typename TDiffManifoldConfiguration, int ISplineOrder, typename TTimePolicy, typename TModifiedDerivedConf>
+#define _CLASS DiffManifoldBSpline<aslam::splines::DesignVariableSegmentBSplineConf<SE3BSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy>, TModifiedDerivedConf>, aslam::splines::DesignVariableSegmentBSplineConf<TModifiedDerivedConf> >
+
+_TEMPLATE
+template <typename FactoryData_>
+typename _CLASS::twist_expression_t _CLASS::ExpressionFactory<FactoryData_>::getTwistExpression() const {
+	typedef aslam::backend::VectorExpressionNode<6> node_t;
+
+	class ExpressionNode : public node_t {
+	public:
+		ExpressionNode(const DataSharedPtr & dataPtr) : _dataPtr(dataPtr){}
+	private:
+		const DataSharedPtr _dataPtr;
+		inline void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians, const Eigen::MatrixXd * applyChainRule) const {
+			const int dimension=_dataPtr->getSpline().getDimension(), pointSize = dimension, splineOrder = _dataPtr->getSpline().getSplineOrder();
+			typename _CLASS::twist_jacobian_t J(pointSize, dimension * splineOrder);
+			auto & eval = _dataPtr->getEvaluator();
+			eval.evalTwistJacobian(J);
+
+			int col = 0;
+			for(SegmentConstIterator i = eval.begin(), end = eval.end(); i != end; ++i)
+			{
+				internal::AddJac<typename _CLASS::twist_jacobian_t, Dimension, Dimension>::addJac(J, col, &i->getDesignVariable(), outJacobians, applyChainRule, pointSize, dimension);
+				col+=dimension;
+			}
+			if(_dataPtr->hasTimeExpression()){
+				auto evalJac = eval.evalTwistDerivative();
+				_dataPtr->getTimeExpression().evaluateJacobians(outJacobians, applyChainRule ? Eigen::MatrixXd(*applyChainRule * evalJac) : Eigen::MatrixXd(evalJac));
+			}
+		}
+
+	protected:
+		virtual node_t::vector_t evaluateImplementation() const {
+			return _dataPtr->getEvaluator().evalTwist();
+		}
+
+		virtual void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const {
+			evaluateJacobiansImplementation(outJacobians, NULL);
+		}
+
+		virtual void evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians, const Eigen::MatrixXd & applyChainRule) const {
+			evaluateJacobiansImplementation(outJacobians, &applyChainRule);
+		}
+
+		virtual void getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const {
+			_dataPtr->getDesignVariables(designVariables);
+		}
+	};
+	return twist_expression_t(boost::shared_ptr<node_t>(aslam::splines::allocateExpressionNode<ExpressionNode>(this->getDataPtr()->getSpline().getExpressionNodeArena(), this->getDataPtr())));
+}
+
+#undef _CLASS
+#undef _TEMPLATE
+
+} // namespace bsplines
+
+#endif /* OPTSE3BSPLINEIMPL_HPP_ */
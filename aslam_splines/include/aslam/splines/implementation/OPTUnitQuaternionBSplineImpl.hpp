@@ -53,7 +53,7 @@ typename _CLASS::angular_derivative_expression_t _CLASS::ExpressionFactory<Facto
 			_dataPtr->getDesignVariables(designVariables);
 		}
 	};
-	return angular_derivative_expression_t(boost::shared_ptr<node_t>(static_cast<node_t *> (new ExpressionNode(this->getDataPtr()))));
+	return angular_derivative_expression_t(boost::shared_ptr<node_t>(aslam::splines::allocateExpressionNode<ExpressionNode>(this->getDataPtr()->getSpline().getExpressionNodeArena(), this->getDataPtr())));
 }
 
 _TEMPLATE
@@ -103,7 +103,7 @@ typename _CLASS::angular_derivative_expression_t _CLASS::ExpressionFactory<Facto
 			_dataPtr->getDesignVariables(designVariables);
 		}
 	};
-	return angular_derivative_expression_t(boost::shared_ptr<node_t>(static_cast<node_t *> (new ExpressionNode(this->getDataPtr()))));
+	return angular_derivative_expression_t(boost::shared_ptr<node_t>(aslam::splines::allocateExpressionNode<ExpressionNode>(this->getDataPtr()->getSpline().getExpressionNodeArena(), this->getDataPtr())));
 }
 
 #undef _CLASS
@@ -1,11 +1,71 @@
 #include <aslam/splines/BSplineExpressions.hpp>
 #include <aslam/splines/BSplinePoseDesignVariable.hpp>
+#include <sm/kinematics/quaternion_algebra.hpp>
 
 namespace aslam {
     namespace splines {
-    
-        BSplineTransformationExpressionNode::BSplineTransformationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time) :
-            _spline(spline), _designVariables(designVariables), _time(time)
+
+        namespace {
+            /// adds the Jacobian blocks of a direct spline evaluation, one Rows x 6 block per design variable
+            template<int Rows>
+            inline void addJacobians(aslam::backend::JacobianContainer & outJacobians, const node_design_variables_t & designVariables, const Eigen::MatrixXd & J)
+            {
+                SM_ASSERT_EQ_DBG(aslam::Exception, J.cols(), 6 * (int)designVariables.size(), "Bad");
+                for(size_t i = 0; i < designVariables.size(); ++i)
+                {
+                    outJacobians.add(designVariables[i], J.block<Rows, 6>(0, i * 6));
+                }
+            }
+
+            /// adds the Jacobians A * basis(i, derivativeOrder) of a quantity depending on the curve's derivativeOrder's derivative through A
+            template<int Rows>
+            inline void addJacobians(aslam::backend::JacobianContainer & outJacobians, const node_design_variables_t & designVariables, const BSplinePoseEvaluation & e, int derivativeOrder, const Eigen::Matrix<double, Rows, 6> & A)
+            {
+                SM_ASSERT_EQ_DBG(aslam::Exception, (int)designVariables.size(), (int)e.basis.rows(), "Bad");
+                for(size_t i = 0; i < designVariables.size(); ++i)
+                {
+                    outJacobians.add(designVariables[i], Eigen::Matrix<double, Rows, 6>(A * e.basis(i, derivativeOrder)));
+                }
+            }
+
+            /// the Jacobian of the translational part with respect to the curve value
+            inline Eigen::Matrix<double, 3, 6> translationJacobian()
+            {
+                Eigen::Matrix<double, 3, 6> J = Eigen::Matrix<double, 3, 6>::Zero();
+                J.leftCols<3>().setIdentity();
+                return J;
+            }
+
+            /// see BSplinePose::angularVelocityBodyFrame and BSplinePose::angularAccelerationBodyFrame
+            inline Eigen::Vector3d angularDerivativeBodyFrame(const BSplinePoseEvaluation & e, int derivativeOrder)
+            {
+                return -e.C.transpose() * e.S * e.derivatives.col(derivativeOrder).tail<3>();
+            }
+
+            /// see BSplinePose::angularVelocityBodyFrameAndJacobian and BSplinePose::angularAccelerationBodyFrameAndJacobian
+            inline void addAngularDerivativeBodyFrameJacobians(aslam::backend::JacobianContainer & outJacobians, const node_design_variables_t & designVariables, const bsplines::BSplinePose * spline, const BSplinePoseEvaluation & e, int derivativeOrder)
+            {
+                const Eigen::Vector3d p = e.derivatives.col(0).tail<3>(), pdot = e.derivatives.col(derivativeOrder).tail<3>();
+                const Eigen::Matrix3d C_w_b = e.C.transpose();
+
+                Eigen::Matrix<double, 3, 6> Jo;
+                const Eigen::Vector3d omega = -C_w_b * spline->rotation()->angularVelocityAndJacobian(p, pdot, &Jo);
+                Jo = (-C_w_b * Jo).eval();
+
+                // the Jacobians with respect to the curve value (through p and the inverse orientation) and its derivative (through pdot)
+                Eigen::Matrix<double, 3, 6> Jvalue = Eigen::Matrix<double, 3, 6>::Zero(), Jderivative = Eigen::Matrix<double, 3, 6>::Zero();
+                Jvalue.rightCols<3>() = Jo.leftCols<3>() - sm::kinematics::crossMx(omega) * C_w_b * e.S;
+                Jderivative.rightCols<3>() = Jo.rightCols<3>();
+
+                for(size_t i = 0; i < designVariables.size(); ++i)
+                {
+                    outJacobians.add(designVariables[i], Eigen::Matrix<double, 3, 6>(Jvalue * e.basis(i, 0) + Jderivative * e.basis(i, derivativeOrder)));
+                }
+            }
+        }
+
+        BSplineTransformationExpressionNode::BSplineTransformationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache, ExpressionNodeArena * arena) :
+            _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _cache(cache)
         {
 
         }
@@ -17,18 +77,21 @@ namespace aslam {
 
         Eigen::Matrix4d BSplineTransformationExpressionNode::toTransformationMatrixImplementation()
         {
-            return _spline->transformation(_time);
+            if(!_cache) return _spline->transformation(_time);
+            return _cache->evaluate(*_spline, _time)->T;
         }
 
         void BSplineTransformationExpressionNode::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const
         {
-            Eigen::MatrixXd J;
-            _spline->transformationAndJacobian(_time, &J);
-      
-            for(size_t i = 0; i < _designVariables.size(); ++i)
+            if(!_cache)
             {
-                outJacobians.add(_designVariables[i], J.block<6,6>(0,i*6) );
+                Eigen::MatrixXd J;
+                _spline->transformationAndJacobian(_time, &J);
+                addJacobians<6>(outJacobians, _designVariables, J);
+                return;
             }
+            BSplinePoseEvaluationCache::EvaluationPtr e = _cache->evaluate(*_spline, _time);
+            addJacobians(outJacobians, _designVariables, *e, 0, e->JT);
         }
 
         void BSplineTransformationExpressionNode::getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const
@@ -45,8 +108,8 @@ namespace aslam {
 
         ///////////
 
-        BSplineRotationExpressionNode::BSplineRotationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time) :
-            _spline(spline), _designVariables(designVariables), _time(time)
+        BSplineRotationExpressionNode::BSplineRotationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache, ExpressionNodeArena * arena) :
+            _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _cache(cache)
         {
 
         }
@@ -58,21 +121,23 @@ namespace aslam {
 
         Eigen::Matrix3d BSplineRotationExpressionNode::toRotationMatrixImplementation() const
         {
-            return _spline->orientation(_time);
+            if(!_cache) return _spline->orientation(_time);
+            return _cache->evaluate(*_spline, _time)->C;
         }
 
         void BSplineRotationExpressionNode::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const
         {
-            Eigen::MatrixXd J;
-            _spline->orientationAndJacobian(_time, &J, NULL);
-
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.rows(), 3, "Bad");
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.cols(), 6 * (int)_designVariables.size(), "Bad");
-      
-            for(size_t i = 0; i < _designVariables.size(); ++i)
+            if(!_cache)
             {
-                outJacobians.add(_designVariables[i], J.block<3,6>(0,i*6) );
+                Eigen::MatrixXd J;
+                _spline->orientationAndJacobian(_time, &J, NULL);
+                addJacobians<3>(outJacobians, _designVariables, J);
+                return;
             }
+            BSplinePoseEvaluationCache::EvaluationPtr e = _cache->evaluate(*_spline, _time);
+            Eigen::Matrix<double, 3, 6> JO = Eigen::Matrix<double, 3, 6>::Zero();
+            JO.rightCols<3>() = e->S;
+            addJacobians(outJacobians, _designVariables, *e, 0, JO);
         }
 
         void BSplineRotationExpressionNode::getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const
@@ -87,8 +152,8 @@ namespace aslam {
 
         /////////////////////
 
-        BSplinePositionExpressionNode::BSplinePositionExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time) :
-            _spline(spline), _designVariables(designVariables), _time(time)
+        BSplinePositionExpressionNode::BSplinePositionExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache, ExpressionNodeArena * arena) :
+            _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _cache(cache)
         {
 
         }
@@ -100,21 +165,20 @@ namespace aslam {
 
         Eigen::Vector3d BSplinePositionExpressionNode::evaluateImplementation() const
         {
-
-            return _spline->eval(_time).head<3>();
+            if(!_cache) return _spline->eval(_time).head<3>();
+            return _cache->evaluate(*_spline, _time)->derivatives.col(0).head<3>();
         }
 
         void BSplinePositionExpressionNode::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const
         {
-            Eigen::MatrixXd J;
-            _spline->evalDAndJacobian(_time, 0, &J, NULL);
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.rows(), 6, "Bad");
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.cols(), 6 * (int)_designVariables.size(), "Bad");
-
-            for(size_t i = 0; i < _designVariables.size(); ++i)
+            if(!_cache)
             {
-                outJacobians.add(_designVariables[i], J.block<3,6>(0,i*6) );
+                Eigen::MatrixXd J;
+                _spline->evalDAndJacobian(_time, 0, &J, NULL);
+                addJacobians<3>(outJacobians, _designVariables, J);
+                return;
             }
+            addJacobians(outJacobians, _designVariables, *_cache->evaluate(*_spline, _time), 0, translationJacobian());
         }
 
         void BSplinePositionExpressionNode::getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const
@@ -130,8 +194,8 @@ namespace aslam {
 
         /////////////////////
 
-        BSplineVelocityExpressionNode::BSplineVelocityExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time) :
-            _spline(spline), _designVariables(designVariables), _time(time)
+        BSplineVelocityExpressionNode::BSplineVelocityExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache, ExpressionNodeArena * arena) :
+            _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _cache(cache)
         {
 
         }
@@ -143,21 +207,20 @@ namespace aslam {
 
         Eigen::Vector3d BSplineVelocityExpressionNode::evaluateImplementation() const
         {
-
-            return _spline->evalD(_time,1).head<3>();
+            if(!_cache) return _spline->evalD(_time,1).head<3>();
+            return _cache->evaluate(*_spline, _time)->derivatives.col(1).head<3>();
         }
 
         void BSplineVelocityExpressionNode::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const
         {
-            Eigen::MatrixXd J;
-            _spline->evalDAndJacobian(_time, 1, &J, NULL);
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.rows(), 6, "Bad");
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.cols(), 6 * (int)_designVariables.size(), "Bad");
-
-            for(size_t i = 0; i < _designVariables.size(); ++i)
+            if(!_cache)
             {
-                outJacobians.add(_designVariables[i], J.block<3,6>(0,i*6) );
+                Eigen::MatrixXd J;
+                _spline->evalDAndJacobian(_time, 1, &J, NULL);
+                addJacobians<3>(outJacobians, _designVariables, J);
+                return;
             }
+            addJacobians(outJacobians, _designVariables, *_cache->evaluate(*_spline, _time), 1, translationJacobian());
         }
 
         void BSplineVelocityExpressionNode::getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const
@@ -174,8 +237,8 @@ namespace aslam {
 
         /////////////////////
 
-        BSplineAccelerationExpressionNode::BSplineAccelerationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time) :
-            _spline(spline), _designVariables(designVariables), _time(time)
+        BSplineAccelerationExpressionNode::BSplineAccelerationExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache, ExpressionNodeArena * arena) :
+            _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _cache(cache)
         {
 
         }
@@ -187,21 +250,20 @@ namespace aslam {
 
         Eigen::Vector3d BSplineAccelerationExpressionNode::evaluateImplementation() const
         {
-
-            return _spline->evalD(_time,2).head<3>();
+            if(!_cache) return _spline->evalD(_time,2).head<3>();
+            return _cache->evaluate(*_spline, _time)->derivatives.col(2).head<3>();
         }
 
         void BSplineAccelerationExpressionNode::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const
         {
-            Eigen::MatrixXd J;
-            _spline->evalDAndJacobian(_time, 2, &J, NULL);
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.rows(), 6, "Bad");
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.cols(), 6 * (int)_designVariables.size(), "Bad");
-
-            for(size_t i = 0; i < _designVariables.size(); ++i)
+            if(!_cache)
             {
-                outJacobians.add(_designVariables[i], J.block<3,6>(0,i*6) );
+                Eigen::MatrixXd J;
+                _spline->evalDAndJacobian(_time, 2, &J, NULL);
+                addJacobians<3>(outJacobians, _designVariables, J);
+                return;
             }
+            addJacobians(outJacobians, _designVariables, *_cache->evaluate(*_spline, _time), 2, translationJacobian());
         }
 
         void BSplineAccelerationExpressionNode::getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const
@@ -217,8 +279,8 @@ namespace aslam {
         BSplineAccelerationBodyFrameExpressionNode(
         bsplines::BSplinePose* spline,
         const std::vector<aslam::backend::DesignVariable*>& designVariables,
-        double time) :
-        _spline(spline), _designVariables(designVariables), _time(time) {
+        double time, BSplinePoseEvaluationCache * cache, ExpressionNodeArena * arena) :
+        _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _cache(cache) {
     }
 
     BSplineAccelerationBodyFrameExpressionNode::
@@ -227,20 +289,24 @@ namespace aslam {
 
     Eigen::Vector3d BSplineAccelerationBodyFrameExpressionNode::
         evaluateImplementation() const {
+      if (!_cache)
         return _spline->linearAccelerationBodyFrame(_time);
+      BSplinePoseEvaluationCache::EvaluationPtr e = _cache->evaluate(*_spline,
+        _time);
+      return e->C.transpose() * e->derivatives.col(2).head<3>();
     }
 
     void BSplineAccelerationBodyFrameExpressionNode::
         evaluateJacobiansImplementation(aslam::backend::JacobianContainer&
         outJacobians) const {
-      Eigen::MatrixXd J;
-      _spline->evalDAndJacobian(_time, 2, &J, NULL);
-      SM_ASSERT_EQ_DBG(aslam::Exception, J.rows(), 6, "Bad");
-      SM_ASSERT_EQ_DBG(aslam::Exception, J.cols(),
-        6 * (int)_designVariables.size(), "Bad");
-      for (size_t i = 0; i < _designVariables.size(); ++i)
-        outJacobians.add(_designVariables[i],
-          J.block<3 , 6>(0, i * 6));
+      if (!_cache) {
+        Eigen::MatrixXd J;
+        _spline->evalDAndJacobian(_time, 2, &J, NULL);
+        addJacobians<3>(outJacobians, _designVariables, J);
+        return;
+      }
+      addJacobians(outJacobians, _designVariables,
+        *_cache->evaluate(*_spline, _time), 2, translationJacobian());
     }
 
     void BSplineAccelerationBodyFrameExpressionNode::
@@ -252,8 +318,8 @@ namespace aslam {
 
 
         ///////////////////
-        BSplineAngularVelocityBodyFrameExpressionNode::BSplineAngularVelocityBodyFrameExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time) :
-            _spline(spline), _designVariables(designVariables), _time(time)
+        BSplineAngularVelocityBodyFrameExpressionNode::BSplineAngularVelocityBodyFrameExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache, ExpressionNodeArena * arena) :
+            _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _cache(cache)
         {
 
         }
@@ -265,21 +331,20 @@ namespace aslam {
 
         Eigen::Vector3d BSplineAngularVelocityBodyFrameExpressionNode::evaluateImplementation() const
         {
-
-            return _spline->angularVelocityBodyFrame(_time);
+            if(!_cache) return _spline->angularVelocityBodyFrame(_time);
+            return angularDerivativeBodyFrame(*_cache->evaluate(*_spline, _time), 1);
         }
 
         void BSplineAngularVelocityBodyFrameExpressionNode::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const
         {
-            Eigen::MatrixXd J;
-            _spline->angularVelocityBodyFrameAndJacobian(_time, &J, NULL);
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.rows(), 3, "Bad");
-            SM_ASSERT_EQ_DBG(aslam::Exception, J.cols(), 6 * (int)_designVariables.size(), "Bad");
-
-            for(size_t i = 0; i < _designVariables.size(); ++i)
+            if(!_cache)
             {
-                outJacobians.add(_designVariables[i], J.block<3,6>(0,i*6) );
+                Eigen::MatrixXd J;
+                _spline->angularVelocityBodyFrameAndJacobian(_time, &J, NULL);
+                addJacobians<3>(outJacobians, _designVariables, J);
+                return;
             }
+            addAngularDerivativeBodyFrameJacobians(outJacobians, _designVariables, _spline, *_cache->evaluate(*_spline, _time), 1);
         }
 
         void BSplineAngularVelocityBodyFrameExpressionNode::getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const
@@ -403,8 +468,8 @@ namespace aslam {
         ///////////////////////////////////
         // EuclideanExpression offset
 
-        BSplineEuclideanExpressionNode::BSplineEuclideanExpressionNode(bsplines::BSpline * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, int order) :
-            _spline(spline), _designVariables(designVariables), _time(time), _order(order)
+        BSplineEuclideanExpressionNode::BSplineEuclideanExpressionNode(bsplines::BSpline * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, int order, ExpressionNodeArena * arena) :
+            _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _order(order)
         {
 
         }
@@ -440,8 +505,8 @@ namespace aslam {
             
         }
 
-        BSplineAngularAccelerationBodyFrameExpressionNode::BSplineAngularAccelerationBodyFrameExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time) :
-        _spline(spline), _designVariables(designVariables), _time(time)
+        BSplineAngularAccelerationBodyFrameExpressionNode::BSplineAngularAccelerationBodyFrameExpressionNode(bsplines::BSplinePose * spline, const std::vector<aslam::backend::DesignVariable *> & designVariables, double time, BSplinePoseEvaluationCache * cache, ExpressionNodeArena * arena) :
+        _spline(spline), _designVariables(designVariables.begin(), designVariables.end(), node_design_variables_t::allocator_type(arena)), _time(time), _cache(cache)
         {
 
         }
@@ -452,17 +517,18 @@ namespace aslam {
         }
 
         Eigen::Vector3d BSplineAngularAccelerationBodyFrameExpressionNode::evaluateImplementation() const {
-          return _spline->angularAccelerationBodyFrame(_time);
+          if (!_cache) return _spline->angularAccelerationBodyFrame(_time);
+          return angularDerivativeBodyFrame(*_cache->evaluate(*_spline, _time), 2);
         }
 
         void BSplineAngularAccelerationBodyFrameExpressionNode::evaluateJacobiansImplementation(aslam::backend::JacobianContainer & outJacobians) const {
-          Eigen::MatrixXd J;
-          _spline->angularAccelerationBodyFrameAndJacobian(_time, &J, NULL);
-          SM_ASSERT_EQ_DBG(aslam::Exception, J.rows(), 3, "Bad"); SM_ASSERT_EQ_DBG(aslam::Exception, J.cols(), 6 * (int)_designVariables.size(), "Bad");
-
-          for (size_t i = 0; i < _designVariables.size(); ++i) {
-            outJacobians.add(_designVariables[i], J.block<3, 6>(0, i * 6));
+          if (!_cache) {
+            Eigen::MatrixXd J;
+            _spline->angularAccelerationBodyFrameAndJacobian(_time, &J, NULL);
+            addJacobians<3>(outJacobians, _designVariables, J);
+            return;
           }
+          addAngularDerivativeBodyFrameJacobians(outJacobians, _designVariables, _spline, *_cache->evaluate(*_spline, _time), 2);
         }
 
         void BSplineAngularAccelerationBodyFrameExpressionNode::getDesignVariablesImplementation(aslam::backend::DesignVariable::set_t & designVariables) const {
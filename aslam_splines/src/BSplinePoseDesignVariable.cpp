@@ -7,14 +7,14 @@ namespace aslam {
     
         /// \brief this guy takes a copy.
         BSplinePoseDesignVariable::BSplinePoseDesignVariable(const bsplines::BSplinePose & bsplinePose) :
-            _bsplinePose(bsplinePose)
+            _bsplinePose(bsplinePose), _expressionNodeArena(NULL), _useEvaluationCache(false)
         {
             // here is where the magic happens.
 
             // Create all of the design variables as maps into the vector of spline coefficients.
             for(int i = 0; i < _bsplinePose.numVvCoefficients(); ++i)
             {
-                _designVariables.push_back( new aslam::backend::DesignVariableMappedVector<6>( _bsplinePose.fixedSizeVvCoefficientVector<6>(i) ) );
+                _designVariables.push_back( new ControlVertexDesignVariable( _bsplinePose.fixedSizeVvCoefficientVector<6>(i), &_evaluationCache ) );
             }
         }
     
@@ -57,17 +57,25 @@ namespace aslam {
             return dvs;
         }
 
-        aslam::backend::TransformationExpression BSplinePoseDesignVariable::transformation(double tk)
+        const std::vector<aslam::backend::DesignVariable *> & BSplinePoseDesignVariable::localDesignVariables(double tk)
         {
-      
-            Eigen::VectorXi dvidxs = _bsplinePose.localVvCoefficientVectorIndices(tk);
-            std::vector<aslam::backend::DesignVariable *> dvs;
-            for(int i = 0; i < dvidxs.size(); ++i)
+            // reused by all calls of a thread, so it only allocates while growing
+            static thread_local std::vector<aslam::backend::DesignVariable *> dvs;
+            const int firstIndex = _bsplinePose.segmentIndex(tk);
+            dvs.clear();
+            for(int i = 0; i < _bsplinePose.splineOrder(); ++i)
             {
-                dvs.push_back(&_designVariables[dvidxs[i]]);
+                dvs.push_back(&_designVariables[firstIndex + i]);
             }
+            return dvs;
+        }
+
+        aslam::backend::TransformationExpression BSplinePoseDesignVariable::transformation(double tk)
+        {
+      
+            const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
       
-            boost::shared_ptr<BSplineTransformationExpressionNode> root( new BSplineTransformationExpressionNode(&_bsplinePose, dvs, tk) );
+            boost::shared_ptr<BSplineTransformationExpressionNode> root = allocateExpressionNode<BSplineTransformationExpressionNode>(_expressionNodeArena, &_bsplinePose, dvs, tk, expressionEvaluationCache(), _expressionNodeArena);
       
             return aslam::backend::TransformationExpression(root);
 
@@ -75,14 +83,9 @@ namespace aslam {
     
         aslam::backend::RotationExpression BSplinePoseDesignVariable::orientation(double tk)
         {
-            Eigen::VectorXi dvidxs = _bsplinePose.localVvCoefficientVectorIndices(tk);
-            std::vector<aslam::backend::DesignVariable *> dvs;
-            for(int i = 0; i < dvidxs.size(); ++i)
-            {
-                dvs.push_back(&_designVariables[dvidxs[i]]);
-            }
+            const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
       
-            boost::shared_ptr<BSplineRotationExpressionNode> root( new BSplineRotationExpressionNode(&_bsplinePose, dvs, tk) );
+            boost::shared_ptr<BSplineRotationExpressionNode> root = allocateExpressionNode<BSplineRotationExpressionNode>(_expressionNodeArena, &_bsplinePose, dvs, tk, expressionEvaluationCache(), _expressionNodeArena);
       
             return aslam::backend::RotationExpression(root);
       
@@ -90,14 +93,9 @@ namespace aslam {
 
         aslam::backend::EuclideanExpression BSplinePoseDesignVariable::position(double tk)
         {
-            Eigen::VectorXi dvidxs = _bsplinePose.localVvCoefficientVectorIndices(tk);
-            std::vector<aslam::backend::DesignVariable *> dvs;
-            for(int i = 0; i < dvidxs.size(); ++i)
-            {
-                dvs.push_back(&_designVariables[dvidxs[i]]);
-            }
+            const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
 	
-            boost::shared_ptr<BSplinePositionExpressionNode> root( new BSplinePositionExpressionNode(&_bsplinePose, dvs, tk) );
+            boost::shared_ptr<BSplinePositionExpressionNode> root = allocateExpressionNode<BSplinePositionExpressionNode>(_expressionNodeArena, &_bsplinePose, dvs, tk, expressionEvaluationCache(), _expressionNodeArena);
 	
             return aslam::backend::EuclideanExpression(root);
 
@@ -105,14 +103,9 @@ namespace aslam {
 
         aslam::backend::EuclideanExpression BSplinePoseDesignVariable::linearVelocity(double tk)
         {
-            Eigen::VectorXi dvidxs = _bsplinePose.localVvCoefficientVectorIndices(tk);
-            std::vector<aslam::backend::DesignVariable *> dvs;
-            for(int i = 0; i < dvidxs.size(); ++i)
-            {
-                dvs.push_back(&_designVariables[dvidxs[i]]);
-            }
+            const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
 
-            boost::shared_ptr<BSplineVelocityExpressionNode> root( new BSplineVelocityExpressionNode(&_bsplinePose, dvs, tk) );
+            boost::shared_ptr<BSplineVelocityExpressionNode> root = allocateExpressionNode<BSplineVelocityExpressionNode>(_expressionNodeArena, &_bsplinePose, dvs, tk, expressionEvaluationCache(), _expressionNodeArena);
 
             return aslam::backend::EuclideanExpression(root);
 
@@ -120,14 +113,9 @@ namespace aslam {
 
         aslam::backend::EuclideanExpression BSplinePoseDesignVariable::linearAcceleration(double tk)
         {
-            Eigen::VectorXi dvidxs = _bsplinePose.localVvCoefficientVectorIndices(tk);
-            std::vector<aslam::backend::DesignVariable *> dvs;
-            for(int i = 0; i < dvidxs.size(); ++i)
-            {
-                dvs.push_back(&_designVariables[dvidxs[i]]);
-            }
+            const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
 	
-            boost::shared_ptr<BSplineAccelerationExpressionNode> root( new BSplineAccelerationExpressionNode(&_bsplinePose, dvs, tk) );
+            boost::shared_ptr<BSplineAccelerationExpressionNode> root = allocateExpressionNode<BSplineAccelerationExpressionNode>(_expressionNodeArena, &_bsplinePose, dvs, tk, expressionEvaluationCache(), _expressionNodeArena);
 	
             return aslam::backend::EuclideanExpression(root);
 
@@ -135,27 +123,18 @@ namespace aslam {
 
       aslam::backend::EuclideanExpression
           BSplinePoseDesignVariable::linearAccelerationBodyFrame(double tk) {
-        Eigen::VectorXi dvidxs =
-          _bsplinePose.localVvCoefficientVectorIndices(tk);
-        std::vector<aslam::backend::DesignVariable*> dvs;
-        for (int i = 0; i < dvidxs.size(); ++i)
-          dvs.push_back(&_designVariables[dvidxs[i]]);
-        boost::shared_ptr<BSplineAccelerationBodyFrameExpressionNode> root(
-          new BSplineAccelerationBodyFrameExpressionNode(
-          &_bsplinePose, dvs, tk));
+        const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
+        boost::shared_ptr<BSplineAccelerationBodyFrameExpressionNode> root =
+          allocateExpressionNode<BSplineAccelerationBodyFrameExpressionNode>(
+          _expressionNodeArena, &_bsplinePose, dvs, tk, expressionEvaluationCache(), _expressionNodeArena);
         return aslam::backend::EuclideanExpression(root);
       }
 
         aslam::backend::EuclideanExpression BSplinePoseDesignVariable::angularVelocityBodyFrame(double tk)
         {
-            Eigen::VectorXi dvidxs = _bsplinePose.localVvCoefficientVectorIndices(tk);
-            std::vector<aslam::backend::DesignVariable *> dvs;
-            for(int i = 0; i < dvidxs.size(); ++i)
-            {
-                dvs.push_back(&_designVariables[dvidxs[i]]);
-            }
+            const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
 	
-            boost::shared_ptr<BSplineAngularVelocityBodyFrameExpressionNode> root( new BSplineAngularVelocityBodyFrameExpressionNode(&_bsplinePose, dvs, tk) );
+            boost::shared_ptr<BSplineAngularVelocityBodyFrameExpressionNode> root = allocateExpressionNode<BSplineAngularVelocityBodyFrameExpressionNode>(_expressionNodeArena, &_bsplinePose, dvs, tk, expressionEvaluationCache(), _expressionNodeArena);
 	
             return aslam::backend::EuclideanExpression(root);
 
@@ -163,14 +142,9 @@ namespace aslam {
 
         aslam::backend::EuclideanExpression BSplinePoseDesignVariable::angularAccelerationBodyFrame(double tk)
         {
-        	Eigen::VectorXi dvidxs = _bsplinePose.localVvCoefficientVectorIndices(tk);
-        	std::vector<aslam::backend::DesignVariable *> dvs;
-        	for(int i = 0; i < dvidxs.size(); ++i)
-        	{
-        		dvs.push_back(&_designVariables[dvidxs[i]]);
-        	}
+        	const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(tk);
 
-        	boost::shared_ptr<BSplineAngularAccelerationBodyFrameExpressionNode> root( new BSplineAngularAccelerationBodyFrameExpressionNode(&_bsplinePose, dvs, tk) );
+        	boost::shared_ptr<BSplineAngularAccelerationBodyFrameExpressionNode> root = allocateExpressionNode<BSplineAngularAccelerationBodyFrameExpressionNode>(_expressionNodeArena, &_bsplinePose, dvs, tk, expressionEvaluationCache(), _expressionNodeArena);
 
         	return aslam::backend::EuclideanExpression(root);
 
@@ -179,7 +153,8 @@ namespace aslam {
         void BSplinePoseDesignVariable::addSegment(double t, Eigen::Matrix4d T)
         {
             _bsplinePose.addPoseSegment(t,T);
-            _designVariables.push_back( new aslam::backend::DesignVariableMappedVector<6>( _bsplinePose.fixedSizeVvCoefficientVector<6>(_bsplinePose.numVvCoefficients()-1) ) );
+            _evaluationCache.clear();
+            _designVariables.push_back( new ControlVertexDesignVariable( _bsplinePose.fixedSizeVvCoefficientVector<6>(_bsplinePose.numVvCoefficients()-1), &_evaluationCache ) );
             for(int i = 0; i < _bsplinePose.numVvCoefficients()-1; i++)
             {
                 _designVariables[i].updateMap(_bsplinePose.fixedSizeVvCoefficientVector<6>(i).data());
@@ -190,7 +165,8 @@ namespace aslam {
         void BSplinePoseDesignVariable::addSegment2(double t, Eigen::Matrix4d T, double lambda)
         {
             _bsplinePose.addPoseSegment2(t,T,lambda);
-            _designVariables.push_back( new aslam::backend::DesignVariableMappedVector<6>( _bsplinePose.fixedSizeVvCoefficientVector<6>(_bsplinePose.numVvCoefficients()-1) ) );
+            _evaluationCache.clear();
+            _designVariables.push_back( new ControlVertexDesignVariable( _bsplinePose.fixedSizeVvCoefficientVector<6>(_bsplinePose.numVvCoefficients()-1), &_evaluationCache ) );
             for(int i = 0; i < _bsplinePose.numVvCoefficients()-1; i++)
             {
                 _designVariables[i].updateMap(_bsplinePose.fixedSizeVvCoefficientVector<6>(i).data());
@@ -201,6 +177,7 @@ namespace aslam {
         void BSplinePoseDesignVariable::removeSegment()
         {
             _bsplinePose.removeCurveSegment();
+            _evaluationCache.clear();
             _designVariables.erase(_designVariables.begin());
             for(int i = 0; i < _bsplinePose.numVvCoefficients(); i++)
             {
@@ -215,7 +192,7 @@ namespace aslam {
 
         aslam::backend::TransformationExpression BSplinePoseDesignVariable::transformationAtTime(const aslam::backend::ScalarExpression & time, double leftBuffer, double rightBuffer)
         {
-            boost::shared_ptr<TransformationTimeOffsetExpressionNode> root( new TransformationTimeOffsetExpressionNode( this, time, leftBuffer, rightBuffer) );
+            boost::shared_ptr<TransformationTimeOffsetExpressionNode> root = allocateExpressionNode<TransformationTimeOffsetExpressionNode>(_expressionNodeArena, this, time, leftBuffer, rightBuffer);
       
             return aslam::backend::TransformationExpression(root);
 
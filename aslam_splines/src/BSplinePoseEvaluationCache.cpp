@@ -0,0 +1,75 @@
+#include <aslam/splines/BSplinePoseEvaluationCache.hpp>
+
+namespace aslam {
+    namespace splines {
+
+        BSplinePoseEvaluationCache::EvaluationPtr BSplinePoseEvaluationCache::compute(const bsplines::BSplinePose & spline, double tk)
+        {
+            boost::shared_ptr<BSplinePoseEvaluation> evaluation(new BSplinePoseEvaluation);
+            const int splineOrder = spline.splineOrder();
+            const int segmentIndex = spline.segmentIndex(tk);
+
+            // one segment lookup for all derivatives: the derivative d is the coefficients times M' u_d
+            const Eigen::MatrixXd & M = spline.basisMatrix(segmentIndex);
+            evaluation->basis.resize(splineOrder, BSplinePoseEvaluation::MaxDerivativeOrder + 1);
+            for(int d = 0; d <= BSplinePoseEvaluation::MaxDerivativeOrder; ++d)
+            {
+                evaluation->basis.col(d) = M.transpose() * spline.u(tk, d);
+            }
+            evaluation->derivatives = spline.coefficients().middleCols(segmentIndex, splineOrder) * evaluation->basis;
+
+            Eigen::MatrixXd JT;
+            evaluation->T = spline.curveValueToTransformationAndJacobian(evaluation->derivatives.col(0), &JT);
+            evaluation->JT = JT;
+            evaluation->C = spline.rotation()->parametersToRotationMatrix(evaluation->derivatives.col(0).tail<3>(), &evaluation->S);
+            return evaluation;
+        }
+
+        BSplinePoseEvaluationCache::EvaluationPtr BSplinePoseEvaluationCache::evaluate(const bsplines::BSplinePose & spline, double tk)
+        {
+            const unsigned generation = _generation;
+            Shard & s = shard(tk);
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                std::map<double, Entry>::const_iterator it = s.evaluations.find(tk);
+                if(it != s.evaluations.end() && it->second.generation == generation) return it->second.evaluation;
+            }
+            // computed without the lock; if another thread was faster, its evaluation is kept. Evaluations that got outdated
+            // while being computed are not stored.
+            EvaluationPtr evaluation = compute(spline, tk);
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if(generation != _generation) return evaluation;
+            Entry & entry = s.evaluations[tk];
+            if(entry.evaluation && entry.generation == generation) return entry.evaluation;
+            entry.generation = generation;
+            entry.evaluation = evaluation;
+            return evaluation;
+        }
+
+        void BSplinePoseEvaluationCache::clear()
+        {
+            ++_generation;
+            for(int i = 0; i < NumShards; ++i)
+            {
+                std::lock_guard<std::mutex> lock(_shards[i].mutex);
+                _shards[i].evaluations.clear();
+            }
+        }
+
+        size_t BSplinePoseEvaluationCache::size() const
+        {
+            const unsigned generation = _generation;
+            size_t size = 0;
+            for(int i = 0; i < NumShards; ++i)
+            {
+                std::lock_guard<std::mutex> lock(_shards[i].mutex);
+                for(std::map<double, Entry>::const_iterator it = _shards[i].evaluations.begin(); it != _shards[i].evaluations.end(); ++it)
+                {
+                    if(it->second.generation == generation) ++size;
+                }
+            }
+            return size;
+        }
+
+    } // namespace splines
+} // namespace aslam
@@ -19,13 +19,8 @@ namespace aslam {
 
         aslam::backend::EuclideanExpression EuclideanBSplineDesignVariable::toEuclideanExpression(double time, int order)
         {
-            Eigen::VectorXi dvidxs = _bspline.localVvCoefficientVectorIndices(time);
-            std::vector<aslam::backend::DesignVariable *> dvs;
-            for(int i = 0; i < dvidxs.size(); ++i)
-            {
-                dvs.push_back(&_designVariables[dvidxs[i]]);
-            }
-            boost::shared_ptr<aslam::splines::BSplineEuclideanExpressionNode > root( new aslam::splines::BSplineEuclideanExpressionNode(&_bspline, dvs, time, order) );
+            const std::vector<aslam::backend::DesignVariable *> & dvs = localDesignVariables(time);
+            boost::shared_ptr<aslam::splines::BSplineEuclideanExpressionNode > root = allocateExpressionNode<aslam::splines::BSplineEuclideanExpressionNode>(_expressionNodeArena, &_bspline, dvs, time, order, _expressionNodeArena);
             
             return aslam::backend::EuclideanExpression(root);
         }
@@ -0,0 +1,34 @@
+#ifndef ASLAM_SPLINES_TEST_DENSE_NORMAL_EQUATIONS_HPP
+#define ASLAM_SPLINES_TEST_DENSE_NORMAL_EQUATIONS_HPP
+
+#include <vector>
+#include <Eigen/Core>
+#include <aslam/backend/ErrorTerm.hpp>
+
+/// the dense Hessian (upper block triangle) and rhs the error terms add for the design variables dvs, which must have the block indices 0, ..., dvs.size() - 1
+template <typename ErrorTermPointers>
+void buildDenseNormalEquations(const ErrorTermPointers & errorTerms, const std::vector<aslam::backend::DesignVariable *> & dvs, bool useMEstimator, Eigen::MatrixXd & H, Eigen::VectorXd & rhs)
+{
+    std::vector<int> blocks;
+    int dimension = 0;
+    for(size_t i = 0; i < dvs.size(); ++i)
+    {
+        dimension += dvs[i]->minimalDimensions();
+        blocks.push_back(dimension);
+    }
+    aslam::backend::SparseBlockMatrix sparseH(blocks, blocks, true);
+    rhs.setZero(dimension);
+    for(auto & e : errorTerms)
+    {
+        e->buildHessian(sparseH, rhs, useMEstimator);
+    }
+    H = sparseH.toDense();
+}
+
+/// the upper triangle of a dense Hessian, as built by buildDenseNormalEquations
+inline Eigen::MatrixXd upperTriangle(const Eigen::MatrixXd & H)
+{
+    return H.triangularView<Eigen::Upper>();
+}
+
+#endif /* ASLAM_SPLINES_TEST_DENSE_NORMAL_EQUATIONS_HPP */
@@ -9,9 +9,14 @@
 #include <aslam/backend/HomogeneousPoint.hpp>
 #include <aslam/backend/JacobianContainerSparse.hpp>
 #include <aslam/splines/BSplinePoseDesignVariable.hpp>
+#include <aslam/splines/BSplineExpressions.hpp>
 #include <aslam/splines/BSplineRSPoseDesignVariable.hpp>
 #include <sm/kinematics/EulerRodriguez.hpp>
 #include <aslam/backend/Scalar.hpp>
+#include <thread>
+#ifdef SPEEDMEASURE
+#include <sm/timing/Timer.hpp>
+#endif
 
 using namespace aslam::backend;
 using sm::kinematics::EulerRodriguez;
@@ -175,6 +180,91 @@ TEST(BSplineExpressionTestSuite, testTransformationExpression)
 }
 
 
+TEST(BSplineExpressionTestSuite, testArenaTransformationExpression)
+{
+    try {
+        HomogeneousPoint hp(Eigen::Vector4d::Random());
+        HomogeneousExpression he = hp.toExpression();
+
+        BSplinePoseDesignVariable bdv = generateRandomSpline();
+        TransformationExpression heapT = bdv.transformation(5.0);
+
+        ExpressionNodeArena arena;
+        bdv.setExpressionNodeArena(&arena);
+        {
+            TransformationExpression T = bdv.transformation(5.0);
+            EXPECT_EQ(1u, arena.numBlocks());
+            sm::eigen::assertNear(heapT.toTransformationMatrix(), T.toTransformationMatrix(), 1e-12, SM_SOURCE_FILE_POS);
+
+            HomogeneousExpression The = T * he;
+            ExpressionNodeFunctor<HomogeneousExpression> functor(The);
+
+            SCOPED_TRACE("");
+            functor.testJacobian();
+        }
+        bdv.setExpressionNodeArena(NULL);
+
+        // the parallel error term builders may create expressions in the same arena concurrently
+        {
+            ExpressionNodeArena sharedArena(1 << 10);
+            bdv.setExpressionNodeArena(&sharedArena);
+            const int numberOfThreads = 4, numberOfExpressions = 1000;
+            std::vector<std::vector<TransformationExpression> > expressions(numberOfThreads);
+            std::vector<std::thread> threads;
+            for(int t = 0; t < numberOfThreads; t++){
+                threads.push_back(std::thread([&bdv, &expressions, t](){
+                    for(int i = 0; i < numberOfExpressions; i++){
+                        expressions[t].push_back(bdv.transformation(1.0 + i * 4.0 / numberOfExpressions));
+                    }
+                }));
+            }
+            for(std::thread & thread : threads){
+                thread.join();
+            }
+            bdv.setExpressionNodeArena(NULL);
+
+            for(int t = 0; t < numberOfThreads; t++){
+                for(int i = 0; i < numberOfExpressions; i++){
+                    sm::eigen::assertNear(expressions[t][i].toTransformationMatrix(), bdv.spline().transformation(1.0 + i * 4.0 / numberOfExpressions), 1e-12, SM_SOURCE_FILE_POS);
+                }
+            }
+        }
+
+#ifdef SPEEDMEASURE
+        const int numberOfExpressions = 100000;
+        for(int j = 0; j < 10; j++){
+            {
+                sm::timing::Timer timer("construct transformation expressions");
+                std::vector<TransformationExpression> expressions;
+                expressions.reserve(numberOfExpressions);
+                for(int i = 0; i < numberOfExpressions; i++){
+                    expressions.push_back(bdv.transformation(1.0 + i * 4.0 / numberOfExpressions));
+                }
+                timer.stop();
+            }
+            {
+                sm::timing::Timer timer("construct transformation expressions in an arena");
+                ExpressionNodeArena problemArena;
+                bdv.setExpressionNodeArena(&problemArena);
+                std::vector<TransformationExpression> expressions;
+                expressions.reserve(numberOfExpressions);
+                for(int i = 0; i < numberOfExpressions; i++){
+                    expressions.push_back(bdv.transformation(1.0 + i * 4.0 / numberOfExpressions));
+                }
+                bdv.setExpressionNodeArena(NULL);
+                timer.stop();
+            }
+        }
+        sm::timing::Timing::print(std::cout);
+#endif
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
+
+
 TEST(BSplineExpressionTestSuite, testAccelerationExpression)
 {
     try {
@@ -230,6 +320,100 @@ TEST(BSplineExpressionTestSuite, testAngularVelocityExpression)
   
 }
 
+TEST(BSplineExpressionTestSuite, testSharedEvaluationCache)
+{
+    try {
+        BSplinePoseDesignVariable bdv = generateRandomSpline();
+
+        // the cache is opt-in
+        EXPECT_FALSE(bdv.useEvaluationCache());
+        bdv.transformation(5.0).toTransformationMatrix();
+        EXPECT_EQ(0u, bdv.evaluationCache().size());
+
+        bdv.setUseEvaluationCache(true);
+        TransformationExpression T = bdv.transformation(5.0);
+        EuclideanExpression v = bdv.linearVelocity(5.0);
+        EuclideanExpression omega = bdv.angularVelocityBodyFrame(5.0);
+
+        sm::eigen::assertNear(bdv.spline().transformation(5.0), T.toTransformationMatrix(), 1e-12, SM_SOURCE_FILE_POS);
+        sm::eigen::assertNear(bdv.spline().linearVelocity(5.0), v.toEuclidean(), 1e-12, SM_SOURCE_FILE_POS);
+        sm::eigen::assertNear(bdv.spline().angularVelocityBodyFrame(5.0), omega.toEuclidean(), 1e-12, SM_SOURCE_FILE_POS);
+        EXPECT_EQ(1u, bdv.evaluationCache().size());
+
+        // an update moves the linearization point and outdates the cached evaluations, which are then recomputed
+        const Eigen::Matrix4d T0 = T.toTransformationMatrix();
+        Eigen::VectorXd dp = Eigen::VectorXd::Random(6);
+        DesignVariable::set_t dvs;
+        omega.getDesignVariables(dvs);
+        (*dvs.begin())->update(dp.data(), 6);
+        EXPECT_EQ(0u, bdv.evaluationCache().size());
+        sm::eigen::assertNear(bdv.spline().angularVelocityBodyFrame(5.0), omega.toEuclidean(), 1e-12, SM_SOURCE_FILE_POS);
+        sm::eigen::assertNear(bdv.spline().transformation(5.0), T.toTransformationMatrix(), 1e-12, SM_SOURCE_FILE_POS);
+        EXPECT_GT((T.toTransformationMatrix() - T0).norm(), 1e-6);
+        EXPECT_EQ(1u, bdv.evaluationCache().size());
+
+        // so does reverting it
+        (*dvs.begin())->revertUpdate();
+        EXPECT_EQ(0u, bdv.evaluationCache().size());
+        sm::eigen::assertNear(T0, T.toTransformationMatrix(), 1e-12, SM_SOURCE_FILE_POS);
+
+        // nodes without a cache evaluate the spline directly
+        BSplinePose & spline = const_cast<BSplinePose &>(bdv.spline());
+        EuclideanExpression directOmega(boost::shared_ptr<EuclideanExpressionNode>(new BSplineAngularVelocityBodyFrameExpressionNode(&spline, bdv.getDesignVariables(5.0), 5.0)));
+        sm::eigen::assertNear(omega.toEuclidean(), directOmega.toEuclidean(), 1e-12, SM_SOURCE_FILE_POS);
+        JacobianContainerSparse<> J(3), directJ(3);
+        omega.evaluateJacobians(J);
+        directOmega.evaluateJacobians(directJ);
+        sm::eigen::assertNear(Eigen::MatrixXd(J.asSparseMatrix()), Eigen::MatrixXd(directJ.asSparseMatrix()), 1e-12, SM_SOURCE_FILE_POS);
+
+        ExpressionNodeFunctor<EuclideanExpression> functor(omega);
+        SCOPED_TRACE("");
+        functor.testJacobian();
+
+#ifdef SPEEDMEASURE
+        // pose, velocity and angular velocity per time, once at distinct times and once with every time shared by ten such triples;
+        // each iteration evaluates values and Jacobians and then updates a design variable
+        const int numberOfTimes = 10000;
+        for(int shared = 1; shared <= 10; shared *= 10){
+            for(int cached = 0; cached < 2; cached++){
+                bdv.setUseEvaluationCache(cached);
+                std::vector<TransformationExpression> Ts;
+                std::vector<EuclideanExpression> vs;
+                for(int i = 0; i < numberOfTimes; i++){
+                    const double t = 1.0 + (i / shared) * 4.0 * shared / numberOfTimes;
+                    Ts.push_back(bdv.transformation(t));
+                    vs.push_back(bdv.linearVelocity(t));
+                    vs.push_back(bdv.angularVelocityBodyFrame(t));
+                }
+                const std::string label = std::string(cached ? "cached" : "uncached") + (shared > 1 ? " evaluation at shared times" : " evaluation at distinct times");
+                for(int j = 0; j < 10; j++){
+                    sm::timing::Timer timer(label);
+                    JacobianContainerSparse<> J6(6), J3(3);
+                    for(size_t i = 0; i < Ts.size(); i++){
+                        Ts[i].toTransformationMatrix();
+                        Ts[i].evaluateJacobians(J6);
+                        J6.clear();
+                    }
+                    for(size_t i = 0; i < vs.size(); i++){
+                        vs[i].toEuclidean();
+                        vs[i].evaluateJacobians(J3);
+                        J3.clear();
+                    }
+                    (*dvs.begin())->update(dp.data(), 6);
+                    timer.stop();
+                    (*dvs.begin())->revertUpdate();
+                }
+            }
+        }
+        sm::timing::Timing::print(std::cout);
+#endif
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
+
 
 
 
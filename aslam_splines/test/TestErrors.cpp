@@ -1,8 +1,13 @@
 #include <sm/eigen/gtest.hpp>
 #include <aslam/backend/JacobianContainerSparse.hpp>
 #include <aslam/backend/SimpleSplineError.hpp>
+#include <aslam/backend/BatchedSplineError.hpp>
+#include <aslam/backend/BSplineMotionError.hpp>
+#include <aslam/backend/MEstimatorPolicies.hpp>
 #include <aslam/splines/BSplineDesignVariable.hpp>
 #include <bsplines/BSpline.hpp>
+#include <boost/make_shared.hpp>
+#include "DenseNormalEquations.hpp"
 
 
 using namespace bsplines;
@@ -64,3 +69,307 @@ TEST(SplineErrorTestSuite, testSimpleSplineError)
 }
 
 
+TEST(SplineErrorTestSuite, testBatchedSplineError)
+{
+    try
+    {
+        using namespace aslam::backend;
+        BSplineDesignVariable<1> initSpline = generateRandomBSpline();
+        const int N = 20;
+        Eigen::VectorXd times = Eigen::VectorXd::LinSpaced(N, 2.1, 6.9);
+        Eigen::Matrix<double, 1, Eigen::Dynamic> values = Eigen::Matrix<double, 1, Eigen::Dynamic>::Random(N);
+        Eigen::VectorXd weights = Eigen::VectorXd::Random(N).cwiseAbs();
+        BatchedSplineError<BSplineDesignVariable<1> > e(&initSpline, times, values, weights);
+
+        ASSERT_EQ(N, (int)e.dimension());
+
+        // the squared error is the weighted sum of the SimpleSplineErrors' squared errors
+        std::vector<boost::shared_ptr<VectorExpression<1> > > splineExpressions;
+        std::vector<boost::shared_ptr<SimpleSplineError<BSplineDesignVariable<1> > > > simpleErrors;
+        double squaredError = 0;
+        for(int i = 0; i < N; ++i)
+        {
+            splineExpressions.push_back(boost::make_shared<VectorExpression<1> >(initSpline.toExpression(times[i], 0)));
+            simpleErrors.push_back(boost::make_shared<SimpleSplineError<BSplineDesignVariable<1> > >(&initSpline, splineExpressions.back().get(), values.col(i), times[i]));
+            simpleErrors.back()->setInvR(Eigen::Matrix<double, 1, 1>::Constant(weights[i]));
+            squaredError += weights[i] * simpleErrors.back()->evaluateError();
+        }
+        EXPECT_NEAR(squaredError, e.evaluateError(), 1e-9);
+        EXPECT_NEAR(squaredError, e.error().squaredNorm(), 1e-9);
+
+        JacobianContainerSparse<> estJ(e.dimension());
+        e.evaluateJacobiansFiniteDifference(estJ);
+
+        JacobianContainerSparse<> J(e.dimension());
+        e.evaluateJacobians(J);
+
+        SCOPED_TRACE("");
+        sm::eigen::assertNear(J.asDenseMatrix(), estJ.asDenseMatrix(), 1e-6, SM_SOURCE_FILE_POS, "Checking the jacobian vs. finite differences");
+
+        // the Hessian and rhs are the sum of the (inverse covariance weighted) SimpleSplineErrors' ones
+        std::vector<DesignVariable *> dvs;
+        for(size_t i = 0; i < initSpline.numDesignVariables(); ++i)
+        {
+            dvs.push_back(initSpline.designVariable(i));
+        }
+        std::vector<BatchedSplineError<BSplineDesignVariable<1> > *> batchedErrors(1, &e);
+        Eigen::MatrixXd H, simpleH;
+        Eigen::VectorXd rhs, simpleRhs;
+        buildDenseNormalEquations(batchedErrors, dvs, false, H, rhs);
+        buildDenseNormalEquations(simpleErrors, dvs, false, simpleH, simpleRhs);
+        sm::eigen::assertNear(upperTriangle(H), upperTriangle(simpleH), 1e-9, SM_SOURCE_FILE_POS, "Checking the Hessian against the SimpleSplineErrors");
+        sm::eigen::assertNear(rhs, simpleRhs, 1e-9, SM_SOURCE_FILE_POS, "Checking the rhs against the SimpleSplineErrors");
+
+        // the M-estimator weight of the batch's squared error scales the whole contribution
+        boost::shared_ptr<MEstimator> mEstimator = boost::make_shared<CauchyMEstimator>(0.5);
+        e.setMEstimatorPolicy(mEstimator);
+        const double weight = mEstimator->getWeight(squaredError);
+        EXPECT_LT(weight, 1.0);
+        buildDenseNormalEquations(batchedErrors, dvs, true, H, rhs);
+        sm::eigen::assertNear(upperTriangle(H), weight * upperTriangle(simpleH), 1e-9, SM_SOURCE_FILE_POS, "Checking the M-estimator weighted Hessian");
+        sm::eigen::assertNear(rhs, weight * simpleRhs, 1e-9, SM_SOURCE_FILE_POS, "Checking the M-estimator weighted rhs");
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
+
+
+TEST(SplineErrorTestSuite, testBatchedSplineErrorHessianIsBanded)
+{
+    try
+    {
+        using namespace aslam::backend;
+        const int numberOfSegments = 50, splineOrder = 4;
+        BSpline bspline(splineOrder);
+        bspline.initConstantSpline(0, numberOfSegments, numberOfSegments, Eigen::VectorXd::Zero(2));
+        bspline.setCoefficientMatrix(Eigen::MatrixXd::Random(2, bspline.numVvCoefficients()));
+        BSplineDesignVariable<2> splineDv(bspline);
+        std::vector<int> blocks;
+        for(size_t i = 0; i < splineDv.numDesignVariables(); ++i)
+        {
+            splineDv.designVariable(i)->setActive(true);
+            splineDv.designVariable(i)->setBlockIndex(i);
+            blocks.push_back(2 * (i + 1));
+        }
+
+        // measurements in every segment
+        const int N = 4 * numberOfSegments;
+        BatchedSplineError<BSplineDesignVariable<2> > e(&splineDv, Eigen::VectorXd::LinSpaced(N, 0.1, numberOfSegments - 0.1), Eigen::MatrixXd::Random(2, N));
+        const int n = e.numDesignVariables();
+        ASSERT_EQ((int)splineDv.numDesignVariables(), n);
+
+        SparseBlockMatrix H(blocks, blocks, true);
+        Eigen::VectorXd rhs = Eigen::VectorXd::Zero(blocks.back());
+        e.buildHessian(H, rhs, false);
+
+        // only the upper band |i - j| < splineOrder is allocated
+        int allocatedBlocks = 0;
+        for(int i = 0; i < n; ++i)
+        {
+            for(int j = i; j < n; ++j)
+            {
+                if(H.block(i, j, false))
+                {
+                    ++allocatedBlocks;
+                    EXPECT_LT(j - i, splineOrder) << "block (" << i << ", " << j << ") is outside the band";
+                }
+            }
+        }
+        EXPECT_EQ(splineOrder * n - splineOrder * (splineOrder - 1) / 2, allocatedBlocks);
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
+
+
+struct ErrorTermCollector {
+    std::vector<boost::shared_ptr<aslam::backend::ErrorTerm> > errorTerms;
+    void addErrorTerm(const boost::shared_ptr<aslam::backend::ErrorTerm> & et) { errorTerms.push_back(et); }
+};
+
+template <typename SplineDv>
+std::vector<aslam::backend::DesignVariable *> getDesignVariables(SplineDv & splineDv)
+{
+    std::vector<aslam::backend::DesignVariable *> dvs;
+    for(size_t i = 0; i < splineDv.numDesignVariables(); ++i)
+        dvs.push_back(splineDv.designVariable(i));
+    return dvs;
+}
+
+
+TEST(SplineErrorTestSuite, testBSplineMotionError)
+{
+    try
+    {
+        using namespace aslam::backend;
+        BSplineDesignVariable<1> initSpline = generateRandomBSpline();
+        Eigen::MatrixXd W = Eigen::MatrixXd::Identity(1, 1);
+        BSplineMotionError<BSplineDesignVariable<1> > e(&initSpline, W);
+
+        // the segments' squared errors sum up to c' Q c
+        const Eigen::MatrixXd & coefficients = initSpline.spline().coefficients();
+        Eigen::VectorXd c = Eigen::VectorXd::Map(coefficients.data(), coefficients.size());
+        ASSERT_EQ(initSpline.spline().numValidTimeSegments(), (int)e.numberOfSegments());
+        EXPECT_NEAR(c.dot(e.Q() * c), e.evaluateError(), 1e-9);
+        sm::eigen::assertNear(e.rhs(), -e.Q() * c, 1e-9, SM_SOURCE_FILE_POS);
+
+        for(size_t s = 0; s < e.numberOfSegments(); ++s)
+        {
+            SCOPED_TRACE(s);
+            const SegmentQuadraticFormError::Ptr & segmentError = e.segmentError(s);
+            JacobianContainerSparse<> estJ(segmentError->dimension());
+            segmentError->evaluateJacobiansFiniteDifference(estJ);
+
+            JacobianContainerSparse<> J(segmentError->dimension());
+            segmentError->evaluateJacobians(J);
+            sm::eigen::assertNear(J.asDenseMatrix(), estJ.asDenseMatrix(), 1e-6, SM_SOURCE_FILE_POS, "Checking the jacobian vs. finite differences");
+        }
+
+        // Gauss-Newton recovers Q
+        ErrorTermCollector segmentErrors;
+        e.addErrorTerms(segmentErrors);
+        Eigen::MatrixXd H;
+        Eigen::VectorXd rhs;
+        buildDenseNormalEquations(segmentErrors.errorTerms, getDesignVariables(initSpline), false, H, rhs);
+        sm::eigen::assertNear(H, upperTriangle(e.Q()), 1e-9, SM_SOURCE_FILE_POS);
+        sm::eigen::assertNear(rhs, e.rhs(), 1e-9, SM_SOURCE_FILE_POS);
+
+        // also for a constant spline, where c' Q c = 0
+        BSpline constantBSpline(4);
+        constantBSpline.initConstantSpline(0, 9, 6, Eigen::VectorXd::Ones(1));
+        BSplineDesignVariable<1> constantSpline(constantBSpline);
+        for(size_t i = 0; i < constantSpline.numDesignVariables(); ++i)
+        {
+            constantSpline.designVariable(i)->setActive(true);
+            constantSpline.designVariable(i)->setBlockIndex(i);
+        }
+        BSplineMotionError<BSplineDesignVariable<1> > constantError(&constantSpline, W);
+        EXPECT_NEAR(0, constantError.evaluateError(), 1e-12);
+        ErrorTermCollector constantSegmentErrors;
+        constantError.addErrorTerms(constantSegmentErrors);
+        buildDenseNormalEquations(constantSegmentErrors.errorTerms, getDesignVariables(constantSpline), false, H, rhs);
+        sm::eigen::assertNear(H, upperTriangle(constantError.Q()), 1e-9, SM_SOURCE_FILE_POS);
+        EXPECT_GT(constantError.Q().norm(), 0);
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
+
+
+TEST(SplineErrorTestSuite, testBSplineMotionErrorJacobiansAreBanded)
+{
+    try
+    {
+        using namespace aslam::backend;
+        const int numberOfSegments = 2000;
+        BSpline bspline(4);
+        bspline.initConstantSpline(0, numberOfSegments, numberOfSegments, Eigen::VectorXd::Zero(2));
+        bspline.setCoefficientMatrix(Eigen::MatrixXd::Random(2, bspline.numVvCoefficients()));
+        BSplineDesignVariable<2> splineDv(bspline);
+        for(size_t i = 0; i < splineDv.numDesignVariables(); ++i)
+        {
+            splineDv.designVariable(i)->setActive(true);
+            splineDv.designVariable(i)->setBlockIndex(i);
+        }
+        BSplineMotionError<BSplineDesignVariable<2> > e(&splineDv, Eigen::MatrixXd::Identity(2, 2));
+        ASSERT_EQ(numberOfSegments, (int)e.numberOfSegments());
+
+        // every segment's Jacobians cover its splineOrder design variables with splineOrder * 2 rows each
+        for(size_t s = 0; s < e.numberOfSegments(); ++s)
+        {
+            SCOPED_TRACE(s);
+            const SegmentQuadraticFormError::Ptr & segmentError = e.segmentError(s);
+            ASSERT_EQ(8u, segmentError->dimension());
+            ASSERT_EQ(4u, segmentError->numDesignVariables());
+
+            JacobianContainerSparse<> J(segmentError->dimension());
+            segmentError->evaluateJacobians(J);
+            ASSERT_EQ(4u, J.numDesignVariables());
+            for(size_t i = 0; i < J.numDesignVariables(); ++i)
+            {
+                EXPECT_EQ(splineDv.designVariable(s + i), J.designVariable(i));
+            }
+            sm::eigen::assertNear(J.asDenseMatrix(), segmentError->sqrtQ(), 1e-12, SM_SOURCE_FILE_POS);
+        }
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
+
+
+TEST(SplineErrorTestSuite, testBSplineMotionErrorSlidingWindow)
+{
+    try
+    {
+        using namespace aslam::backend;
+        BSplineDesignVariable<1> initSpline = generateRandomBSpline();
+        Eigen::MatrixXd W = Eigen::MatrixXd::Identity(1, 1);
+        BSplineMotionError<BSplineDesignVariable<1> > e(&initSpline, W);
+
+        for(int i = 0; i < 3; ++i)
+        {
+            initSpline.addSegment(initSpline.spline().t_max() + 0.7, Eigen::VectorXd::Random(1));
+            SegmentQuadraticFormError::Ptr appended = e.handleAppendedSegment();
+            EXPECT_EQ(e.segmentError(e.numberOfSegments() - 1), appended);
+            SegmentQuadraticFormError::Ptr front = e.segmentError(0);
+            initSpline.removeSegment();
+            EXPECT_EQ(front, e.handleRemovedFrontSegment());
+
+            // the incrementally maintained contributions agree with the ones of a fresh error term
+            BSplineMotionError<BSplineDesignVariable<1> > fresh(&initSpline, W);
+            ASSERT_EQ(fresh.numberOfSegments(), e.numberOfSegments());
+            sm::eigen::assertNear(e.Q(), fresh.Q(), 1e-9, SM_SOURCE_FILE_POS);
+            EXPECT_NEAR(fresh.evaluateError(), e.evaluateError(), 1e-9);
+        }
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
+
+
+TEST(SplineErrorTestSuite, testBSplineMotionErrorGrowingSpline)
+{
+    try
+    {
+        using namespace aslam::backend;
+        BSplineDesignVariable<1> initSpline = generateRandomBSpline();
+        Eigen::MatrixXd W = Eigen::MatrixXd::Identity(1, 1);
+        BSplineMotionError<BSplineDesignVariable<1> > e(&initSpline, W);
+        ErrorTermCollector segmentErrors;
+        e.addErrorTerms(segmentErrors);
+
+        for(int i = 0; i < 3; ++i)
+        {
+            initSpline.addSegment(initSpline.spline().t_max() + 0.7, Eigen::VectorXd::Random(1));
+            initSpline.designVariable(initSpline.numDesignVariables() - 1)->setActive(true);
+            initSpline.designVariable(initSpline.numDesignVariables() - 1)->setBlockIndex(initSpline.numDesignVariables() - 1);
+            segmentErrors.addErrorTerm(e.handleAppendedSegment());
+            ASSERT_EQ(initSpline.spline().numValidTimeSegments(), (int)e.numberOfSegments());
+
+            // the grown error covers all segments, as a fresh one does
+            BSplineMotionError<BSplineDesignVariable<1> > fresh(&initSpline, W);
+            sm::eigen::assertNear(e.Q(), fresh.Q(), 1e-9, SM_SOURCE_FILE_POS);
+            EXPECT_NEAR(fresh.evaluateError(), e.evaluateError(), 1e-9);
+
+            Eigen::MatrixXd H;
+            Eigen::VectorXd rhs;
+            buildDenseNormalEquations(segmentErrors.errorTerms, getDesignVariables(initSpline), false, H, rhs);
+            sm::eigen::assertNear(H, upperTriangle(fresh.Q()), 1e-9, SM_SOURCE_FILE_POS);
+            sm::eigen::assertNear(rhs, fresh.rhs(), 1e-9, SM_SOURCE_FILE_POS);
+        }
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
@@ -9,14 +9,18 @@
 #include <cmath>
 
 #include <type_traits>
+#include <atomic>
 #include <algorithm>
 #include <sm/eigen/gtest.hpp>
 #include <sm/eigen/NumericalDiff.hpp>
 #include <sm/kinematics/Transformation.hpp>
 #include <aslam/splines/OPTBSpline.hpp>
 #include <aslam/splines/OPTUnitQuaternionBSpline.hpp>
+#include <aslam/splines/OPTSE3BSpline.hpp>
+#include <aslam/splines/OPTCompositeBSpline.hpp>
 #include <bsplines/EuclideanBSpline.hpp>
 #include <bsplines/UnitQuaternionBSpline.hpp>
+#include <bsplines/SE3BSpline.hpp>
 #include <bsplines/NsecTimePolicy.hpp>
 #include <bsplines/BSplineFitter.hpp>
 
@@ -35,6 +39,12 @@
 #include <aslam/backend/OptimizationProblem.hpp>
 #include <aslam/backend/ExpressionErrorTerm.hpp>
 #include <aslam/backend/VectorExpressionToGenericMatrixTraits.hpp>
+#include <aslam/backend/OPTBSplineMotionError.hpp>
+#include <aslam/backend/QuadraticIntegralError.hpp>
+#include "DenseNormalEquations.hpp"
+#ifdef SPEEDMEASURE
+#include <sm/timing/Timer.hpp>
+#endif
 
 
 //#define NO_T1
@@ -363,6 +373,54 @@ struct OPTSplineSpecializationTester<UnitQuaternionBSplineConfiguration<TDiffMan
 };
 
 
+template <typename TDiffManifoldConfiguration, int IEigenSplineOrder, typename TTimePolicy, int ISplineOrder>
+struct MaxDerivative<SE3BSplineConfiguration<TDiffManifoldConfiguration, IEigenSplineOrder, TTimePolicy>, ISplineOrder> {
+	// the time expression factories need one more derivative than the value expressions
+	enum { LIMIT=SE3BSplineConfiguration<TDiffManifoldConfiguration, IEigenSplineOrder, TTimePolicy>::BSpline::MaxSupportedDerivativeOrderEvaluation - 1, VALUE = LIMIT < ISplineOrder ? LIMIT : ISplineOrder };
+};
+
+template <typename TDiffManifoldConfiguration, int IEigenSplineOrder, typename TTimePolicy, int ISplineOrder, int IDim>
+struct OPTSplineSpecializationTester<SE3BSplineConfiguration<TDiffManifoldConfiguration, IEigenSplineOrder, TTimePolicy>, ISplineOrder, IDim>
+{
+	typedef SE3BSplineConfiguration<TDiffManifoldConfiguration, IEigenSplineOrder, TTimePolicy> CONF;
+	typedef typename OPTBSpline<CONF>::BSpline TestBSpline;
+	typedef typename TestBSpline::time_t time_t;
+
+	static void test(TestBSpline & bspline, time_t t, typename TestBSpline::TimeExpression timeExpression, time_t timeExpLowerBound, time_t timeExpUpperBound){
+
+		auto fact = bspline.template getExpressionFactoryAt < 2 > (t);
+		auto factTimeExp = bspline.template getExpressionFactoryAt<1> (timeExpression, timeExpLowerBound, timeExpUpperBound);
+
+		auto twistExpression = fact.getTwistExpression();
+		auto twistExpressionTE = factTimeExp.getTwistExpression();
+
+		typename TestBSpline::template Evaluator<2> eval = bspline.template getEvaluatorAt < 2 > (t);
+		sm::eigen::assertEqual(eval.evalTwist(), twistExpression.evaluate(), SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(eval.evalTwist(), twistExpressionTE.evaluate(), 1E-9, SM_SOURCE_FILE_POS);
+
+		JacobianContainerSparse<> jac(6);
+		typename TestBSpline::twist_jacobian_t J;
+
+		twistExpression.evaluateJacobians(jac);
+		eval.evalTwistJacobian(J);
+		sm::eigen::assertEqual(J, jac.asDenseMatrix(), SM_SOURCE_FILE_POS);
+
+		if(isNumericallyDifferentiableAt(bspline, twistExpression, 1, t))
+		{
+			SCOPED_TRACE(""); testJacobian(twistExpression, bspline.getSplineOrder());
+		}
+
+		if(t != bspline.getMaxTime() && t != bspline.getMinTime()){
+			int expectedNumberOfDVs = bspline.getSplineOrder() + std::distance(bspline.getSegmentIterator(timeExpLowerBound), bspline.getSegmentIterator(timeExpUpperBound)) + 1; // number of control vertices relevant for the interval + 1 for the time design variable!
+			if(isNumericallyDifferentiableAt(bspline, twistExpressionTE, 2, t))
+			{
+				SCOPED_TRACE(""); testJacobian<time_t>(twistExpressionTE, expectedNumberOfDVs, 2);
+			}
+		}
+	}
+};
+
+
 #ifndef NO_T1
 
 template <typename Tester>
@@ -397,7 +455,9 @@ typedef ::testing::Types<
 	OPTSplineTester<UnitQuaternionBSpline<Eigen::Dynamic>, 5, 3>,
 	OPTSplineTester<UnitQuaternionBSpline<Eigen::Dynamic, NsecTimePolicy>, 5, 3>,
 	OPTSplineTester<UnitQuaternionBSpline<Eigen::Dynamic>, 8, 3>,
-	OPTSplineTester<UnitQuaternionBSpline<Eigen::Dynamic>, 9, 3>
+	OPTSplineTester<UnitQuaternionBSpline<Eigen::Dynamic>, 9, 3>,
+	OPTSplineTester<SE3BSpline<4>, 4, 6>,
+	OPTSplineTester<SE3BSpline<Eigen::Dynamic, NsecTimePolicy>, 3, 6>
 #endif
 > Testers;
 
@@ -524,6 +584,334 @@ TEST(OPTBSplineTestSuite, testAppendingUpdatesDesignVariableList)
 	}
 }
 
+TEST(OPTBSplineTestSuite, testRemovingSegmentsUpdatesDesignVariableList)
+{
+	try {
+		OPTBSpline<EuclideanBSpline<3, 2>::CONF>::BSpline testSpline;
+
+		auto zero = Eigen::Vector2d::Zero();
+		testSpline.initConstantUniformSpline(0, 2, 2, zero);
+		const size_t before = testSpline.getDesignVariables().size();
+		for(int i = 0; i < 100; i++){
+			testSpline.appendSegmentsUniformly(1);
+			testSpline.removeSegment();
+
+			ASSERT_EQ(before, testSpline.numDesignVariables());
+			ASSERT_EQ(testSpline.getDesignVariables(testSpline.getMinTime()).front(), testSpline.designVariable(0));
+		}
+		ASSERT_EQ(100, testSpline.getMinTime());
+	}
+	catch(const std::exception & e)
+	{
+		FAIL() << e.what();
+	}
+}
+
+template <typename TSpline>
+struct WeightedSquaredAccelerationFunctor {
+	typename TSpline::point_t W;
+	inline double eval(const TSpline & spline, typename TSpline::time_t t) const {
+		return spline.template getEvaluatorAt<2>(t).evalD(2).cwiseAbs2().dot(W);
+	}
+	inline double getZeroValue(const TSpline & /* spline */) const {
+		return 0.0;
+	}
+};
+
+struct ErrorTermCollector {
+	std::vector<boost::shared_ptr<ErrorTerm> > errorTerms;
+	void addErrorTerm(const boost::shared_ptr<ErrorTerm> & et) { errorTerms.push_back(et); }
+	double evaluateError() const {
+		double sum = 0;
+		for(auto & et : errorTerms) sum += et->evaluateError();
+		return sum;
+	}
+};
+
+TEST(OPTBSplineTestSuite, testMotionErrorIsExactAccelerationIntegral)
+{
+	try {
+		typedef OPTBSpline<EuclideanBSpline<4, 3>::CONF>::BSpline TestSpline;
+		TestSpline testSpline;
+		testSpline.initConstantUniformSpline(0, 5, 7, Eigen::Vector3d::Zero());
+		for(auto it = testSpline.getAbsoluteBegin(); it != testSpline.getAbsoluteEnd(); ++it) it->setControlVertex(Eigen::Vector3d::Random());
+		for(size_t i = 0; i < testSpline.numDesignVariables(); ++i) {
+			testSpline.designVariable(i)->setActive(true);
+			testSpline.designVariable(i)->setBlockIndex(i);
+		}
+
+		WeightedSquaredAccelerationFunctor<TestSpline> f;
+		f.W = Eigen::Vector3d(1, 2, 3);
+		OPTBSplineMotionError<TestSpline> e(&testSpline, f.W);
+		ASSERT_EQ(testSpline.getNumValidTimeSegments(), (int)e.numberOfSegments());
+
+		const double integral = testSpline.evalFunctorIntegralToTolerance<double>(testSpline.getMinTime(), testSpline.getMaxTime(), f, 1E-12, 1E-10);
+		EXPECT_NEAR(integral, e.evaluateError(), integral * 1E-9);
+
+		for(size_t s = 0; s < e.numberOfSegments(); ++s) {
+			SCOPED_TRACE(s);
+			JacobianContainerSparse<> estJ(e.segmentError(s)->dimension());
+			e.segmentError(s)->evaluateJacobiansFiniteDifference(estJ);
+			JacobianContainerSparse<> J(e.segmentError(s)->dimension());
+			e.segmentError(s)->evaluateJacobians(J);
+			sm::eigen::assertNear(J.asDenseMatrix(), estJ.asDenseMatrix(), 1e-6, SM_SOURCE_FILE_POS, "Checking the jacobian vs. finite differences");
+		}
+
+		// the segments' Gauss-Newton system is the exact one
+		ErrorTermCollector segmentErrors;
+		e.addErrorTerms(segmentErrors);
+		std::vector<DesignVariable *> dvs(testSpline.getDesignVariables().begin(), testSpline.getDesignVariables().end());
+		Eigen::MatrixXd H;
+		Eigen::VectorXd rhs;
+		buildDenseNormalEquations(segmentErrors.errorTerms, dvs, false, H, rhs);
+		sm::eigen::assertNear(H, upperTriangle(e.Q()), 1e-9, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(rhs, e.rhs(), 1e-9, SM_SOURCE_FILE_POS);
+	}
+	catch(const std::exception & e)
+	{
+		FAIL() << e.what();
+	}
+}
+
+TEST(OPTBSplineTestSuite, testMotionErrorJacobiansAreBanded)
+{
+	try {
+		typedef OPTBSpline<EuclideanBSpline<4, 3>::CONF>::BSpline TestSpline;
+		const int numberOfSegments = 2000;
+		TestSpline testSpline;
+		testSpline.initConstantUniformSpline(0, numberOfSegments, numberOfSegments, Eigen::Vector3d::Zero());
+		for(auto it = testSpline.getAbsoluteBegin(); it != testSpline.getAbsoluteEnd(); ++it) it->setControlVertex(Eigen::Vector3d::Random());
+		for(size_t i = 0; i < testSpline.numDesignVariables(); ++i) {
+			testSpline.designVariable(i)->setActive(true);
+			testSpline.designVariable(i)->setBlockIndex(i);
+		}
+
+		OPTBSplineMotionError<TestSpline> e(&testSpline, Eigen::Vector3d(1, 2, 3));
+		ASSERT_EQ(numberOfSegments, (int)e.numberOfSegments());
+
+		// every segment's Jacobians cover its four design variables with 4 * 3 rows each
+		for(size_t s = 0; s < e.numberOfSegments(); ++s) {
+			SCOPED_TRACE(s);
+			const SegmentQuadraticFormError::Ptr & segmentError = e.segmentError(s);
+			ASSERT_EQ(12u, segmentError->dimension());
+			ASSERT_EQ(4u, segmentError->numDesignVariables());
+
+			JacobianContainerSparse<> J(segmentError->dimension());
+			segmentError->evaluateJacobians(J);
+			ASSERT_EQ(4u, J.numDesignVariables());
+			for(size_t i = 0; i < J.numDesignVariables(); ++i) {
+				EXPECT_EQ(testSpline.designVariable(s + i), J.designVariable(i));
+			}
+			sm::eigen::assertNear(J.asDenseMatrix(), segmentError->sqrtQ(), 1e-12, SM_SOURCE_FILE_POS);
+		}
+	}
+	catch(const std::exception & e)
+	{
+		FAIL() << e.what();
+	}
+}
+
+TEST(OPTBSplineTestSuite, testQuadraticIntegralSegmentErrorsMatchPerPointErrors)
+{
+	try {
+		typedef OPTBSpline<EuclideanBSpline<4, 3>::CONF>::BSpline TestSpline;
+		TestSpline testSpline;
+		testSpline.initConstantUniformSpline(0, 5, 7, Eigen::Vector3d::Zero());
+		for(auto it = testSpline.getAbsoluteBegin(); it != testSpline.getAbsoluteEnd(); ++it) it->setControlVertex(Eigen::Vector3d::Random());
+		for(size_t i = 0; i < testSpline.numDesignVariables(); ++i) {
+			testSpline.designVariable(i)->setActive(true);
+			testSpline.designVariable(i)->setBlockIndex(i);
+		}
+
+		auto velocityFactory = [&testSpline](double t) { return testSpline.getExpressionFactoryAt<1>(t).getValueExpression(1); };
+		const Eigen::Matrix3d sqrtInvR = Eigen::Vector3d(1, 2, 3).asDiagonal();
+		const auto algorithm = integration::createKnotAlignedAlgorithm(testSpline);
+		const double a = 0.3, b = 4.6;
+		const int numberOfPoints = 3;
+
+		ErrorTermCollector perPoint, perSegment;
+		integration::addQuadraticIntegralExpressionErrorTerms(algorithm, perPoint, a, b, numberOfPoints, velocityFactory, sqrtInvR);
+		integration::addQuadraticIntegralExpressionSegmentErrorTerms(algorithm, perSegment, a, b, numberOfPoints, velocityFactory, sqrtInvR);
+
+		ASSERT_EQ(7u, perSegment.errorTerms.size());
+		ASSERT_EQ(7u * numberOfPoints, perPoint.errorTerms.size());
+		EXPECT_NEAR(perPoint.evaluateError(), perSegment.evaluateError(), perPoint.evaluateError() * 1E-12);
+
+		// the stacked residual of all points of a segment
+		ErrorTerm & e = *perSegment.errorTerms[3];
+		ASSERT_EQ(3u * numberOfPoints, e.dimension());
+		JacobianContainerSparse<> estJ(e.dimension());
+		e.evaluateJacobiansFiniteDifference(estJ);
+		JacobianContainerSparse<> J(e.dimension());
+		e.evaluateJacobians(J);
+		sm::eigen::assertNear(J.asDenseMatrix(), estJ.asDenseMatrix(), 1e-6, SM_SOURCE_FILE_POS, "Checking the jacobian vs. finite differences");
+
+#ifdef SPEEDMEASURE
+		// problem construction and Hessian assembly of the per point and the per segment terms on a long spline
+		TestSpline longSpline;
+		const int numberOfSegments = 1000;
+		longSpline.initConstantUniformSpline(0, numberOfSegments, numberOfSegments, Eigen::Vector3d::Zero());
+		for(auto it = longSpline.getAbsoluteBegin(); it != longSpline.getAbsoluteEnd(); ++it) it->setControlVertex(Eigen::Vector3d::Random());
+		std::vector<int> blocks;
+		for(size_t i = 0; i < longSpline.numDesignVariables(); ++i) {
+			longSpline.designVariable(i)->setActive(true);
+			longSpline.designVariable(i)->setBlockIndex(i);
+			blocks.push_back(3 * (i + 1));
+		}
+		auto longVelocityFactory = [&longSpline](double t) { return longSpline.getExpressionFactoryAt<1>(t).getValueExpression(1); };
+		const auto longAlgorithm = integration::createKnotAlignedAlgorithm(longSpline);
+		auto buildHessian = [&blocks](const ErrorTermCollector & errorTerms) {
+			SparseBlockMatrix H(blocks, blocks, true);
+			Eigen::VectorXd rhs = Eigen::VectorXd::Zero(blocks.back());
+			for(auto & et : errorTerms.errorTerms) et->buildHessian(H, rhs, false);
+		};
+		for(int j = 0; j < 10; j++) {
+			{
+				sm::timing::Timer timer("QuadraticIntegral: add per point terms");
+				ErrorTermCollector longPerPoint;
+				integration::addQuadraticIntegralExpressionErrorTerms(longAlgorithm, longPerPoint, 0.0, double(numberOfSegments), numberOfPoints, longVelocityFactory, sqrtInvR);
+				timer.stop();
+				sm::timing::Timer hessianTimer("QuadraticIntegral: build Hessian of per point terms");
+				buildHessian(longPerPoint);
+				hessianTimer.stop();
+			}
+			{
+				sm::timing::Timer timer("QuadraticIntegral: add per segment terms");
+				ErrorTermCollector longPerSegment;
+				integration::addQuadraticIntegralExpressionSegmentErrorTerms(longAlgorithm, longPerSegment, 0.0, double(numberOfSegments), numberOfPoints, longVelocityFactory, sqrtInvR);
+				timer.stop();
+				sm::timing::Timer hessianTimer("QuadraticIntegral: build Hessian of per segment terms");
+				buildHessian(longPerSegment);
+				hessianTimer.stop();
+			}
+		}
+		sm::timing::Timing::print(std::cout);
+#endif
+	}
+	catch(const std::exception & e)
+	{
+		FAIL() << e.what();
+	}
+}
+
+TEST(OPTBSplineTestSuite, testParallelQuadraticIntegralErrorTermsMatchSerialOnes)
+{
+	try {
+		typedef OPTBSpline<EuclideanBSpline<4, 3>::CONF>::BSpline TestSpline;
+		TestSpline testSpline;
+		testSpline.initConstantUniformSpline(0, 5, 7, Eigen::Vector3d::Zero());
+		for(auto it = testSpline.getAbsoluteBegin(); it != testSpline.getAbsoluteEnd(); ++it) it->setControlVertex(Eigen::Vector3d::Random());
+
+		auto velocityFactory = [&testSpline](double t) { return testSpline.getExpressionFactoryAt<1>(t).getValueExpression(1); };
+		const Eigen::Matrix3d sqrtInvR = Eigen::Matrix3d::Identity();
+		const auto algorithm = integration::createKnotAlignedAlgorithm(testSpline);
+
+		ErrorTermCollector serial, parallel;
+		integration::addQuadraticIntegralExpressionErrorTerms(algorithm, serial, 0.3, 4.6, 3, velocityFactory, sqrtInvR);
+		integration::addQuadraticIntegralExpressionErrorTermsInParallel(algorithm, parallel, 0.3, 4.6, 3, velocityFactory, sqrtInvR, 4);
+
+		ASSERT_EQ(serial.errorTerms.size(), parallel.errorTerms.size());
+		for(size_t i = 0; i < serial.errorTerms.size(); ++i) {
+			EXPECT_EQ(serial.errorTerms[i]->evaluateError(), parallel.errorTerms[i]->evaluateError());
+		}
+	}
+	catch(const std::exception & e)
+	{
+		FAIL() << e.what();
+	}
+}
+
+struct CountedTerm {
+	static std::atomic<int> alive;
+	CountedTerm() { alive++; }
+	~CountedTerm() { alive--; }
+};
+std::atomic<int> CountedTerm::alive(0);
+
+struct CountedTermCollector {
+	std::vector<boost::shared_ptr<CountedTerm> > errorTerms;
+	void addErrorTerm(const boost::shared_ptr<CountedTerm> & et) { errorTerms.push_back(et); }
+};
+
+TEST(OPTBSplineTestSuite, testParallelQuadraticIntegralErrorTermsDoNotLeakOnThrow)
+{
+	const double a = 0, b = 1, failingTime = 0.8;
+	CountedTermCollector problem;
+	EXPECT_THROW(integration::addQuadraticIntegralErrorTermsInParallel<integration::algorithms::SimpsonRule>(problem, a, b, 101, [failingTime](double t, double /* factor */) -> CountedTerm * {
+		if(std::fabs(t - failingTime) < 1E-9) throw std::runtime_error("factory failure");
+		return new CountedTerm();
+	}, 4), std::runtime_error);
+	EXPECT_TRUE(problem.errorTerms.empty());
+	EXPECT_EQ(0, CountedTerm::alive.load());
+}
+
+template <int IComponent, typename TSpline>
+void testCompositeComponentExpressions(TSpline & testSpline, const double t){
+	auto fact = testSpline.template getExpressionFactoryAt<2>(t);
+	auto eval = testSpline.template getEvaluatorAt<2>(t);
+
+	ASSERT_EQ(testSpline.getDesignVariables().size(), testSpline.template getEuclideanDesignVariables<IComponent>().size());
+	std::vector<DesignVariable *> dvs = testSpline.template getEuclideanDesignVariables<IComponent>(t);
+	for(size_t i = 0; i < dvs.size(); i++){
+		dvs[i]->setActive(true);
+		dvs[i]->setBlockIndex(i);
+	}
+
+	for(int derivativeOrder = 0; derivativeOrder <= 1; derivativeOrder++){
+		auto expression = fact.template getEuclideanValueExpression<IComponent>(derivativeOrder);
+		sm::eigen::assertEqual(eval.template evalEuclideanD<IComponent>(derivativeOrder), expression.evaluate(), SM_SOURCE_FILE_POS);
+
+		DesignVariable::set_t set;
+		expression.getDesignVariables(set);
+		ASSERT_EQ(dvs.size(), set.size());
+
+		JacobianContainerSparse<> jac(TSpline::template EuclideanComponent<IComponent>::Dimension);
+		expression.evaluateJacobians(jac);
+		typename TSpline::template EuclideanComponent<IComponent>::jacobian_t J;
+		eval.template evalEuclideanJacobian<IComponent>(derivativeOrder, J);
+		sm::eigen::assertEqual(J, jac.asDenseMatrix(), SM_SOURCE_FILE_POS);
+		{
+			SCOPED_TRACE("");
+			testExpression(expression, testSpline.getSplineOrder());
+		}
+	}
+	for(size_t i = 0; i < dvs.size(); i++){
+		dvs[i]->setActive(false);
+	}
+}
+
+TEST(OPTBSplineTestSuite, testCompositeSplineExpressions)
+{
+	try {
+		typedef OPTBSpline<CompositeBSplineConfiguration<UnitQuaternionBSpline<4>::CONF, 3, 1> >::BSpline TestSpline;
+		TestSpline testSpline;
+		testSpline.initConstantUniformSpline(0, 10, 5, quatRandom());
+		for(auto & i : testSpline){
+			testSpline.getManifold().randomizePoint(i.getControlVertex());
+			i.getEuclideanControlVertex<0>().setRandom();
+			i.getEuclideanControlVertex<1>().setRandom();
+		}
+
+		const double t = 4.2;
+		testCompositeComponentExpressions<0>(testSpline, t);
+		testCompositeComponentExpressions<1>(testSpline, t);
+
+		auto fact = testSpline.getExpressionFactoryAt<2>(t);
+		auto eval = testSpline.getEvaluatorAt<2>(t);
+		sm::eigen::assertEqual(eval.evalD(1), fact.getValueExpression(1).evaluate(), SM_SOURCE_FILE_POS);
+		sm::eigen::assertEqual(eval.evalAngularVelocity(), fact.getAngularVelocityExpression().evaluate(), SM_SOURCE_FILE_POS);
+
+		// the design variables of all components get added
+		OptimizationProblem problem;
+		testSpline.addDesignVariables(problem);
+		EXPECT_EQ(3 * testSpline.getDesignVariables().size(), problem.numDesignVariables());
+	}
+	catch(const std::exception & e)
+	{
+		FAIL() << e.what();
+	}
+}
+
 #endif
 
 #ifndef NO_T2
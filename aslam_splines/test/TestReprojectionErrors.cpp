@@ -0,0 +1,254 @@
+#include <sm/eigen/gtest.hpp>
+#include <sm/kinematics/RotationVector.hpp>
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <aslam/cameras.hpp>
+#include <aslam/Frame.hpp>
+#include <aslam/backend/JacobianContainerSparse.hpp>
+#include <aslam/backend/HomogeneousPoint.hpp>
+#include <aslam/backend/MEstimatorPolicies.hpp>
+#include <aslam/backend/CovarianceReprojectionError.hpp>
+#include <aslam/backend/BSplineRSFrameReprojectionError.hpp>
+#include <bsplines/BSplinePose.hpp>
+#include "DenseNormalEquations.hpp"
+
+
+using namespace bsplines;
+using namespace aslam::splines;
+
+typedef aslam::cameras::DistortedPinholeRsCameraGeometry camera_geometry_t;
+typedef aslam::Frame<camera_geometry_t> frame_t;
+typedef frame_t::keypoint_t keypoint_t;
+
+BSplinePose generateRandomPoseSpline()
+{
+    BSplinePose bsp(4, boost::make_shared<sm::kinematics::RotationVector>());
+    const int N = 10;
+    Eigen::VectorXd times(N);
+    for(int i = 0; i < N; ++i)
+        times(i) = i;
+
+    Eigen::Matrix<double, 6, Eigen::Dynamic> poses(6, N);
+    poses.setRandom();
+    poses *= 0.2;
+
+    bsp.initPoseSpline3(times, poses, 6, 1e-4);
+    return bsp;
+}
+
+/// the keypoint measured near the projection of p with a correlated covariance
+keypoint_t createKeypoint(const camera_geometry_t & geometry, const Eigen::Vector4d & p)
+{
+    keypoint_t::measurement_t y;
+    geometry.homogeneousToKeypoint(p, y);
+    keypoint_t k;
+    k.setMeasurement(y + keypoint_t::measurement_t(0.7, -1.3));
+    Eigen::Matrix2d invR;
+    invR << 2.0, 0.3, 0.3, 1.0;
+    k.setInverseMeasurementCovariance(invR);
+    return k;
+}
+
+/// the covariance's mixing matrix as computed with dynamically sized types before the fixed size rewrite
+Eigen::MatrixXd dynamicCovarianceMatrix(const BSplinePose & spline, const camera_geometry_t & geometry, const Eigen::Vector4d & p, double observationTime, double lineDelay)
+{
+    Eigen::Vector2d hat_y;
+    Eigen::Matrix<double, 2, 4> outJp;
+    geometry.homogeneousToKeypoint(p, hat_y, outJp);
+
+    Eigen::VectorXd splinePoint = spline.evalD(observationTime, 0);
+    Eigen::MatrixXd JT;
+    Eigen::VectorXd Phi_dot_c = spline.evalD(observationTime, 1);
+    Eigen::MatrixXd T = spline.curveValueToTransformationAndJacobian(splinePoint, &JT);
+    Eigen::MatrixXd TPboxminus = sm::kinematics::boxMinus(Eigen::Vector4d(T * p));
+
+    Eigen::MatrixXd J = outJp * TPboxminus * JT * Phi_dot_c * lineDelay;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(2, 2);
+    A(0,1) += J(0);
+    A(1,1) += J(1);
+    return A;
+}
+
+
+TEST(ReprojectionErrorTestSuite, testCovarianceReprojectionErrorMatchesDynamicFormulation)
+{
+    try
+    {
+        using namespace aslam::backend;
+        boost::shared_ptr<camera_geometry_t> geometry = boost::make_shared<camera_geometry_t>(camera_geometry_t::getTestGeometry());
+        CameraDesignVariable<camera_geometry_t> camera(geometry);
+        camera.setActive(false, false, false);
+
+        frame_t frame;
+        frame.setGeometry(geometry);
+        frame.setTime(aslam::Time(3.0));
+
+        BSplinePoseDesignVariable spline(generateRandomPoseSpline());
+        Scalar lineDelayDv(1e-3);
+
+        const Eigen::Vector4d points[] = { Eigen::Vector4d(0.1, -0.2, 2.0, 1.0), Eigen::Vector4d(-0.5, 0.4, 3.0, 1.0), Eigen::Vector4d(0.3, 0.6, 1.5, 1.0) };
+        for(const Eigen::Vector4d & p : points)
+        {
+            frame.addKeypoint(createKeypoint(*geometry, p));
+            const int keypointIndex = frame.numKeypoints() - 1;
+            const keypoint_t & k = frame.keypoint(keypointIndex);
+
+            HomogeneousPoint point(p);
+            point.setActive(true);
+            point.setBlockIndex(0);
+
+            // with the line delay design variable and with the camera's shutter
+            for(Scalar * lineDelay : { &lineDelayDv, (Scalar *) NULL })
+            {
+                SCOPED_TRACE(lineDelay ? "line delay design variable" : "camera line delay");
+                CovarianceReprojectionError<frame_t> e(&frame, keypointIndex, point.toExpression(), camera, &spline, lineDelay);
+                const double lineDelayValue = lineDelay ? lineDelay->toScalar() : geometry->shutter().lineDelay();
+
+                const Eigen::MatrixXd A = dynamicCovarianceMatrix(spline.spline(), *geometry, p, e.observationTime(), lineDelayValue);
+                sm::eigen::assertNear(e.covarianceMatrix(), A, 1e-12, SM_SOURCE_FILE_POS, "Checking the covariance against the dynamic formulation");
+
+                const double squaredError = e.evaluateError();
+                const Eigen::MatrixXd invR = (A * k.invR().inverse() * A.transpose()).inverse();
+                sm::eigen::assertNear(e.invR(), invR, 1e-9, SM_SOURCE_FILE_POS, "Checking the inverse covariance against the dynamic formulation");
+                EXPECT_NEAR(e.error().dot(invR * e.error()), squaredError, 1e-9 * squaredError);
+
+                JacobianContainerSparse<> estJ(e.dimension());
+                e.evaluateJacobiansFiniteDifference(estJ);
+                JacobianContainerSparse<> J(e.dimension());
+                e.evaluateJacobians(J);
+                sm::eigen::assertNear(J.asDenseMatrix(), estJ.asDenseMatrix(), 1e-6, SM_SOURCE_FILE_POS, "Checking the jacobian vs. finite differences");
+            }
+        }
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
+
+
+TEST(ReprojectionErrorTestSuite, testBSplineRSFrameReprojectionError)
+{
+    try
+    {
+        using namespace aslam::backend;
+        boost::shared_ptr<camera_geometry_t> geometry = boost::make_shared<camera_geometry_t>(camera_geometry_t::getTestGeometry());
+        CameraDesignVariable<camera_geometry_t> camera(geometry);
+        camera.setActive(false, false, false);
+
+        frame_t frame;
+        frame.setGeometry(geometry);
+        frame.setTime(aslam::Time(3.0));
+
+        BSplineRSPoseDesignVariable spline(generateRandomPoseSpline(), 1e-3);
+
+        std::vector<int> keypointIndices;
+        std::vector<boost::shared_ptr<HomogeneousPoint> > keypointPoints;
+        const int K = 5;
+        for(int k = 0; k < K; ++k)
+        {
+            keypointPoints.push_back(boost::make_shared<HomogeneousPoint>(Eigen::Vector4d(0.3 * k - 0.6, 0.1 * k - 0.2, 2.0 + 0.2 * k, 1.0)));
+            keypoint_t keypoint = createKeypoint(*geometry, keypointPoints.back()->toHomogeneous());
+            if(k == 1)
+            {
+                // observed in the same line as keypoint 0
+                keypoint_t::measurement_t y = keypoint.y();
+                y(1) = frame.keypoint(0).y()(1);
+                keypoint.setMeasurement(y);
+            }
+            frame.addKeypoint(keypoint);
+            keypointIndices.push_back(K - 1 - k);
+        }
+        std::reverse(keypointPoints.begin(), keypointPoints.end());
+        std::vector<HomogeneousExpression> points;
+        for(int k = 0; k < K; ++k)
+        {
+            points.push_back(keypointPoints[k]->toExpression());
+        }
+
+        BSplineRSFrameReprojectionError<frame_t> e(&frame, keypointIndices, points, camera, &spline);
+        ASSERT_EQ(2 * K, (int)e.dimension());
+        EXPECT_EQ(K - 1, (int)e.numberOfObservationLines());
+
+        // the frame's design variables (control vertices, line delay, points and the camera's projection) get the block indices 0, 1, ...
+        for(size_t i = 0; i < spline.numDesignVariables(); ++i)
+        {
+            spline.designVariable(i)->setActive(false);
+        }
+        std::vector<DesignVariable *> dvs;
+        for(size_t i = 0; i < e.numDesignVariables(); ++i)
+        {
+            dvs.push_back(e.designVariable(i));
+            dvs.back()->setActive(true);
+            dvs.back()->setBlockIndex(i);
+        }
+        camera.setActive(true, false, false);
+
+        const double squaredError = e.evaluateError();
+        EXPECT_NEAR(e.error().squaredNorm(), squaredError, 1e-12);
+
+        // the Jacobians with respect to all of the frame's design variables
+        JacobianContainerSparse<> estJ(e.dimension());
+        e.evaluateJacobiansFiniteDifference(estJ);
+        JacobianContainerSparse<> J(e.dimension());
+        e.evaluateJacobians(J);
+        SCOPED_TRACE("");
+        sm::eigen::assertNear(J.asDenseMatrix(), estJ.asDenseMatrix(), 1e-6, SM_SOURCE_FILE_POS, "Checking the jacobian vs. finite differences");
+
+        // the Gauss-Newton normal equations J^T J and -J^T e
+        std::vector<BSplineRSFrameReprojectionError<frame_t> *> frameErrors(1, &e);
+        Eigen::MatrixXd H;
+        Eigen::VectorXd rhs;
+        buildDenseNormalEquations(frameErrors, dvs, false, H, rhs);
+        const Eigen::MatrixXd Jd = J.asDenseMatrix();
+        sm::eigen::assertNear(upperTriangle(H), upperTriangle(Jd.transpose() * Jd), 1e-9, SM_SOURCE_FILE_POS, "Checking the Hessian against J^T J");
+        sm::eigen::assertNear(rhs, -Jd.transpose() * e.error(), 1e-9, SM_SOURCE_FILE_POS, "Checking the rhs against -J^T e");
+
+        // the keypoints' reprojection errors with the same transformation expression, point and camera, weighted and stacked
+        std::vector<boost::shared_ptr<CovarianceReprojectionError<frame_t> > > keypointErrors;
+        JacobianContainerSparse<> stackedJ(e.dimension());
+        double keypointsSquaredError = 0;
+        for(int k = 0; k < K; ++k)
+        {
+            const int keypointIndex = keypointIndices[k];
+            HomogeneousExpression point = spline.transformation(frame.keypointTime(keypointIndex).toSec(), frame.keypoint(keypointIndex).y()(1)) * points[k];
+            keypointErrors.push_back(boost::make_shared<CovarianceReprojectionError<frame_t> >(&frame, keypointIndex, point, camera));
+            keypointErrors.back()->setInvR(frame.keypoint(keypointIndex).invR());
+            keypointsSquaredError += keypointErrors.back()->evaluateError();
+
+            const Eigen::Matrix2d sqrtInvR = frame.keypoint(keypointIndex).invR().llt().matrixU();
+            sm::eigen::assertNear(e.error().segment<2>(2 * k), sqrtInvR * keypointErrors.back()->error(), 1e-9, SM_SOURCE_FILE_POS, "Checking the residual against the keypoint's one");
+
+            JacobianContainerSparse<> keypointJ(2);
+            keypointErrors.back()->evaluateJacobians(keypointJ);
+            for(auto it = keypointJ.begin(); it != keypointJ.end(); ++it)
+            {
+                Eigen::MatrixXd stackedBlock = Eigen::MatrixXd::Zero(e.dimension(), it->second.cols());
+                stackedBlock.middleRows(2 * k, 2) = sqrtInvR * it->second;
+                stackedJ.add(it->first, stackedBlock);
+            }
+        }
+        EXPECT_NEAR(keypointsSquaredError, squaredError, 1e-9 * squaredError);
+        sm::eigen::assertNear(Jd, stackedJ.asDenseMatrix(), 1e-9, SM_SOURCE_FILE_POS, "Checking the jacobian against the stacked keypoints' ones");
+
+        Eigen::MatrixXd keypointsH;
+        Eigen::VectorXd keypointsRhs;
+        buildDenseNormalEquations(keypointErrors, dvs, false, keypointsH, keypointsRhs);
+        sm::eigen::assertNear(upperTriangle(H), upperTriangle(keypointsH), 1e-9, SM_SOURCE_FILE_POS, "Checking the Hessian against the keypoints' reprojection errors");
+        sm::eigen::assertNear(rhs, keypointsRhs, 1e-9, SM_SOURCE_FILE_POS, "Checking the rhs against the keypoints' reprojection errors");
+
+        // the M-estimator weight of the frame's squared error scales the whole contribution
+        boost::shared_ptr<MEstimator> mEstimator = boost::make_shared<CauchyMEstimator>(1.0);
+        e.setMEstimatorPolicy(mEstimator);
+        const double weight = mEstimator->getWeight(squaredError);
+        Eigen::MatrixXd weightedH;
+        Eigen::VectorXd weightedRhs;
+        buildDenseNormalEquations(frameErrors, dvs, true, weightedH, weightedRhs);
+        sm::eigen::assertNear(upperTriangle(weightedH), weight * upperTriangle(H), 1e-9, SM_SOURCE_FILE_POS, "Checking the M-estimator weighted Hessian");
+        sm::eigen::assertNear(weightedRhs, weight * rhs, 1e-9, SM_SOURCE_FILE_POS, "Checking the M-estimator weighted rhs");
+    }
+    catch(const std::exception & e)
+    {
+        FAIL() << e.what();
+    }
+}
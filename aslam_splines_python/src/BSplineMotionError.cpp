@@ -13,6 +13,23 @@
 using namespace boost::python;
 using namespace aslam::backend;
 
+template<class SplineDv>
+void exportMotionError(const char * name, const char * initDoc, const char * initOrderDoc)
+{
+  typedef BSplineMotionError<SplineDv> motion_error_t;
+  class_<motion_error_t, boost::shared_ptr<motion_error_t>, boost::noncopyable>(name, init<SplineDv*, Eigen::MatrixXd >(initDoc))
+    .def(init<SplineDv*, Eigen::MatrixXd, unsigned int >(initOrderDoc))
+    .def("numberOfSegments", &motion_error_t::numberOfSegments)
+    .def("segmentError", &motion_error_t::segmentError, return_value_policy<copy_const_reference>())
+    .def("addErrorTerms", &motion_error_t::template addErrorTerms<OptimizationProblem>, "void addErrorTerms(OptimizationProblem): adds every segment's error term")
+    .def("handleAppendedSegment", &motion_error_t::handleAppendedSegment)
+    .def("handleRemovedFrontSegment", &motion_error_t::handleRemovedFrontSegment)
+    .def("evaluateError", &motion_error_t::evaluateError)
+    .def("Q", &motion_error_t::Q)
+    .def("rhs", &motion_error_t::rhs)
+    ;
+}
+
 void exportBSplineMotionError()
 {
 
@@ -23,37 +40,16 @@ void exportBSplineMotionError()
   def("addMotionErrorTerms", &addMotionErrorTerms<aslam::splines::BSplineDesignVariable<3> >, "void addMotionErrorTerms( OptimizationProblemBase, SplineDv, W, errorTermOrder)");
 
 
-    class_<BSplineMotionError<aslam::splines::EuclideanBSplineDesignVariable>, boost::shared_ptr<BSplineMotionError<aslam::splines::EuclideanBSplineDesignVariable> >, bases<ErrorTerm> >
-        ("BSplineEuclideanMotionError", init<aslam::splines::EuclideanBSplineDesignVariable*, Eigen::MatrixXd >("BSplineEuclideanMotionError(EuclideanBSplineDesignVariable, W)"))
-         .def(init<aslam::splines::EuclideanBSplineDesignVariable*, Eigen::MatrixXd, unsigned int >("BSplineGenericMotionError(EuclideanBSplineDesignVariable, W, errorTermOrder)"))
-         ;
-    using namespace aslam::splines;
-    class_<BSplineMotionError< BSplineDesignVariable<1> >, boost::shared_ptr<BSplineMotionError< BSplineDesignVariable<1> > >, bases<ErrorTerm> >
-        ("BSpline1MotionError", init<BSplineDesignVariable<1> *, Eigen::MatrixXd >("BSpline1MotionError(BSpline1DesignVariable, W)"))
-         .def(init<aslam::splines::BSplineDesignVariable<1>*, Eigen::MatrixXd, unsigned int >("BSpline1MotionError(BSpline1DesignVariable, W, errorTermOrder)"))
-         ;
-    class_<BSplineMotionError< BSplineDesignVariable<2> >, boost::shared_ptr<BSplineMotionError< BSplineDesignVariable<2> > >, bases<ErrorTerm> >
-        ("BSpline2MotionError", init<BSplineDesignVariable<2> *, Eigen::MatrixXd >("BSpline2MotionError(BSpline2DesignVariable, W)"))
-         .def(init<aslam::splines::BSplineDesignVariable<2>*, Eigen::MatrixXd, unsigned int >("BSpline2MotionError(BSpline2DesignVariable, W, errorTermOrder)"))
+    class_<SegmentQuadraticFormError, SegmentQuadraticFormError::Ptr, bases<ErrorTerm>, boost::noncopyable>("SegmentQuadraticFormError", no_init)
+         .def("sqrtQ", &SegmentQuadraticFormError::sqrtQ, return_value_policy<copy_const_reference>())
+         .def("Q", &SegmentQuadraticFormError::Q)
          ;
 
-    class_<BSplineMotionError< BSplineDesignVariable<3> >, boost::shared_ptr<BSplineMotionError< BSplineDesignVariable<3> > >, bases<ErrorTerm> >
-        ("BSpline3MotionError", init<BSplineDesignVariable<3> *, Eigen::MatrixXd >("BSpline3MotionError(BSpline3DesignVariable, W)"))
-         .def(init<aslam::splines::BSplineDesignVariable<3>*, Eigen::MatrixXd, unsigned int >("BSpline3MotionError(BSpline3DesignVariable, W, errorTermOrder)"))
-         ;
-
-
-
-  
-    class_<BSplineMotionError<aslam::splines::BSplinePoseDesignVariable>, boost::shared_ptr<BSplineMotionError<aslam::splines::BSplinePoseDesignVariable> >, bases<ErrorTerm> >
-        ("BSplineMotionError", init<aslam::splines::BSplinePoseDesignVariable*, Eigen::MatrixXd >("BSplineMotionError(BSplinePoseDesignVariable, W)"))
-         .def(init<aslam::splines::BSplinePoseDesignVariable*, Eigen::MatrixXd, unsigned int >("BSplineMotionError(BSplinePoseDesignVariable, W, errorTermOrder)"))
-         ;
-
-    class_<BSplineMotionError<aslam::splines::BSplineRSPoseDesignVariable>, boost::shared_ptr<BSplineMotionError<aslam::splines::BSplineRSPoseDesignVariable> >, bases<ErrorTerm> >
-    ("BSplineRSMotionError", init<aslam::splines::BSplineRSPoseDesignVariable*, Eigen::MatrixXd >("BSplineRSMotionError(BSplinePoseDesignVariable, W)"))
-     .def(init<aslam::splines::BSplineRSPoseDesignVariable*, Eigen::MatrixXd, unsigned int >("BSplineRSMotionError(BSplinePoseDesignVariable, W, errorTermOrder)"))
-    ;
-    
-    
+    using namespace aslam::splines;
+    exportMotionError<EuclideanBSplineDesignVariable>("BSplineEuclideanMotionError", "BSplineEuclideanMotionError(EuclideanBSplineDesignVariable, W)", "BSplineGenericMotionError(EuclideanBSplineDesignVariable, W, errorTermOrder)");
+    exportMotionError<BSplineDesignVariable<1> >("BSpline1MotionError", "BSpline1MotionError(BSpline1DesignVariable, W)", "BSpline1MotionError(BSpline1DesignVariable, W, errorTermOrder)");
+    exportMotionError<BSplineDesignVariable<2> >("BSpline2MotionError", "BSpline2MotionError(BSpline2DesignVariable, W)", "BSpline2MotionError(BSpline2DesignVariable, W, errorTermOrder)");
+    exportMotionError<BSplineDesignVariable<3> >("BSpline3MotionError", "BSpline3MotionError(BSpline3DesignVariable, W)", "BSpline3MotionError(BSpline3DesignVariable, W, errorTermOrder)");
+    exportMotionError<BSplinePoseDesignVariable>("BSplineMotionError", "BSplineMotionError(BSplinePoseDesignVariable, W)", "BSplineMotionError(BSplinePoseDesignVariable, W, errorTermOrder)");
+    exportMotionError<BSplineRSPoseDesignVariable>("BSplineRSMotionError", "BSplineRSMotionError(BSplinePoseDesignVariable, W)", "BSplineRSMotionError(BSplinePoseDesignVariable, W, errorTermOrder)");
 }
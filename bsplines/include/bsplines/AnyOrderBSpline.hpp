@@ -0,0 +1,281 @@
+/*
+ * AnyOrderBSpline.hpp
+ *
+ *  Maps a spline order only known at runtime onto the fixed order spline instantiations,
+ *  such that runtime configured splines get the fixed size (heap allocation free) evaluators.
+ */
+
+#ifndef ANYORDERBSPLINE_HPP_
+#define ANYORDERBSPLINE_HPP_
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "EuclideanBSpline.hpp"
+#include "UnitQuaternionBSpline.hpp"
+
+namespace bsplines {
+
+	enum {
+		MinDispatchedSplineOrder = 2,
+		MaxDispatchedSplineOrder = 8
+	};
+
+	namespace internal {
+		template <template <int> class TFunctor, int ISplineOrder, int IMaxSplineOrder>
+		struct SplineOrderDispatcher {
+			template <typename ... TArgs>
+			inline static auto dispatch(int splineOrder, TArgs && ... args) -> decltype(TFunctor<ISplineOrder>::apply(std::forward<TArgs>(args)...)) {
+				if(splineOrder == ISplineOrder) return TFunctor<ISplineOrder>::apply(std::forward<TArgs>(args)...);
+				return SplineOrderDispatcher<TFunctor, ISplineOrder + 1, IMaxSplineOrder>::dispatch(splineOrder, std::forward<TArgs>(args)...);
+			}
+		};
+
+		template <template <int> class TFunctor, int IMaxSplineOrder>
+		struct SplineOrderDispatcher<TFunctor, IMaxSplineOrder, IMaxSplineOrder> {
+			template <typename ... TArgs>
+			inline static auto dispatch(int splineOrder, TArgs && ... args) -> decltype(TFunctor<IMaxSplineOrder>::apply(std::forward<TArgs>(args)...)) {
+				SM_ASSERT_EQ(std::runtime_error, splineOrder, (int) IMaxSplineOrder, "spline order " << splineOrder << " is not in the dispatched range [" << (int) MinDispatchedSplineOrder << ", " << (int) MaxDispatchedSplineOrder << "]");
+				return TFunctor<IMaxSplineOrder>::apply(std::forward<TArgs>(args)...);
+			}
+		};
+	}
+
+	/**
+	 * Calls TFunctor<splineOrder>::apply(args...) for a runtime splineOrder in [MinDispatchedSplineOrder, MaxDispatchedSplineOrder].
+	 * All instantiations of apply must have the same return type.
+	 */
+	template <template <int> class TFunctor, typename ... TArgs>
+	inline auto dispatchSplineOrder(int splineOrder, TArgs && ... args) -> decltype(TFunctor<MinDispatchedSplineOrder>::apply(std::forward<TArgs>(args)...)) {
+		return internal::SplineOrderDispatcher<TFunctor, MinDispatchedSplineOrder, MaxDispatchedSplineOrder>::dispatch(splineOrder, std::forward<TArgs>(args)...);
+	}
+
+	/**
+	 * A spline family provides the fixed order spline types (Spline<ISplineOrder>) together with the runtime parameters needed to create them.
+	 */
+	template <int IDimension = Eigen::Dynamic, typename TTimePolicy = DefaultTimePolicy>
+	struct EuclideanBSplineFamily {
+		template <int ISplineOrder>
+		using Spline = EuclideanBSpline<ISplineOrder, IDimension, TTimePolicy>;
+
+		EuclideanBSplineFamily(int dimension = IDimension) : _dimension(dimension) {}
+
+		template <int ISplineOrder>
+		inline Spline<ISplineOrder> create() const { return Spline<ISplineOrder>(ISplineOrder, _dimension); }
+	private:
+		int _dimension;
+	};
+
+	template <typename TTimePolicy = DefaultTimePolicy>
+	struct UnitQuaternionBSplineFamily {
+		template <int ISplineOrder>
+		using Spline = UnitQuaternionBSpline<ISplineOrder, TTimePolicy>;
+
+		template <int ISplineOrder>
+		inline Spline<ISplineOrder> create() const { return Spline<ISplineOrder>(ISplineOrder); }
+	};
+
+	/**
+	 * Type erased handle to a spline of the given family with a spline order chosen at runtime.
+	 * Use visit to run code on the concrete fixed order spline, or the convenience methods below, which pay one dispatch per call.
+	 */
+	template <typename TSplineFamily>
+	class AnyOrderBSpline {
+	 public:
+		typedef TSplineFamily family_t;
+		typedef typename family_t::template Spline<MinDispatchedSplineOrder> min_order_spline_t;
+		typedef typename min_order_spline_t::point_t point_t;
+		typedef typename min_order_spline_t::time_t time_t;
+
+	 private:
+		struct HolderBase {
+			virtual ~HolderBase() {}
+			virtual HolderBase * clone() const = 0;
+		};
+
+		template <int ISplineOrder>
+		struct Holder : public HolderBase {
+			EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+			typedef typename family_t::template Spline<ISplineOrder> spline_t;
+			spline_t spline;
+			Holder(const spline_t & spline) : spline(spline) {}
+			virtual HolderBase * clone() const { return new Holder(spline); }
+		};
+
+		template <int ISplineOrder>
+		struct HolderCreator {
+			inline static HolderBase * apply(const family_t & family) { return new Holder<ISplineOrder>(family.template create<ISplineOrder>()); }
+		};
+
+		template <int ISplineOrder>
+		struct VisitorApplier {
+			template <typename THolderBase>
+			using holder_t = typename std::conditional<std::is_const<THolderBase>::value, const Holder<ISplineOrder>, Holder<ISplineOrder> >::type;
+
+			template <typename THolderBase, typename TVisitor>
+			inline static auto apply(THolderBase & holder, TVisitor && visitor) -> decltype(visitor(static_cast<holder_t<THolderBase> &>(holder).spline)) {
+				return visitor(static_cast<holder_t<THolderBase> &>(holder).spline);
+			}
+		};
+
+	 public:
+		/// \brief type erased evaluator; the fixed order evaluator lives in place (no heap allocation per evaluation)
+		template <int IMaximalDerivativeOrder>
+		class Evaluator {
+			struct Interface {
+				virtual ~Interface() {}
+				virtual Interface * copyTo(void * storage) const = 0;
+				virtual point_t eval() const = 0;
+				virtual point_t evalD(int derivativeOrder) const = 0;
+				virtual void evalJacobian(int derivativeOrder, Eigen::MatrixXd & jacobian) const = 0;
+				virtual time_t getKnot() const = 0;
+			};
+
+			template <int ISplineOrder>
+			struct Implementation : public Interface {
+				typedef typename family_t::template Spline<ISplineOrder> spline_t;
+				typename spline_t::template Evaluator<IMaximalDerivativeOrder> evaluator;
+				Implementation(const spline_t & spline, const time_t & t) : evaluator(spline, t) {}
+				virtual Interface * copyTo(void * storage) const { return new (storage) Implementation(*this); }
+				virtual point_t eval() const { return evaluator.eval(); }
+				virtual point_t evalD(int derivativeOrder) const { return evaluator.evalD(derivativeOrder); }
+				virtual void evalJacobian(int derivativeOrder, Eigen::MatrixXd & jacobian) const {
+					evalJacobianInto(derivativeOrder, jacobian, std::is_same<typename spline_t::full_jacobian_t, Eigen::MatrixXd>());
+				}
+				/// dynamic size Jacobians are computed in the caller's buffer
+				inline void evalJacobianInto(int derivativeOrder, Eigen::MatrixXd & jacobian, std::true_type) const {
+					evaluator.evalJacobian(derivativeOrder, jacobian);
+				}
+				/// fixed size Jacobians are computed on the stack and copied, which only allocates if the caller's buffer has the wrong size
+				inline void evalJacobianInto(int derivativeOrder, Eigen::MatrixXd & jacobian, std::false_type) const {
+					typename spline_t::full_jacobian_t J;
+					evaluator.evalJacobian(derivativeOrder, J);
+					jacobian = J;
+				}
+				virtual time_t getKnot() const { return evaluator.getKnot(); }
+			};
+
+			/// the storage must fit the implementation of every dispatched order
+			template <int ISplineOrder, int IDummy = 0>
+			struct StorageRequirements {
+				enum {
+					Size = sizeof(Implementation<ISplineOrder>) > (size_t) StorageRequirements<ISplineOrder + 1>::Size ? sizeof(Implementation<ISplineOrder>) : (size_t) StorageRequirements<ISplineOrder + 1>::Size,
+					Alignment = alignof(Implementation<ISplineOrder>) > (size_t) StorageRequirements<ISplineOrder + 1>::Alignment ? alignof(Implementation<ISplineOrder>) : (size_t) StorageRequirements<ISplineOrder + 1>::Alignment
+				};
+			};
+			template <int IDummy>
+			struct StorageRequirements<MaxDispatchedSplineOrder, IDummy> {
+				enum {
+					Size = sizeof(Implementation<MaxDispatchedSplineOrder>),
+					Alignment = alignof(Implementation<MaxDispatchedSplineOrder>) > 16 ? alignof(Implementation<MaxDispatchedSplineOrder>) : 16
+				};
+			};
+
+			struct Creator {
+				void * storage;
+				const time_t & t;
+				template <typename TSpline>
+				inline Interface * operator()(const TSpline & spline) const { return new (storage) Implementation<TSpline::SplineOrder>(spline, t); }
+			};
+
+			typename std::aligned_storage<StorageRequirements<MinDispatchedSplineOrder>::Size, StorageRequirements<MinDispatchedSplineOrder>::Alignment>::type _storage;
+			Interface * _impl;
+			int _splineOrder;
+		 public:
+			EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+			Evaluator(const AnyOrderBSpline & spline, const time_t & t) : _impl(spline.visit(Creator{&_storage, t})), _splineOrder(spline.getSplineOrder()) {}
+			Evaluator(const Evaluator & other) : _impl(other._impl->copyTo(&_storage)), _splineOrder(other._splineOrder) {}
+			Evaluator & operator=(const Evaluator & other) {
+				if(this != &other){
+					_impl->~Interface();
+					_impl = other._impl->copyTo(&_storage);
+					_splineOrder = other._splineOrder;
+				}
+				return *this;
+			}
+			~Evaluator() { _impl->~Interface(); }
+
+			inline point_t eval() const { return _impl->eval(); }
+			inline point_t evalD(int derivativeOrder) const { return _impl->evalD(derivativeOrder); }
+			/// \brief reuse jacobian across calls: it is only reallocated when its size changes
+			inline void evalJacobian(int derivativeOrder, Eigen::MatrixXd & jacobian) const { _impl->evalJacobian(derivativeOrder, jacobian); }
+			/// \brief the Jacobian into the concrete spline's (possibly fixed size) type; ISplineOrder must match the spline's order
+			template <int ISplineOrder>
+			inline void evalJacobian(int derivativeOrder, typename family_t::template Spline<ISplineOrder>::full_jacobian_t & jacobian) const {
+				SM_ASSERT_EQ(std::runtime_error, ISplineOrder, _splineOrder, "");
+				static_cast<const Implementation<ISplineOrder> *>(_impl)->evaluator.evalJacobian(derivativeOrder, jacobian);
+			}
+			inline time_t getKnot() const { return _impl->getKnot(); }
+		};
+
+		AnyOrderBSpline(int splineOrder, const family_t & family = family_t()) : _splineOrder(splineOrder), _holder(dispatchSplineOrder<HolderCreator>(splineOrder, family)) {}
+		AnyOrderBSpline(const AnyOrderBSpline & other) : _splineOrder(other._splineOrder), _holder(other._holder->clone()) {}
+		AnyOrderBSpline(AnyOrderBSpline && other) = default;
+		AnyOrderBSpline & operator=(const AnyOrderBSpline & other) { _splineOrder = other._splineOrder; _holder.reset(other._holder->clone()); return *this; }
+		AnyOrderBSpline & operator=(AnyOrderBSpline && other) = default;
+
+		inline int getSplineOrder() const { return _splineOrder; }
+
+		/// \brief calls visitor(spline) with the concrete fixed order spline
+		template <typename TVisitor>
+		inline auto visit(TVisitor && visitor) -> decltype(VisitorApplier<MinDispatchedSplineOrder>::apply(std::declval<HolderBase &>(), std::forward<TVisitor>(visitor))) {
+			return dispatchSplineOrder<VisitorApplier>(_splineOrder, *_holder, std::forward<TVisitor>(visitor));
+		}
+		template <typename TVisitor>
+		inline auto visit(TVisitor && visitor) const -> decltype(VisitorApplier<MinDispatchedSplineOrder>::apply(std::declval<const HolderBase &>(), std::forward<TVisitor>(visitor))) {
+			return dispatchSplineOrder<VisitorApplier>(_splineOrder, static_cast<const HolderBase &>(*_holder), std::forward<TVisitor>(visitor));
+		}
+
+		/// \brief access the concrete spline; ISplineOrder must match getSplineOrder()
+		template <int ISplineOrder>
+		inline typename family_t::template Spline<ISplineOrder> & get() {
+			SM_ASSERT_EQ(std::runtime_error, ISplineOrder, _splineOrder, "");
+			return static_cast<Holder<ISplineOrder> &>(*_holder).spline;
+		}
+		template <int ISplineOrder>
+		inline const typename family_t::template Spline<ISplineOrder> & get() const {
+			SM_ASSERT_EQ(std::runtime_error, ISplineOrder, _splineOrder, "");
+			return static_cast<const Holder<ISplineOrder> &>(*_holder).spline;
+		}
+
+		template <int IMaximalDerivativeOrder>
+		inline Evaluator<IMaximalDerivativeOrder> getEvaluatorAt(const time_t & t) const { return Evaluator<IMaximalDerivativeOrder>(*this, t); }
+
+		inline void initConstantUniformSpline(const time_t & tMin, const time_t & tMax, int numSegments, const point_t & constant) { visit(ConstantUniformInitializer{tMin, tMax, numSegments, constant}); }
+		inline time_t getMinTime() const { return visit(MinTimeGetter()); }
+		inline time_t getMaxTime() const { return visit(MaxTimeGetter()); }
+		inline int getNumControlVertices() const { return visit(NumControlVerticesGetter()); }
+		inline void setControlVertices(const Eigen::MatrixXd & controlVertices) { visit(ControlVerticesSetter{controlVertices}); }
+
+		inline point_t eval(const time_t & t) const { return getEvaluatorAt<0>(t).eval(); }
+		inline point_t evalD(const time_t & t, int derivativeOrder) const { return getEvaluatorAt<Eigen::Dynamic>(t).evalD(derivativeOrder); }
+
+	 private:
+		struct ConstantUniformInitializer {
+			const time_t & tMin, & tMax;
+			int numSegments;
+			const point_t & constant;
+			template <typename TSpline> inline void operator()(TSpline & spline) const { spline.initConstantUniformSpline(tMin, tMax, numSegments, constant); }
+		};
+		struct MinTimeGetter {
+			template <typename TSpline> inline time_t operator()(const TSpline & spline) const { return spline.getMinTime(); }
+		};
+		struct MaxTimeGetter {
+			template <typename TSpline> inline time_t operator()(const TSpline & spline) const { return spline.getMaxTime(); }
+		};
+		struct NumControlVerticesGetter {
+			template <typename TSpline> inline int operator()(const TSpline & spline) const { return spline.getNumControlVertices(); }
+		};
+		struct ControlVerticesSetter {
+			const Eigen::MatrixXd & controlVertices;
+			template <typename TSpline> inline void operator()(TSpline & spline) const { spline.setControlVertices(controlVertices); }
+		};
+
+		int _splineOrder;
+		std::unique_ptr<HolderBase> _holder;
+	};
+}
+
+#endif /* ANYORDERBSPLINE_HPP_ */
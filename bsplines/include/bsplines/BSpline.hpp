@@ -260,6 +260,17 @@ namespace bsplines {
        */
       Eigen::VectorXd evalD(double t, int derivativeOrder) const;
 
+      /** 
+       * Evaluate the spline curve and its derivatives up to maxDerivativeOrder at time t
+       * with a single segment lookup.
+       * 
+       * @param t The time to evaluate the spline curve
+       * @param maxDerivativeOrder The highest derivative order. This must be >= 0
+       * 
+       * @return A matrix whose column i is evalD(t, i).
+       */
+      Eigen::MatrixXd evalDs(double t, int maxDerivativeOrder) const;
+
       /** 
        * Evaluate the derivative of the spline curve at time t and retrieve the Jacobian
        * of the value with respect to small changes in the paramter vector. The Jacobian
@@ -287,6 +298,20 @@ namespace bsplines {
        */
       Eigen::VectorXd evalDAndJacobian(double t, int derivativeOrder, Eigen::MatrixXd * Jacobian, Eigen::VectorXi * coefficientIndices) const;
 
+      /** 
+       * Evaluate the spline curve and its derivatives up to maxDerivativeOrder at time t
+       * with a single segment lookup and retrieve their Jacobians with respect to the local
+       * parameter vector.
+       * 
+       * @param t The time to evaluate the spline curve
+       * @param maxDerivativeOrder The highest derivative order. This must be >= 0
+       * @param a pointer to the Jacobian matrix to fill in. Its rows i * dimension() to (i + 1) * dimension() - 1 hold the Jacobian of evalD(t, i)
+       * @param a pointer to an int vector that will be filled with the local coefficient indices
+       * 
+       * @return A matrix whose column i is evalD(t, i).
+       */
+      Eigen::MatrixXd evalDsAndJacobian(double t, int maxDerivativeOrder, Eigen::MatrixXd * Jacobian, Eigen::VectorXi * coefficientIndices) const;
+
 
 
       /** 
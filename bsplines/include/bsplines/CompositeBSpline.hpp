@@ -0,0 +1,182 @@
+/*
+ * CompositeBSpline.hpp
+ *
+ *  A B-spline with a list of additional fixed size Euclidean components sharing the knots, segments and basis functions of a primary manifold spline (e.g. orientation, position and a bias).
+ *  Every segment stores the control vertices of all components, so one segment lookup and one basis evaluation serve all of them.
+ */
+
+#ifndef COMPOSITEBSPLINE_HPP_
+#define COMPOSITEBSPLINE_HPP_
+
+#include "DiffManifoldBSpline.hpp"
+#include "UnitQuaternionBSpline.hpp"
+#include <tuple>
+
+namespace bsplines {
+	template <typename TPrimaryBSplineConfiguration = UnitQuaternionBSplineConfiguration<>, int ... IEuclideanDimensions>
+	struct CompositeBSplineConfiguration;
+
+	namespace internal {
+		template <int ... IValues>
+		struct IntSequence {};
+		template <int N, int ... IValues>
+		struct MakeIntSequence : public MakeIntSequence<N - 1, N - 1, IValues...> {};
+		template <int ... IValues>
+		struct MakeIntSequence<0, IValues...> { typedef IntSequence<IValues...> type; };
+
+		inline constexpr bool areAllPositive() { return true; }
+		template <typename ... TInts>
+		inline constexpr bool areAllPositive(int value, TInts ... values) { return value > 0 && areAllPositive(values...); }
+
+		/// the types of a list of fixed size Euclidean components
+		template <typename TScalar, int ... IEuclideanDimensions>
+		struct EuclideanComponents {
+			static_assert(sizeof...(IEuclideanDimensions) > 0, "a composite spline needs at least one Euclidean component");
+			static_assert(areAllPositive(IEuclideanDimensions...), "the Euclidean components need fixed dimensions");
+
+			enum { NumberOfComponents = sizeof...(IEuclideanDimensions) };
+			typedef std::tuple<Eigen::Matrix<TScalar, IEuclideanDimensions, 1>...> points_t;
+			typedef typename MakeIntSequence<NumberOfComponents>::type indices_t;
+
+			template <int IComponent>
+			struct Component {
+				typedef typename std::tuple_element<IComponent, points_t>::type point_t;
+				enum { Dimension = point_t::RowsAtCompileTime };
+			};
+		};
+	}
+
+	template <typename TPrimaryBSplineConfiguration, int ... IEuclideanDimensions>
+	struct CompositeBSplineConfiguration : public TPrimaryBSplineConfiguration {
+	public:
+		typedef TPrimaryBSplineConfiguration ParentConf;
+		typedef CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...> Conf;
+		typedef typename TPrimaryBSplineConfiguration::ManifoldConf ManifoldConf;
+		typedef DiffManifoldBSpline<Conf> BSpline;
+		typedef internal::EuclideanComponents<typename TPrimaryBSplineConfiguration::Manifold::scalar_t, IEuclideanDimensions...> EuclideanComponents;
+
+		CompositeBSplineConfiguration(TPrimaryBSplineConfiguration primaryConfiguration = TPrimaryBSplineConfiguration()) : ParentConf(primaryConfiguration) {}
+		CompositeBSplineConfiguration(ManifoldConf manifoldConfiguration, int splineOrder) : ParentConf(manifoldConfiguration, splineOrder) {}
+		CompositeBSplineConfiguration(int splineOrder) : ParentConf(splineOrder) {}
+	};
+
+	namespace internal {
+		template <typename TPrimaryBSplineConfiguration, int ... IEuclideanDimensions>
+		struct DiffManifoldBSplineTraits<CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...> > : public DiffManifoldBSplineTraits<TPrimaryBSplineConfiguration> {
+		};
+
+		template <typename TPrimaryBSplineConfiguration, int ... IEuclideanDimensions>
+		struct SegmentData<CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...> > : public SegmentData<TPrimaryBSplineConfiguration> {
+			EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+			typedef SegmentData<TPrimaryBSplineConfiguration> parent_t;
+			typedef CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...> configuration_t;
+			typedef typename parent_t::Manifold Manifold;
+			typedef typename parent_t::point_t point_t;
+			typedef typename parent_t::time_t time_t;
+			typedef typename configuration_t::EuclideanComponents EuclideanComponents;
+
+		public:
+			/// does not invalidate the segment's cached values, like getControlVertex()
+			template <int IComponent = 0>
+			inline typename EuclideanComponents::template Component<IComponent>::point_t & getEuclideanControlVertex() { return std::get<IComponent>(_euclideanPoints); }
+			template <int IComponent = 0>
+			inline const typename EuclideanComponents::template Component<IComponent>::point_t & getEuclideanControlVertex() const { return std::get<IComponent>(_euclideanPoints); }
+			template <int IComponent = 0>
+			inline void setEuclideanControlVertex(const typename EuclideanComponents::template Component<IComponent>::point_t & point) { std::get<IComponent>(_euclideanPoints) = point; this->accessCache().handleUpdatedValueEvent(); }
+
+			/// the Euclidean control vertices start at zero, also for segments appended later (see DiffManifoldBSpline::setEuclideanControlVertices)
+			inline SegmentData(const configuration_t & conf, const Manifold & manifold, const time_t & t, const point_t & point) : parent_t(conf, manifold, t, point) { setZero(typename EuclideanComponents::indices_t()); }
+		protected:
+			typename EuclideanComponents::points_t _euclideanPoints;
+		private:
+			template <int ... IComponents>
+			inline void setZero(IntSequence<IComponents...>) {
+				int expand[] = { (std::get<IComponents>(_euclideanPoints).setZero(), 0)... };
+				(void) expand;
+			}
+		};
+	}
+
+	template <typename TPrimaryBSplineConfiguration, int ... IEuclideanDimensions, typename TConfigurationDerived>
+	class DiffManifoldBSpline<CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, IEuclideanDimensions...>, TConfigurationDerived> : public DiffManifoldBSpline<TPrimaryBSplineConfiguration, TConfigurationDerived> {
+		typedef DiffManifoldBSpline<TPrimaryBSplineConfiguration, TConfigurationDerived> parent_t;
+	public:
+		typedef typename parent_t::configuration_t configuration_t;
+		typedef typename parent_t::spline_t spline_t;
+		typedef typename parent_t::time_t time_t;
+		typedef typename parent_t::point_t point_t;
+		typedef typename parent_t::SplineOrderVector SplineOrderVector;
+		typedef typename parent_t::SegmentIterator SegmentIterator;
+		typedef typename parent_t::SegmentConstIterator SegmentConstIterator;
+		typedef internal::EuclideanComponents<typename parent_t::scalar_t, IEuclideanDimensions...> EuclideanComponents;
+		typedef typename EuclideanComponents::points_t euclidean_points_t;
+
+		SM_DEFINE_EXCEPTION(Exception, std::runtime_error);
+
+		enum {
+			NumberOfEuclideanComponents = EuclideanComponents::NumberOfComponents
+		};
+
+		/// the types of the IComponent's Euclidean component
+		template <int IComponent>
+		struct EuclideanComponent {
+			enum { Dimension = EuclideanComponents::template Component<IComponent>::Dimension };
+			typedef typename EuclideanComponents::template Component<IComponent>::point_t point_t;
+			typedef Eigen::Matrix<typename parent_t::scalar_t, Dimension, multiplyEigenSize(Dimension, parent_t::SplineOrder) > jacobian_t;
+		};
+
+		DiffManifoldBSpline(int splineOrder = parent_t::SplineOrder) : parent_t(configuration_t(splineOrder)){}
+		DiffManifoldBSpline(const configuration_t & conf) : parent_t(conf){}
+
+		/**
+		 * Sets the IComponent's Euclidean control vertices starting at the first relevant control vertex (see setControlVertices).
+		 * @param controlVertices EuclideanComponent<IComponent>::Dimension x n matrix holding n control vertices
+		 */
+		template <int IComponent = 0>
+		void setEuclideanControlVertices(const Eigen::MatrixXd & controlVertices);
+
+		/**
+		 * Same as above but starting at the one reached after moving offset from the first relevant control vertex for startingAtFirstRelevantControlVertexForThisTime.
+		 * This reaches the control vertices of appended segments, too.
+		 */
+		template <int IComponent = 0>
+		void setEuclideanControlVertices(const Eigen::MatrixXd & controlVertices, const time_t startingAtFirstRelevantControlVertexForThisTime, int offset = 0);
+
+		template<int IMaximalDerivativeOrder>
+		class Evaluator : public parent_t::template Evaluator<IMaximalDerivativeOrder> {
+		public :
+			Evaluator(const spline_t & spline, const time_t & t);
+			Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt);
+
+			template <int IComponent = 0>
+			typename EuclideanComponent<IComponent>::point_t evalEuclidean() const { return evalEuclideanD<IComponent>(0); }
+			template <int IComponent = 0>
+			typename EuclideanComponent<IComponent>::point_t evalEuclideanD(int derivativeOrder) const;
+
+			/// the Jacobian of evalEuclideanD<IComponent>(derivativeOrder) with respect to the relevant control vertices of that component
+			template <int IComponent = 0>
+			void evalEuclideanJacobian(int derivativeOrder, typename EuclideanComponent<IComponent>::jacobian_t & jacobian) const;
+
+			/// evaluates the derivativeOrder's derivative of all Euclidean components
+			inline euclidean_points_t evalEuclideanComponentsD(int derivativeOrder) const { return evalEuclideanComponentsD(derivativeOrder, typename EuclideanComponents::indices_t()); }
+
+			/// evaluates the derivativeOrder's derivative of all components
+			inline void evalComponentsD(int derivativeOrder, point_t & primary, Eigen::Matrix<typename parent_t::scalar_t, IEuclideanDimensions, 1> & ... euclidean) const {
+				primary = this->evalD(derivativeOrder);
+				std::tie(euclidean...) = evalEuclideanComponentsD(derivativeOrder);
+			}
+		private:
+			template <int ... IComponents>
+			inline euclidean_points_t evalEuclideanComponentsD(int derivativeOrder, internal::IntSequence<IComponents...>) const { return euclidean_points_t(evalEuclideanD<IComponents>(derivativeOrder)...); }
+		};
+
+		template<int IMaximalDerivativeOrder>
+		inline Evaluator<IMaximalDerivativeOrder> getEvaluatorAt(const time_t & t) const { return Evaluator<IMaximalDerivativeOrder>(this->getDerived(), t); }
+	};
+
+	template <int ISplineOrder = Eigen::Dynamic, int IEuclideanDimension = 3, typename TTimePolicy = DefaultTimePolicy>
+	using UnitQuaternionEuclideanBSpline = typename CompositeBSplineConfiguration<UnitQuaternionBSplineConfiguration<manifolds::UnitQuaternionManifoldConf<>, ISplineOrder, TTimePolicy>, IEuclideanDimension>::BSpline;
+}
+
+#include "implementation/CompositeBSplineImpl.hpp"
+#endif /* COMPOSITEBSPLINE_HPP_ */
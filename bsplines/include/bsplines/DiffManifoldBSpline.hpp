@@ -15,6 +15,8 @@
 #include "SimpleTypeTimePolicy.hpp"
 #include "manifolds/DiffManifold.hpp"
 #include "KnotArithmetics.hpp"
+#include "NodeDistributedCache.hpp"
+#include "NumericIntegrator.hpp"
 
 
 namespace bsplines {
@@ -66,22 +68,30 @@ namespace bsplines {
 			typedef typename TDiffManifoldBSplineConfiguration::TimePolicy::time_t time_t;
 			typedef Eigen::Matrix<typename Manifold::scalar_t, TDiffManifoldBSplineConfiguration::SplineOrder::VALUE, TDiffManifoldBSplineConfiguration::SplineOrder::VALUE> basis_matrix_t;
 
+			/// registry of the values cached per segment (see DiffManifoldBSpline::registerSegmentCacheSlot)
+			typedef nodecache::NodeDistributedCache<SegmentData> cache_t;
+
 		public:
+			/// writes through the mutable access do not invalidate the segment's cached values; use setControlVertex or call accessCache().handleUpdatedValueEvent() afterwards
 			inline point_t & getControlVertex() { return _point; }
 			inline basis_matrix_t & getBasisMatrix() { return _basisMatrix; }
 
-			inline void setControlVertex(const point_t & point) { _point = point; }
+			inline void setControlVertex(const point_t & point) { _point = point; _cache.handleUpdatedValueEvent(); }
 
 			inline const point_t & getControlVertex() const { return _point; }
 			inline const basis_matrix_t & getBasisMatrix() const { return _basisMatrix; }
 			inline time_t getKnot() const { return _t; }
 			inline time_t getTime() const { return getKnot(); }
 
+			/// the values cached for this segment. They are not part of the segment's logical state and therefore accessible through const segments, too.
+			inline typename cache_t::PerNodeCache & accessCache() const { return _cache; }
+
           inline SegmentData(const TDiffManifoldBSplineConfiguration & conf, const typename TDiffManifoldBSplineConfiguration::Manifold & /* manifold */, const time_t & t, const point_t & point) : _point(point), _basisMatrix((int)conf.getSplineOrder(), (int)conf.getSplineOrder()), _t(t) {}
 		protected:
 			point_t _point;
 			basis_matrix_t _basisMatrix;
 			time_t _t;
+			mutable typename cache_t::PerNodeCache _cache;
 		};
 
 		template <typename TDiffManifoldBSplineConfiguration>
@@ -117,6 +127,41 @@ namespace bsplines {
 			};
 		};
 
+		template <int IValue>
+		struct IntToVoid {
+			typedef void type;
+		};
+
+		/**
+		 * Integrand functors (see evalFunctorIntegral) may declare enum { PolynomialDegree = p } if their value at t is a polynomial of degree p in the spline's value and derivatives at t.
+		 * VALUE is -1 for functors without such a declaration.
+		 */
+		template <typename TFunctor, typename TEnable = void>
+		struct FunctorPolynomialDegree {
+			enum { VALUE = -1 };
+		};
+
+		template <typename TFunctor>
+		struct FunctorPolynomialDegree<TFunctor, typename IntToVoid<TFunctor::PolynomialDegree>::type> {
+			enum { VALUE = TFunctor::PolynomialDegree };
+		};
+
+		/**
+		 * Integrand functors may additionally declare enum { MaximalDerivativeOrder = d } and provide
+		 *   template <typename TEvaluator> TValue evalAt(const TEvaluator & evaluator) const;
+		 * for evaluators of up to the d'th derivative. Numeric integration then evaluates all integration points in one sweep along the segments (see numeric_integrator::internal::HasEvalBatch).
+		 * VALUE is -1 for functors without such a declaration.
+		 */
+		template <typename TFunctor, typename TEnable = void>
+		struct FunctorMaximalDerivativeOrder {
+			enum { VALUE = -1 };
+		};
+
+		template <typename TFunctor>
+		struct FunctorMaximalDerivativeOrder<TFunctor, typename IntToVoid<TFunctor::MaximalDerivativeOrder>::type> {
+			enum { VALUE = TFunctor::MaximalDerivativeOrder };
+		};
+
 		template <typename Spline, int IMaximalDerivativeOrder>
 		struct get_evaluator {
 			typedef typename Spline::template Evaluator<IMaximalDerivativeOrder> type;
@@ -172,6 +217,7 @@ namespace bsplines {
 	public:
 		typedef internal::SegmentMap<configuration_t> segment_map_t;
 		typedef typename segment_map_t::segment_data_t segment_data_t;
+		typedef typename segment_data_t::cache_t segment_cache_t;
 
 	protected:
 		typedef typename segment_map_t::SegmentMapIterator SegmentMapIterator;
@@ -182,9 +228,9 @@ namespace bsplines {
 		typedef typename segment_map_t::SegmentConstIterator SegmentConstIterator;
 
 
-		DiffManifoldBSpline(const configuration_t & configuration) : _configuration(configuration), _state(internal::state::CONSTRUCTING), _manifold(configuration), _segments(new segment_map_t()) {}
+		DiffManifoldBSpline(const configuration_t & configuration) : _configuration(configuration), _state(internal::state::CONSTRUCTING), _manifold(configuration), _segments(new segment_map_t()), _segmentCache(new segment_cache_t()) {}
 
-		DiffManifoldBSpline(const DiffManifoldBSpline & other) : _configuration(other._configuration), _state(other._state), _manifold(other._manifold), _segments(new segment_map_t(*other._segments)) { if(isInitialized()) initIterators();}
+		DiffManifoldBSpline(const DiffManifoldBSpline & other) : _configuration(other._configuration), _state(other._state), _manifold(other._manifold), _segments(new segment_map_t(*other._segments)), _segmentCache(other._segmentCache) { if(isInitialized()) initIterators();}
 		DiffManifoldBSpline(DiffManifoldBSpline && /* other */) = default;
 
 		DiffManifoldBSpline & operator=(const DiffManifoldBSpline & other);
@@ -283,6 +329,17 @@ namespace bsplines {
 		 */
 		time_t appendSegments(KnotGenerator<time_t> & knotGenerator, int numSegments = 1, const point_t * value = nullptr);
 
+		/**
+		 * Removes all knots and control vertices (with their segment data) that are not relevant for times greater than or equal to t.
+		 * Afterwards getMinTime() is the left hand knot of the segment containing t. Together with appendSegments this keeps the memory of a sliding window spline bounded.
+		 *
+		 * This is only allowed on slices starting at the splines absolute beginning. Iterators and references to removed segments become invalid.
+		 *
+		 * @param t the time that needs to stay evaluable. It must be within [getMinTime(), getMaxTime()].
+		 * @return the number of removed knots
+		 */
+		size_t removeSegmentsBefore(const time_t & t);
+
 		/**
 		 * Get the number of valid time segments in the slice. Valid is a time segment, in whose interior spline order many basis functions are nonzero.
 		 * This requires at least spline order -1 many knots before its left hand knot and after its right hand knot.
@@ -302,6 +359,9 @@ namespace bsplines {
 		 */
 		inline size_t getNumKnots() const;
 
+		/// \brief all knots in ascending order (e.g. for numeric_integrator::algorithms::KnotAlignedGaussLegendreRule)
+		std::vector<time_t> getKnots() const;
+
 		inline bool isInitialized() const { return _state == internal::state::SplineState::EVALUABLE; }
 
 		inline time_t getMinTime() const;
@@ -327,6 +387,11 @@ namespace bsplines {
 		 */
 		inline SegmentIterator getSegmentIterator(const time_t & t);
 		inline SegmentConstIterator getSegmentIterator(const time_t & t) const;
+		/**
+		 * Same as above but starts searching at hint. This is cheap if t lies in or at most a few segments after hint's segment (e.g. while walking over sorted times) and falls back to the tree search otherwise.
+		 * @param hint a valid segment of this spline, i.e. in [begin(), end())
+		 */
+		inline SegmentConstIterator getSegmentIterator(const time_t & t, SegmentConstIterator hint) const;
 
 		time_t getMinimalDistanceToNeighborKnots(const time_t & t) const;
 
@@ -341,8 +406,31 @@ namespace bsplines {
 		template <typename TValue, typename TFunctor>
 		TValue evalFunctorIntegralNumerically(const time_t & t1, const time_t & t2, const TFunctor & f, int numberOfPoints = 100) const;
 
+		/**
+		 * Integrates f over [t1, t2] with a Gauss-Legendre rule of numberOfPointsPerSegment points on each spline segment (piece of [t1, t2] between two knots).
+		 * This is exact if f is a polynomial of degree < 2 * numberOfPointsPerSegment in time on every segment. The integral is taken with respect to getDurationAsDouble time units.
+		 * With integer time policies (e.g. NsecTimePolicy) the nodes are truncated to whole time ticks, so the result is only exact up to the integrand's change within one tick.
+		 */
+		template <typename TValue, typename TFunctor>
+		TValue evalFunctorIntegralGaussLegendre(const time_t & t1, const time_t & t2, const TFunctor & f, int numberOfPointsPerSegment) const;
+
+		/**
+		 * Integrates f over [t1, t2] segment by segment with TAlgorithm (see numeric_integrator::integrateFunctorToTolerance), refining each segment until its error estimate is below
+		 * max(tolerance * (segment's share of [t1, t2]), relativeTolerance * |segment's integral|) or maxNumberOfPointsPerSegment would be exceeded.
+		 * With integer time policies the integrand is evaluated at the integration points truncated to whole time ticks, which the error estimate does not cover.
+		 * @param errorEstimate if given receives the sum of the segments' error estimates
+		 */
+		template <typename TValue, typename TFunctor, typename TAlgorithm = numeric_integrator::algorithms::RombergRule>
+		TValue evalFunctorIntegralToTolerance(const time_t & t1, const time_t & t2, const TFunctor & f, double tolerance, double relativeTolerance = 0, int maxNumberOfPointsPerSegment = 1025, double * errorEstimate = NULL) const;
+
+		/**
+		 * Integrates f segment by segment with evalFunctorIntegralToTolerance until the relative error estimate is below 1E-10, but with a budget of points.
+		 * It never spends more than max(100, 5 * number of segments) points, so it is never more expensive than evalFunctorIntegralNumerically's default of 100 points,
+		 * except that every segment gets at least 5 points. When the budget runs out first, the result is that of the last Romberg level reached.
+		 * Call evalFunctorIntegralToTolerance directly for a guaranteed accuracy.
+		 */
 		template <typename TValue, typename TFunctor>
-		inline TValue evalFunctorIntegral(const time_t & t1, const time_t & t2, const TFunctor & f) const { return evalFunctorIntegralNumerically<TValue, TFunctor>(t1, t2, f); }
+		TValue evalFunctorIntegral(const time_t & t1, const time_t & t2, const TFunctor & f) const;
 
 		point_t evalIntegralNumerically(const time_t & t1, const time_t & t2, int numberOfPoints = 100) const;
 		inline point_t evalIntegral(const time_t & t1, const time_t & t2) const { return evalIntegralNumerically(t1, t2); }
@@ -354,6 +442,8 @@ namespace bsplines {
 			EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 			Evaluator(const spline_t & spline, const time_t & t);
+			/// \brief construct with the already known segment of t (spline.getSegmentIterator(t))
+			Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt);
 			SegmentConstIterator getFirstRelevantSegmentIterator() const;
 			inline SegmentConstIterator begin() const { return getFirstRelevantSegmentIterator(); }
 
@@ -393,6 +483,9 @@ namespace bsplines {
 			const duration_t _positionInSegment;
 			const double _relativePositionInSegment;
 
+			/// \brief asserts that spline is evaluable before looking up the segment of t
+			inline static SegmentConstIterator getSegmentIteratorOfEvaluableSpline(const spline_t & spline, const time_t & t);
+
 			inline void computeLocalViInto(SplineOrderVector & localVi) const;
 			inline const SplineOrderVector & getLocalBi(int derivativeOrder = 0) const;
 			inline const SplineOrderVector & getLocalCumulativeBi(int derivativeOrder = 0) const;
@@ -417,6 +510,33 @@ namespace bsplines {
 		template<int IMaximalDerivativeOrder>
 		inline typename internal::get_evaluator<spline_t, IMaximalDerivativeOrder>::type getEvaluatorAt(const time_t & t) const;
 
+		/**
+		 * Calls f(i, evaluator) with an evaluator at times[i] for every index i.
+		 * The segments are found by walking along the knots from the previous time's segment, which is fastest for ascending times. Unsorted times are supported but pay a tree search for every backward step.
+		 * @param numberOfThreads if greater than one the times are split into that many contiguous chunks evaluated in parallel; f must be thread safe then.
+		 */
+		template<int IMaximalDerivativeOrder, typename TFunctor>
+		void forEachEvaluatorAt(const std::vector<time_t> & times, TFunctor && f, int numberOfThreads = 1) const;
+
+		/// \brief resizes output to times.size() and stores the derivativeOrder's derivative at times[i] in output[i] (see forEachEvaluatorAt)
+		template<int IMaximalDerivativeOrder, typename TPointContainer>
+		void evalBatch(const std::vector<time_t> & times, int derivativeOrder, TPointContainer & output, int numberOfThreads = 1) const;
+
+		/// \brief resizes output to times.size() and stores the derivativeOrder's derivative's Jacobian at times[i] in output[i]. Only available for splines whose evaluator supports evalJacobian.
+		template<int IMaximalDerivativeOrder, typename TJacobianContainer>
+		void evalJacobianBatch(const std::vector<time_t> & times, int derivativeOrder, TJacobianContainer & output, int numberOfThreads = 1) const;
+
+		/**
+		 * Registers a value to be cached in every segment (e.g. a quantity derived from the segment's control vertex).
+		 * The cached values get invalid whenever their segment's control vertices are accessed mutably, which includes updates through design variables, and when the knots change. Copied segments start with invalid values.
+		 * Reading the cached values through NodeCacheSlot::get is thread safe, but not concurrently with changes of the spline.
+		 */
+		template <typename TValue>
+		inline std::shared_ptr<typename segment_cache_t::template NodeCacheSlot<TValue> > registerSegmentCacheSlot() { return segment_cache_t::template registerCacheableValue<TValue>(_segmentCache); }
+
+		/// \brief invalidates the cached values of all segments in O(1)
+		inline void invalidateSegmentCaches() { _segmentCache->invalidateAll(); }
+
 	protected:
 		typedef typename knot_arithmetics::UniformTimeCalculator<TimePolicy> UniformTimeCalculator;
 
@@ -424,6 +544,8 @@ namespace bsplines {
 		enum internal::state::SplineState _state;
 		manifold_t _manifold;
 		std::shared_ptr<segment_map_t> _segments;
+		/// shared with copies of this spline as they share the registered slots, too
+		std::shared_ptr<segment_cache_t> _segmentCache;
 		SegmentIterator _begin, _end, _firstRelevantSegment;
 
 		inline const spline_t & getDerived() const { return *static_cast<const spline_t *>(this); }
@@ -39,6 +39,7 @@ namespace bsplines {
 		typedef typename parent_t::point_t point_t;
 		typedef typename parent_t::SplineOrderVector SplineOrderVector;
 		typedef typename parent_t::SegmentMapConstIterator SegmentMapConstIterator;
+		typedef typename parent_t::SegmentConstIterator SegmentConstIterator;
 		typedef typename parent_t::full_jacobian_t full_jacobian_t;
 
 		DiffManifoldBSpline(int splineOrder = parent_t::SplineOrder, int dimension = parent_t::Dimension) : parent_t(configuration_t (typename configuration_t::ManifoldConf(dimension), splineOrder)){}
@@ -46,10 +47,20 @@ namespace bsplines {
 
 		point_t evalIntegral(const time_t & t1, const time_t & t2) const;
 
+		/**
+		 * As the spline is a polynomial in time on each segment, integrands declaring a PolynomialDegree (see internal::FunctorPolynomialDegree) are integrated exactly
+		 * by a per segment Gauss-Legendre rule (up to the truncation of its nodes to whole ticks with integer time policies). All others are integrated as by the base class (see parent_t::evalFunctorIntegral).
+		 */
+		template <typename TValue, typename TFunctor>
+		inline TValue evalFunctorIntegral(const time_t & t1, const time_t & t2, const TFunctor & f) const {
+			return evalFunctorIntegral<TValue>(t1, t2, f, std::integral_constant<bool, (internal::FunctorPolynomialDegree<TFunctor>::VALUE >= 0)>());
+		}
+
 		template<int IMaximalDerivativeOrder>
 		class Evaluator : public parent_t::template Evaluator<IMaximalDerivativeOrder> {
 		public :
 			Evaluator(const spline_t & spline, const time_t & t);
+			Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt);
 
 			point_t eval() const;
 
@@ -66,6 +77,13 @@ namespace bsplines {
 		inline Evaluator<IMaximalDerivativeOrder> getEvaluatorAt(const time_t & t) const { return parent_t::template getEvaluatorAt<IMaximalDerivativeOrder>(t); }
 
 	protected:
+		template <typename TValue, typename TFunctor>
+		TValue evalFunctorIntegral(const time_t & t1, const time_t & t2, const TFunctor & f, std::true_type isPolynomial) const;
+		template <typename TValue, typename TFunctor>
+		inline TValue evalFunctorIntegral(const time_t & t1, const time_t & t2, const TFunctor & f, std::false_type /* isPolynomial */) const {
+			return parent_t::template evalFunctorIntegral<TValue>(t1, t2, f);
+		}
+
 		enum IteratorPosition { IteratorPosition_first, IteratorPosition_last, IteratorPosition_end };
 		enum AddOrSet { AddOrSet_add, AddOrSet_set };
 
@@ -9,6 +9,7 @@
 #define NODEDISTRIBUTEDCACHE_HPP_
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <sm/assert_macros.hpp>
 #include <Eigen/Core>
@@ -25,6 +26,11 @@ class CacheInvalidator{
 };
 
 
+/**
+ * Registry of values cached distributed over nodes : every registered slot owns one entry in the per node caches.
+ * Entries are valid until their node handles an update event or the whole cache is invalidated, both in O(1) by comparing stamps.
+ * Concurrent readers are safe, updates and invalidations must not run concurrently with them.
+ */
 template <typename TNode>
 class NodeDistributedCache{
 public:
@@ -36,17 +42,42 @@ public:
 		class PerNodeCacheEntry{
 		public:
 			EIGEN_MAKE_ALIGNED_OPERATOR_NEW
-			void setValid(bool valid);
-			bool isValid();
+			PerNodeCacheEntry() : _node(NULL), _cache(NULL), _slotId(0), _epoch(0), _updateCount(0), _dependencyStamp(0) {}
+			virtual ~PerNodeCacheEntry() {}
+
+			/// \brief marks the entry valid for the current node and cache state and the given stamp of other dependencies (e.g. update counts of other nodes)
+			inline void setValid(bool valid, size_t dependencyStamp = 0){
+				_epoch = valid ? _cache->_epoch : 0;
+				_updateCount = _node->_updateCount;
+				_dependencyStamp = dependencyStamp;
+			}
+			inline bool isValid(size_t dependencyStamp = 0) const {
+				return _epoch == _cache->_epoch && _updateCount == _node->_updateCount && _dependencyStamp == dependencyStamp;
+			}
+		protected:
+			const PerNodeCache * _node;
+		private:
+			const NodeDistributedCache * _cache;
+			size_t _slotId;
+			size_t _epoch, _updateCount, _dependencyStamp;
+			template <typename TValue> friend class NodeCacheSlot;
 		};
 
 		template <typename TValue>
 		class PerNodeCacheValue : public PerNodeCacheEntry {
 			TValue _value;
-			bool _valid;
-			PerNodeCacheValue() : _valid(false){
+			PerNodeCacheValue() {
 			}
 			friend class NodeCacheSlot<TValue>;
+
+			template <typename TFunctor>
+			inline const TValue & getUnlocked(TFunctor && updater, size_t dependencyStamp){
+				if(!this->isValid(dependencyStamp)){
+					updater(_value);
+					this->setValid(true, dependencyStamp);
+				}
+				return _value;
+			}
 		public:
 			EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -54,30 +85,34 @@ public:
 				return _value;
 			}
 
+			/// \brief returns the cached value after updating it with updater(value) if invalid. Safe for concurrent readers of the node.
 			template <typename TFunctor>
-			inline const TValue & get(TFunctor & updater){
-				if(!isValid()){
-					updater(_value);
-					setValid(true);
-				}
-				return _value;
+			inline const TValue & get(TFunctor && updater, size_t dependencyStamp = 0){
+				std::lock_guard<std::mutex> lock(this->_node->_mutex);
+				return getUnlocked(updater, dependencyStamp);
 			}
 
 			inline operator TValue & (){
 				return _value;
 			}
-
-			inline void setValid(bool valid){ _valid = valid; }
-			inline bool isValid(){ return _valid; }
 		};
 
+		PerNodeCache() : _updateCount(0) {}
+		/// the cached values are derived from the node's value : a copied node starts with an empty cache and recomputes them on demand
+		PerNodeCache(const PerNodeCache & /* other */) : _updateCount(0) {}
+		PerNodeCache & operator=(const PerNodeCache & /* other */){
+			handleUpdatedValueEvent();
+			return *this;
+		}
 
-		void handleUpdatedValueEvent(){
-			for(typename std::vector<PerNodeCacheEntry *>::iterator i = entries.begin(), end = entries.end(); i != end; i++){
-
-			}
+		/// invalidates all cached values of this node in O(1). Must be called whenever the node's value changes.
+		inline void handleUpdatedValueEvent(){
+			_updateCount++;
 		}
 
+		/// \brief the number of handled update events. Values derived from other nodes as well can use it as dependency stamp to detect their updates.
+		inline size_t getUpdateCount() const { return _updateCount; }
+
 		~PerNodeCache(){
 			for(typename std::vector<PerNodeCacheEntry *>::iterator i = entries.begin(), end = entries.end(); i != end; i++){
 				if(*i!=NULL)
@@ -86,6 +121,8 @@ public:
 		}
 	private:
 		std::vector<PerNodeCacheEntry *> entries;
+		size_t _updateCount;
+		mutable std::mutex _mutex;
 
 		template <typename TValue> friend class PerNodeCacheValue;
 		template <typename TValue> friend class NodeCacheSlot;
@@ -102,58 +139,94 @@ public:
 	template <typename TValue>
 	class NodeCacheSlot {
 		size_t _index;
+		size_t _id;
 		NodeDistributedCache & _cache;
+		std::shared_ptr<NodeDistributedCache> _cacheOwner;
 
-		NodeCacheSlot(size_t index, NodeDistributedCache & cache) : _index(index), _cache(cache) {}
+		NodeCacheSlot(size_t index, size_t id, NodeDistributedCache & cache, const std::shared_ptr<NodeDistributedCache> & cacheOwner) : _index(index), _id(id), _cache(cache), _cacheOwner(cacheOwner) {}
 
 		friend class NodeDistributedCache<TNode>;
-
+	public:
+		typedef typename PerNodeCache::template PerNodeCacheValue<TValue> CacheValueT;
+	private:
+		inline CacheValueT & accessNodeCacheUnlocked(PerNodeCache & nodeCache){
+			typename PerNodeCache::PerNodeCacheEntry * & pEntry = nodeCache.getEntry(_index);
+			if(pEntry == NULL || pEntry->_slotId != _id){
+				// an entry left behind by a freed slot with the same index may hold a different type
+				delete pEntry;
+				pEntry = new CacheValueT();
+				pEntry->_slotId = _id;
+				pEntry->_node = &nodeCache;
+				pEntry->_cache = &_cache;
+			}
+			return *static_cast<CacheValueT *>(pEntry);
+		}
 	public:
 		~NodeCacheSlot(){
 			_cache.freeIndex(_index);
 		}
-		typedef typename PerNodeCache::template PerNodeCacheValue<TValue> CacheValueT;
 		inline TValue & accessValue(TNode & node){
 			return accessNodeCache(node).accessValue();
 		}
 
 		inline CacheValueT & accessNodeCache(TNode & node){
-			typename PerNodeCache::PerNodeCacheEntry * & pEntry = NodeCacheAccessor<TNode>::accessNodeCache(node).getEntry(_index);
-			if(pEntry == NULL){
-				pEntry = new CacheValueT();
-			}
-			return *static_cast<CacheValueT *>(pEntry);
+			PerNodeCache & nodeCache = NodeCacheAccessor<TNode>::accessNodeCache(node);
+			std::lock_guard<std::mutex> lock(nodeCache._mutex);
+			return accessNodeCacheUnlocked(nodeCache);
+		}
+
+		/// \brief returns node's value of this slot after updating it with updater(value) if invalid (see PerNodeCacheValue::get). Safe for concurrent readers of the node.
+		template <typename TFunctor>
+		inline const TValue & get(TNode & node, TFunctor && updater, size_t dependencyStamp = 0){
+			PerNodeCache & nodeCache = NodeCacheAccessor<TNode>::accessNodeCache(node);
+			std::lock_guard<std::mutex> lock(nodeCache._mutex);
+			return accessNodeCacheUnlocked(nodeCache).getUnlocked(updater, dependencyStamp);
 		}
 	};
 
+	NodeDistributedCache() : _epoch(1), _nextSlotId(1), _numIndices(0) {}
+
 	template <typename TValue>
 	inline std::shared_ptr<NodeCacheSlot<TValue> > registerCacheableValue(){
-		return std::shared_ptr<NodeCacheSlot<TValue> >(new NodeCacheSlot<TValue>(getNextFreeIndex(), *this));
+		std::lock_guard<std::mutex> lock(_registrationMutex);
+		return std::shared_ptr<NodeCacheSlot<TValue> >(new NodeCacheSlot<TValue>(getNextFreeIndex(), _nextSlotId++, *this, std::shared_ptr<NodeDistributedCache>()));
+	}
+
+	/// \brief registers a slot that keeps the shared cache alive as long as it exists
+	template <typename TValue>
+	static inline std::shared_ptr<NodeCacheSlot<TValue> > registerCacheableValue(const std::shared_ptr<NodeDistributedCache> & cache){
+		std::lock_guard<std::mutex> lock(cache->_registrationMutex);
+		return std::shared_ptr<NodeCacheSlot<TValue> >(new NodeCacheSlot<TValue>(cache->getNextFreeIndex(), cache->_nextSlotId++, *cache, cache));
+	}
+
+	/// \brief invalidates the cached values of all nodes in O(1), e.g. after all of them got updated at once
+	inline void invalidateAll(){
+		_epoch++;
 	}
 private:
-	std::vector<bool> slotUsage;
-	int getNextFreeIndex(){
-		//TODO optimize : optimize for continuous usage e.g. by introducing a full up to index
-		int j = 0;
-		for(std::vector<bool>::iterator i = slotUsage.begin(), end = slotUsage.end(); i != end; (i++, j++)){
-			if(!*i){
-				*i = true;
-				return j;
-			}
+	size_t _epoch;
+	size_t _nextSlotId;
+	size_t _numIndices;
+	std::vector<size_t> _freeIndices;
+	std::mutex _registrationMutex;
+
+	size_t getNextFreeIndex(){
+		if(_freeIndices.empty()){
+			return _numIndices++;
 		}
-		slotUsage.push_back(true);
-		return slotUsage.size() - 1;
-	};
+		const size_t index = _freeIndices.back();
+		_freeIndices.pop_back();
+		return index;
+	}
 
-	void freeIndex(int i){
-		SM_ASSERT_TRUE_DBG(std::runtime_error, slotUsage[i], "bug in NodeCacheAccessor!");
-		slotUsage[i] = false;
+	void freeIndex(size_t i){
+		std::lock_guard<std::mutex> lock(_registrationMutex);
+		SM_ASSERT_LT_DBG(std::runtime_error, _freeIndices.size(), _numIndices, "bug in NodeCacheAccessor!");
+		_freeIndices.push_back(i);
 	}
 public:
 	~NodeDistributedCache(){
-		for(std::vector<bool>::iterator i = slotUsage.begin(), end = slotUsage.end(); i != end; i++){
-			SM_ASSERT_FALSE(std::runtime_error, *i, "memory leak : there are still some slots alive when deleting the entire cache!");
-		}
+		SM_ASSERT_EQ(std::runtime_error, _freeIndices.size(), _numIndices, "memory leak : there are still some slots alive when deleting the entire cache!");
 	}
 };
 
@@ -13,7 +13,7 @@
 
 namespace bsplines {
 
-struct NsecTimePolicy : public SimpleTypeTimePolicy<sm::timing::NsecTime> {
+struct NsecTimePolicy : public IntegerTypeTimePolicy<sm::timing::NsecTime> {
 	constexpr inline static sm::timing::NsecTime getOne() {
 		return sm::timing::NsecTime(1E9);
 	}
@@ -9,6 +9,14 @@
 #define NUMERICINTEGRATOR_HPP_
 
 #include <cmath>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <type_traits>
+#include <Eigen/Core>
+#include <sm/assert_macros.hpp>
 
 namespace numeric_integrator {
 	template <typename ValueFactor, typename IntegrationScalar>
@@ -52,7 +60,9 @@ namespace numeric_integrator {
 		template <typename ValueFactor, typename IntegrationScalar>
 		class FixStepSizeIntegrator : public AbstractIntegrator<ValueFactor, IntegrationScalar> {
 		 public:
-			FixStepSizeIntegrator(IntegrationScalar a, IntegrationScalar b, int nIntegrationPoints): AbstractIntegrator<ValueFactor, IntegrationScalar>(a, b, nIntegrationPoints), stepSize((b-a) / this->maxIndex), iIntegrationPoint(0) {}
+			FixStepSizeIntegrator(IntegrationScalar a, IntegrationScalar b, int nIntegrationPoints): AbstractIntegrator<ValueFactor, IntegrationScalar>(a, b, nIntegrationPoints), stepSize((b-a) / this->maxIndex), iIntegrationPoint(0) {
+				SM_ASSERT_TRUE_DBG(std::runtime_error, nIntegrationPoints > 2, "too few integration points given : " << nIntegrationPoints);
+			}
 			inline bool isAtEnd() const { return iIntegrationPoint > this->maxIndex; }
 			inline void next() { ++iIntegrationPoint;}
 			inline IntegrationScalar getIntegrationScalar() const { return (iIntegrationPoint == this->maxIndex) ? this->b : this->a + stepSize * iIntegrationPoint; }
@@ -80,12 +90,442 @@ namespace numeric_integrator {
 		};
 	}
 
+	namespace internal {
+		/**
+		 * Computes the nodes and weights of the n-point Gauss-Legendre rule on [-1, 1] by Newton iteration on the Legendre polynomial P_n.
+		 * It integrates polynomials up to degree 2n - 1 exactly.
+		 */
+		inline void computeGaussLegendreRule(int n, std::vector<double> & nodes, std::vector<double> & weights){
+			nodes.resize(n);
+			weights.resize(n);
+			for(int i = 0; i < (n + 1) / 2; i++){
+				double x = std::cos(M_PI * (i + 0.75) / (n + 0.5)), dp = 0;
+				for(int iteration = 0; iteration < 100; iteration++){
+					double p = 1, pPrev = 0;
+					for(int j = 1; j <= n; j++){
+						const double pPrevPrev = pPrev;
+						pPrev = p;
+						p = ((2 * j - 1) * x * pPrev - (j - 1) * pPrevPrev) / j;
+					}
+					dp = n * (x * p - pPrev) / (x * x - 1);
+					const double dx = p / dp;
+					x -= dx;
+					if(std::fabs(dx) < 1E-15) break;
+				}
+				nodes[i] = -x;
+				nodes[n - 1 - i] = x;
+				weights[i] = weights[n - 1 - i] = 2 / ((1 - x * x) * dp * dp);
+			}
+		}
+
+		/// \brief the number of Gauss-Legendre points required to integrate a polynomial of the given degree exactly
+		inline int getNumberOfGaussLegendrePointsForDegree(int polynomialDegree){
+			return polynomialDegree / 2 + 1;
+		}
+
+		/// \brief nodes and weights of a quadrature rule on [-1, 1]
+		struct QuadratureRule {
+			std::vector<double> nodes, weights;
+		};
+
+		inline std::shared_ptr<const QuadratureRule> createGaussLegendreRule(int n){
+			std::shared_ptr<QuadratureRule> rule(new QuadratureRule());
+			computeGaussLegendreRule(n, rule->nodes, rule->weights);
+			return rule;
+		}
+
+		/**
+		 * The 15-point Kronrod extension of the 7-point Gauss-Legendre rule (QUADPACK's qk15).
+		 * The Gauss points are the odd ones, gaussWeights holds their Gauss-Legendre weights (zero for the Kronrod-only points).
+		 */
+		struct GaussKronrod15Rule : public QuadratureRule {
+			std::vector<double> gaussWeights;
+
+			static const std::shared_ptr<const GaussKronrod15Rule> & get(){
+				static const std::shared_ptr<const GaussKronrod15Rule> rule(new GaussKronrod15Rule());
+				return rule;
+			}
+		private:
+			GaussKronrod15Rule(){
+				const double x[8] = {0.991455371120812639206854697526329, 0.949107912342758524526189684047851, 0.864864423359769072789712788640926, 0.741531185599394439863864773280788, 0.586087235467691130294144845693013, 0.405845151377397166906606412076961, 0.207784955007898467600689403773245, 0};
+				const double wk[8] = {0.022935322010529224963732008058970, 0.063092092629978553290700663189204, 0.104790010322250183839876322541518, 0.140653259715525918745189590510238, 0.169004726639267902826583426598550, 0.190350578064785409913256402421014, 0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+				const double wg[8] = {0, 0.129484966168869693270611432679082, 0, 0.279705391489276667901467771423780, 0, 0.381830050505118944950369775488975, 0, 0.417959183673469387755102040816327};
+				for(int i = 0; i < 15; i++){
+					const int j = i < 8 ? i : 14 - i;
+					nodes.push_back(i < 8 ? -x[j] : x[j]);
+					weights.push_back(wk[j]);
+					gaussWeights.push_back(wg[j]);
+				}
+			}
+		};
+
+		/**
+		 * Applies a quadrature rule on consecutive panels [a + panelBounds[i], a + panelBounds[i + 1]].
+		 * The weights already contain the panel lengths, so the common factor is one.
+		 */
+		template <typename ValueFactor, typename IntegrationScalar>
+		class PanelRuleIntegrator : public AbstractIntegrator<ValueFactor, IntegrationScalar> {
+		 public:
+			PanelRuleIntegrator(IntegrationScalar a, IntegrationScalar b, const std::shared_ptr<const QuadratureRule> & rule, const std::vector<double> & panelBounds) :
+				AbstractIntegrator<ValueFactor, IntegrationScalar>(a, b, rule->nodes.size() * (panelBounds.size() - 1)), rule(rule), panelBounds(panelBounds), iIntegrationPoint(0), iNode(0), iPanel(0) {}
+
+			inline bool isAtEnd() const { return iIntegrationPoint > this->maxIndex; }
+			inline void next() {
+				++iIntegrationPoint;
+				if(++iNode == (int) rule->nodes.size()){
+					iNode = 0;
+					++iPanel;
+				}
+			}
+			inline IntegrationScalar getIntegrationScalar() const {
+				return this->a + (IntegrationScalar)((panelBounds[iPanel] + panelBounds[iPanel + 1] + (panelBounds[iPanel + 1] - panelBounds[iPanel]) * rule->nodes[iNode]) / 2);
+			}
+			inline ValueFactor getValueFactor() const { return rule->weights[iNode] * (panelBounds[iPanel + 1] - panelBounds[iPanel]) / 2; }
+			inline ValueFactor getCommonFactor() const { return 1; }
+			/// \brief the index of the panel containing the current integration point (e.g. the knot segment for the KnotAlignedGaussLegendreRule)
+			inline int getPanelIndex() const { return iPanel; }
+		 protected:
+			std::shared_ptr<const QuadratureRule> rule;
+			std::vector<double> panelBounds;
+			int iIntegrationPoint, iNode, iPanel;
+		};
+
+		/// \brief the bounds of numberOfPanels equally long panels covering [0, length]
+		inline std::vector<double> getEquallySpacedPanelBounds(double length, int numberOfPanels){
+			std::vector<double> bounds(numberOfPanels + 1);
+			for(int i = 0; i <= numberOfPanels; i++) bounds[i] = length * i / numberOfPanels;
+			return bounds;
+		}
+
+		/**
+		 * Composite Gauss-Legendre integrators with IPointsPerPanel points per panel and as many panels as needed to use at least nIntegrationPoints points.
+		 * IPointsPerPanel = 0 uses a single panel with nIntegrationPoints points.
+		 */
+		template <int IPointsPerPanel>
+		struct GaussLegendreRuleIntegrators {
+			template <typename ValueFactor, typename IntegrationScalar>
+			class Integrator : public PanelRuleIntegrator<ValueFactor, IntegrationScalar> {
+			 public:
+				Integrator(IntegrationScalar a, IntegrationScalar b, int nIntegrationPoints) : PanelRuleIntegrator<ValueFactor, IntegrationScalar>(a, b,
+						createGaussLegendreRule(IPointsPerPanel > 0 ? IPointsPerPanel : nIntegrationPoints),
+						getEquallySpacedPanelBounds((double)(b - a), IPointsPerPanel > 0 ? std::max(1, (nIntegrationPoints + IPointsPerPanel - 1) / IPointsPerPanel) : 1)) {}
+			};
+		};
+
+		/// \brief composite Gauss-Kronrod 15 integrator with as many panels as needed to use at least nIntegrationPoints points
+		template <typename ValueFactor, typename IntegrationScalar>
+		class GaussKronrodRuleIntegrator : public PanelRuleIntegrator<ValueFactor, IntegrationScalar> {
+		 public:
+			GaussKronrodRuleIntegrator(IntegrationScalar a, IntegrationScalar b, int nIntegrationPoints) : PanelRuleIntegrator<ValueFactor, IntegrationScalar>(a, b,
+					GaussKronrod15Rule::get(), getEquallySpacedPanelBounds((double)(b - a), std::max(1, (nIntegrationPoints + 14) / 15))) {}
+		};
+
+		inline double getNorm(double value){
+			return std::fabs(value);
+		}
+		template <typename TDerived>
+		inline double getNorm(const Eigen::MatrixBase<TDerived> & value){
+			return value.norm();
+		}
+
+		/**
+		 * Adaptive Gauss-Kronrod 15 quadrature : repeatedly bisects the panel with the largest error estimate |K15 - G7| until the summed estimate is below tolerance or the next bisection would exceed maxNumberOfPoints.
+		 * Returns the integral's estimate and stores the final panel bounds (relative to a) in panelBounds if given.
+		 */
+		template <typename TValue, typename TArgScalar, typename TFunctor>
+		TValue integrateAdaptiveGaussKronrod(TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, int maxNumberOfPoints, const TValue & zero, std::vector<double> * panelBounds = NULL, double * errorEstimate = NULL){
+			struct Panel {
+				double lower, upper, error;
+				TValue value;
+			};
+			const GaussKronrod15Rule & rule = *GaussKronrod15Rule::get();
+			auto evalPanel = [&](Panel & panel){
+				TValue kronrod = zero, gauss = zero;
+				const double halfLength = (panel.upper - panel.lower) / 2, center = (panel.upper + panel.lower) / 2;
+				for(int i = 0; i < 15; i++){
+					const TValue value = f(a + (TArgScalar)(center + halfLength * rule.nodes[i]));
+					kronrod += value * (rule.weights[i] * halfLength);
+					if(rule.gaussWeights[i] != 0) gauss += value * (rule.gaussWeights[i] * halfLength);
+				}
+				panel.value = kronrod;
+				panel.error = getNorm(kronrod - gauss);
+			};
+			auto hasSmallerError = [](const Panel & p1, const Panel & p2){ return p1.error < p2.error; };
+
+			std::vector<Panel, Eigen::aligned_allocator<Panel> > panels(1);
+			panels[0].lower = 0;
+			panels[0].upper = (double)(b - a);
+			evalPanel(panels[0]);
+			double error = panels[0].error;
+			// the panels form a max heap with respect to their error
+			for(int numberOfPoints = 15; error > tolerance && numberOfPoints + 15 <= maxNumberOfPoints; numberOfPoints += 15){
+				std::pop_heap(panels.begin(), panels.end(), hasSmallerError);
+				Panel & worst = panels.back();
+				error -= worst.error;
+				Panel upperHalf;
+				upperHalf.lower = (worst.lower + worst.upper) / 2;
+				upperHalf.upper = worst.upper;
+				worst.upper = upperHalf.lower;
+				evalPanel(worst);
+				evalPanel(upperHalf);
+				error += worst.error + upperHalf.error;
+				std::push_heap(panels.begin(), panels.end(), hasSmallerError);
+				panels.push_back(upperHalf);
+				std::push_heap(panels.begin(), panels.end(), hasSmallerError);
+			}
+
+			TValue sum = zero;
+			for(const Panel & panel : panels) sum += panel.value;
+			if(panelBounds){
+				panelBounds->clear();
+				for(const Panel & panel : panels) panelBounds->push_back(panel.lower);
+				panelBounds->push_back((double)(b - a));
+				std::sort(panelBounds->begin(), panelBounds->end());
+			}
+			if(errorEstimate) *errorEstimate = error;
+			return sum;
+		}
+
+		inline bool isConverged(double error, double tolerance, double relativeTolerance, double norm){
+			return error <= std::max(tolerance, relativeTolerance * norm);
+		}
+
+		/// \brief the weights of the Romberg rule with 2^numberOfLevels + 1 equally spaced points on [-1, 1], obtained by applying the Romberg tableau to the trapezoidal rules' weights
+		inline std::shared_ptr<const QuadratureRule> createRombergRule(int numberOfLevels){
+			std::shared_ptr<QuadratureRule> rule(new QuadratureRule());
+			const int numberOfIntervals = 1 << numberOfLevels;
+			for(int i = 0; i <= numberOfIntervals; i++) rule->nodes.push_back(2. * i / numberOfIntervals - 1);
+
+			std::vector<Eigen::VectorXd> row(1, Eigen::VectorXd::Zero(numberOfIntervals + 1)), previousRow;
+			row[0][0] = row[0][numberOfIntervals] = 1;
+			for(int level = 1; level <= numberOfLevels; level++){
+				previousRow.swap(row);
+				row.resize(level + 1);
+				const int stride = numberOfIntervals >> level;
+				row[0] = previousRow[0] / 2;
+				for(int i = stride; i < numberOfIntervals; i += 2 * stride) row[0][i] = 2. / (1 << level);
+				double factor = 1;
+				for(int j = 1; j <= level; j++){
+					factor *= 4;
+					row[j] = row[j - 1] + (row[j - 1] - previousRow[j - 1]) / (factor - 1);
+				}
+			}
+			rule->weights.assign(row.back().data(), row.back().data() + numberOfIntervals + 1);
+			return rule;
+		}
+
+		/**
+		 * Romberg integration : halves the trapezoidal step size (reusing all previous points) and Richardson extrapolates until the difference of the two last diagonal entries of the tableau is below max(tolerance, relativeTolerance * |integral|)
+		 * or the next level would exceed maxNumberOfPoints.
+		 */
+		template <typename TValue, typename TArgScalar, typename TFunctor>
+		TValue integrateRomberg(TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, double relativeTolerance, int maxNumberOfPoints, const TValue & zero, double * errorEstimate = NULL){
+			enum { MinNumberOfLevels = 2 };
+			const double length = (double)(b - a);
+			std::vector<TValue, Eigen::aligned_allocator<TValue> > row(1, (f(a) + f(b)) * (length / 2)), previousRow;
+			double error = std::numeric_limits<double>::infinity();
+			for(int level = 1, numberOfPoints = 2; numberOfPoints + (1 << (level - 1)) <= maxNumberOfPoints; level++){
+				const int numberOfNewPoints = 1 << (level - 1);
+				const double stepSize = length / (2 * numberOfNewPoints);
+				TValue sum = zero;
+				for(int i = 0; i < numberOfNewPoints; i++) sum += f(a + (TArgScalar)(stepSize * (2 * i + 1)));
+				numberOfPoints += numberOfNewPoints;
+
+				previousRow.swap(row);
+				row.resize(level + 1);
+				row[0] = previousRow[0] * 0.5 + sum * stepSize;
+				double factor = 1;
+				for(int j = 1; j <= level; j++){
+					factor *= 4;
+					row[j] = row[j - 1] + (row[j - 1] - previousRow[j - 1]) * (1 / (factor - 1));
+				}
+				error = getNorm(row[level] - previousRow[level - 1]);
+				if(level >= MinNumberOfLevels && isConverged(error, tolerance, relativeTolerance, getNorm(row[level]))) break;
+			}
+			if(errorEstimate) *errorEstimate = error;
+			return row.back();
+		}
+
+		/**
+		 * Node x(t) = tanh(pi / 2 * sinh(t)) and weight x'(t) of the tanh-sinh substitution. The node is returned as its distance 1 - |x(t)| to the nearer bound, which stays accurate where x(t) rounds to +-1.
+		 */
+		inline void getTanhSinhNodeComplementAndWeight(double t, double & nodeComplement, double & weight){
+			const double u = M_PI / 2 * std::sinh(std::fabs(t)), coshU = std::cosh(u);
+			nodeComplement = 1 / (std::exp(u) * coshU);
+			weight = M_PI / 2 * std::cosh(t) / (coshU * coshU);
+		}
+
+		/// \brief the tanh-sinh rule on [-1, 1] with n = 2 * N + 1 points, i.e. the trapezoidal rule on N steps of the substitution's parameter on each side
+		inline std::shared_ptr<const QuadratureRule> createTanhSinhRule(int n){
+			// beyond 3 the weights are below 1E-12 and the nodes hardly distinguishable from +-1
+			const double parameterBound = 3;
+			std::shared_ptr<QuadratureRule> rule(new QuadratureRule());
+			const int N = std::max(1, (n - 1) / 2);
+			const double stepSize = parameterBound / N;
+			rule->nodes.resize(2 * N + 1);
+			rule->weights.resize(2 * N + 1);
+			for(int k = 0; k <= N; k++){
+				double nodeComplement, weight;
+				getTanhSinhNodeComplementAndWeight(k * stepSize, nodeComplement, weight);
+				rule->nodes[N + k] = 1 - nodeComplement;
+				rule->nodes[N - k] = nodeComplement - 1;
+				rule->weights[N + k] = rule->weights[N - k] = weight * stepSize;
+			}
+			return rule;
+		}
+
+		/**
+		 * Tanh-sinh (double exponential) integration : halves the step size in the substitution's parameter (reusing all previous points) until the difference of two consecutive estimates is below max(tolerance, relativeTolerance * |integral|)
+		 * or the next level would exceed maxNumberOfPoints. It converges exponentially also for integrands with endpoint singularities, which are never evaluated at the bounds themselves.
+		 * Nodes closer to a bound than its floating point resolution are skipped, which limits the accuracy for singular integrands to about the integral over that last ulp (e.g. 3E-8 for 1 / sqrt(1 - x) on [0, 1]).
+		 */
+		template <typename TValue, typename TArgScalar, typename TFunctor>
+		TValue integrateTanhSinh(TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, double relativeTolerance, int maxNumberOfPoints, const TValue & zero, double * errorEstimate = NULL){
+			enum { MinNumberOfLevels = 1 };
+			// the weights fall below 1E-35 at 4 and the nodes' distance to the bounds below 1E-37
+			const double parameterBound = 4;
+			const double halfLength = (double)(b - a) / 2;
+			// each node is offset from its nearer bound; nodes whose offset is below the bound's resolution would round onto it and are dropped (their weight is negligible)
+			auto evalPair = [&](double t) -> TValue {
+				double nodeComplement, weight;
+				getTanhSinhNodeComplementAndWeight(t, nodeComplement, weight);
+				const TArgScalar offset = (TArgScalar)(halfLength * nodeComplement);
+				const TArgScalar lower = a + offset, upper = b - offset;
+				TValue value = zero;
+				if(lower != a) value += f(lower);
+				if(upper != b) value += f(upper);
+				return value * weight;
+			};
+			int N = 8;
+			double stepSize = parameterBound / N;
+
+			double nodeComplement, weight;
+			getTanhSinhNodeComplementAndWeight(0, nodeComplement, weight);
+			TValue sum = f(a + (TArgScalar)halfLength) * weight;
+			for(int k = 1; k <= N; k++) sum += evalPair(k * stepSize);
+			TValue value = sum * (stepSize * halfLength);
+
+			double error = std::numeric_limits<double>::infinity();
+			for(int level = 1, numberOfPoints = 2 * N + 1; numberOfPoints + 2 * N <= maxNumberOfPoints; level++){
+				numberOfPoints += 2 * N;
+				N *= 2;
+				stepSize /= 2;
+				for(int k = 1; k <= N; k += 2) sum += evalPair(k * stepSize);
+				TValue refinedValue = sum * (stepSize * halfLength);
+				error = getNorm(refinedValue - value);
+				value = refinedValue;
+				if(level >= MinNumberOfLevels && isConverged(error, tolerance, relativeTolerance, getNorm(value))) break;
+			}
+			if(errorEstimate) *errorEstimate = error;
+			return value;
+		}
+
+		/// \brief single panel integrator with the rule created by TRuleFactory(nIntegrationPoints)
+		template <std::shared_ptr<const QuadratureRule> (*TRuleFactory)(int)>
+		struct SinglePanelRuleIntegrators {
+			template <typename ValueFactor, typename IntegrationScalar>
+			class Integrator : public PanelRuleIntegrator<ValueFactor, IntegrationScalar> {
+			 public:
+				Integrator(IntegrationScalar a, IntegrationScalar b, int nIntegrationPoints) : PanelRuleIntegrator<ValueFactor, IntegrationScalar>(a, b, TRuleFactory(nIntegrationPoints), getEquallySpacedPanelBounds((double)(b - a), 1)) {}
+			};
+		};
+
+		/// \brief the largest Romberg rule with at most nIntegrationPoints points (but at least 3)
+		inline std::shared_ptr<const QuadratureRule> createRombergRuleForPoints(int nIntegrationPoints){
+			int numberOfLevels = 1;
+			while((1 << (numberOfLevels + 1)) + 1 <= nIntegrationPoints) numberOfLevels++;
+			return createRombergRule(numberOfLevels);
+		}
+	}
+
 	namespace algorithms {
 		class SimpsonRule : public IntegrationAlgorithm<SimpsonRule, internal::SimpsonRuleIntegrator> {
 		};
 		class TrapezoidalRule : public IntegrationAlgorithm<TrapezoidalRule, internal::TrapezoidalRuleIntegrator> {
 		};
 
+		/**
+		 * Gauss-Legendre rule with nIntegrationPoints points (integrating polynomials of degree up to 2 * nIntegrationPoints - 1 exactly)
+		 * or, if IPointsPerPanel > 0, composite rule of as many IPointsPerPanel point rules on equally long panels as needed to use at least nIntegrationPoints points.
+		 */
+		template <int IPointsPerPanel = 0>
+		class GaussLegendreRule : public IntegrationAlgorithm<GaussLegendreRule<IPointsPerPanel>, internal::GaussLegendreRuleIntegrators<IPointsPerPanel>::template Integrator> {
+		};
+
+		/// \brief composite Gauss-Kronrod 15 rule on equally long panels (see integrateFunctorAdaptive for the adaptive version)
+		class GaussKronrodRule : public IntegrationAlgorithm<GaussKronrodRule, internal::GaussKronrodRuleIntegrator> {
+		};
+
+		/**
+		 * Adaptive Gauss-Kronrod 15 rule : the panels are found by adaptively integrating the scalar guide function, e.g. the squared norm of an error term at the current estimate.
+		 * getIntegrator's nIntegrationPoints limits the number of points.
+		 * This algorithm has state, so it must be used through the functions taking an algorithm instance.
+		 */
+		template <typename TGuide>
+		class AdaptiveGaussKronrodRule {
+		 public:
+			AdaptiveGaussKronrodRule(const TGuide & guide, double tolerance) : _guide(guide), _tolerance(tolerance) {}
+
+			template <typename ValueFactor, typename IntegrationScalar>
+			internal::PanelRuleIntegrator<ValueFactor, IntegrationScalar> getIntegrator(IntegrationScalar a, IntegrationScalar b, int nIntegrationPoints) const
+			{
+				std::vector<double> panelBounds;
+				internal::integrateAdaptiveGaussKronrod<double>(a, b, _guide, _tolerance, nIntegrationPoints, 0., &panelBounds);
+				return internal::PanelRuleIntegrator<ValueFactor, IntegrationScalar>(a, b, internal::GaussKronrod15Rule::get(), panelBounds);
+			}
+		 private:
+			TGuide _guide;
+			double _tolerance;
+		};
+
+		template <typename TGuide>
+		inline AdaptiveGaussKronrodRule<TGuide> createAdaptiveGaussKronrodRule(const TGuide & guide, double tolerance){
+			return AdaptiveGaussKronrodRule<TGuide>(guide, tolerance);
+		}
+
+		/**
+		 * Gauss-Legendre rule applied per segment of a knot sequence (e.g. a spline's), so that no integration point straddles a knot where spline integrands lose smoothness.
+		 * getIntegrator's nIntegrationPoints is the number of points per segment. It integrates integrands being polynomials of degree up to 2 * nIntegrationPoints - 1 on each segment exactly (see internal::getNumberOfGaussLegendrePointsForDegree).
+		 * This algorithm has state, so it must be used through the functions taking an algorithm instance.
+		 */
+		template <typename TKnot = double>
+		class KnotAlignedGaussLegendreRule {
+		 public:
+			/// \brief knots must be sorted ascending
+			KnotAlignedGaussLegendreRule(const std::vector<TKnot> & knots) : _knots(knots) {}
+
+			template <typename ValueFactor, typename IntegrationScalar>
+			internal::PanelRuleIntegrator<ValueFactor, IntegrationScalar> getIntegrator(IntegrationScalar a, IntegrationScalar b, int nIntegrationPoints) const
+			{
+				const bool reversed = b < a;
+				const IntegrationScalar lower = reversed ? b : a, upper = reversed ? a : b;
+				std::vector<double> panelBounds(1, 0.);
+				for(typename std::vector<TKnot>::const_iterator it = std::upper_bound(_knots.begin(), _knots.end(), lower), end = _knots.end(); it != end && *it < upper; ++it){
+					panelBounds.push_back((double)(*it - lower));
+				}
+				panelBounds.push_back((double)(upper - lower));
+				if(reversed){
+					// integrate from a down to b
+					const double length = panelBounds.back();
+					for(double & bound : panelBounds) bound -= length;
+					std::reverse(panelBounds.begin(), panelBounds.end());
+				}
+				return internal::PanelRuleIntegrator<ValueFactor, IntegrationScalar>(a, b, internal::createGaussLegendreRule(nIntegrationPoints), panelBounds);
+			}
+
+			const std::vector<TKnot> & getKnots() const { return _knots; }
+		 private:
+			std::vector<TKnot> _knots;
+		};
+
+		/// \brief Romberg rule on the largest 2^k + 1 equally spaced points not exceeding nIntegrationPoints (see integrateFunctorToTolerance for the version with error estimate)
+		class RombergRule : public IntegrationAlgorithm<RombergRule, internal::SinglePanelRuleIntegrators<internal::createRombergRuleForPoints>::template Integrator> {
+		};
+
+		/// \brief tanh-sinh (double exponential) rule with nIntegrationPoints points, suited for integrands with endpoint singularities (see integrateFunctorToTolerance for the version with error estimate)
+		class TanhSinhRule : public IntegrationAlgorithm<TanhSinhRule, internal::SinglePanelRuleIntegrators<internal::createTanhSinhRule>::template Integrator> {
+		};
+
 		typedef SimpsonRule Default;
 	}
 	typedef algorithms::Default DefaultAlgorithm;
@@ -113,79 +553,150 @@ namespace numeric_integrator {
 		return Integrand<TValue, TArgScalar>(integrand);
 	}
 
-//	enum Algorithm {
-//		TRAPEZOIDAL,
-//		SIMPSON,
-//		TANH1,
-//		TANH3,
-//		TANH5,
-//		TANH_SINH,
-//		DEFAULT = SIMPSON
-//	};
-
 	namespace internal {
-		template <typename TValue, int IExponent, typename TArgScalar, typename TFunctor>
-		inline TValue tanhFunctor(const TFunctor & f, TArgScalar pos, TArgScalar mean, TArgScalar diffHalf){
-			const double posPowExp = IExponent == 1 ? pos : pow(pos, IExponent);
-			double ch = cosh(posPowExp);
-			if(IExponent == 1)
-				return f((TArgScalar)(diffHalf * tanh(posPowExp) + mean)) / ch * ch;
-			else
-				return f((TArgScalar)(diffHalf * tanh(posPowExp) + mean)) * IExponent * posPowExp / (pos * ch * ch);
+		/**
+		 * Integrands may evaluate all integration points in one call by providing
+		 *   void evalBatch(const std::vector<TArgScalar> & points, std::vector<TValue, Eigen::aligned_allocator<TValue> > & values) const;
+		 * which resizes values to points.size(). The points are sorted (descending if b < a). integrateFunctor uses it automatically.
+		 */
+		template <typename TFunctor, typename TArgScalar, typename TValue, typename TEnable = void>
+		struct HasEvalBatch : public std::false_type {
+		};
+
+		template <typename TFunctor, typename TArgScalar, typename TValue>
+		struct HasEvalBatch<TFunctor, TArgScalar, TValue, decltype(std::declval<const TFunctor &>().evalBatch(std::declval<const std::vector<TArgScalar> &>(), std::declval<std::vector<TValue, Eigen::aligned_allocator<TValue> > &>()))> : public std::true_type {
+		};
+
+		template <typename TValue, typename TIntegrator, typename TFunctor>
+		inline TValue sumUp(TIntegrator & integrator, const TFunctor & f, std::false_type /* hasEvalBatch */){
+			TValue sum = f(integrator.getIntegrationScalar()) * integrator.getValueFactor();
+			integrator.next();
+
+			for(; !integrator.isAtEnd(); integrator.next()){
+				double valueFactor = integrator.getValueFactor();
+				if(valueFactor == 1)
+					sum += f(integrator.getIntegrationScalar());
+				else
+					sum += f(integrator.getIntegrationScalar()) * valueFactor;
+			}
+			return sum;
+		}
+
+		template <typename TValue, typename TIntegrator, typename TFunctor>
+		inline TValue sumUp(TIntegrator & integrator, const TFunctor & f, std::true_type /* hasEvalBatch */){
+			std::vector<decltype(integrator.getIntegrationScalar())> points;
+			std::vector<double> valueFactors;
+			points.reserve(integrator.getNIntegrationPoints());
+			valueFactors.reserve(integrator.getNIntegrationPoints());
+			for(; !integrator.isAtEnd(); integrator.next()){
+				points.push_back(integrator.getIntegrationScalar());
+				valueFactors.push_back(integrator.getValueFactor());
+			}
+
+			std::vector<TValue, Eigen::aligned_allocator<TValue> > values;
+			f.evalBatch(points, values);
+			SM_ASSERT_EQ_DBG(std::runtime_error, values.size(), points.size(), "evalBatch must return one value per point");
+
+			TValue sum = values[0] * valueFactors[0];
+			for(size_t i = 1; i < values.size(); i++){
+				if(valueFactors[i] == 1)
+					sum += values[i];
+				else
+					sum += values[i] * valueFactors[i];
+			}
+			return sum;
 		}
 	}
 
 	//TODO allow integration according to arbitrary TimePolicy
 	template <typename Algorithm, typename TValue, typename TArgScalar, typename TFunctor>
-	inline TValue integrateFunctor(TArgScalar a, TArgScalar b, const TFunctor & f, int numberOfPoints, TValue zero = TValue(0)){
+	inline TValue integrateFunctor(const Algorithm & algorithm, TArgScalar a, TArgScalar b, const TFunctor & f, int numberOfPoints, TValue zero = TValue(0)){
 		if(a == b) return zero;
 
-		auto integrator = Algorithm().template getIntegrator<double>(a, b, numberOfPoints);
-
-		SM_ASSERT_TRUE_DBG(std::runtime_error, numberOfPoints>2 && !integrator.isAtEnd(), "too few integration points given : " << numberOfPoints);
+		auto integrator = algorithm.template getIntegrator<double>(a, b, numberOfPoints);
 
-		TValue sum = f(integrator.getIntegrationScalar()) * integrator.getValueFactor();
-		integrator.next();
+		SM_ASSERT_TRUE_DBG(std::runtime_error, numberOfPoints>0 && !integrator.isAtEnd(), "too few integration points given : " << numberOfPoints);
 
-		for(; !integrator.isAtEnd(); integrator.next()){
-			double valueFactor = integrator.getValueFactor();
-			if(valueFactor == 1)
-				sum += f(integrator.getIntegrationScalar());
-			else
-				sum += f(integrator.getIntegrationScalar()) * valueFactor;
-		}
+		const TValue sum = internal::sumUp<TValue>(integrator, f, internal::HasEvalBatch<TFunctor, TArgScalar, TValue>());
 		return sum * integrator.getCommonFactor();
-
-// TODO implement TANH* stuff
-//		TArgScalar diff = b-a, stepSize = diff / (numberOfPoints - 1);
-//		if(diff == 0) return zero;
-//
-//		switch(EAlgorithm){
-//		case TANH1:
-//		case TANH3:
-//		case TANH5:
-//			throw std::runtime_error("TANHX integration scheme not supported yet");
-//			{
-//				const double diffHalf = diff /2.;
-//				const double mean = 0.5 * (a+b);
-//				const int exponent = 2 * (EAlgorithm - TANH1) + 1;
-//				TValue sum = internal::tanhFunctor<TValue, exponent>(f, (TArgScalar)0, mean, diffHalf);
-//
-//				for(int i = numberOfPoints / 2, end = numberOfPoints / 2; i <= end; i++){
-//					sum += internal::tanhFunctor<TValue, exponent>(f, (TArgScalar) i, mean, diffHalf);
-//				}
-//				return sum / diffHalf;
-//			}
-//		case TANH_SINH:
-//			throw std::runtime_error("TANH_SINH integration scheme not supported yet");
-//			break;
-//		}
+	}
+	template <typename Algorithm, typename TValue, typename TArgScalar, typename TFunctor>
+	inline TValue integrateFunctor(TArgScalar a, TArgScalar b, const TFunctor & f, int numberOfPoints, TValue zero = TValue(0)){
+		return integrateFunctor<Algorithm, TValue>(Algorithm(), a, b, f, numberOfPoints, zero);
 	}
 	template <typename TValue, typename TArgScalar, typename TFunctor>
 	inline TValue integrateFunctor(TArgScalar a, TArgScalar b, const TFunctor & f, int numberOfPoints, TValue zero = TValue(0)){
 		return integrateFunctor<algorithms::Default> (a, b, f, numberOfPoints, zero);
 	}
 
+	/**
+	 * Integrates f over [a, b] with the adaptive Gauss-Kronrod 15 quadrature until the error estimate is below tolerance or maxNumberOfPoints is reached.
+	 * @param errorEstimate if given receives the final error estimate
+	 */
+	template <typename TValue, typename TArgScalar, typename TFunctor>
+	inline TValue integrateFunctorAdaptive(TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, int maxNumberOfPoints = 1000, TValue zero = TValue(0), double * errorEstimate = NULL){
+		if(a == b) return zero;
+		if(b < a) return -integrateFunctorAdaptive<TValue>(b, a, f, tolerance, maxNumberOfPoints, zero, errorEstimate);
+		return internal::integrateAdaptiveGaussKronrod<TValue>(a, b, f, tolerance, maxNumberOfPoints, zero, NULL, errorEstimate);
+	}
+
+	namespace internal {
+		/// \brief integrates to a tolerance with Algorithm by doubling the number of points until two consecutive results agree; specialized for algorithms refining progressively
+		template <typename Algorithm>
+		struct ToleranceIntegration {
+			template <typename TValue, typename TArgScalar, typename TFunctor>
+			static TValue integrate(const Algorithm & algorithm, TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, double relativeTolerance, int maxNumberOfPoints, const TValue & zero, double * errorEstimate){
+				int numberOfPoints = 9;
+				TValue value = integrateFunctor<Algorithm, TValue>(algorithm, a, b, f, numberOfPoints, zero);
+				double error = std::numeric_limits<double>::infinity();
+				while(2 * numberOfPoints - 1 <= maxNumberOfPoints){
+					numberOfPoints = 2 * numberOfPoints - 1;
+					TValue refinedValue = integrateFunctor<Algorithm, TValue>(algorithm, a, b, f, numberOfPoints, zero);
+					error = getNorm(refinedValue - value);
+					value = refinedValue;
+					if(isConverged(error, tolerance, relativeTolerance, getNorm(value))) break;
+				}
+				if(errorEstimate) *errorEstimate = error;
+				return value;
+			}
+		};
+
+		template <>
+		struct ToleranceIntegration<algorithms::RombergRule> {
+			template <typename TValue, typename TArgScalar, typename TFunctor>
+			static TValue integrate(const algorithms::RombergRule & /* algorithm */, TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, double relativeTolerance, int maxNumberOfPoints, const TValue & zero, double * errorEstimate){
+				return integrateRomberg<TValue>(a, b, f, tolerance, relativeTolerance, maxNumberOfPoints, zero, errorEstimate);
+			}
+		};
+
+		template <>
+		struct ToleranceIntegration<algorithms::TanhSinhRule> {
+			template <typename TValue, typename TArgScalar, typename TFunctor>
+			static TValue integrate(const algorithms::TanhSinhRule & /* algorithm */, TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, double relativeTolerance, int maxNumberOfPoints, const TValue & zero, double * errorEstimate){
+				return integrateTanhSinh<TValue>(a, b, f, tolerance, relativeTolerance, maxNumberOfPoints, zero, errorEstimate);
+			}
+		};
+	}
+
+	/**
+	 * Integrates f over [a, b] with the given algorithm, refining until the error estimate is below max(tolerance, relativeTolerance * |integral|) or maxNumberOfPoints would be exceeded.
+	 * Romberg and tanh-sinh refine progressively, reusing all previous points. Other algorithms are rerun with twice the number of points.
+	 * @param errorEstimate if given receives the final error estimate (the difference of the last two estimates)
+	 */
+	template <typename Algorithm, typename TValue, typename TArgScalar, typename TFunctor>
+	inline TValue integrateFunctorToTolerance(const Algorithm & algorithm, TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, double relativeTolerance = 0, int maxNumberOfPoints = 1025, TValue zero = TValue(0), double * errorEstimate = NULL){
+		if(a == b){
+			if(errorEstimate) *errorEstimate = 0;
+			return zero;
+		}
+		if(b < a) return -integrateFunctorToTolerance<Algorithm, TValue>(algorithm, b, a, f, tolerance, relativeTolerance, maxNumberOfPoints, zero, errorEstimate);
+		return internal::ToleranceIntegration<Algorithm>::template integrate<TValue>(algorithm, a, b, f, tolerance, relativeTolerance, maxNumberOfPoints, zero, errorEstimate);
+	}
+	template <typename Algorithm, typename TValue, typename TArgScalar, typename TFunctor>
+	inline TValue integrateFunctorToTolerance(TArgScalar a, TArgScalar b, const TFunctor & f, double tolerance, double relativeTolerance = 0, int maxNumberOfPoints = 1025, TValue zero = TValue(0), double * errorEstimate = NULL){
+		return integrateFunctorToTolerance<Algorithm, TValue>(Algorithm(), a, b, f, tolerance, relativeTolerance, maxNumberOfPoints, zero, errorEstimate);
+	}
+
 	template <typename Algorithm, typename TValue, typename TArgScalar>
 	inline TValue integrateFunction(TArgScalar a, TArgScalar b, TValue (& integrand)(const TArgScalar & t), int numberOfPoints, TValue zero = TValue(0)){
 		return integrateFunctor<Algorithm>(a, b, createIntegrand(integrand), numberOfPoints, zero);
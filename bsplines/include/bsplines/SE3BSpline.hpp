@@ -0,0 +1,119 @@
+/*
+ * SE3BSpline.hpp
+ *
+ *  Cumulative B-spline on the rigid body transformations (see manifolds::SE3Manifold).
+ *  One segment lookup yields the pose, its time derivatives and the body twist together with their Jacobians.
+ */
+
+#ifndef SE3BSPLINE_HPP_
+#define SE3BSPLINE_HPP_
+
+#include <array>
+#include "manifolds/SE3Manifold.hpp"
+#include "DiffManifoldBSpline.hpp"
+
+namespace bsplines {
+	template <typename TDiffManifoldConfiguration = manifolds::SE3ManifoldConf<>, int ISplineOrder = Eigen::Dynamic, typename TTimePolicy = DefaultTimePolicy>
+	struct SE3BSplineConfiguration : public DiffManifoldBSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy> {
+	public:
+		typedef DiffManifoldBSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy> ParentConf;
+		typedef SE3BSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy> Conf;
+		typedef TDiffManifoldConfiguration ManifoldConf;
+		typedef DiffManifoldBSpline<Conf> BSpline;
+
+		SE3BSplineConfiguration(TDiffManifoldConfiguration manifoldConfiguration = TDiffManifoldConfiguration(), int splineOrder = ISplineOrder) : ParentConf(manifoldConfiguration, splineOrder) {}
+		SE3BSplineConfiguration(int splineOrder) : ParentConf(TDiffManifoldConfiguration(), splineOrder) {}
+	};
+
+	namespace internal {
+		template <typename TDiffManifoldConfiguration, int ISplineOrder, typename TTimePolicy>
+		struct DiffManifoldBSplineTraits<SE3BSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy> > {
+			enum { NeedsCumulativeBasisMatrices = true };
+		};
+	}
+
+	template <typename TDiffManifoldConfiguration, int ISplineOrder, typename TTimePolicy, typename TConfigurationDerived>
+	class DiffManifoldBSpline<SE3BSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy>, TConfigurationDerived> : public DiffManifoldBSpline<typename SE3BSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy>::ParentConf, TConfigurationDerived> {
+		typedef DiffManifoldBSpline<typename SE3BSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy>::ParentConf, TConfigurationDerived> parent_t;
+	public:
+		typedef typename parent_t::configuration_t configuration_t;
+		typedef typename parent_t::spline_t spline_t;
+		typedef typename parent_t::manifold_t manifold_t;
+		typedef typename parent_t::time_t time_t;
+		typedef typename parent_t::point_t point_t;
+		typedef typename parent_t::tangent_vector_t tangent_vector_t;
+		typedef typename parent_t::dmatrix_t dmatrix_t;
+		typedef typename parent_t::full_jacobian_t full_jacobian_t;
+		typedef typename parent_t::SplineOrderVector SplineOrderVector;
+		typedef typename parent_t::SegmentMapConstIterator SegmentMapConstIterator;
+		typedef typename parent_t::SegmentConstIterator SegmentConstIterator;
+		typedef typename manifold_t::transformation_matrix_t transformation_matrix_t;
+		/// body twist [angular velocity; linear velocity], both expressed in the moving frame
+		typedef tangent_vector_t twist_t;
+		typedef Eigen::Matrix<double, configuration_t::Dimension::VALUE, multiplyEigenSize(configuration_t::Dimension::VALUE, ISplineOrder) > twist_jacobian_t;
+
+		SM_DEFINE_EXCEPTION(Exception, std::runtime_error);
+
+		enum {
+			MaxSupportedDerivativeOrderEvaluation = 2,
+			MaxSupportedDerivativeOrderJacobian = 2
+		};
+
+		DiffManifoldBSpline(int splineOrder = parent_t::SplineOrder) : parent_t(SE3BSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy>(typename configuration_t::ManifoldConf(), splineOrder)){}
+		DiffManifoldBSpline(const configuration_t & conf) : parent_t(conf){}
+
+	public:
+		template<int IMaximalDerivativeOrder>
+		class Evaluator : public parent_t::template Evaluator<IMaximalDerivativeOrder> {
+		public :
+			Evaluator(const spline_t & spline, const time_t & t);
+			Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt);
+
+			/// the derivativeOrder's time derivative of the point coordinates [q; t]
+			point_t evalD(int derivativeOrder) const;
+
+			/// the pose as homogeneous transformation matrix
+			transformation_matrix_t evalTransformation() const;
+
+			twist_t evalTwist() const;
+			/// the time derivative of the body twist (needs IMaximalDerivativeOrder >= 2)
+			twist_t evalTwistDerivative() const;
+
+			/// the Jacobian of evalD(derivativeOrder) with respect to the tangent space updates of the control vertices
+			void evalJacobian(int derivativeOrder, full_jacobian_t & jacobian) const;
+			void evalJacobian(full_jacobian_t & jacobian) const;
+
+			void evalTwistJacobian(twist_jacobian_t & jacobian) const;
+		private:
+			typedef Eigen::Matrix4d matrix_t;
+			/// a transformation matrix and its first MaxSupportedDerivativeOrderEvaluation time derivatives
+			typedef std::array<matrix_t, MaxSupportedDerivativeOrderEvaluation + 1> jet_t;
+			typedef std::vector<jet_t, Eigen::aligned_allocator<jet_t> > jet_vector_t;
+			struct CalculationCache;
+
+			inline int getNumVectors() const;
+			static void multiplyJets(const jet_t & a, const jet_t & b, int maxDerivativeOrder, jet_t & result);
+			static point_t getPointDerivative(const CalculationCache & cache, int derivativeOrder);
+			static point_t getPointDerivativeVariation(const CalculationCache & cache, int derivativeOrder, const jet_t & variation);
+			static twist_t getTwistVariation(const CalculationCache & cache, const jet_t & variation);
+		};
+
+		template<int IMaximalDerivativeOrder>
+		inline Evaluator<IMaximalDerivativeOrder> getEvaluatorAt(const time_t & t) const { return parent_t::template getEvaluatorAt<IMaximalDerivativeOrder>(t); }
+	};
+
+
+	template <int ISplineOrder = Eigen::Dynamic, typename TTimePolicy = DefaultTimePolicy, typename TScalar = double>
+#if __cplusplus >= 201103L
+	using SE3BSpline = typename SE3BSplineConfiguration<manifolds::SE3ManifoldConf<TScalar>, ISplineOrder, TTimePolicy>::BSpline;
+#else
+	class SE3BSpline {
+	public:
+		typedef SE3BSplineConfiguration<manifolds::SE3ManifoldConf<TScalar>, ISplineOrder, TTimePolicy> CONF;
+		typedef typename CONF::BSpline TYPE;
+	};
+#endif
+}
+
+#include "implementation/SE3BSplineImpl.hpp"
+#endif /* SE3BSPLINE_HPP_ */
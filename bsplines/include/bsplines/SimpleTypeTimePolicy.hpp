@@ -10,6 +10,7 @@
 
 #include <cmath>
 #include <cassert>
+#include <type_traits>
 
 namespace bsplines {
 	template <typename SimpleType_>
@@ -44,7 +45,7 @@ namespace bsplines {
 			// For example with nanoseconds as signed 64 bit integers this holds if 
 			// duration * segments = duration * duration / T <= ~9.22e9 seconds. // where T is the uniform knot distance.
 			// I.e. for 1000s the maximum supported knot rate is around 9kHz.
-			// TODO increase the maximal supported duration^2 * knotFreq.
+			// For integral time types use IntegerTypeTimePolicy below, which has no such limit.
 			return ((t - from) * segments) / duration;
 		}
 
@@ -58,6 +59,43 @@ namespace bsplines {
 		}
 	};
 
+	/**
+	 * A time policy for integral time types (e.g. nanoseconds) whose uniform knot arithmetic is exact and never forms the product duration * segments.
+	 * The knot offsets floor(duration * pos / segments) are computed as width * pos + (remainder * pos) / segments with width = duration / segments and remainder = duration % segments < segments,
+	 * and getSegmentNumber corrects a floating point estimate by at most a few steps of this exact knot function.
+	 * Hence it works for any duration representable in time_t with up to std::numeric_limits<int>::max() segments.
+	 */
+	template <typename Integer_>
+	struct IntegerTypeTimePolicy : public SimpleTypeTimePolicy<Integer_> {
+		static_assert(std::is_integral<Integer_>::value, "IntegerTypeTimePolicy requires an integral time type");
+		typedef SimpleTypeTimePolicy<Integer_> parent_t;
+		typedef typename parent_t::time_t time_t;
+		typedef typename parent_t::duration_t duration_t;
+
+		/// \brief exact floor(duration * pos / segments) for 0 <= pos <= segments without intermediate overflow
+		inline static duration_t getUniformKnotOffset(duration_t duration, int segments, int pos)
+		{
+			const duration_t width = duration / segments, remainder = duration % segments;
+			return width * pos + (remainder * pos) / segments;
+		}
+
+		inline static time_t linearlyInterpolate(time_t from, time_t till, int segments, int pos)
+		{
+			if(pos == segments) return till;
+			return from + getUniformKnotOffset(parent_t::computeDuration(from, till), segments, pos);
+		}
+
+		/// \brief returns the largest segment index k such that linearlyInterpolate(from, till, segments, k) <= t
+		inline static int getSegmentNumber(time_t from, time_t till, int segments, time_t t)
+		{
+			const duration_t duration = parent_t::computeDuration(from, till), d = parent_t::computeDuration(from, t);
+			int k = (int) std::floor((long double) d * segments / duration);
+			while(getUniformKnotOffset(duration, segments, k) > d) --k;
+			while(getUniformKnotOffset(duration, segments, k + 1) <= d) ++k;
+			return k;
+		}
+	};
+
 } // namespace bsplines
 
 #endif /* SIMPLETYPETIMEPOLICY_HPP_ */
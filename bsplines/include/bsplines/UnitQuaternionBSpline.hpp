@@ -45,6 +45,7 @@ namespace bsplines {
 		typedef typename parent_t::full_jacobian_t full_jacobian_t;
 		typedef typename parent_t::SplineOrderVector SplineOrderVector;
 		typedef typename parent_t::SegmentMapConstIterator SegmentMapConstIterator;
+		typedef typename parent_t::SegmentConstIterator SegmentConstIterator;
 		typedef Eigen::Matrix<double, configuration_t::Dimension::VALUE, multiplyEigenSize(configuration_t::Dimension::VALUE, ISplineOrder) > angular_jacobian_t;
 
 		SM_DEFINE_EXCEPTION(Exception, std::runtime_error);
@@ -66,6 +67,7 @@ namespace bsplines {
 
 		public :
 			Evaluator(const spline_t & spline, const time_t & t);
+			Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt);
 
 			point_t evalD(int derivativeOrder) const;
 
@@ -92,6 +94,12 @@ namespace bsplines {
 
 			template <int IDerivativeOrder>
 			void evalAngularDerivativeJacobian(angular_jacobian_t & jacobian) const;
+
+			/**
+			 * Computes angular velocity and acceleration and optionally their Jacobians at once.
+			 * The orientation and its first two time derivatives are accumulated in one pass along the quaternion product (together with their Jacobians if requested) instead of once per quantity.
+			 */
+			void evalAngularVelocityAndAcceleration(tangent_vector_t & angularVelocity, tangent_vector_t & angularAcceleration, angular_jacobian_t * angularVelocityJacobian = nullptr, angular_jacobian_t * angularAccelerationJacobian = nullptr) const;
 		private:
 			struct CalculationCache;
 			inline int getNumVectors() const;
@@ -111,11 +119,34 @@ namespace bsplines {
 			dmatrix_t getRiDJacobian(const CalculationCache & cache, int derivativeOrder, int i, int j) const;
 
 			dmatrix_t getRiDJacobian(const CalculationCache & cache, int derivativeOrder, int i) const;
+			void getRiDJacobians(const CalculationCache & cache, int maxDerivativeOrder, int i, dmatrix_t * jacobians) const;
+			static tangent_vector_t computeAngularDerivative(const point_t & q, const point_t & qD);
+			static void computeAngularDerivativeJacobian(const point_t & q, const point_t & qD, const full_jacobian_t & qJacobian, const full_jacobian_t & qDJacobian, angular_jacobian_t & jacobian);
 			dmatrix_t evalJacobianDRecursiveProductRest(const CalculationCache & cache, int derivativeOrder, int i, const int kombinatorialFactor, int j) const;
 		};
 
 		template<int IMaximalDerivativeOrder>
 		inline Evaluator<IMaximalDerivativeOrder> getEvaluatorAt(const time_t & t) const { return parent_t::template getEvaluatorAt<IMaximalDerivativeOrder>(t); }
+
+		/**
+		 * Evaluates the orientations at all times (output[i] at times[i]) with the batched quaternion kernels of the manifold.
+		 * The control vertex differences are computed once per segment and no evaluators are constructed; the exponentials and products run vectorized over all times.
+		 * Faster than evalBatch<0>(times, 0, output) for batches of more than a few times (see the evalBatchVectorized test with SPEEDMEASURE).
+		 */
+		template<typename TPointContainer>
+		void evalBatchVectorized(const std::vector<time_t> & times, TPointContainer & output) const;
+
+		/**
+		 * Enables caching the logarithms of the control vertex differences in the segments (see registerSegmentCacheSlot).
+		 * Pays off when evaluating repeatedly between changes of the control vertices, e.g. within one optimizer iteration. Concurrent evaluation stays thread safe.
+		 */
+		void setLogVectorCaching(bool enable);
+		inline bool isLogVectorCaching() const { return (bool) _logVectorSlot; }
+
+		/// \brief computes log(previous^-1 * segment) of the two neighbouring segments' control vertices, from the cache if enabled
+		inline void computeLogVectorInto(const SegmentMapConstIterator & previous, const SegmentMapConstIterator & segment, tangent_vector_t & phi) const;
+	private:
+		std::shared_ptr<typename parent_t::segment_cache_t::template NodeCacheSlot<tangent_vector_t> > _logVectorSlot;
 	};
 
 
@@ -2,6 +2,7 @@
 #define BSPLINEFITTERIMPL_HPP_
 
 #include "DiffManifoldBSplineTools.hpp"
+#include "SegmentQuadraticIntegral.hpp"
 #include "../DynamicOrTemplateInt.hpp"
 #include "../DiffManifoldBSpline.hpp"
 
@@ -193,11 +194,11 @@ namespace internal{
 					time_t t(it->getKnot());
 					if(t >= minTime){
 						newTimes.push_back(t);
-						newPoints.push_back(spline.template getEvaluatorAt<0>(t).eval());
 						weights.push_back(baseWeight); //TODO improve: normalize the weight base on the amount of points given per segment.
 					}
 				}
 			);
+			spline.template evalBatch<0>(newTimes, 0, newPoints);
 			//TODO optimize: use better ways to concatenate times and points.
 			SM_ASSERT_EQ_DBG(std::runtime_error, newTimes.size(), relevantOldVCs, "BUG in "  << __FILE__ << ":" << __LINE__);
 			SM_ASSERT_EQ_DBG(std::runtime_error, newPoints.size(), relevantOldVCs, "BUG in "  << __FILE__ << ":" << __LINE__);
@@ -342,7 +343,7 @@ namespace internal{
 		}
 
 		const int capturedCurrentControlVertices = calculateControlVertexOffsets ? fixNFirstRelevantControlVertices + numToFitControlVertices : fixNFirstRelevantControlVertices;
-		const typename TSpline::point_t* currentControlVertices[capturedCurrentControlVertices];
+		std::vector<const typename TSpline::point_t*> currentControlVertices(capturedCurrentControlVertices);
 		if(capturedCurrentControlVertices){
 			auto it = spline.getFirstRelevantSegmentByLast(spline.getSegmentIterator(times[0]));
 			for(int i = 0; i < capturedCurrentControlVertices; ++i){
@@ -366,16 +367,14 @@ namespace internal{
 		auto A = backend.createA(constraintSize, coefficientDim, D);
 		auto b = backend.createB(constraintSize);
 
-		int brow = 0;
-
 		// Add the position constraints.
-		for(size_t i = 0; i < numPoints; i++)
+		spline.template forEachEvaluatorAt<1>(times, [&](size_t i, const typename TSpline::template Evaluator<1> & evaluator)
 		{
+			const int brow = i;
 			time_t time = times[i];
 			scalar_t weight = weights? weights(i) : scalar_t(1.0);
 			int knotIndex = knotIndexResolver.getKnotIndexAtTime(time) - controlVertexIndexOffset;
-			//TODO optimize : a uniform time spline evaluator could be much faster here!
-			typename TSpline::SplineOrderVector bi = spline.template getEvaluatorAt<1>(times[i]).getLocalBi();
+			typename TSpline::SplineOrderVector bi = evaluator.getLocalBi();
 
 			if(weight != scalar_t(1.0)){
 				bi *= weight;
@@ -405,8 +404,7 @@ namespace internal{
 			else{
 				backend.segmentB(b, brow, D) += points[i] * weight;
 			}
-			++brow;
-		}
+		});
 
 		b = A.transpose() * b;
 		A = A.transpose() * A;
@@ -463,9 +461,9 @@ namespace internal{
 		for(typename TSpline::SegmentConstIterator sIt = start; sIt != end; sIt++)
 		{
 			if(FittingBackend_ == FittingBackend::DENSE && blockRow >= 0 && blockRow <= blockRows - blocksInQ){ // all splineOrder many diagonal blocks are contained in the toMatrix
-				addOrSetSegmentQuadraticIntegralDiag(spline, Wdiag, sIt, derivativeOrder, Backend::blockA(toMatrix, blockRow, blockRow, D, blocksInQ), true);
+				internal::addOrSetSegmentQuadraticIntegralDiag(spline, Wdiag, sIt, derivativeOrder, Backend::blockA(toMatrix, blockRow, blockRow, D, blocksInQ), true);
 			} else { // we have to assign sub blocks individually
-				addOrSetSegmentQuadraticIntegralDiag<Q_T &>(spline, Wdiag, sIt, derivativeOrder, Q, false);
+				internal::addOrSetSegmentQuadraticIntegralDiag<TSpline, Q_T &>(spline, Wdiag, sIt, derivativeOrder, Q, false);
 				/*
 				 * Q and toMatrix (=:M) (both square) have shifted block index space. i_Q + brow = i_M.
 				 * Lets x denote the coefficients of all non fixed control vertices
@@ -502,77 +500,6 @@ namespace internal{
 			blockRow ++;
 		}
 	}
-
-	_TEMPLATE
-	template<typename M_T>
-	inline void _CLASS::addOrSetSegmentQuadraticIntegralDiag(const TSpline & spline, const point_t & Wdiag, typename TSpline::SegmentConstIterator segmentIt, int derivativeOrder, M_T toMatrix, bool add)
-	{
-		const int D = spline.getPointSize();
-		const int splineOrder = spline.getSplineOrder();
-		SM_ASSERT_GE_LT(Exception, segmentIt.getKnot(), spline.getMinTime(), spline.getMaxTime(), "Out of range");
-		SM_ASSERT_EQ(Exception, Wdiag.rows(), D, "Wdiag must be of control point size");
-
-		typename TSpline::SplineOrderSquareMatrix Dm(splineOrder, splineOrder);
-		Dm.setZero(splineOrder, splineOrder);
-		spline.computeDiiInto(segmentIt, Dm);
-		typename TSpline::SplineOrderSquareMatrix V(splineOrder, splineOrder);
-		V.setZero(splineOrder, splineOrder);
-		spline.computeViInto(segmentIt, V);
-
-		// Calculate the appropriate derivative version of V
-		// using the matrix multiplication version of the derivative.
-		for(int i = 0; i < derivativeOrder; i++)
-		{
-			V = (Dm.transpose() * V * Dm).eval();
-		}
-
-		const auto splineOrderTimesPointSize = spline.getSplineOrder() * spline.getPointSize();
-		typedef decltype(splineOrderTimesPointSize) SplineOrderTimesPointSize;
-		typedef Eigen::Matrix<double, SplineOrderTimesPointSize::VALUE, SplineOrderTimesPointSize::VALUE> MType;
-
-		MType WV((int)splineOrderTimesPointSize, (int)splineOrderTimesPointSize);
-
-		WV.setZero(splineOrderTimesPointSize, splineOrderTimesPointSize);
-
-		for(int d = 0; d < D; d++)
-		{
-			WV.block(splineOrder*d, splineOrder*d, splineOrder, splineOrder) = Wdiag(d) * V;
-		}
-
-		MType M((int)splineOrderTimesPointSize, (int)splineOrderTimesPointSize);
-		computeMiInto(spline, segmentIt, M);
-
-		if(add) toMatrix += M.transpose() * WV * M;
-		else toMatrix = M.transpose() * WV * M;
-	}
-
-	_TEMPLATE
-	template <typename M_T>
-	void _CLASS::computeBijInto(const TSpline & spline, const typename TSpline::SegmentConstIterator & segmentIndex, int columnIndex, M_T B)
-	{
-		const int D = spline.getPointSize();
-		const int splineOrder = spline.getSplineOrder();
-
-		for(int i = 0; i < D; i++)
-		{
-			B.block(i*splineOrder,i,splineOrder,1) = segmentIndex->getBasisMatrix().col(columnIndex);
-		}
-	}
-
-	_TEMPLATE
-	template <typename M_T>
-	void _CLASS::computeMiInto(const TSpline & spline, const typename TSpline::SegmentConstIterator & segmentIndex, M_T & M)
-	{
-		const int D = spline.getPointSize();
-		const int splineOrder = spline.getSplineOrder();
-		const int splineOrderTimesPointSize = splineOrder * D;
-		M.setZero();
-
-		for(int j = 0; j < splineOrder; j++)
-		{
-			computeBijInto(spline, segmentIndex, j, M.block(0, j*D, splineOrderTimesPointSize, D));
-		}
-	}
 }
 
 #undef _TEMPLATE
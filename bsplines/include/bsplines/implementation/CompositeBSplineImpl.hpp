@@ -0,0 +1,93 @@
+/*
+ * CompositeBSplineImpl.hpp
+ */
+
+namespace bsplines {
+
+	#define _TEMPLATE template <typename TPrimaryBSplineConfiguration, int ... Dimensions, typename TConfigurationDerived>
+	#define _CLASS DiffManifoldBSpline<CompositeBSplineConfiguration<TPrimaryBSplineConfiguration, Dimensions...>, TConfigurationDerived>
+
+	_TEMPLATE
+	template <int IComponent>
+	void _CLASS::setEuclideanControlVertices(const Eigen::MatrixXd & controlVertices){
+		setEuclideanControlVertices<IComponent>(controlVertices, this->getMinTime());
+	}
+
+	_TEMPLATE
+	template <int IComponent>
+	void _CLASS::setEuclideanControlVertices(const Eigen::MatrixXd & controlVertices, const time_t startingAtFirstRelevantControlVertexForThisTime, int offset){
+		SM_ASSERT_EQ(Exception, controlVertices.rows(), (int) EuclideanComponent<IComponent>::Dimension, "The control vertices must be stored column wise!");
+		SM_ASSERT_LE(Exception, controlVertices.cols(), this->getNumControlVertices(), "There must be getNumControlVertices() or less many controlVertices!");
+		// as manipulateControlVertices
+		SegmentIterator it = this->getFirstRelevantSegmentByLast(this->getSegmentIterator(startingAtFirstRelevantControlVertexForThisTime));
+		if(offset){
+			internal::moveIterator(it, offset > 0 ? this->end() : this->begin(), offset);
+		}
+		for(int i = 0, n = controlVertices.cols(); it != this->getAbsoluteEnd() && i < n; i++, it++){
+			it->template setEuclideanControlVertex<IComponent>(controlVertices.col(i));
+		}
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	_CLASS::Evaluator<IMaximalDerivativeOrder>::Evaluator(const spline_t & spline, const time_t & t) : parent_t::template Evaluator<IMaximalDerivativeOrder> (spline, t)
+	{
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	_CLASS::Evaluator<IMaximalDerivativeOrder>::Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt) : parent_t::template Evaluator<IMaximalDerivativeOrder> (spline, t, segmentIt)
+	{
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	template <int IComponent>
+	typename _CLASS::template EuclideanComponent<IComponent>::point_t _CLASS::Evaluator<IMaximalDerivativeOrder>::evalEuclideanD(int derivativeOrder) const {
+		typedef typename EuclideanComponent<IComponent>::point_t euclidean_point_t;
+		SM_ASSERT_GE_DBG(Exception, derivativeOrder, 0, "To integrate, use the integral function");
+		const int splineOrder = this->_spline.getSplineOrder();
+		euclidean_point_t rv = euclidean_point_t::Zero();
+		if(derivativeOrder >= splineOrder) return rv;
+
+		SegmentConstIterator it = this->begin();
+		if(_CLASS::NeedsCumulativeBasisMatrices){
+			// use the prepared cumulative basis of the primary component : sum_i B_i p_i = c_0 p_0 + sum_{i > 0} c_i (p_i - p_{i-1}), with c_0 = 1 for the value and 0 for its derivatives
+			const SplineOrderVector & c = this->getLocalCumulativeBi(derivativeOrder);
+			const euclidean_point_t * last = & it->template getEuclideanControlVertex<IComponent>();
+			if(derivativeOrder == 0) rv = *last;
+			for(int i = 1; i < splineOrder; i++){
+				++it;
+				const euclidean_point_t & next = it->template getEuclideanControlVertex<IComponent>();
+				rv += c[i] * (next - *last);
+				last = & next;
+			}
+		}
+		else {
+			const SplineOrderVector & b = this->getLocalBi(derivativeOrder);
+			for(int i = 0; i < splineOrder; i++, ++it){
+				rv += b[i] * it->template getEuclideanControlVertex<IComponent>();
+			}
+		}
+		return rv;
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	template <int IComponent>
+	void _CLASS::Evaluator<IMaximalDerivativeOrder>::evalEuclideanJacobian(int derivativeOrder, typename EuclideanComponent<IComponent>::jacobian_t & jacobian) const {
+		enum { Dimension = EuclideanComponent<IComponent>::Dimension };
+		SM_ASSERT_GE_DBG(Exception, derivativeOrder, 0, "To integrate, use the integral function");
+		const int splineOrder = this->_spline.getSplineOrder();
+		jacobian.setZero(Dimension, Dimension * splineOrder);
+		if(derivativeOrder >= splineOrder) return;
+
+		const SplineOrderVector & b = this->getLocalBi(derivativeOrder);
+		for(int i = 0; i < splineOrder; i++){
+			jacobian.template block<Dimension, Dimension>(0, i * Dimension).diagonal().setConstant(b[i]);
+		}
+	}
+
+	#undef _CLASS
+	#undef _TEMPLATE
+} // namespace bsplines
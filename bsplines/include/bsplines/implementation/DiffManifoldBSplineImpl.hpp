@@ -19,6 +19,7 @@ namespace bsplines {
 		_configuration = other._configuration;
 		_manifold = other._manifold;
 		_segments = std::shared_ptr<segment_map_t>(new segment_map_t(*other._segments));
+		_segmentCache = other._segmentCache;
 		if(isInitialized()){
 			initIterators();
 		}
@@ -233,7 +234,9 @@ namespace bsplines {
 			internal::moveIterator(it, offset > 0 ? end() : begin(), offset);
 		}
 		for(SegmentIterator  end = getAbsoluteEnd(); it != end && i < manipulateTheFirstNControlVertices; it ++){
-			controlVertexManipulator(i++, it->getControlVertex());
+			point_t controlVertex = it->getControlVertex();
+			controlVertexManipulator(i++, controlVertex);
+			it->setControlVertex(controlVertex);
 		}
 	}
 
@@ -307,6 +310,22 @@ namespace bsplines {
 		return getMaxTime();
 	}
 
+	_TEMPLATE
+	size_t _CLASS::removeSegmentsBefore(const time_t & t) {
+		assertEvaluable();
+		SM_ASSERT_TRUE(Exception, _firstRelevantSegment == getAbsoluteBegin(), "Removing segments may only be called on a head slice.");
+
+		const SegmentIterator newFirstRelevantSegment = getFirstRelevantSegmentByLast(getSegmentIterator(t));
+		const size_t removed = std::distance(getAbsoluteBegin(), newFirstRelevantSegment);
+		if(removed == 0) return 0;
+
+		// the basis matrices of the remaining segments only depend on remaining knots and therefore stay valid
+		_segments->erase(getAbsoluteBegin(), newFirstRelevantSegment);
+		_firstRelevantSegment = getAbsoluteBegin();
+		_begin = internal::getMovedIterator(_firstRelevantSegment, _end, getSplineOrder() - 1);
+		return removed;
+	}
+
 	_TEMPLATE
 	typename _CLASS::time_t _CLASS::appendSegmentsUniformly(unsigned int numSegments, const point_t * value, const time_t beyondThisTime) {
 		SegmentIterator it = getAbsoluteEnd(), aBegin = getAbsoluteBegin();
@@ -363,6 +382,9 @@ namespace bsplines {
 		const int splineOrder = getSplineOrder();
 		const SegmentMapIterator end = _segments->end();
 
+		// cached values may depend on the knots
+		invalidateSegmentCaches();
+
 		std::deque<time_t> relevantKnots; //TODO optimize : replace deque with a fixed size (splineOrder * 2 - 1) circular sequence on the stack
 
 		// try to collect the first splineOrder * 2 - 1 knots
@@ -526,6 +548,17 @@ namespace bsplines {
 		return _segments->size();
 	}
 
+	_TEMPLATE
+	std::vector<typename _CLASS::time_t> _CLASS::getKnots() const
+	{
+		std::vector<time_t> knots;
+		knots.reserve(getNumKnots());
+		for(SegmentMapConstIterator it = _segments->begin(), end = _segments->end(); it != end; ++it){
+			knots.push_back(it->first);
+		}
+		return knots;
+	}
+
 
 	_TEMPLATE
 	inline typename _CLASS::time_t _CLASS::getMinTime() const
@@ -644,6 +677,21 @@ namespace bsplines {
 	}
 
 
+	_TEMPLATE
+	inline typename _CLASS::SegmentConstIterator _CLASS::getSegmentIterator(const time_t & t, SegmentConstIterator hint) const
+	{
+		if(t < hint.getKnot() || t > getMaxTime()) return getSegmentIterator(t);
+		// walking further than a few segments costs more than the tree search
+		const int maxNumberOfSteps = 4;
+		const SegmentConstIterator end = _end;
+		int steps = 0;
+		for(SegmentConstIterator next = hint; ++next != end && next.getKnot() <= t; ){
+			if(++steps > maxNumberOfSteps) return getSegmentIterator(t);
+			hint = next;
+		}
+		return hint;
+	}
+
 	_TEMPLATE
 	inline typename _CLASS::time_t _CLASS::getMinimalDistanceToNeighborKnots(const time_t & t) const {
 		auto it = getSegmentIterator(t);
@@ -672,7 +720,7 @@ namespace bsplines {
 		SM_ASSERT_EQ(Exception, coefficients.rows(), index + D, "wrong number of coefficients")
 
 		for(SegmentMapIterator end = _segments->begin(); index >= 0; index -= D){
-			it->getControlVertex() = coefficients.segment(index, D);
+			it->setControlVertex(coefficients.segment(index, D));
 			if(it == end) break;
 			it--;
 		}
@@ -696,9 +744,14 @@ namespace bsplines {
 
 	template <typename SplineT>
 	struct EvalFunctor{
+		enum { PolynomialDegree = 1, MaximalDerivativeOrder = 0 };
 		inline typename SplineT::point_t eval(const SplineT & spline, typename SplineT::time_t t) const {
 			return spline.template getEvaluatorAt<0>(t).eval();
 		}
+		template <typename TEvaluator>
+		inline typename SplineT::point_t evalAt(const TEvaluator & evaluator) const {
+			return evaluator.eval();
+		}
 		inline typename SplineT::point_t  getZeroValue(const SplineT & spline) const {
 			return SplineT::point_t::Zero((int)spline.getPointSize());
 		}
@@ -709,7 +762,7 @@ namespace bsplines {
 		return getDerived().template evalFunctorIntegralNumerically<point_t>(t1, t2, EvalFunctor<spline_t>(), numberOfPoints);
 	}
 
-	template <typename SplineT, typename TFunctor, typename TValue>
+	template <typename SplineT, typename TFunctor, typename TValue, bool IEvaluatesBatches = (internal::FunctorMaximalDerivativeOrder<TFunctor>::VALUE >= 0)>
 	struct IntegrandFunctor {
 		const SplineT & _spline;
 		const TFunctor & _f;
@@ -720,6 +773,21 @@ namespace bsplines {
 		}
 	};
 
+	/// evaluates all integration points in one segment sweep for functors supporting evaluators (see internal::FunctorMaximalDerivativeOrder)
+	template <typename SplineT, typename TFunctor, typename TValue>
+	struct IntegrandFunctor<SplineT, TFunctor, TValue, true> : public IntegrandFunctor<SplineT, TFunctor, TValue, false> {
+		typedef typename SplineT::template Evaluator<TFunctor::MaximalDerivativeOrder> evaluator_t;
+		IntegrandFunctor(const SplineT & spline, const TFunctor & f): IntegrandFunctor<SplineT, TFunctor, TValue, false>(spline, f){}
+
+		inline void evalBatch(const std::vector<typename SplineT::time_t> & times, std::vector<TValue, Eigen::aligned_allocator<TValue> > & values) const {
+			values.resize(times.size());
+			const TFunctor & f = this->_f;
+			this->_spline.template forEachEvaluatorAt<TFunctor::MaximalDerivativeOrder>(times, [&values, &f](size_t i, const evaluator_t & evaluator){
+				values[i] = f.evalAt(evaluator);
+			});
+		}
+	};
+
 	_TEMPLATE
 	template <typename TValue, typename TFunctor>
 	inline TValue _CLASS ::evalFunctorIntegralNumerically(const time_t & t1, const time_t & t2, const TFunctor & f, int numberOfPoints) const {
@@ -728,20 +796,108 @@ namespace bsplines {
 		return numeric_integrator::template integrateFunctor<numeric_integrator::algorithms::Default, TValue, time_t, const IFunc>(t1, t2, IFunc(this->getDerived(), f), numberOfPoints, f.getZeroValue(this->getDerived()));
 	}
 
+	_TEMPLATE
+	template <typename TValue, typename TFunctor>
+	TValue _CLASS ::evalFunctorIntegralGaussLegendre(const time_t & t1, const time_t & t2, const TFunctor & f, int numberOfPointsPerSegment) const {
+		if(t1 > t2) return -getDerived().template evalFunctorIntegralGaussLegendre<TValue, TFunctor>(t2, t1, f, numberOfPointsPerSegment);
+		TValue sum = f.getZeroValue(this->getDerived());
+		if(t1 == t2) return sum;
+		SM_ASSERT_GE(Exception, t1, getMinTime(), "");
+		SM_ASSERT_LE(Exception, t2, getMaxTime(), "");
+
+		std::vector<double> nodes, weights;
+		numeric_integrator::internal::computeGaussLegendreRule(numberOfPointsPerSegment, nodes, weights);
+
+		for(SegmentConstIterator it = getSegmentIterator(t1), next = it; ; it = next){
+			++next;
+			const time_t a = std::max(it.getKnot(), t1), b = next.getKnot() < t2 ? next.getKnot() : t2;
+			if(a < b){
+				const duration_t length = computeDuration(a, b);
+				const double halfLength = getDurationAsDouble(length) / 2;
+				for(int i = 0; i < numberOfPointsPerSegment; ++i){
+					const time_t t = a + (duration_t) (length * ((nodes[i] + 1) / 2));
+					sum += f.eval(this->getDerived(), t) * (weights[i] * halfLength);
+				}
+			}
+			if(!(next.getKnot() < t2)) break;
+		}
+		return sum;
+	}
+
+	_TEMPLATE
+	template <typename TValue, typename TFunctor, typename TAlgorithm>
+	TValue _CLASS ::evalFunctorIntegralToTolerance(const time_t & t1, const time_t & t2, const TFunctor & f, double tolerance, double relativeTolerance, int maxNumberOfPointsPerSegment, double * errorEstimate) const {
+		if(t1 > t2) return -getDerived().template evalFunctorIntegralToTolerance<TValue, TFunctor, TAlgorithm>(t2, t1, f, tolerance, relativeTolerance, maxNumberOfPointsPerSegment, errorEstimate);
+		if(errorEstimate) *errorEstimate = 0;
+		const TValue zero = f.getZeroValue(this->getDerived());
+		TValue sum = zero;
+		if(t1 == t2) return sum;
+		SM_ASSERT_GE(Exception, t1, getMinTime(), "");
+		SM_ASSERT_LE(Exception, t2, getMaxTime(), "");
+
+		const double totalLength = getDurationAsDouble(computeDuration(t1, t2));
+		for(SegmentConstIterator it = getSegmentIterator(t1), next = it; ; it = next){
+			++next;
+			const time_t a = std::max(it.getKnot(), t1), b = next.getKnot() < t2 ? next.getKnot() : t2;
+			if(a < b){
+				// integrate over the offset from a in getDurationAsDouble units to keep the points inside the segment
+				const duration_t length = computeDuration(a, b);
+				const double lengthAsDouble = getDurationAsDouble(length);
+				auto segmentIntegrand = [&](double offset) -> TValue { return f.eval(this->getDerived(), a + (duration_t) (length * (offset / lengthAsDouble))); };
+				double segmentErrorEstimate;
+				sum += numeric_integrator::integrateFunctorToTolerance<TAlgorithm, TValue>(0., lengthAsDouble, segmentIntegrand, tolerance * lengthAsDouble / totalLength, relativeTolerance, maxNumberOfPointsPerSegment, zero, &segmentErrorEstimate);
+				if(errorEstimate) *errorEstimate += segmentErrorEstimate;
+			}
+			if(!(next.getKnot() < t2)) break;
+		}
+		return sum;
+	}
+
+	_TEMPLATE
+	template <typename TValue, typename TFunctor>
+	TValue _CLASS ::evalFunctorIntegral(const time_t & t1, const time_t & t2, const TFunctor & f) const {
+		enum { NumberOfPoints = 100, MinNumberOfPointsPerSegment = 5 };
+		if(t1 > t2) return -getDerived().template evalFunctorIntegral<TValue, TFunctor>(t2, t1, f);
+		if(t1 == t2) return f.getZeroValue(this->getDerived());
+
+		int numberOfSegments = 1;
+		for(SegmentConstIterator it = getSegmentIterator(t1), last = getSegmentIterator(t2, it); it != last; ++it) numberOfSegments++;
+		const int maxNumberOfPointsPerSegment = std::max((int) MinNumberOfPointsPerSegment, (int) NumberOfPoints / numberOfSegments);
+		return getDerived().template evalFunctorIntegralToTolerance<TValue, TFunctor>(t1, t2, f, 1E-12, 1E-10, maxNumberOfPointsPerSegment);
+	}
+
 	_TEMPLATE
 	template <int IMaximalDerivativeOrder>
 	_CLASS::Evaluator<IMaximalDerivativeOrder >::Evaluator(const spline_t & spline, const time_t & t) :
+		Evaluator(spline, t, getSegmentIteratorOfEvaluableSpline(spline, t))
+	{
+	}
+
+	_TEMPLATE
+	template <int IMaximalDerivativeOrder>
+	inline typename _CLASS::SegmentConstIterator _CLASS::Evaluator<IMaximalDerivativeOrder>::getSegmentIteratorOfEvaluableSpline(const spline_t & spline, const time_t & t)
+	{
+		// the spline must be evaluable before its segments are looked up
+		spline.assertEvaluable();
+		return spline.getSegmentIterator(t);
+	}
+
+
+	_TEMPLATE
+	template <int IMaximalDerivativeOrder>
+	_CLASS::Evaluator<IMaximalDerivativeOrder >::Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt) :
 		internal::AssertInitializedSpline<spline_t>(spline),
 		_tmp(static_cast<int>(spline.getSplineOrder())),
 		_spline(spline),
 		_t(t),
-		_ti(spline.getSegmentIterator(t)),
+		_ti(segmentIt),
 		_firstRelevantControlVertexIt(spline.getFirstRelevantSegmentByLast(_ti)),
 		_end(internal::getMovedIterator(_ti, spline.getAbsoluteEnd(), 1)),
 		_segmentLength(spline.computeSegmentLength(_ti)),
 		_positionInSegment(computeDuration(_ti.getKnot(), t)),
 		_relativePositionInSegment(((duration_t) (_segmentLength) == (duration_t) (TTimePolicy::getZero())) ? 0 : divideDurations(_positionInSegment, _segmentLength))
 	{
+		SM_ASSERT_TRUE_DBG(Exception, _ti == spline.getSegmentIterator(t), "segmentIt must be the segment of t");
 		const auto splineOrder = _spline.getSplineOrder();
 		//TODO optimize : set cache while calculating the u
 		for(int derivativeOrder = 0; derivativeOrder < NumberOfPreparedDerivatives; derivativeOrder++){
@@ -752,7 +908,6 @@ namespace bsplines {
 		}
 	}
 
-
 	_TEMPLATE
 	template <int IMaximalDerivativeOrder>
 	inline typename _CLASS::SegmentConstIterator
@@ -1019,6 +1174,45 @@ namespace bsplines {
 		return typename _CLASS::spline_t::template Evaluator<IMaximalDerivativeOrder>(this->getDerived(), t);
 	}
 
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder, typename TFunctor>
+	void _CLASS::forEachEvaluatorAt(const std::vector<time_t> & times, TFunctor && f, int numberOfThreads) const {
+		typedef typename spline_t::template Evaluator<IMaximalDerivativeOrder> evaluator_t;
+		assertEvaluable();
+
+		auto evaluateRange = [&](size_t begin, size_t end) {
+			if(begin == end) return;
+			SegmentConstIterator it = getSegmentIterator(times[begin]);
+			for(size_t i = begin; i < end; i++){
+				it = getSegmentIterator(times[i], it);
+				const evaluator_t evaluator(getDerived(), times[i], it);
+				f(i, evaluator);
+			}
+		};
+
+		internal::forEachRangeInParallel(times.size(), evaluateRange, numberOfThreads);
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder, typename TPointContainer>
+	void _CLASS::evalBatch(const std::vector<time_t> & times, int derivativeOrder, TPointContainer & output, int numberOfThreads) const {
+		typedef typename spline_t::template Evaluator<IMaximalDerivativeOrder> evaluator_t;
+		output.resize(times.size());
+		forEachEvaluatorAt<IMaximalDerivativeOrder>(times, [&output, derivativeOrder](size_t i, const evaluator_t & evaluator){
+			output[i] = evaluator.evalD(derivativeOrder);
+		}, numberOfThreads);
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder, typename TJacobianContainer>
+	void _CLASS::evalJacobianBatch(const std::vector<time_t> & times, int derivativeOrder, TJacobianContainer & output, int numberOfThreads) const {
+		typedef typename spline_t::template Evaluator<IMaximalDerivativeOrder> evaluator_t;
+		output.resize(times.size());
+		forEachEvaluatorAt<IMaximalDerivativeOrder>(times, [&output, derivativeOrder](size_t i, const evaluator_t & evaluator){
+			evaluator.evalJacobian(derivativeOrder, output[i]);
+		}, numberOfThreads);
+	}
+
 #undef _TEMPLATE
 #undef _CLASS
 }
@@ -8,6 +8,9 @@
 #ifndef DIFFMANIFOLDBSPLINETOOLS_HPP_
 #define DIFFMANIFOLDBSPLINETOOLS_HPP_
 
+#include <vector>
+#include <future>
+#include <algorithm>
 
 namespace bsplines {
 namespace internal{
@@ -46,6 +49,28 @@ inline Iterator getMovedIterator(const Iterator & it, const Iterator & limit, in
 	return nIt;
 }
 
+/**
+ * Calls evaluateRange(begin, end) for contiguous ranges covering 0 ... n - 1, on numberOfThreads threads (the calling thread takes the first range).
+ * Fewer than two indices per thread are evaluated in one range on the calling thread. Exceptions of any range are rethrown after all ranges finished.
+ */
+template<typename RangeFunctor>
+inline void forEachRangeInParallel(size_t n, const RangeFunctor & evaluateRange, int numberOfThreads)
+{
+	if(numberOfThreads <= 1 || n < 2 * (size_t) numberOfThreads){
+		evaluateRange(0, n);
+		return;
+	}
+
+	const size_t chunkSize = (n + numberOfThreads - 1) / numberOfThreads;
+	std::vector<std::future<void> > chunks;
+	for(size_t begin = chunkSize; begin < n; begin += chunkSize){
+		chunks.push_back(std::async(std::launch::async, [&evaluateRange, begin, n, chunkSize](){ evaluateRange(begin, std::min(n, begin + chunkSize)); }));
+	}
+	// if this throws, the futures' destructors still wait for the other ranges
+	evaluateRange(0, chunkSize);
+	for(auto & chunk : chunks) chunk.get();
+}
+
 }
 }
 
@@ -86,12 +86,27 @@ namespace bsplines {
 		return integral;
 	}
 
+	_TEMPLATE
+	template <typename TValue, typename TFunctor>
+	TValue _CLASS::evalFunctorIntegral(const time_t & t1, const time_t & t2, const TFunctor & f, std::true_type /* isPolynomial */) const
+	{
+		// each value or derivative of the spline is a polynomial of degree <= splineOrder - 1 in time on every segment
+		const int degree = internal::FunctorPolynomialDegree<TFunctor>::VALUE * (this->getSplineOrder() - 1);
+		return this->template evalFunctorIntegralGaussLegendre<TValue>(t1, t2, f, numeric_integrator::internal::getNumberOfGaussLegendrePointsForDegree(degree));
+	}
+
 	_TEMPLATE
 	template<int IMaximalDerivativeOrder>
 	_CLASS::Evaluator<IMaximalDerivativeOrder>::Evaluator(const spline_t & spline, const time_t & t) : parent_t::template Evaluator<IMaximalDerivativeOrder> (spline, t)
 	{
 	}
 
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	_CLASS::Evaluator<IMaximalDerivativeOrder>::Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt) : parent_t::template Evaluator<IMaximalDerivativeOrder> (spline, t, segmentIt)
+	{
+	}
+
 	_TEMPLATE
 	template<int IMaximalDerivativeOrder>
 	inline typename _CLASS::point_t _CLASS::Evaluator<IMaximalDerivativeOrder>::eval() const
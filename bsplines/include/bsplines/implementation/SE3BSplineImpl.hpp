@@ -0,0 +1,316 @@
+/*
+ * SE3BSplineImpl.hpp
+ *
+ *  The pose is T(t) = T_0 * A_1(t) * ... * A_n(t) with A_i(t) = exp(b_i(t) * Omega_i), Omega_i = log(T_{i-1}^-1 * T_i) and b_i the cumulative basis functions.
+ *  As A_i' = b_i' * hat(Omega_i) * A_i all time derivatives follow from the Leibniz rule on 4x4 matrices ("jets").
+ *  The Jacobians propagate the left perturbations of the control vertices (see DiffManifoldPointUpdateTraits for Lie groups) through the same products.
+ */
+
+#include "bsplines/DiffManifoldBSpline.hpp"
+#include <sm/kinematics/quaternion_algebra.hpp>
+
+namespace bsplines{
+
+	#define _TEMPLATE template <typename TDiffManifoldConfiguration, int ISplineOrder, typename TTimePolicy, typename TConfigurationDerived>
+	#define _CLASS DiffManifoldBSpline<SE3BSplineConfiguration<TDiffManifoldConfiguration, ISplineOrder, TTimePolicy>, TConfigurationDerived>
+
+	namespace internal {
+		inline Eigen::Vector3d veeSkew(const Eigen::Matrix3d & m){
+			return Eigen::Vector3d(m(2, 1) - m(1, 2), m(0, 2) - m(2, 0), m(1, 0) - m(0, 1)) * 0.5;
+		}
+		/// the quaternion [w / 2; 0], such that q (x) [w / 2; 0] is the time derivative of q for the body angular velocity w
+		inline Eigen::Vector4d halfPureQuaternion(const Eigen::Vector3d & w){
+			return Eigen::Vector4d(w[0] * 0.5, w[1] * 0.5, w[2] * 0.5, 0);
+		}
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	struct _CLASS::Evaluator<IMaximalDerivativeOrder>::CalculationCache {
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+		int maxDerivativeOrder;
+		point_t value;
+		jet_t transformation;
+		/// body angular velocity and its derivative, the quaternion's derivatives
+		Eigen::Vector3d omega, omegaD;
+		Eigen::Vector4d qD, qDD;
+		/// the variations of transformation for the unit updates of the control vertices' tangent vectors (index : vertex * Dimension + direction)
+		jet_vector_t variations;
+
+		CalculationCache(const Evaluator * eval, int maxDerivativeOrder, bool computeVariations) : maxDerivativeOrder(maxDerivativeOrder)
+		{
+			typedef typename manifold_t::tangent_map_t tangent_map_t;
+			const auto & manifold = eval->_spline.getManifold();
+			const int n = eval->getNumVectors(), D = maxDerivativeOrder, dim = manifold_t::Dimension;
+
+			std::vector<const point_t *> controlVertices(n + 1);
+			SegmentMapConstIterator it = eval->_firstRelevantControlVertexIt;
+			controlVertices[0] = & it->second.getControlVertex();
+			for(int i = 1; i <= n; i++){
+				it++;
+				controlVertices[i] = & it->second.getControlVertex();
+			}
+
+			std::vector<tangent_vector_t, Eigen::aligned_allocator<tangent_vector_t> > omegas(n + 1);
+			jet_vector_t factors(n + 1), prefixes(n + 1);
+			std::vector<double> b0(n + 1), b1(n + 1, 0.0), b2(n + 1, 0.0);
+
+			value = *controlVertices[0];
+			prefixes[0][0] = manifold_t::getTransformationMatrix(value);
+			for(int k = 1; k <= D; k++) prefixes[0][k].setZero();
+
+			for(int i = 1; i <= n; i++){
+				b0[i] = eval->getLocalCumulativeBi(0)[i];
+				if(D >= 1) b1[i] = eval->getLocalCumulativeBi(1)[i];
+				if(D >= 2) b2[i] = eval->getLocalCumulativeBi(2)[i];
+
+				manifold.logInto(*controlVertices[i - 1], *controlVertices[i], omegas[i]);
+				const point_t e = manifold.expAtId(omegas[i] * b0[i]);
+				value = manifold.mult(value, e);
+
+				const matrix_t X = manifold_t::hat(omegas[i]);
+				jet_t & A = factors[i];
+				A[0] = manifold_t::getTransformationMatrix(e);
+				if(D >= 1) A[1] = b1[i] * X * A[0];
+				if(D >= 2) A[2] = (b2[i] * X + b1[i] * b1[i] * X * X) * A[0];
+				multiplyJets(prefixes[i - 1], A, D, prefixes[i]);
+			}
+			transformation = prefixes[n];
+
+			const Eigen::Vector4d q = value.template head<4>();
+			const Eigen::Matrix3d R = transformation[0].template topLeftCorner<3, 3>();
+			if(D >= 1){
+				const Eigen::Matrix3d RD = transformation[1].template topLeftCorner<3, 3>();
+				omega = internal::veeSkew(R.transpose() * RD);
+				qD = sm::kinematics::qplus(q, internal::halfPureQuaternion(omega));
+				if(D >= 2){
+					omegaD = internal::veeSkew(RD.transpose() * RD + R.transpose() * transformation[2].template topLeftCorner<3, 3>());
+					qDD = sm::kinematics::qplus(qD, internal::halfPureQuaternion(omega)) + sm::kinematics::qplus(q, internal::halfPureQuaternion(omegaD));
+				}
+			}
+
+			if(!computeVariations) return;
+
+			jet_vector_t suffixes(n + 2);
+			suffixes[n + 1][0].setIdentity();
+			for(int k = 1; k <= D; k++) suffixes[n + 1][k].setZero();
+			for(int i = n; i >= 1; i--){
+				multiplyJets(factors[i], suffixes[i + 1], D, suffixes[i]);
+			}
+
+			variations.resize(dim * (n + 1));
+			// the start point enters as T_0 -> exp(d) * T_0
+			for(int e = 0; e < dim; e++){
+				const matrix_t E = manifold_t::hat(tangent_vector_t::Unit(e));
+				for(int k = 0; k <= D; k++) variations[e][k] = E * transformation[k];
+			}
+			for(int j = dim; j < dim * (n + 1); j++){
+				for(int k = 0; k <= D; k++) variations[j][k].setZero();
+			}
+
+			jet_t dA, tmp, dT;
+			for(int i = 1; i <= n; i++){
+				// d Omega_i = K * (d_i - d_{i-1}) for the updates d_i of control vertex i
+				const tangent_map_t K = manifold_t::inverseLeftJacobian(omegas[i]) * manifold_t::adjoint(manifold.invert(*controlVertices[i - 1]));
+				const tangent_map_t L = manifold_t::leftJacobian(omegas[i] * b0[i]) * b0[i];
+				const jet_t & A = factors[i];
+				const matrix_t X = manifold_t::hat(omegas[i]);
+
+				for(int e = 0; e < dim; e++){
+					const matrix_t E = manifold_t::hat(tangent_vector_t::Unit(e));
+					dA[0] = manifold_t::hat(L.col(e)) * A[0];
+					if(D >= 1){
+						const matrix_t dXA = E * A[0] + X * dA[0];
+						dA[1] = b1[i] * dXA;
+						if(D >= 2) dA[2] = b2[i] * dXA + b1[i] * b1[i] * ((E * X + X * E) * A[0] + X * X * dA[0]);
+					}
+					multiplyJets(prefixes[i - 1], dA, D, tmp);
+					multiplyJets(tmp, suffixes[i + 1], D, dT);
+
+					for(int f = 0; f < dim; f++){
+						const double c = K(e, f);
+						if(c == 0.0) continue;
+						for(int k = 0; k <= D; k++){
+							variations[i * dim + f][k] += c * dT[k];
+							variations[(i - 1) * dim + f][k] -= c * dT[k];
+						}
+					}
+				}
+			}
+		}
+	};
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	_CLASS::Evaluator<IMaximalDerivativeOrder>::Evaluator(const spline_t & spline, const time_t & t) : parent_t::template Evaluator<IMaximalDerivativeOrder> (spline, t)
+	{
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	_CLASS::Evaluator<IMaximalDerivativeOrder>::Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt) : parent_t::template Evaluator<IMaximalDerivativeOrder> (spline, t, segmentIt)
+	{
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	inline int _CLASS::Evaluator<IMaximalDerivativeOrder>::getNumVectors() const {
+		return this->_spline.getSplineOrder() - 1;
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	inline void _CLASS::Evaluator<IMaximalDerivativeOrder>::multiplyJets(const jet_t & a, const jet_t & b, int maxDerivativeOrder, jet_t & result) {
+		result[0].noalias() = a[0] * b[0];
+		if(maxDerivativeOrder >= 1){
+			result[1].noalias() = a[1] * b[0];
+			result[1].noalias() += a[0] * b[1];
+		}
+		if(maxDerivativeOrder >= 2){
+			result[2].noalias() = a[2] * b[0];
+			result[2].noalias() += 2 * a[1] * b[1];
+			result[2].noalias() += a[0] * b[2];
+		}
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	typename _CLASS::point_t _CLASS::Evaluator<IMaximalDerivativeOrder>::getPointDerivative(const CalculationCache & cache, int derivativeOrder) {
+		point_t result;
+		switch(derivativeOrder){
+		case 0:
+			return cache.value;
+		case 1:
+			result.template head<4>() = cache.qD;
+			break;
+		default:
+			result.template head<4>() = cache.qDD;
+			break;
+		}
+		result.template tail<3>() = cache.transformation[derivativeOrder].template topRightCorner<3, 1>();
+		return result;
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	typename _CLASS::point_t _CLASS::Evaluator<IMaximalDerivativeOrder>::getPointDerivativeVariation(const CalculationCache & cache, int derivativeOrder, const jet_t & variation) {
+		using sm::kinematics::qplus;
+		using internal::halfPureQuaternion;
+		const Eigen::Vector4d q = cache.value.template head<4>();
+		const Eigen::Matrix3d R = cache.transformation[0].template topLeftCorner<3, 3>();
+		const Eigen::Matrix3d dR = variation[0].template topLeftCorner<3, 3>();
+
+		// every variation of a rotation is a body rotation : dR = R * hat(eta) => dq = q (x) [eta / 2; 0]
+		const Eigen::Vector4d dq = qplus(q, halfPureQuaternion(internal::veeSkew(R.transpose() * dR)));
+		point_t result;
+		result.template tail<3>() = variation[derivativeOrder].template topRightCorner<3, 1>();
+		if(derivativeOrder == 0){
+			result.template head<4>() = dq;
+			return result;
+		}
+
+		const Eigen::Matrix3d RD = cache.transformation[1].template topLeftCorner<3, 3>();
+		const Eigen::Matrix3d dRD = variation[1].template topLeftCorner<3, 3>();
+		const Eigen::Vector3d dOmega = internal::veeSkew(dR.transpose() * RD + R.transpose() * dRD);
+		const Eigen::Vector4d dqD = qplus(dq, halfPureQuaternion(cache.omega)) + qplus(q, halfPureQuaternion(dOmega));
+		if(derivativeOrder == 1){
+			result.template head<4>() = dqD;
+			return result;
+		}
+
+		const Eigen::Matrix3d RDD = cache.transformation[2].template topLeftCorner<3, 3>();
+		const Eigen::Matrix3d dRDD = variation[2].template topLeftCorner<3, 3>();
+		const Eigen::Vector3d dOmegaD = internal::veeSkew(dRD.transpose() * RD + RD.transpose() * dRD + dR.transpose() * RDD + R.transpose() * dRDD);
+		result.template head<4>() = qplus(dqD, halfPureQuaternion(cache.omega)) + qplus(cache.qD, halfPureQuaternion(dOmega)) + qplus(dq, halfPureQuaternion(cache.omegaD)) + qplus(q, halfPureQuaternion(dOmegaD));
+		return result;
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	typename _CLASS::twist_t _CLASS::Evaluator<IMaximalDerivativeOrder>::getTwistVariation(const CalculationCache & cache, const jet_t & variation) {
+		const Eigen::Matrix3d R = cache.transformation[0].template topLeftCorner<3, 3>();
+		const Eigen::Matrix3d dR = variation[0].template topLeftCorner<3, 3>();
+		twist_t result;
+		result.template head<3>() = internal::veeSkew(dR.transpose() * cache.transformation[1].template topLeftCorner<3, 3>() + R.transpose() * variation[1].template topLeftCorner<3, 3>());
+		result.template tail<3>() = dR.transpose() * cache.transformation[1].template topRightCorner<3, 1>() + R.transpose() * variation[1].template topRightCorner<3, 1>();
+		return result;
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	typename _CLASS::point_t _CLASS::Evaluator<IMaximalDerivativeOrder>::evalD(int derivativeOrder) const {
+		SM_ASSERT_GE_LT_DBG(Exception, derivativeOrder, 0, MaxSupportedDerivativeOrderEvaluation + 1, "only derivatives up to " << MaxSupportedDerivativeOrderEvaluation << " are supported yet");
+		if(IMaximalDerivativeOrder != Eigen::Dynamic) {
+			SM_ASSERT_LT_DBG(Exception, derivativeOrder, IMaximalDerivativeOrder + 1, "only derivatives up to the evaluator's template argument IMaximalDerivativeOrder are allowed");
+		}
+		if(derivativeOrder == 0) return this->evalGeneric();
+		CalculationCache cache(this, derivativeOrder, false);
+		return getPointDerivative(cache, derivativeOrder);
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	typename _CLASS::transformation_matrix_t _CLASS::Evaluator<IMaximalDerivativeOrder>::evalTransformation() const {
+		return manifold_t::getTransformationMatrix(this->evalGeneric());
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	typename _CLASS::twist_t _CLASS::Evaluator<IMaximalDerivativeOrder>::evalTwist() const {
+		static_assert(IMaximalDerivativeOrder == Eigen::Dynamic || IMaximalDerivativeOrder >= 1, "the twist needs an evaluator prepared for derivative order 1");
+		CalculationCache cache(this, 1, false);
+		twist_t result;
+		result.template head<3>() = cache.omega;
+		result.template tail<3>() = cache.transformation[0].template topLeftCorner<3, 3>().transpose() * cache.transformation[1].template topRightCorner<3, 1>();
+		return result;
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	typename _CLASS::twist_t _CLASS::Evaluator<IMaximalDerivativeOrder>::evalTwistDerivative() const {
+		static_assert(IMaximalDerivativeOrder == Eigen::Dynamic || IMaximalDerivativeOrder >= 2, "the twist's derivative needs an evaluator prepared for derivative order 2");
+		CalculationCache cache(this, 2, false);
+		const jet_t & T = cache.transformation;
+		twist_t result;
+		result.template head<3>() = cache.omegaD;
+		result.template tail<3>() = T[1].template topLeftCorner<3, 3>().transpose() * T[1].template topRightCorner<3, 1>() + T[0].template topLeftCorner<3, 3>().transpose() * T[2].template topRightCorner<3, 1>();
+		return result;
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	void _CLASS::Evaluator<IMaximalDerivativeOrder>::evalJacobian(int derivativeOrder, full_jacobian_t & jacobian) const {
+		SM_ASSERT_GE_LT_DBG(Exception, derivativeOrder, 0, MaxSupportedDerivativeOrderJacobian + 1, "only Jacobians of derivatives up to " << MaxSupportedDerivativeOrderJacobian << " are supported yet");
+		if(IMaximalDerivativeOrder != Eigen::Dynamic) {
+			SM_ASSERT_LT_DBG(Exception, derivativeOrder, IMaximalDerivativeOrder + 1, "only derivatives up to the evaluator's template argument IMaximalDerivativeOrder are allowed");
+		}
+		const int dim = this->_spline.getDimension();
+		CalculationCache cache(this, derivativeOrder, true);
+		jacobian.resize(this->_spline.getPointSize(), dim * this->_spline.getSplineOrder());
+		for(int j = 0, n = cache.variations.size(); j < n; j++){
+			jacobian.col(j) = getPointDerivativeVariation(cache, derivativeOrder, cache.variations[j]);
+		}
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	void _CLASS::Evaluator<IMaximalDerivativeOrder>::evalJacobian(full_jacobian_t & jacobian) const {
+		evalJacobian(0, jacobian);
+	}
+
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	void _CLASS::Evaluator<IMaximalDerivativeOrder>::evalTwistJacobian(twist_jacobian_t & jacobian) const {
+		static_assert(IMaximalDerivativeOrder == Eigen::Dynamic || IMaximalDerivativeOrder >= 1, "the twist needs an evaluator prepared for derivative order 1");
+		const int dim = this->_spline.getDimension();
+		CalculationCache cache(this, 1, true);
+		jacobian.resize(dim, dim * this->_spline.getSplineOrder());
+		for(int j = 0, n = cache.variations.size(); j < n; j++){
+			jacobian.col(j) = getTwistVariation(cache, cache.variations[j]);
+		}
+	}
+
+	#undef _CLASS
+	#undef _TEMPLATE
+} // namespace bsplines
@@ -0,0 +1,92 @@
+/*
+ * SegmentQuadraticIntegral.hpp
+ *
+ *  Exact quadratic forms of a segment's weighted squared derivative integral, shared by the BSplineFitter and the spline motion error terms.
+ */
+
+#ifndef SEGMENTQUADRATICINTEGRAL_HPP_
+#define SEGMENTQUADRATICINTEGRAL_HPP_
+
+#include <stdexcept>
+#include <sm/assert_macros.hpp>
+#include "../DiffManifoldBSpline.hpp"
+
+namespace bsplines {
+namespace internal {
+
+	template <typename TSpline, typename M_T>
+	inline void computeBijInto(const TSpline & spline, const typename TSpline::SegmentConstIterator & segmentIndex, int columnIndex, M_T B)
+	{
+		const int D = spline.getPointSize();
+		const int splineOrder = spline.getSplineOrder();
+
+		for(int i = 0; i < D; i++)
+		{
+			B.block(i*splineOrder,i,splineOrder,1) = segmentIndex->getBasisMatrix().col(columnIndex);
+		}
+	}
+
+	template <typename TSpline, typename M_T>
+	inline void computeMiInto(const TSpline & spline, const typename TSpline::SegmentConstIterator & segmentIndex, M_T & M)
+	{
+		const int D = spline.getPointSize();
+		const int splineOrder = spline.getSplineOrder();
+		const int splineOrderTimesPointSize = splineOrder * D;
+		M.setZero();
+
+		for(int j = 0; j < splineOrder; j++)
+		{
+			computeBijInto(spline, segmentIndex, j, M.block(0, j*D, splineOrderTimesPointSize, D));
+		}
+	}
+
+	/**
+	 * Adds (or sets) the exact quadratic form of the segment's weighted squared derivative integral, int_segment |diag(Wdiag)^(1/2) d^derivativeOrder/dt^derivativeOrder spline(t)|^2 dt,
+	 * as matrix over the segment's relevant control vertices (stacked in their order) to toMatrix (splineOrder * pointSize square).
+	 */
+	template<typename TSpline, typename M_T>
+	inline void addOrSetSegmentQuadraticIntegralDiag(const TSpline & spline, const typename TSpline::point_t & Wdiag, typename TSpline::SegmentConstIterator segmentIt, int derivativeOrder, M_T toMatrix, bool add)
+	{
+		const int D = spline.getPointSize();
+		const int splineOrder = spline.getSplineOrder();
+		SM_ASSERT_GE_LT(std::runtime_error, segmentIt.getKnot(), spline.getMinTime(), spline.getMaxTime(), "Out of range");
+		SM_ASSERT_EQ(std::runtime_error, Wdiag.rows(), D, "Wdiag must be of control point size");
+
+		typename TSpline::SplineOrderSquareMatrix Dm(splineOrder, splineOrder);
+		Dm.setZero(splineOrder, splineOrder);
+		spline.computeDiiInto(segmentIt, Dm);
+		typename TSpline::SplineOrderSquareMatrix V(splineOrder, splineOrder);
+		V.setZero(splineOrder, splineOrder);
+		spline.computeViInto(segmentIt, V);
+
+		// Calculate the appropriate derivative version of V
+		// using the matrix multiplication version of the derivative.
+		for(int i = 0; i < derivativeOrder; i++)
+		{
+			V = (Dm.transpose() * V * Dm).eval();
+		}
+
+		const auto splineOrderTimesPointSize = spline.getSplineOrder() * spline.getPointSize();
+		typedef decltype(splineOrderTimesPointSize) SplineOrderTimesPointSize;
+		typedef Eigen::Matrix<double, SplineOrderTimesPointSize::VALUE, SplineOrderTimesPointSize::VALUE> MType;
+
+		MType WV((int)splineOrderTimesPointSize, (int)splineOrderTimesPointSize);
+
+		WV.setZero(splineOrderTimesPointSize, splineOrderTimesPointSize);
+
+		for(int d = 0; d < D; d++)
+		{
+			WV.block(splineOrder*d, splineOrder*d, splineOrder, splineOrder) = Wdiag(d) * V;
+		}
+
+		MType M((int)splineOrderTimesPointSize, (int)splineOrderTimesPointSize);
+		computeMiInto(spline, segmentIt, M);
+
+		if(add) toMatrix += M.transpose() * WV * M;
+		else toMatrix = M.transpose() * WV * M;
+	}
+
+} // namespace internal
+} // namespace bsplines
+
+#endif /* SEGMENTQUADRATICINTEGRAL_HPP_ */
@@ -36,7 +36,7 @@ namespace bsplines{
 			NumVectors = ISplineOrder == Eigen::Dynamic ? Eigen::Dynamic : ISplineOrder - 1
 		};
 
-		//TODO optimize : store vectors in segment map
+		// the phi vectors are cached in the segment map if log vector caching is enabled (see computeLogVectorInto)
 
 		DynOrStaticSizedArray<tangent_vector_t, NumVectors> localPhiVectors;
 		DynOrStaticSizedArray<point_t, NumVectors> localRiPoints;
@@ -57,17 +57,14 @@ namespace bsplines{
 
 		CalculationCache(const Evaluator * eval) : localPhiVectors(eval->getNumVectors()), localRiPoints(eval->getNumVectors()), localControlVertices(eval->_spline.getSplineOrder())
 		{
-			const auto & geo = eval->_spline.getManifold();
-			SegmentMapConstIterator it = eval->_firstRelevantControlVertexIt;
-			const point_t * lastControlVertex = & it->second.getControlVertex();
-			localControlVertices[0] = lastControlVertex;
+			SegmentMapConstIterator it = eval->_firstRelevantControlVertexIt, lastIt = it;
+			localControlVertices[0] = & it->second.getControlVertex();
 			for (int k = 0, n = eval->getNumVectors(); k < n; k++){
 				it++;
-				const point_t * nextControlVertex = & it->second.getControlVertex();
-				geo.logInto(*lastControlVertex, *nextControlVertex, localPhiVectors[k]);
-				localControlVertices[k+1] = nextControlVertex;
+				eval->_spline.computeLogVectorInto(lastIt, it, localPhiVectors[k]);
+				localControlVertices[k+1] = & it->second.getControlVertex();
 				localRiPoints[k] = eval->_spline.getManifold().expAtId(localPhiVectors[k] * eval->getLocalCumulativeBi(0)[k+1]);
-				lastControlVertex = nextControlVertex;
+				lastIt = it;
 			}
 		}
 	};
@@ -124,6 +121,12 @@ namespace bsplines{
 	{
 	}
 
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	_CLASS::Evaluator<IMaximalDerivativeOrder>::Evaluator(const spline_t & spline, const time_t & t, const SegmentConstIterator & segmentIt) : parent_t::template Evaluator<IMaximalDerivativeOrder> (spline, t, segmentIt)
+	{
+	}
+
 	_TEMPLATE
 	template<int IMaximalDerivativeOrder>
 	typename _CLASS::point_t _CLASS::Evaluator<IMaximalDerivativeOrder>::evalD(int derivativeOrder) const {
@@ -236,25 +239,33 @@ namespace bsplines{
 	_TEMPLATE
 	template<int IMaximalDerivativeOrder>
 	typename _CLASS::dmatrix_t _CLASS::Evaluator<IMaximalDerivativeOrder>::getRiDJacobian(const CalculationCache & cache, int derivativeOrder, int i) const {
-		if(derivativeOrder == 0){
-//					std::cout << "r_i=\n" << cache.getLocalRiPoint(i) << "\n, q_i-1=\n" << cache.getLocalControlVertex(i - 1) << "\n, C_i-1=\n" << quat2r(quatInv(cache.getLocalControlVertex(i-1))) << ", ret = " << ret << "\n, oplus_i = \n"<< quatOPlus(cache.getLocalRiPoint(i))<< "\n, beta_i = \n" << this->getLocalCumulativeBi(0)[i]<< std::endl;
-			return quatOPlus(cache.getLocalRiPoint(i)) * this->_spline.getManifold().V() * (this->_spline.getManifold().S(this->getLocalCumulativeBi(0)[i] * cache.getLocalPhiVector(i)) * this->getLocalCumulativeBi(0)[i] * getPhiVectorJacobian(cache, i));
+		if(derivativeOrder > 2){
+			throw Exception("only derivatives up to order 2 are supported yet");
 		}
+		dmatrix_t jacobians[3];
+		getRiDJacobians(cache, derivativeOrder, i, jacobians);
+		return jacobians[derivativeOrder];
+	}
 
-		dmatrix_t VPhiJac = this->_spline.getManifold().V() * getPhiVectorJacobian(cache, i);
-		point_t phiQuad = this->_spline.getManifold().V() * cache.getLocalPhiVector(i);
-		dmatrix_t PhiRiJac = quatOPlus(cache.getLocalRiPoint(i)) * VPhiJac + quatPlus(phiQuad) * getRiDJacobian(cache, 0, i);
-		switch(derivativeOrder){
-		case 1:
-			return this->getLocalCumulativeBi(derivativeOrder)[i] * PhiRiJac;
-		case 2:
-			{
-				double cumBiPrime = this->getLocalCumulativeBi(1)[i];
-				point_t tmp = phiQuad * (cumBiPrime * cumBiPrime);
-				tmp[3] += this->getLocalCumulativeBi(2)[i];
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	void _CLASS::Evaluator<IMaximalDerivativeOrder>::getRiDJacobians(const CalculationCache & cache, int maxDerivativeOrder, int i, dmatrix_t * jacobians) const {
+		SM_ASSERT_LE_DBG(Exception, maxDerivativeOrder, 2, "only derivatives up to order 2 are supported yet");
+//					std::cout << "r_i=\n" << cache.getLocalRiPoint(i) << "\n, q_i-1=\n" << cache.getLocalControlVertex(i - 1) << "\n, C_i-1=\n" << quat2r(quatInv(cache.getLocalControlVertex(i-1))) << ", ret = " << ret << "\n, oplus_i = \n"<< quatOPlus(cache.getLocalRiPoint(i))<< "\n, beta_i = \n" << this->getLocalCumulativeBi(0)[i]<< std::endl;
+		const Eigen::Matrix<double, spline_t::Dimension, spline_t::Dimension> phiVectorJacobian = getPhiVectorJacobian(cache, i);
+		jacobians[0] = quatOPlus(cache.getLocalRiPoint(i)) * this->_spline.getManifold().V() * (this->_spline.getManifold().S(this->getLocalCumulativeBi(0)[i] * cache.getLocalPhiVector(i)) * this->getLocalCumulativeBi(0)[i] * phiVectorJacobian);
+		if(maxDerivativeOrder == 0) return;
 
-				return quatPlus(tmp) * PhiRiJac + quatOPlus(qplus(phiQuad, cache.getLocalRiPoint(i))) * (cumBiPrime * cumBiPrime) * VPhiJac;
-			}
+		dmatrix_t VPhiJac = this->_spline.getManifold().V() * phiVectorJacobian;
+		point_t phiQuad = this->_spline.getManifold().V() * cache.getLocalPhiVector(i);
+		dmatrix_t PhiRiJac = quatOPlus(cache.getLocalRiPoint(i)) * VPhiJac + quatPlus(phiQuad) * jacobians[0];
+		const double cumBiPrime = this->getLocalCumulativeBi(1)[i];
+		jacobians[1] = cumBiPrime * PhiRiJac;
+		if(maxDerivativeOrder == 1) return;
+
+		point_t tmp = phiQuad * (cumBiPrime * cumBiPrime);
+		tmp[3] += this->getLocalCumulativeBi(2)[i];
+		jacobians[2] = quatPlus(tmp) * PhiRiJac + quatOPlus(qplus(phiQuad, cache.getLocalRiPoint(i))) * (cumBiPrime * cumBiPrime) * VPhiJac;
 //				case 3: //TODO implement: Jacobian of third order time derivative
 //					{
 //						point_t phiQuad = this->_spline.getManifold().V() * cache.getLocalPhiVector(i);
@@ -270,9 +281,6 @@ namespace bsplines{
 //
 //						return qplus(phiQuad, qplus(tmp, qplus(cummBiPrime *phiQuad, tmp2) + tmp3));
 //					}
-		default:
-			throw Exception("only derivatives up to order 2 are supported yet");
-		}
 	}
 
 	_TEMPLATE
@@ -302,25 +310,27 @@ namespace bsplines{
 	typename _CLASS::tangent_vector_t _CLASS::Evaluator<IMaximalDerivativeOrder>::evalAngularDerivative() const{
 		static_assert(IDerivativeOrder <= 3 && IDerivativeOrder >= 1, "Only angular derivatives of order 1, 2, 3 are supported.");
 
-		point_t d = evalD(IDerivativeOrder);
-		Eigen::Vector3d deps = qeps(d);
-		point_t v = this->eval();
-		Eigen::Vector3d veps = qeps(v);
-		Eigen::Vector3d tmp = (qeta(v) * deps - qeta(d) * veps - veps.cross(deps));
+		const tangent_vector_t ret = computeAngularDerivative(this->eval(), evalD(IDerivativeOrder));
 
 		switch(IDerivativeOrder){
 			case 1:
 			case 2:
-				return 2 * tmp;
+				return ret;
 			case 3:
 			{
-				point_t d1 = evalD(1);
-				point_t d2 = evalD(2);
-				return 2 * (tmp + qeta(d1) * qeps(d2) - qeta(d2) * qeps(d1) - qeps(d1).cross(qeps(d2)));
+				return ret + computeAngularDerivative(evalD(1), evalD(2));
 			}
 		}
 	}
 
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	inline typename _CLASS::tangent_vector_t _CLASS::Evaluator<IMaximalDerivativeOrder>::computeAngularDerivative(const point_t & q, const point_t & qD) {
+		Eigen::Vector3d deps = qeps(qD);
+		Eigen::Vector3d veps = qeps(q);
+		return 2 * (qeta(q) * deps - qeta(qD) * veps - veps.cross(deps));
+	}
+
 	_TEMPLATE
 	template<int IMaximalDerivativeOrder>
 	typename _CLASS::point_t _CLASS::Evaluator<IMaximalDerivativeOrder>::evalDRecursive(int derivativeOrder) const {
@@ -427,21 +437,27 @@ namespace bsplines{
 	template <int IDerivativeOrder>
 	void _CLASS::Evaluator<IMaximalDerivativeOrder>::evalAngularDerivativeJacobian(angular_jacobian_t & jacobian) const{
 		static_assert(IDerivativeOrder <= IMaximalDerivativeOrder, "You have to set the evaluator's IMaximalDerivativeOrder template argument to at least the requested angular derivative's order!");
-		point_t d = evalD(IDerivativeOrder);
-		Eigen::Vector3d deps = qeps(d);
-		point_t v = this->eval();
-		Eigen::Vector3d veps = qeps(v);
 
 		int dim = this->_spline.getDimension(), splineOrder = this->_spline.getSplineOrder(), pointSize = this->_spline.getPointSize();
 		full_jacobian_t qJac(pointSize, dim * splineOrder), dqJac(pointSize, dim * splineOrder);
 		evalJacobian(IDerivativeOrder, dqJac);
+		evalJacobian(0, qJac);
 
-		const auto depsJac = dqJac.block(0, 0, dim, splineOrder * dim);
-		const auto etaDJac = dqJac.block(dim, 0, 1, splineOrder * dim);
+		computeAngularDerivativeJacobian(this->eval(), evalD(IDerivativeOrder), qJac, dqJac, jacobian);
+	}
 
-		evalJacobian(0, qJac);
-		const auto vepsJac = qJac.block(0, 0, dim, splineOrder * dim);
-		const auto etaJac = qJac.block(dim, 0, 1, splineOrder * dim);
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	void _CLASS::Evaluator<IMaximalDerivativeOrder>::computeAngularDerivativeJacobian(const point_t & v, const point_t & d, const full_jacobian_t & qJac, const full_jacobian_t & dqJac, angular_jacobian_t & jacobian) {
+		const int dim = 3;
+		Eigen::Vector3d deps = qeps(d);
+		Eigen::Vector3d veps = qeps(v);
+
+		const auto depsJac = dqJac.topRows(dim);
+		const auto etaDJac = dqJac.row(dim);
+
+		const auto vepsJac = qJac.topRows(dim);
+		const auto etaJac = qJac.row(dim);
 
 		//TODO optimize : move the factor 2 to the d and v terms to save a big matrix scaling
 //				return 2 * (qeta(v) * deps - qeta(d) * veps - veps.cross(deps));
@@ -452,6 +468,60 @@ namespace bsplines{
 		);
 	}
 
+	_TEMPLATE
+	template<int IMaximalDerivativeOrder>
+	void _CLASS::Evaluator<IMaximalDerivativeOrder>::evalAngularVelocityAndAcceleration(tangent_vector_t & angularVelocity, tangent_vector_t & angularAcceleration, angular_jacobian_t * angularVelocityJacobian, angular_jacobian_t * angularAccelerationJacobian) const {
+		static_assert(2 <= IMaximalDerivativeOrder, "You have to set the evaluator's IMaximalDerivativeOrder template argument to at least 2!");
+
+		const bool withJacobians = angularVelocityJacobian || angularAccelerationJacobian;
+		const int D = this->_spline.getPointSize(), n = this->_spline.getSplineOrder(), dim = this->_spline.getManifold().getDimension();
+		const auto & geo = this->_spline.getManifold();
+		CalculationCache cache(this);
+
+		// p[d] is the d-th time derivative of the partial product q_0 * r_1 * ... * r_i, pJac[d] its Jacobian
+		point_t p[3], nextP[3], r[3];
+		full_jacobian_t pJac[3], nextPJac[3];
+		dmatrix_t rJac[3];
+
+		p[0] = cache.getLocalStartPoint();
+		p[1].setZero();
+		p[2].setZero();
+		if(withJacobians){
+			for(int d = 0; d < 3; d++) pJac[d].setZero(D, dim * n);
+			pJac[0].block(0, 0, D, dim) = quatOPlus(p[0]) * geo.V();
+		}
+
+		for(int i = 1; i < n; i++){
+			for(int d = 0; d < 3; d++) r[d] = evalRiD(cache, d, i);
+			if(withJacobians) getRiDJacobians(cache, 2, i, rJac);
+
+			// Leibniz rule : (p * r)^(d) = sum_k binomial(d, k) p^(k) * r^(d - k)
+			for(int d = 0; d < 3; d++){
+				nextP[d].setZero();
+				if(withJacobians) nextPJac[d].setZero(D, dim * n);
+				for(int k = 0; k <= d; k++){
+					const double binomial = (d == 2 && k == 1) ? 2 : 1;
+					nextP[d] += binomial * qplus(p[k], r[d - k]);
+					if(withJacobians){
+						const dmatrix_t rJacobianPart = binomial * quatPlus(p[k]) * rJac[d - k];
+						nextPJac[d].noalias() += binomial * quatOPlus(r[d - k]) * pJac[k];
+						nextPJac[d].block(0, i * dim, D, dim) += rJacobianPart;
+						nextPJac[d].block(0, (i - 1) * dim, D, dim) -= rJacobianPart;
+					}
+				}
+			}
+			for(int d = 0; d < 3; d++){
+				p[d] = nextP[d];
+				if(withJacobians) pJac[d].swap(nextPJac[d]);
+			}
+		}
+
+		angularVelocity = computeAngularDerivative(p[0], p[1]);
+		angularAcceleration = computeAngularDerivative(p[0], p[2]);
+		if(angularVelocityJacobian) computeAngularDerivativeJacobian(p[0], p[1], pJac[0], pJac[1], *angularVelocityJacobian);
+		if(angularAccelerationJacobian) computeAngularDerivativeJacobian(p[0], p[2], pJac[0], pJac[2], *angularAccelerationJacobian);
+	}
+
 	_TEMPLATE
 	template<int IMaximalDerivativeOrder>
 	inline void _CLASS::Evaluator<IMaximalDerivativeOrder>::evalAngularVelocityJacobian(angular_jacobian_t & jacobian) const{
@@ -464,6 +534,94 @@ namespace bsplines{
 		evalAngularDerivativeJacobian<2>(jacobian);
 	}
 
+	_TEMPLATE
+	void _CLASS::setLogVectorCaching(bool enable){
+		if(!enable){
+			_logVectorSlot.reset();
+		}
+		else if(!_logVectorSlot){
+			_logVectorSlot = this->template registerSegmentCacheSlot<tangent_vector_t>();
+		}
+	}
+
+	_TEMPLATE
+	inline void _CLASS::computeLogVectorInto(const SegmentMapConstIterator & previous, const SegmentMapConstIterator & segment, tangent_vector_t & phi) const {
+		if(!_logVectorSlot){
+			this->getManifold().logInto(previous->second.getControlVertex(), segment->second.getControlVertex(), phi);
+			return;
+		}
+		// updates of the segment's own control vertex invalidate the entry, those of the previous one change the dependency stamp
+		phi = _logVectorSlot->get(const_cast<typename parent_t::segment_data_t &>(segment->second), [&](tangent_vector_t & value){
+			this->getManifold().logInto(previous->second.getControlVertex(), segment->second.getControlVertex(), value);
+		}, previous->second.accessCache().getUpdateCount());
+	}
+
+	_TEMPLATE
+	template<typename TPointContainer>
+	void _CLASS::evalBatchVectorized(const std::vector<time_t> & times, TPointContainer & output) const {
+		typedef typename manifold_t::point_batch_t point_batch_t;
+		typedef typename manifold_t::tangent_vector_batch_t tangent_vector_batch_t;
+		typedef typename parent_t::duration_t duration_t;
+
+		const int numberOfTimes = times.size();
+		const int splineOrder = this->getSplineOrder();
+		const int numVectors = splineOrder - 1;
+		output.resize(numberOfTimes);
+		if(numberOfTimes == 0) return;
+		this->assertEvaluable();
+
+		// gather the start points and the scaled control vertex differences per time (the differences and the basis matrix are shared by all times in one segment)
+		point_batch_t product(numberOfTimes, 4), factor(numberOfTimes, 4), tmp(numberOfTimes, 4);
+		std::vector<tangent_vector_batch_t> scaledPhiVectors(numVectors, tangent_vector_batch_t(numberOfTimes, 3));
+		std::vector<tangent_vector_t> phiVectors(numVectors);
+		SplineOrderVector u(splineOrder), cumulativeBi(splineOrder);
+
+		SegmentConstIterator segmentIt = this->getSegmentIterator(times[0]), lastSegmentIt = segmentIt;
+		const point_t * startPoint = NULL;
+		duration_t segmentLength = duration_t();
+		for(int i = 0; i < numberOfTimes; i++){
+			segmentIt = this->getSegmentIterator(times[i], segmentIt);
+			if(i == 0 || segmentIt != lastSegmentIt){
+				SegmentMapConstIterator it = this->getFirstRelevantSegmentByLast(segmentIt);
+				startPoint = & it->second.getControlVertex();
+				for(int k = 0; k < numVectors; k++){
+					SegmentMapConstIterator lastIt = it++;
+					computeLogVectorInto(lastIt, it, phiVectors[k]);
+				}
+				segmentLength = this->computeSegmentLength(segmentIt);
+				lastSegmentIt = segmentIt;
+			}
+			product.row(i) = startPoint->transpose();
+
+			// the cumulative basis functions as in Evaluator::computeUInto and computeLocalCumulativeBiInto, without constructing an evaluator
+			if(segmentLength > TTimePolicy::getZero()){
+				const double relativePosition = parent_t::divideDurations(parent_t::computeDuration(segmentIt.getKnot(), times[i]), segmentLength);
+				double power = 1.0;
+				for(int k = 0; k < splineOrder; k++, power *= relativePosition) u[k] = power;
+			} else {
+				u.setZero(splineOrder);
+			}
+			fastMultiplyAtransposedTimesBInto(segmentIt->getBasisMatrix(), u, cumulativeBi);
+			cumulativeBi[0] = 1.0;
+			for(int k = splineOrder - 2; k > 0; k--) cumulativeBi[k] += cumulativeBi[k + 1];
+
+			for(int k = 0; k < numVectors; k++){
+				scaledPhiVectors[k].row(i) = (phiVectors[k] * cumulativeBi[k + 1]).transpose();
+			}
+		}
+
+		// p = p_0 * exp(phi_1 * b_1) * ... * exp(phi_{n} * b_{n}) for all times at once
+		for(int k = 0; k < numVectors; k++){
+			manifold_t::expAtIdBatchInto(scaledPhiVectors[k], factor);
+			manifold_t::multBatchInto(product, factor, tmp);
+			product.swap(tmp);
+		}
+
+		for(int i = 0; i < numberOfTimes; i++){
+			output[i] = product.row(i).transpose();
+		}
+	}
+
 	#undef _CLASS
 	#undef _TEMPLATE
 } // namespace bsplines
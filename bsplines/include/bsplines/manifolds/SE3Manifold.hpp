@@ -0,0 +1,87 @@
+/*
+ * SE3Manifold.hpp
+ *
+ *  Rigid body transformations as a Lie group.
+ *  A point is the pair (q, t) stored as [q (4, same convention as the UnitQuaternionManifold); t (3)] and represents x -> quat2r(q) * x + t.
+ *  A tangent vector is [phi (3, rotation); rho (3, translation)] and expAtId([phi; rho]) = (axisAngle2quat(phi), J(phi) * rho) with J the left Jacobian of SO(3).
+ */
+
+#ifndef SE3MANIFOLD_HPP_
+#define SE3MANIFOLD_HPP_
+
+#include "LieGroup.hpp"
+#include "UnitQuaternionManifold.hpp"
+
+namespace manifolds {
+	template <typename TScalar = double>
+	struct SE3ManifoldConf : public LieGroupConf<6, 7, TScalar> {
+		typedef LieGroupConf<6, 7, TScalar> ParentConf;
+		typedef DiffManifold<ParentConf> ParentManifold;
+		typedef SE3ManifoldConf Conf;
+		typedef DiffManifold<Conf> Manifold;
+
+		typename ParentConf::Dimension getDimension() const { return ParentConf::Dimension::VALUE; }
+		typename ParentConf::PointSize getPointSize() const { return ParentConf::PointSize::VALUE; }
+	};
+
+	template <typename TScalar, typename TConfigurationDerived >
+	class DiffManifold< SE3ManifoldConf<TScalar>, TConfigurationDerived> : public DiffManifold<typename SE3ManifoldConf<TScalar>::ParentConf, TConfigurationDerived> {
+	public:
+		typedef DiffManifold<typename SE3ManifoldConf<TScalar>::ParentConf, TConfigurationDerived> parent_t;
+		typedef TConfigurationDerived configuration_t;
+		typedef internal::DiffManifoldConfigurationTypeTrait<configuration_t> Types;
+		typedef typename Types::scalar_t scalar_t;
+		typedef typename Types::point_t point_t;
+		typedef typename Types::tangent_vector_t tangent_vector_t;
+		typedef typename Types::dmatrix_t dmatrix_t;
+		typedef typename Types::dmatrix_transposed_t dmatrix_transposed_t;
+		typedef typename Types::dmatrix_point2point_t dmatrix_point2point_t;
+
+		/// homogeneous 4x4 transformation matrix
+		typedef Eigen::Matrix<scalar_t, 4, 4> transformation_matrix_t;
+		/// linear maps of the tangent space (adjoints, Jacobians of exp and log in tangent space coordinates)
+		typedef Eigen::Matrix<scalar_t, 6, 6> tangent_map_t;
+
+		DiffManifold(configuration_t configuration) : parent_t(configuration) {};
+		DiffManifold() : parent_t(configuration_t()) {};
+
+		static void getIdentityInto(point_t & pt);
+		static bool isInManifold(const point_t & pt);
+		static void projectIntoManifold(point_t & pt);
+		static void randomizePoint(point_t & pt);
+
+		static void multInto(const point_t & a, const point_t & b, point_t & result);
+		/// the Jacobian of mult * x (or x * mult if oppositeMult) with respect to x. For oppositeMult it is taken at x = identity, as the product is not bilinear here.
+		inline dmatrix_point2point_t dMultL(const point_t & mult, bool oppositeMult) const;
+		inline void invertInto(const point_t & p, point_t & result) const;
+
+		static void expAtIdInto(const tangent_vector_t & vec, point_t & result);
+		static point_t expAtId(const tangent_vector_t & vec);
+		void dexpAtIdInto(const tangent_vector_t & vec, dmatrix_t & result) const;
+
+		static void logAtIdInto(const point_t & to, tangent_vector_t & result);
+		void dlogAtIdInto(const point_t & to, dmatrix_transposed_t & result) const;
+
+		static transformation_matrix_t getTransformationMatrix(const point_t & p);
+		/// the 4x4 Lie algebra matrix of vec, such that expAtId(vec) = exp(hat(vec)) as matrices
+		static transformation_matrix_t hat(const tangent_vector_t & vec);
+		/// Ad(p) with hat(Ad(p) * vec) = T(p) * hat(vec) * T(p)^-1
+		static tangent_map_t adjoint(const point_t & p);
+		/// J with expAtId(vec + d) ~= expAtId(J * d) * expAtId(vec) for small d
+		static tangent_map_t leftJacobian(const tangent_vector_t & vec);
+		static tangent_map_t inverseLeftJacobian(const tangent_vector_t & vec);
+		/// the Jacobian of the coordinates of expAtId(d) * p with respect to d at d = 0 (the coordinate change of the design variable update)
+		static dmatrix_t dLeftPerturbation(const point_t & p);
+
+	private:
+		static Eigen::Matrix3d rotationLeftJacobian(const Eigen::Vector3d & phi);
+		static Eigen::Matrix3d rotationInverseLeftJacobian(const Eigen::Vector3d & phi);
+		/// the lower left block of the left Jacobian (Barfoot's Q)
+		static Eigen::Matrix3d leftJacobianCoupling(const Eigen::Vector3d & phi, const Eigen::Vector3d & rho);
+		/// the Jacobian of quat2r(q) * v with respect to q
+		static Eigen::Matrix<double, 3, 4> dRotate(const Eigen::Vector4d & q, const Eigen::Vector3d & v);
+	};
+}
+
+#include "implementation/SE3ManifoldImpl.hpp"
+#endif /* SE3MANIFOLD_HPP_ */
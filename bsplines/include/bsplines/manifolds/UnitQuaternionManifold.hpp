@@ -58,6 +58,17 @@ namespace manifolds {
 
 		static void logAtIdInto(const point_t & to, tangent_vector_t & result);
 		void dlogAtIdInto(const point_t & to, dmatrix_transposed_t & result) const;
+
+		/*
+		 * Batched versions of mult and expAtId, as used by UnitQuaternionBSpline::evalBatchVectorized. The batches are stored as structure of arrays (one row per point / vector, one column per coordinate),
+		 * such that Eigen can vectorize the column wise arithmetic with whatever SIMD instruction set is enabled (and falls back to scalar code otherwise).
+		 * result must not alias any argument.
+		 */
+		typedef Eigen::Array<scalar_t, Eigen::Dynamic, 4> point_batch_t;
+		typedef Eigen::Array<scalar_t, Eigen::Dynamic, 3> tangent_vector_batch_t;
+
+		static void multBatchInto(const point_batch_t & a, const point_batch_t & b, point_batch_t & result);
+		static void expAtIdBatchInto(const tangent_vector_batch_t & vecs, point_batch_t & result);
 	};
 }
 
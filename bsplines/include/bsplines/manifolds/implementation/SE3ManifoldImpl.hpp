@@ -0,0 +1,255 @@
+/*
+ * SE3ManifoldImpl.hpp
+ */
+
+#include <sm/kinematics/quaternion_algebra.hpp>
+#include <sm/kinematics/rotations.hpp>
+
+#include "bsplines/manifolds/SE3Manifold.hpp"
+
+
+namespace manifolds {
+
+#define _TEMPLATE template <typename TScalar, typename TConfigurationDerived>
+#define _CLASS DiffManifold<SE3ManifoldConf<TScalar>, TConfigurationDerived>
+
+namespace internal {
+	/// below this rotation angle the coefficients of the SO(3) / SE(3) Jacobians are evaluated by their Taylor expansions to avoid cancellation
+	constexpr double SE3SeriesThreshold = 0.1;
+}
+
+_TEMPLATE
+inline void _CLASS::getIdentityInto(point_t & result) {
+	result << 0, 0, 0, 1, 0, 0, 0;
+}
+
+_TEMPLATE
+bool _CLASS::isInManifold(const point_t & pt)
+{
+	return fabs(pt.template head<4>().norm() - 1) < fabs(1E-9);
+}
+
+_TEMPLATE
+void _CLASS::projectIntoManifold(point_t & pt)
+{
+	SM_ASSERT_GT_DBG(std::runtime_error, pt.template head<4>().norm(), 1E-3, "This quaternion cannot be projected into the unit quaternions!");
+	pt.template head<4>() /= pt.template head<4>().norm();
+}
+
+_TEMPLATE
+void _CLASS::randomizePoint(point_t & pt)
+{
+	Eigen::Vector4d q;
+	DiffManifold<UnitQuaternionManifoldConf<TScalar> >::randomizePoint(q);
+	pt.template head<4>() = q;
+	pt.template tail<3>() = Eigen::Vector3d::Random() * 5;
+}
+
+_TEMPLATE
+inline void _CLASS::multInto(const point_t & a, const point_t & b, point_t & result)
+{
+	const Eigen::Vector4d qa = a.template head<4>();
+	result.template tail<3>() = a.template tail<3>() + ::sm::kinematics::quat2r(qa) * b.template tail<3>();
+	result.template head<4>() = ::sm::kinematics::qplus(qa, b.template head<4>());
+}
+
+_TEMPLATE
+inline typename _CLASS::dmatrix_point2point_t _CLASS::dMultL(const point_t & mult, bool oppositeMult) const
+{
+	dmatrix_point2point_t result = dmatrix_point2point_t::Zero();
+	const Eigen::Vector4d q = mult.template head<4>();
+	if(!oppositeMult){
+		result.template topLeftCorner<4, 4>() = ::sm::kinematics::quatPlus(q);
+		result.template bottomRightCorner<3, 3>() = ::sm::kinematics::quat2r(q);
+	} else {
+		result.template topLeftCorner<4, 4>() = ::sm::kinematics::quatOPlus(q);
+		result.template bottomLeftCorner<3, 4>() = dRotate(::sm::kinematics::quatIdentity(), mult.template tail<3>());
+		result.template bottomRightCorner<3, 3>().setIdentity();
+	}
+	return result;
+}
+
+_TEMPLATE
+inline void _CLASS::invertInto(const point_t & p, point_t & result) const
+{
+	const Eigen::Vector4d q = p.template head<4>();
+	result.template tail<3>() = - ::sm::kinematics::quat2r(q).transpose() * p.template tail<3>();
+	result.template head<4>() = ::sm::kinematics::quatInv(q);
+}
+
+_TEMPLATE
+inline typename _CLASS::point_t _CLASS::expAtId(const tangent_vector_t & vec)
+{
+	point_t result;
+	expAtIdInto(vec, result);
+	return result;
+}
+
+_TEMPLATE
+inline void _CLASS::expAtIdInto(const tangent_vector_t & vec, point_t & result)
+{
+	const Eigen::Vector3d phi = vec.template head<3>();
+	result.template head<4>() = ::sm::kinematics::axisAngle2quat(phi);
+	result.template tail<3>() = rotationLeftJacobian(phi) * vec.template tail<3>();
+}
+
+_TEMPLATE
+inline void _CLASS::dexpAtIdInto(const tangent_vector_t & vec, dmatrix_t & result) const
+{
+	result = dLeftPerturbation(expAtId(vec)) * leftJacobian(vec);
+}
+
+_TEMPLATE
+inline void _CLASS::logAtIdInto(const point_t & to, tangent_vector_t & result)
+{
+	const Eigen::Vector3d phi = ::sm::kinematics::quat2AxisAngle(to.template head<4>());
+	result.template head<3>() = phi;
+	result.template tail<3>() = rotationInverseLeftJacobian(phi) * to.template tail<3>();
+}
+
+_TEMPLATE
+void _CLASS::dlogAtIdInto(const point_t & to, dmatrix_transposed_t & result) const {
+	const Eigen::Vector4d q = to.template head<4>();
+	const Eigen::Vector3d t = to.template tail<3>();
+	const Eigen::Vector3d phi = ::sm::kinematics::quat2AxisAngle(q);
+	const Eigen::Matrix3d JInv = rotationInverseLeftJacobian(phi);
+	const Eigen::Matrix<double, 3, 4> dPhi = ::sm::kinematics::quatLogJacobian2(q);
+
+	// rho = J(phi)^-1 * t and t = J(phi) * rho => d rho / d phi = - J^-1 * d (J(phi) * rho) / d phi = - J^-1 * (Q - t^ * J)
+	const Eigen::Matrix3d dRhoDPhi = - JInv * (leftJacobianCoupling(phi, JInv * t) - ::sm::kinematics::crossMx(t) * rotationLeftJacobian(phi));
+	result.template topLeftCorner<3, 4>() = dPhi;
+	result.template topRightCorner<3, 3>().setZero();
+	result.template bottomLeftCorner<3, 4>() = dRhoDPhi * dPhi;
+	result.template bottomRightCorner<3, 3>() = JInv;
+}
+
+_TEMPLATE
+inline typename _CLASS::transformation_matrix_t _CLASS::getTransformationMatrix(const point_t & p)
+{
+	transformation_matrix_t T = transformation_matrix_t::Identity();
+	T.template topLeftCorner<3, 3>() = ::sm::kinematics::quat2r(p.template head<4>());
+	T.template topRightCorner<3, 1>() = p.template tail<3>();
+	return T;
+}
+
+_TEMPLATE
+inline typename _CLASS::transformation_matrix_t _CLASS::hat(const tangent_vector_t & vec)
+{
+	transformation_matrix_t X = transformation_matrix_t::Zero();
+	X.template topLeftCorner<3, 3>() = ::sm::kinematics::crossMx(vec.template head<3>());
+	X.template topRightCorner<3, 1>() = vec.template tail<3>();
+	return X;
+}
+
+_TEMPLATE
+inline typename _CLASS::tangent_map_t _CLASS::adjoint(const point_t & p)
+{
+	const Eigen::Matrix3d C = ::sm::kinematics::quat2r(p.template head<4>());
+	tangent_map_t Ad;
+	Ad.template topLeftCorner<3, 3>() = C;
+	Ad.template topRightCorner<3, 3>().setZero();
+	Ad.template bottomLeftCorner<3, 3>() = ::sm::kinematics::crossMx(p.template tail<3>()) * C;
+	Ad.template bottomRightCorner<3, 3>() = C;
+	return Ad;
+}
+
+_TEMPLATE
+inline typename _CLASS::tangent_map_t _CLASS::leftJacobian(const tangent_vector_t & vec)
+{
+	const Eigen::Vector3d phi = vec.template head<3>();
+	const Eigen::Matrix3d J = rotationLeftJacobian(phi);
+	tangent_map_t result;
+	result.template topLeftCorner<3, 3>() = J;
+	result.template topRightCorner<3, 3>().setZero();
+	result.template bottomLeftCorner<3, 3>() = leftJacobianCoupling(phi, vec.template tail<3>());
+	result.template bottomRightCorner<3, 3>() = J;
+	return result;
+}
+
+_TEMPLATE
+inline typename _CLASS::tangent_map_t _CLASS::inverseLeftJacobian(const tangent_vector_t & vec)
+{
+	const Eigen::Vector3d phi = vec.template head<3>();
+	const Eigen::Matrix3d JInv = rotationInverseLeftJacobian(phi);
+	tangent_map_t result;
+	result.template topLeftCorner<3, 3>() = JInv;
+	result.template topRightCorner<3, 3>().setZero();
+	result.template bottomLeftCorner<3, 3>() = - JInv * leftJacobianCoupling(phi, vec.template tail<3>()) * JInv;
+	result.template bottomRightCorner<3, 3>() = JInv;
+	return result;
+}
+
+_TEMPLATE
+inline typename _CLASS::dmatrix_t _CLASS::dLeftPerturbation(const point_t & p)
+{
+	// expAtId(d) * p = (exp_q(d_phi) (x) q, d_rho + exp(d_phi^) * t)
+	dmatrix_t result = dmatrix_t::Zero();
+	result.template topLeftCorner<4, 3>() = ::sm::kinematics::quatOPlus(p.template head<4>()) * ::sm::kinematics::quatV<double>();
+	result.template bottomLeftCorner<3, 3>() = - ::sm::kinematics::crossMx(p.template tail<3>());
+	result.template bottomRightCorner<3, 3>().setIdentity();
+	return result;
+}
+
+_TEMPLATE
+inline Eigen::Matrix3d _CLASS::rotationLeftJacobian(const Eigen::Vector3d & phi)
+{
+	const double theta2 = phi.squaredNorm(), theta = sqrt(theta2);
+	double a, b;
+	if(theta < internal::SE3SeriesThreshold){
+		a = 0.5 - theta2 * (1.0 / 24.0 - theta2 / 720.0);
+		b = 1.0 / 6.0 - theta2 * (1.0 / 120.0 - theta2 / 5040.0);
+	} else {
+		a = (1 - cos(theta)) / theta2;
+		b = (theta - sin(theta)) / (theta2 * theta);
+	}
+	const Eigen::Matrix3d X = ::sm::kinematics::crossMx(phi);
+	return Eigen::Matrix3d::Identity() + a * X + b * X * X;
+}
+
+_TEMPLATE
+inline Eigen::Matrix3d _CLASS::rotationInverseLeftJacobian(const Eigen::Vector3d & phi)
+{
+	const double theta2 = phi.squaredNorm(), theta = sqrt(theta2);
+	double c;
+	if(theta < internal::SE3SeriesThreshold){
+		c = 1.0 / 12.0 + theta2 * (1.0 / 720.0 + theta2 / 30240.0);
+	} else {
+		c = (1 - 0.5 * theta / tan(0.5 * theta)) / theta2;
+	}
+	const Eigen::Matrix3d X = ::sm::kinematics::crossMx(phi);
+	return Eigen::Matrix3d::Identity() - 0.5 * X + c * X * X;
+}
+
+_TEMPLATE
+inline Eigen::Matrix3d _CLASS::leftJacobianCoupling(const Eigen::Vector3d & phi, const Eigen::Vector3d & rho)
+{
+	const double theta2 = phi.squaredNorm(), theta = sqrt(theta2);
+	double c1, c2, c3;
+	if(theta < internal::SE3SeriesThreshold){
+		c1 = 1.0 / 6.0 - theta2 * (1.0 / 120.0 - theta2 / 5040.0);
+		c2 = 1.0 / 24.0 - theta2 * (1.0 / 720.0 - theta2 / 40320.0);
+		c3 = 1.0 / 120.0 - theta2 * (1.0 / 2520.0 - theta2 / 120960.0);
+	} else {
+		const double s = sin(theta), c = cos(theta);
+		c1 = (theta - s) / (theta2 * theta);
+		c2 = (theta2 + 2 * c - 2) / (2 * theta2 * theta2);
+		c3 = (2 * theta - 3 * s + theta * c) / (2 * theta2 * theta2 * theta);
+	}
+	const Eigen::Matrix3d X = ::sm::kinematics::crossMx(phi), P = ::sm::kinematics::crossMx(rho);
+	const Eigen::Matrix3d XP = X * P, PX = P * X, XPX = XP * X, XX = X * X;
+	return 0.5 * P + c1 * (XP + PX + XPX) + c2 * (XX * P + PX * X - 3 * XPX) + c3 * (XPX * X + X * XPX);
+}
+
+_TEMPLATE
+inline Eigen::Matrix<double, 3, 4> _CLASS::dRotate(const Eigen::Vector4d & q, const Eigen::Vector3d & v)
+{
+	// quat2r(q) * v is the vector part of q (x) [v; 0] (x) q^-1 for unit q
+	const Eigen::Vector4d p(v[0], v[1], v[2], 0);
+	const Eigen::Vector4d conjugation(-1, -1, -1, 1);
+	const Eigen::Matrix4d d = ::sm::kinematics::quatOPlus(::sm::kinematics::qplus(p, ::sm::kinematics::quatInv(q))) + ::sm::kinematics::quatPlus(::sm::kinematics::qplus(q, p)) * conjugation.asDiagonal();
+	return d.topRows<3>();
+}
+
+#undef _TEMPLATE
+#undef _CLASS
+}
@@ -85,6 +85,31 @@ inline void _CLASS::dexpAtIdInto(const tangent_vector_t & vec, dmatrix_t & resul
 }
 
 
+_TEMPLATE
+inline void _CLASS::multBatchInto(const point_batch_t & a, const point_batch_t & b, point_batch_t & result)
+{
+	// same as qplus(a, b) = quatPlus(a) * b row by row
+	result.resize(a.rows(), 4);
+	result.col(0) =   a.col(3) * b.col(0) - a.col(2) * b.col(1) + a.col(1) * b.col(2) + a.col(0) * b.col(3);
+	result.col(1) =   a.col(2) * b.col(0) + a.col(3) * b.col(1) - a.col(0) * b.col(2) + a.col(1) * b.col(3);
+	result.col(2) = - a.col(1) * b.col(0) + a.col(0) * b.col(1) + a.col(3) * b.col(2) + a.col(2) * b.col(3);
+	result.col(3) = - a.col(0) * b.col(0) - a.col(1) * b.col(1) - a.col(2) * b.col(2) + a.col(3) * b.col(3);
+}
+
+_TEMPLATE
+inline void _CLASS::expAtIdBatchInto(const tangent_vector_batch_t & vecs, point_batch_t & result)
+{
+	typedef Eigen::Array<scalar_t, Eigen::Dynamic, 1> column_t;
+	const column_t theta = vecs.square().rowwise().sum().sqrt();
+	const column_t halfTheta = theta * scalar_t(0.5);
+	// sin(theta / 2) / theta, with its Taylor expansion close to zero
+	const column_t sinHalfThetaOverTheta = (theta < scalar_t(1e-4)).select(scalar_t(0.5) - theta.square() * scalar_t(1.0 / 48.0), halfTheta.sin() / theta.max(std::numeric_limits<scalar_t>::min()));
+
+	result.resize(vecs.rows(), 4);
+	result.template leftCols<3>() = vecs.colwise() * sinHalfThetaOverTheta;
+	result.col(3) = halfTheta.cos();
+}
+
 _TEMPLATE
 bool _CLASS::isInManifold(const point_t & pt)
 {
@@ -70,6 +70,68 @@ class BSplineExporter {
 		return ret;
 	}
 
+	static std::vector<typename TSpline::time_t> toTimesVector(const Eigen::VectorXd & times){
+		std::vector<typename TSpline::time_t> timesVector(times.size());
+		for(int i = 0, end = times.size(); i != end; i++){
+			timesVector[i] = times[i];
+		}
+		return timesVector;
+	}
+
+	// returns the values as columns of a (pointSize x numTimes) matrix
+	static Eigen::MatrixXd evalDBatch(const TSpline * bsp, const Eigen::VectorXd & times, int derivativeOrder){
+		std::vector<typename TSpline::point_t> values;
+		const auto timesVector = toTimesVector(times);
+		switch(derivativeOrder){
+			case 0:
+				bsp->template evalBatch<0>(timesVector, derivativeOrder, values);
+				break;
+			case 1:
+				bsp->template evalBatch<1>(timesVector, derivativeOrder, values);
+				break;
+			case 2:
+				bsp->template evalBatch<2>(timesVector, derivativeOrder, values);
+				break;
+			default:
+				bsp->template evalBatch<Eigen::Dynamic>(timesVector, derivativeOrder, values);
+		}
+		Eigen::MatrixXd ret(bsp->getPointSize(), values.size());
+		for(size_t i = 0; i < values.size(); i++){
+			ret.col(i) = values[i];
+		}
+		return ret;
+	}
+
+	static Eigen::MatrixXd evalBatch(const TSpline * bsp, const Eigen::VectorXd & times){
+		return evalDBatch(bsp, times, 0);
+	}
+
+	// returns the Jacobians stacked vertically
+	static Eigen::MatrixXd evalJacobianDBatch(const TSpline * bsp, const Eigen::VectorXd & times, int derivativeOrder){
+		std::vector<typename TSpline::full_jacobian_t, Eigen::aligned_allocator<typename TSpline::full_jacobian_t> > jacobians;
+		const auto timesVector = toTimesVector(times);
+		switch(derivativeOrder){
+			case 0:
+				bsp->template evalJacobianBatch<0>(timesVector, derivativeOrder, jacobians);
+				break;
+			case 1:
+				bsp->template evalJacobianBatch<1>(timesVector, derivativeOrder, jacobians);
+				break;
+			case 2:
+				bsp->template evalJacobianBatch<2>(timesVector, derivativeOrder, jacobians);
+				break;
+			default:
+				bsp->template evalJacobianBatch<Eigen::Dynamic>(timesVector, derivativeOrder, jacobians);
+		}
+		if(jacobians.empty()) return Eigen::MatrixXd();
+		const int rows = jacobians[0].rows();
+		Eigen::MatrixXd ret(rows * jacobians.size(), jacobians[0].cols());
+		for(size_t i = 0; i < jacobians.size(); i++){
+			ret.block(rows * i, 0, rows, ret.cols()) = jacobians[i];
+		}
+		return ret;
+	}
+
 	static typename Eigen::MatrixXd evalJacobian(const TSpline * bsp, typename TSpline::time_t t){
 		return evalJacobianD(bsp, t, 0);
 	}
@@ -281,6 +343,9 @@ class BSplineExporter {
 		.def("evalD", evalD, "Evaluate a spline curve derivative at a point in time")
 		.def("evalJacobian", evalJacobian, "Matrix evalJacobian(double t) :  Evaluate the spline curve evaluation's jacobian with respect to changes in the control vertices at time t.")
 		.def("evalJacobianD", evalJacobianD, "Matrix evalJacobianD(double t, derivativeOrder) :  Evaluate the spline curve derivative's (or evaluation's, for derivativeOrder = 0) jacobian with respect to changes in the control vertices at time t.")
+		.def("evalBatch", evalBatch, "Matrix evalBatch(np.array times) : Evaluate the spline curve at all times (preferably ascending). Returns the values as columns.")
+		.def("evalDBatch", evalDBatch, "Matrix evalDBatch(np.array times, int derivativeOrder) : Evaluate a spline curve derivative at all times (preferably ascending). Returns the values as columns.")
+		.def("evalJacobianDBatch", evalJacobianDBatch, "Matrix evalJacobianDBatch(np.array times, int derivativeOrder) : Evaluate the derivative's jacobians at all times (preferably ascending). Returns the jacobians stacked vertically.")
 		.def("getEvaluatorAt", &TSpline::template getEvaluatorAt<Eigen::Dynamic> , "Get a evaluator at a point in time")
 		//		.def("Phi", &TSpline::Phi, "Evaluate the local basis matrix at a point in time")
 		//		.def("localBasisMatrix", &TSpline::localBasisMatrix, "Evaluate the local basis matrix at a point in time")
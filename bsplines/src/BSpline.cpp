@@ -348,6 +348,51 @@ namespace bsplines {
 
     }
 
+    Eigen::MatrixXd BSpline::evalDs(double t, int maxDerivativeOrder) const
+    {
+      return evalDsAndJacobian(t, maxDerivativeOrder, NULL, NULL);
+    }
+
+    Eigen::MatrixXd BSpline::evalDsAndJacobian(double t, int maxDerivativeOrder, Eigen::MatrixXd * Jacobian, Eigen::VectorXi * coefficientIndices) const
+    {
+      SM_ASSERT_GE(Exception, maxDerivativeOrder, 0, "To integrate, use the integral function");
+      // Returns the normalized u value and the lower-bound time index.
+      std::pair<double,int> ui = computeUAndTIndex(t);
+      Eigen::MatrixXd U(splineOrder_, maxDerivativeOrder + 1);
+      for(int i = 0; i <= maxDerivativeOrder; i++)
+	{
+	  U.col(i) = computeU(ui.first, ui.second, i);
+	}
+
+      int bidx = ui.second - splineOrder_ + 1;
+      int D = coefficients_.rows();
+
+      // B^T * [u_0 u_1 ...]
+      Eigen::MatrixXd Bt_U = basisMatrices_[bidx].transpose() * U;
+
+      if(Jacobian)
+	{
+	  // The Jacobians, one block row per derivative order
+	  Jacobian->resize(D * (maxDerivativeOrder + 1), splineOrder_ * D);
+	  Eigen::MatrixXd one = Eigen::MatrixXd::Identity(D, D);
+	  for(int i = 0; i <= maxDerivativeOrder; i++)
+	    {
+	      for(int j = 0; j < splineOrder_; j++)
+		{
+		  Jacobian->block(i*D, j*D, D, D) = one * Bt_U(j, i);
+		}
+	    }
+	}
+
+      if(coefficientIndices)
+	{
+	  *coefficientIndices = Eigen::VectorXi::LinSpaced(splineOrder_*D,bidx*D,(bidx + splineOrder_)*D - 1);
+	}
+
+      // [c_0 c_1 c_2 c_3] * B^T * [u_0 u_1 ...]
+      return coefficients_.block(0,bidx,D,splineOrder_) * Bt_U;
+    }
+
     Eigen::VectorXd BSpline::evalDAndJacobian(double t, int derivativeOrder, Eigen::MatrixXd * Jacobian, Eigen::VectorXi * coefficientIndices) const
     {
       SM_ASSERT_GE(Exception, derivativeOrder, 0, "To integrate, use the integral function");
@@ -743,6 +788,8 @@ Eigen::VectorXi BSpline::segmentVvCoefficientVectorIndices(int segmentIdx) const
 	{
 	  knots_.erase(knots_.begin());
 	  coefficients_ = coefficients_.block(0,1,coefficients_.rows(),coefficients_.cols() - 1).eval();
+	  // the remaining segments keep their knots and hence their basis matrices
+	  basisMatrices_.erase(basisMatrices_.begin());
 	}
     }
 
@@ -0,0 +1,110 @@
+#include <bsplines/AnyOrderBSpline.hpp>
+
+namespace bsplines {
+
+template <int ISplineOrder>
+struct AnyOrderEuclideanReferenceCheck {
+	static void apply(AnyOrderBSpline<EuclideanBSplineFamily<> > & anySpline, const Eigen::MatrixXd & controlVertices) {
+		typedef EuclideanBSpline<Eigen::Dynamic, Eigen::Dynamic>::TYPE DynamicSpline;
+		DynamicSpline reference(ISplineOrder, rows);
+		reference.initConstantUniformSpline(minTime, maxTime, numberOfSegments, DynamicSpline::point_t::Zero(rows));
+		reference.setControlVertices(controlVertices);
+
+		const auto & spline = anySpline.get<ISplineOrder>();
+		static_assert(std::remove_reference<decltype(spline)>::type::SplineOrder == ISplineOrder, "the dispatched spline must have a fixed order");
+
+		for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+			const double t = minTime + duration * i / numberOfTimeSteps;
+			auto evaluator = anySpline.getEvaluatorAt<2>(t);
+			auto referenceEvaluator = reference.getEvaluatorAt<2>(t);
+			for(int d = 0; d <= 2; d++){
+				sm::eigen::assertNear(evaluator.evalD(d), referenceEvaluator.evalD(d), 1E-12, SM_SOURCE_FILE_POS);
+				Eigen::MatrixXd J;
+				DynamicSpline::full_jacobian_t referenceJ;
+				evaluator.evalJacobian(d, J);
+				referenceEvaluator.evalJacobian(d, referenceJ);
+				sm::eigen::assertNear(J, referenceJ, 1E-12, SM_SOURCE_FILE_POS);
+
+				// a reused buffer is not reallocated
+				const double * data = J.data();
+				evaluator.evalJacobian(d, J);
+				SM_ASSERT_EQ(std::runtime_error, J.data(), data, "");
+				typename std::remove_reference<decltype(spline)>::type::full_jacobian_t fixedOrderJ;
+				evaluator.template evalJacobian<ISplineOrder>(d, fixedOrderJ);
+				sm::eigen::assertEqual(fixedOrderJ, J, SM_SOURCE_FILE_POS);
+			}
+			sm::eigen::assertNear(anySpline.eval(t), spline.template getEvaluatorAt<0>(t).eval(), 1E-12, SM_SOURCE_FILE_POS);
+		}
+	}
+};
+
+TEST(AnyOrderBSplineTestSuite, testEuclideanOrderDispatch)
+{
+	for(int splineOrder = MinDispatchedSplineOrder; splineOrder <= MaxDispatchedSplineOrder; splineOrder++){
+		AnyOrderBSpline<EuclideanBSplineFamily<> > anySpline(splineOrder, EuclideanBSplineFamily<>(rows));
+		SM_ASSERT_EQ(std::runtime_error, anySpline.getSplineOrder(), splineOrder, "");
+		anySpline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, Eigen::VectorXd::Zero(rows));
+		SM_ASSERT_EQ(std::runtime_error, anySpline.getMinTime(), minTime, "");
+		SM_ASSERT_EQ(std::runtime_error, anySpline.getMaxTime(), maxTime, "");
+		SM_ASSERT_EQ(std::runtime_error, anySpline.getNumControlVertices(), (int) numberOfSegments + splineOrder - 1, "");
+
+		const Eigen::MatrixXd controlVertices = Eigen::MatrixXd::Random(rows, anySpline.getNumControlVertices());
+		anySpline.setControlVertices(controlVertices);
+		const AnyOrderBSpline<EuclideanBSplineFamily<> > copy(anySpline);
+		dispatchSplineOrder<AnyOrderEuclideanReferenceCheck>(splineOrder, anySpline, controlVertices);
+		sm::eigen::assertEqual(copy.eval(0.5), anySpline.eval(0.5), SM_SOURCE_FILE_POS);
+	}
+	EXPECT_THROW(AnyOrderBSpline<EuclideanBSplineFamily<> >(MaxDispatchedSplineOrder + 1, EuclideanBSplineFamily<>(rows)), std::runtime_error);
+}
+
+template <int ISplineOrder>
+struct AnyOrderUnitQuaternionReferenceCheck {
+	static void apply(AnyOrderBSpline<UnitQuaternionBSplineFamily<> > & anySpline) {
+		// the reference has a runtime order, so it cannot share a wrongly dispatched fixed order instantiation
+		UQTestSplineD reference(ISplineOrder);
+		reference.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSplineD::point_t(0, 0, 0, 1));
+
+		auto & spline = anySpline.get<ISplineOrder>();
+		UQTestSplineD::point_t p;
+		auto i = spline.getAbsoluteBegin();
+		for(auto j = reference.getAbsoluteBegin(); j != reference.getAbsoluteEnd(); ++i, ++j){
+			reference.getManifold().randomizePoint(p);
+			i->setControlVertex(p);
+			j->setControlVertex(p);
+		}
+
+		for(unsigned int k = 0; k <= numberOfTimeSteps; k++){
+			const double t = minTime + duration * k / numberOfTimeSteps;
+			auto evaluator = anySpline.getEvaluatorAt<2>(t);
+			auto referenceEvaluator = reference.getEvaluatorAt<2>(t);
+			SM_ASSERT_EQ(std::runtime_error, evaluator.getKnot(), referenceEvaluator.getKnot(), "");
+			for(int d = 0; d <= 2; d++){
+				sm::eigen::assertNear(evaluator.evalD(d), referenceEvaluator.evalD(d), 1E-12, SM_SOURCE_FILE_POS);
+				Eigen::MatrixXd J;
+				UQTestSplineD::full_jacobian_t referenceJ;
+				evaluator.evalJacobian(d, J);
+				referenceEvaluator.evalJacobian(d, referenceJ);
+				sm::eigen::assertNear(J, referenceJ, 1E-12, SM_SOURCE_FILE_POS);
+
+				// the fixed order Jacobian avoids the dynamic buffer altogether
+				typename std::remove_reference<decltype(spline)>::type::full_jacobian_t fixedOrderJ;
+				evaluator.template evalJacobian<ISplineOrder>(d, fixedOrderJ);
+				sm::eigen::assertEqual(fixedOrderJ, J, SM_SOURCE_FILE_POS);
+			}
+			// copies must carry their own in place evaluator
+			const AnyOrderBSpline<UnitQuaternionBSplineFamily<> >::Evaluator<2> copy(evaluator);
+			sm::eigen::assertEqual(copy.evalD(1), evaluator.evalD(1), SM_SOURCE_FILE_POS);
+		}
+	}
+};
+
+TEST(AnyOrderBSplineTestSuite, testUnitQuaternionOrderDispatch)
+{
+	for(int splineOrder = MinDispatchedSplineOrder; splineOrder <= MaxDispatchedSplineOrder; splineOrder++){
+		AnyOrderBSpline<UnitQuaternionBSplineFamily<> > anySpline(splineOrder);
+		anySpline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSplineD::point_t(0, 0, 0, 1));
+		dispatchSplineOrder<AnyOrderUnitQuaternionReferenceCheck>(splineOrder, anySpline);
+	}
+}
+
+} // namespace bsplines
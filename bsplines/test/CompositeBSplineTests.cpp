@@ -0,0 +1,138 @@
+#include "DiffManifoldBSplineTests.hpp"
+
+namespace bsplines {
+
+TEST(CompositeBSplineTestSuite, evaluatesAsItsComponentSplines)
+{
+	CompositeTestSpline spline;
+	UQTestSpline uqSpline;
+	TestSpline euclideanSpline(splineOrder, rows);
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	uqSpline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	euclideanSpline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, zero);
+
+	Eigen::MatrixXd positions = Eigen::MatrixXd::Random(rows, spline.getNumControlVertices());
+	spline.setEuclideanControlVertices(positions);
+	euclideanSpline.setControlVertices(positions);
+	auto uqIt = uqSpline.getAbsoluteBegin();
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it, ++uqIt){
+		spline.getManifold().randomizePoint(it->getControlVertex());
+		uqIt->getControlVertex() = it->getControlVertex();
+	}
+
+	for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+		const double t = minTime + duration * i / numberOfTimeSteps;
+		auto eval = spline.getEvaluatorAt<2>(t);
+		auto uqEval = uqSpline.getEvaluatorAt<2>(t);
+		auto euclideanEval = euclideanSpline.getEvaluatorAt<2>(t);
+
+		for(int d = 0; d <= 2; d++){
+			CompositeTestSpline::point_t q;
+			CompositeTestSpline::EuclideanComponent<0>::point_t p;
+			eval.evalComponentsD(d, q, p);
+			sm::eigen::assertEqual(q, uqEval.evalD(d), SM_SOURCE_FILE_POS);
+			sm::eigen::assertNear(p, euclideanEval.evalD(d), 1E-9, SM_SOURCE_FILE_POS);
+
+			CompositeTestSpline::EuclideanComponent<0>::jacobian_t J;
+			TestSpline::full_jacobian_t expectedJ;
+			eval.evalEuclideanJacobian(d, J);
+			euclideanEval.evalJacobian(d, expectedJ);
+			sm::eigen::assertNear(J, expectedJ, 1E-12, SM_SOURCE_FILE_POS);
+		}
+		sm::eigen::assertEqual(eval.evalAngularVelocity(), uqEval.evalAngularVelocity(), SM_SOURCE_FILE_POS);
+	}
+
+#ifdef SPEEDMEASURE
+	for(int j = 0; j < 100; j++){
+		double w = 0;
+		for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+			const double t = minTime + duration * i / numberOfTimeSteps;
+			{
+				sm::timing::Timer timer("Composite two component splines");
+				w += uqSpline.getEvaluatorAt<1>(t).evalAngularVelocity()[0] + euclideanSpline.getEvaluatorAt<1>(t).evalD(1)[0];
+				timer.stop();
+			}
+			{
+				sm::timing::Timer timer("Composite joint evaluator");
+				auto eval = spline.getEvaluatorAt<1>(t);
+				w -= eval.evalAngularVelocity()[0] + eval.evalEuclideanD(1)[0];
+				timer.stop();
+			}
+		}
+		SM_ASSERT_NEAR(std::runtime_error, w, 0, 1E-9, "");
+	}
+#endif
+}
+
+typedef CompositeBSplineConfiguration<UQTestSpline::CONF, rows, 1>::BSpline TwoComponentTestSpline;
+
+TEST(CompositeBSplineTestSuite, evaluatesEveryEuclideanComponent)
+{
+	TwoComponentTestSpline spline;
+	TestSpline positionSpline(splineOrder, rows);
+	EuclideanBSpline<splineOrder, 1>::TYPE biasSpline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	positionSpline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, zero);
+	biasSpline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, Eigen::VectorXd::Zero(1));
+
+	const Eigen::MatrixXd positions = Eigen::MatrixXd::Random(rows, spline.getNumControlVertices());
+	const Eigen::MatrixXd biases = Eigen::MatrixXd::Random(1, spline.getNumControlVertices());
+	spline.setEuclideanControlVertices<0>(positions);
+	spline.setEuclideanControlVertices<1>(biases);
+	positionSpline.setControlVertices(positions);
+	biasSpline.setControlVertices(biases);
+
+	for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+		const double t = minTime + duration * i / numberOfTimeSteps;
+		auto eval = spline.getEvaluatorAt<2>(t);
+		for(int d = 0; d <= 2; d++){
+			TwoComponentTestSpline::point_t q;
+			TwoComponentTestSpline::EuclideanComponent<0>::point_t p;
+			TwoComponentTestSpline::EuclideanComponent<1>::point_t b;
+			eval.evalComponentsD(d, q, p, b);
+			sm::eigen::assertEqual(q, eval.evalD(d), SM_SOURCE_FILE_POS);
+			sm::eigen::assertNear(p, positionSpline.getEvaluatorAt<2>(t).evalD(d), 1E-9, SM_SOURCE_FILE_POS);
+			sm::eigen::assertNear(b, biasSpline.getEvaluatorAt<2>(t).evalD(d), 1E-9, SM_SOURCE_FILE_POS);
+
+			TwoComponentTestSpline::EuclideanComponent<1>::jacobian_t J;
+			EuclideanBSpline<splineOrder, 1>::TYPE::full_jacobian_t expectedJ;
+			eval.evalEuclideanJacobian<1>(d, J);
+			biasSpline.getEvaluatorAt<2>(t).evalJacobian(d, expectedJ);
+			sm::eigen::assertNear(J, expectedJ, 1E-12, SM_SOURCE_FILE_POS);
+		}
+	}
+}
+
+TEST(CompositeBSplineTestSuite, setsTheEuclideanControlVerticesOfAppendedSegments)
+{
+	TwoComponentTestSpline spline;
+	EuclideanBSpline<splineOrder, 1>::TYPE biasSpline;
+	const double delta = duration / numberOfSegments;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	biasSpline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, Eigen::VectorXd::Zero(1));
+	const Eigen::MatrixXd biases = Eigen::MatrixXd::Random(1, spline.getNumControlVertices());
+	spline.setEuclideanControlVertices<1>(biases);
+	biasSpline.setControlVertices(biases);
+
+	const int appendedSegments = 3;
+	spline.appendSegmentsUniformly(appendedSegments);
+	biasSpline.appendSegmentsUniformly(appendedSegments);
+	auto assertSameBias = [&](){
+		for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+			const double t = minTime + (duration + appendedSegments * delta) * i / numberOfTimeSteps;
+			sm::eigen::assertNear(spline.getEvaluatorAt<0>(t).evalEuclidean<1>(), biasSpline.getEvaluatorAt<0>(t).eval(), 1E-9, SM_SOURCE_FILE_POS);
+		}
+	};
+	// appended Euclidean control vertices start at zero like the Euclidean spline's default point
+	assertSameBias();
+
+	// set the control vertices of the appended segments only
+	const Eigen::MatrixXd appendedBiases = Eigen::MatrixXd::Random(1, appendedSegments);
+	const int offset = spline.getNumControlVertices() - appendedSegments;
+	spline.setEuclideanControlVertices<1>(appendedBiases, spline.getMinTime(), offset);
+	biasSpline.setControlVertices(appendedBiases, biasSpline.getMinTime(), offset);
+
+	assertSameBias();
+}
+
+} // namespace bsplines
@@ -2,6 +2,8 @@
 #include "bsplines/manifolds/UnitQuaternionManifold.hpp"
 #include "gtest/gtest.h"
 #include <sm/eigen/gtest.hpp>
+#include <limits>
+#include <algorithm>
 
 #define TEST_SPLINES
 
@@ -220,6 +222,36 @@ TEST(DiffManifoldBSplineTestSuite, testAddingSegments)
 }
 
 
+TEST(DiffManifoldBSplineTestSuite, testRemovingSegmentsKeepsSlidingWindowBounded)
+{
+	TestSpline window, full;
+	const double delta = duration / numberOfSegments;
+	const int windowSegments = 4;
+
+	window.initConstantUniformSpline(minTime, minTime + windowSegments * delta, windowSegments, zero);
+	full.initConstantUniformSpline(minTime, minTime + windowSegments * delta, windowSegments, zero);
+	const size_t absoluteNumberOfSegments = window.getAbsoluteNumberOfSegments();
+
+	for(unsigned int i = 0; i < numberOfSegments; i++){
+		TestSpline::point_t x = TestSpline::point_t::Random(rows);
+		window.appendSegmentsUniformly(1, &x);
+		full.appendSegmentsUniformly(1, &x);
+
+		const double t = window.getMaxTime() - windowSegments * delta;
+		SM_ASSERT_EQ(std::runtime_error, window.removeSegmentsBefore(t), 1u, "");
+		SM_ASSERT_EQ(std::runtime_error, window.removeSegmentsBefore(t), 0u, "");
+		SM_ASSERT_EQ(std::runtime_error, window.getAbsoluteNumberOfSegments(), absoluteNumberOfSegments, "");
+		SM_ASSERT_EQ(std::runtime_error, window.getNumValidTimeSegments(), windowSegments, "");
+		SM_ASSERT_EQ(std::runtime_error, window.firstRelevantSegment().getKnot(), window.getAbsoluteBegin().getKnot(), "");
+		SM_ASSERT_NEAR(std::runtime_error, window.getMinTime(), t, 1E-9, "");
+
+		for(unsigned int j = 0; j <= numberOfTimeSteps; j++) {
+			double tEval = window.getMinTime() + (window.getMaxTime() - window.getMinTime()) * ((double) j / numberOfTimeSteps);
+			sm::eigen::assertNear(window.getEvaluatorAt<1>(tEval).evalD(1), full.getEvaluatorAt<1>(tEval).evalD(1), 1E-9, SM_SOURCE_FILE_POS, "");
+		}
+	}
+}
+
 TEST(DiffManifoldBSplineTestSuite, testGetBi)
 {
 	const int numTimeSteps = 100;
@@ -274,10 +306,51 @@ TEST(DiffManifoldBSplineTestSuite, testLongTimeBSplineCompilation)
 	sm::eigen::assertEqual(rbspline.getEvaluatorAt<0>(minTimeLong).eval(), p, SM_SOURCE_FILE_POS);
 }
 
+TEST(DiffManifoldBSplineTestSuite, testNsecTimePolicyLongHighRateUniformKnots)
+{
+	typedef NsecTimePolicy::time_t time_t;
+	const time_t day = time_t(86400) * NsecTimePolicy::getOne();
+	// two days at ~10kHz : duration * segments is far beyond the range of 64 bit integers
+	const time_t from = 7 * day, till = from + 2 * day + 12345;
+	const int segments = 1728000003;
+	SM_ASSERT_GT(std::runtime_error, till - from, std::numeric_limits<int64_t>::max() / segments, "the test needs a duration * segments product beyond 64 bit");
+	// the reference splits the duration into whole segment lengths and a remainder, whose product with k fits into 64 bit
+	const time_t wholeSegmentLength = (till - from) / segments, remainder = (till - from) % segments;
+
+	knot_arithmetics::UniformTimeCalculator<NsecTimePolicy> calc(splineOrder, from, till, segments);
+	const int preamble = knot_arithmetics::getNumRequiredPreambleKnots(splineOrder);
+	const int probes[] = {0, 1, 2, 12345, segments / 3, segments / 2 + 7, segments - 2, segments - 1};
+	for(int k : probes){
+		const time_t knot = NsecTimePolicy::linearlyInterpolate(from, till, segments, k), nextKnot = NsecTimePolicy::linearlyInterpolate(from, till, segments, k + 1);
+		SM_ASSERT_LE(std::runtime_error, remainder, std::numeric_limits<int64_t>::max() / std::max(k, 1), "k=" << k);
+		SM_ASSERT_EQ(std::runtime_error, knot - from, wholeSegmentLength * k + remainder * k / segments, "k=" << k);
+		SM_ASSERT_EQ(std::runtime_error, calc.getTimeByKnotIndex(k + preamble), knot, "k=" << k);
+		SM_ASSERT_EQ(std::runtime_error, NsecTimePolicy::getSegmentNumber(from, till, segments, knot), k, "k=" << k);
+		SM_ASSERT_EQ(std::runtime_error, NsecTimePolicy::getSegmentNumber(from, till, segments, nextKnot - 1), k, "k=" << k);
+		SM_ASSERT_EQ(std::runtime_error, calc.getKnotIndexAtTime(knot + (nextKnot - knot) / 2), k + preamble, "k=" << k);
+	}
+	SM_ASSERT_EQ(std::runtime_error, NsecTimePolicy::getSegmentNumber(from, till, segments, till), segments, "");
+
+	// appending far from the epoch with a 100us knot delta has to keep the segment lookup consistent
+	TestSplineNsecTime spline;
+	const time_t delta = NsecTimePolicy::getOne() / 10000, start = 30 * day;
+	auto knotGenerator = spline.initConstantUniformSplineWithKnotDelta(start, start + 50 * delta, delta, TestSplineNsecTime::point_t(ones));
+	knotGenerator.extendBeyondTime(start + 100 * delta);
+	spline.appendSegments(knotGenerator, -1);
+	SM_ASSERT_EQ(std::runtime_error, spline.getMinTime(), start, "");
+	SM_ASSERT_GE(std::runtime_error, spline.getMaxTime(), start + 100 * delta, "");
+	for(int i = 0; i < 100; i++){
+		SM_ASSERT_EQ(std::runtime_error, spline.getEvaluatorAt<0>(start + i * delta + delta / 2).getKnot(), start + i * delta, "i=" << i);
+	}
+}
+
 } //namespace bsplines
 
 #include "UnitQuaternionBSplineTests.cpp"
+#include "SE3BSplineTests.cpp"
+#include "CompositeBSplineTests.cpp"
 #include "EuclideanBSplineTests.cpp"
+#include "AnyOrderBSplineTests.cpp"
 
 #ifdef SPEEDMEASURE
 TEST(ZLASTDiffManifoldBSplineTestSuite, printTimings)
@@ -6,6 +6,8 @@
 #include <bsplines/DiffManifoldBSpline.hpp>
 #include <bsplines/EuclideanBSpline.hpp>
 #include <bsplines/UnitQuaternionBSpline.hpp>
+#include <bsplines/SE3BSpline.hpp>
+#include <bsplines/CompositeBSpline.hpp>
 #include <bsplines/BSplineFitter.hpp>
 #include <bsplines/NsecTimePolicy.hpp>
 
@@ -43,6 +45,10 @@ typedef EuclideanBSpline<splineOrder, rows, NsecTimePolicy>::TYPE TestSplineNsec
 typedef UnitQuaternionBSpline<>::TYPE UQTestSplineD;
 typedef UnitQuaternionBSpline<splineOrder>::TYPE UQTestSpline;
 
+typedef SE3BSpline<splineOrder>::TYPE SE3TestSpline;
+
+typedef UnitQuaternionEuclideanBSpline<splineOrder, rows>::TYPE CompositeTestSpline;
+
 struct LongDuration {
 	long v;
 	LongDuration(long v) : v(v){
@@ -174,6 +180,38 @@ void initMinimalSpline(TSpline & spline){
 
 
 
+template <typename TSpline, int IMaximalDerivativeOrder>
+void testEvalBatchAgainstEvaluator(const TSpline & spline, int derivativeOrder){
+	typedef typename TSpline::point_t point_t;
+	typedef typename TSpline::full_jacobian_t full_jacobian_t;
+
+	std::vector<typename TSpline::time_t> times;
+	for(int i = 0, n = numberOfTimeSteps * 3; i <= n; i++){
+		times.push_back(spline.getMinTime() + (spline.getMaxTime() - spline.getMinTime()) * i / n);
+	}
+	// an unsorted tail exercises the fall back to the tree search
+	for(unsigned int i = 0; i < numberOfTimeSteps; i++){
+		times.push_back(times[std::rand() % times.size()]);
+	}
+
+	for(int numberOfThreads = 1; numberOfThreads <= 3; numberOfThreads += 2){
+		std::vector<point_t, Eigen::aligned_allocator<point_t> > values;
+		std::vector<full_jacobian_t, Eigen::aligned_allocator<full_jacobian_t> > jacobians;
+		spline.template evalBatch<IMaximalDerivativeOrder>(times, derivativeOrder, values, numberOfThreads);
+		spline.template evalJacobianBatch<IMaximalDerivativeOrder>(times, derivativeOrder, jacobians, numberOfThreads);
+		SM_ASSERT_EQ(std::runtime_error, values.size(), times.size(), "");
+		SM_ASSERT_EQ(std::runtime_error, jacobians.size(), times.size(), "");
+
+		for(size_t i = 0; i < times.size(); i++){
+			auto evaluator = spline.template getEvaluatorAt<IMaximalDerivativeOrder>(times[i]);
+			full_jacobian_t jacobian;
+			evaluator.evalJacobian(derivativeOrder, jacobian);
+			sm::eigen::assertEqual(evaluator.evalD(derivativeOrder), values[i], SM_SOURCE_FILE_POS);
+			sm::eigen::assertEqual(jacobian, jacobians[i], SM_SOURCE_FILE_POS);
+		}
+	}
+}
+
 template <>
 struct InputTypeTraits<double> {
 	inline static double random(){
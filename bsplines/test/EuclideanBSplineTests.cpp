@@ -587,6 +587,27 @@ TEST(EuclideanBSplineTestSuite, testBSplineJacobianGenerically)
 	BSplineJacobianTester<TestSpline, 4>::testFunc(10, 1);
 }
 
+TEST(EuclideanBSplineTestSuite, evalBatch)
+{
+	TestSpline spline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, zero);
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it) it->setControlVertex(TestSpline::point_t::Random());
+
+	// hints in, shortly before and far before the segment of t as well as a stale one after it
+	for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+		const double t = minTime + duration * i / numberOfTimeSteps;
+		const TestSpline::SegmentConstIterator expected = spline.getSegmentIterator(t);
+		SM_ASSERT_TRUE(std::runtime_error, spline.getSegmentIterator(t, expected) == expected, "");
+		SM_ASSERT_TRUE(std::runtime_error, spline.getSegmentIterator(t, spline.getSegmentIterator(std::max(minTime, t - duration / numberOfSegments))) == expected, "");
+		SM_ASSERT_TRUE(std::runtime_error, spline.getSegmentIterator(t, spline.getSegmentIterator(minTime)) == expected, "");
+		SM_ASSERT_TRUE(std::runtime_error, spline.getSegmentIterator(t, spline.getSegmentIterator(maxTime)) == expected, "");
+	}
+
+	testEvalBatchAgainstEvaluator<TestSpline, 0>(spline, 0);
+	testEvalBatchAgainstEvaluator<TestSpline, 2>(spline, 2);
+	testEvalBatchAgainstEvaluator<TestSpline, Eigen::Dynamic>(spline, 3);
+}
+
 template <typename TSpline>
 void testIntegral(){
 	const auto t0 = typename TSpline::TimePolicy::time_t(0);
@@ -608,4 +629,218 @@ TEST(EuclideanBSplineTestSuite, evalIntegral)
 	testIntegral<TestSplineLongTime>();
 }
 
+template <typename TSpline, bool IDeclarePolynomialDegree>
+struct SquaredVelocityFunctor {
+	inline double eval(const TSpline & spline, typename TSpline::time_t t) const {
+		return spline.template getEvaluatorAt<1>(t).evalD(1).squaredNorm();
+	}
+	inline double getZeroValue(const TSpline & /* spline */) const {
+		return 0.0;
+	}
+};
+
+template <typename TSpline>
+struct SquaredVelocityFunctor<TSpline, true> : public SquaredVelocityFunctor<TSpline, false> {
+	enum { PolynomialDegree = 2 };
+};
+
+template <typename TFunctor>
+struct CountingFunctor : public TFunctor {
+	mutable int numberOfEvaluations = 0;
+	template <typename TSpline>
+	inline double eval(const TSpline & spline, typename TSpline::time_t t) const {
+		numberOfEvaluations++;
+		return TFunctor::eval(spline, t);
+	}
+};
+
+TEST(EuclideanBSplineTestSuite, evalFunctorIntegralExactForPolynomialFunctors)
+{
+	static_assert(internal::FunctorPolynomialDegree<SquaredVelocityFunctor<TestSpline, false> >::VALUE == -1, "");
+	static_assert(internal::FunctorPolynomialDegree<SquaredVelocityFunctor<TestSpline, true> >::VALUE == 2, "");
+
+	TestSpline spline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, zero);
+	for(auto it = spline.begin(); it != spline.end(); ++it) it->setControlVertex(TestSpline::point_t::Random());
+
+	const SquaredVelocityFunctor<TestSpline, true> exactF;
+	const SquaredVelocityFunctor<TestSpline, false> numericF;
+	const double t1 = minTime + duration * 0.13, t2 = maxTime - duration * 0.29;
+	const double exact = spline.evalFunctorIntegral<double>(t1, t2, exactF);
+	SM_ASSERT_NEAR(std::runtime_error, exact, spline.evalFunctorIntegralGaussLegendre<double>(t1, t2, exactF, 6), 1E-12, "");
+	SM_ASSERT_NEAR(std::runtime_error, exact, spline.evalFunctorIntegralNumerically<double>(t1, t2, exactF, 5001), 1E-6, "");
+	double errorEstimate;
+	// the default converges per segment within the point budget of evalFunctorIntegralNumerically
+	const CountingFunctor<SquaredVelocityFunctor<TestSpline, false> > countingF;
+	SM_ASSERT_NEAR(std::runtime_error, exact, spline.evalFunctorIntegral<double>(t1, t2, countingF), std::fabs(exact) * 1E-9, "");
+	SM_ASSERT_LE(std::runtime_error, countingF.numberOfEvaluations, std::max(100, 5 * (int) numberOfSegments), "");
+	countingF.numberOfEvaluations = 0;
+	const double t3 = spline.getSegmentIterator(t1).getKnot() + duration / numberOfSegments * 0.7;
+	SM_ASSERT_NEAR(std::runtime_error, spline.evalFunctorIntegral<double>(t1, t3, exactF), spline.evalFunctorIntegral<double>(t1, t3, countingF), 1E-12, "");
+	SM_ASSERT_LT(std::runtime_error, countingF.numberOfEvaluations, 100, "a polynomial integrand on a single segment converges early");
+	SM_ASSERT_NEAR(std::runtime_error, exact, spline.evalFunctorIntegralToTolerance<double>(t1, t2, numericF, 1E-12, 1E-10), std::fabs(exact) * 1E-9, "");
+	SM_ASSERT_NEAR(std::runtime_error, exact, spline.evalFunctorIntegralToTolerance<double>(t1, t2, numericF, 1E-6, 0, 1025, &errorEstimate), 1E-6, "");
+	SM_ASSERT_LE(std::runtime_error, errorEstimate, 1E-6, "");
+	SM_ASSERT_NEAR(std::runtime_error, -exact, (spline.evalFunctorIntegralToTolerance<double, SquaredVelocityFunctor<TestSpline, false>, numeric_integrator::algorithms::TanhSinhRule>(t2, t1, numericF, 1E-9)), 1E-9, "");
+	SM_ASSERT_NEAR(std::runtime_error, -exact, spline.evalFunctorIntegral<double>(t2, t1, exactF), 1E-12, "");
+	SM_ASSERT_NEAR(std::runtime_error, spline.evalFunctorIntegral<double>(minTime, maxTime, exactF), spline.evalFunctorIntegral<double>(minTime, t1, exactF) + exact + spline.evalFunctorIntegral<double>(t2, maxTime, exactF), 1E-12, "");
+
+	for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+		const double t = minTime + duration * i / numberOfTimeSteps;
+		sm::eigen::assertNear(spline.evalIntegral(minTime, t), spline.evalFunctorIntegral<TestSpline::point_t>(minTime, t, EvalFunctor<TestSpline>()), 1E-12, SM_SOURCE_FILE_POS);
+	}
+}
+
+TEST(EuclideanBSplineTestSuite, evalFunctorIntegralGaussLegendreWithNsecTime)
+{
+	// the same spline over [0, 1] in seconds and in nanoseconds
+	TestSpline spline;
+	TestSplineNsecTime nsecSpline;
+	spline.initConstantUniformSpline(0.0, 1.0, numberOfSegments, zero);
+	nsecSpline.initConstantUniformSpline(0, NsecTimePolicy::getOne(), numberOfSegments, zero);
+	auto nsecIt = nsecSpline.getAbsoluteBegin();
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it, ++nsecIt){
+		it->setControlVertex(TestSpline::point_t::Random());
+		nsecIt->setControlVertex(it->getControlVertex());
+	}
+
+	// the Gauss-Legendre nodes are truncated to whole nanoseconds, so the integrals only agree up to the integrand's change within a nanosecond
+	const double exact = spline.evalFunctorIntegral<double>(0.13, 0.71, SquaredVelocityFunctor<TestSpline, true>());
+	const double nsec = nsecSpline.evalFunctorIntegral<double>(130000000, 710000000, SquaredVelocityFunctor<TestSplineNsecTime, true>());
+	SM_ASSERT_NEAR(std::runtime_error, exact, nsec, std::fabs(exact) * 1E-6, "");
+}
+
+template <typename TSpline>
+struct BatchSquaredVelocityFunctor : public SquaredVelocityFunctor<TSpline, false> {
+	enum { MaximalDerivativeOrder = 1 };
+	template <typename TEvaluator>
+	inline double evalAt(const TEvaluator & evaluator) const {
+		return evaluator.evalD(1).squaredNorm();
+	}
+};
+
+TEST(EuclideanBSplineTestSuite, evalFunctorIntegralNumericallyEvaluatesBatches)
+{
+	static_assert(internal::FunctorMaximalDerivativeOrder<SquaredVelocityFunctor<TestSpline, false> >::VALUE == -1, "");
+	static_assert(internal::FunctorMaximalDerivativeOrder<BatchSquaredVelocityFunctor<TestSpline> >::VALUE == 1, "");
+	static_assert(numeric_integrator::internal::HasEvalBatch<IntegrandFunctor<TestSpline, BatchSquaredVelocityFunctor<TestSpline>, double>, double, double>::value, "");
+	static_assert(!numeric_integrator::internal::HasEvalBatch<IntegrandFunctor<TestSpline, SquaredVelocityFunctor<TestSpline, false>, double>, double, double>::value, "");
+
+	TestSpline spline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, zero);
+	for(auto it = spline.begin(); it != spline.end(); ++it) it->setControlVertex(TestSpline::point_t::Random());
+
+	const SquaredVelocityFunctor<TestSpline, false> pointwiseF;
+	const BatchSquaredVelocityFunctor<TestSpline> batchF;
+	const double t1 = minTime + duration * 0.13, t2 = maxTime - duration * 0.29;
+	SM_ASSERT_NEAR(std::runtime_error, spline.evalFunctorIntegralNumerically<double>(t1, t2, batchF), spline.evalFunctorIntegralNumerically<double>(t1, t2, pointwiseF), 1E-12, "");
+	SM_ASSERT_NEAR(std::runtime_error, spline.evalFunctorIntegralNumerically<double>(t2, t1, batchF), spline.evalFunctorIntegralNumerically<double>(t2, t1, pointwiseF), 1E-12, "");
+	sm::eigen::assertNear(spline.evalIntegralNumerically(t1, t2), spline.evalIntegral(t1, t2), 1E-6, SM_SOURCE_FILE_POS);
+
+#ifdef SPEEDMEASURE
+	for(int j = 0; j < 100; j++){
+		{
+			sm::timing::Timer timer("Integral pointwise evaluation");
+			spline.evalFunctorIntegralNumerically<double>(minTime, maxTime, pointwiseF, 10000);
+			timer.stop();
+		}
+		{
+			sm::timing::Timer timer("Integral batch evaluation");
+			spline.evalFunctorIntegralNumerically<double>(minTime, maxTime, batchF, 10000);
+			timer.stop();
+		}
+	}
+#endif
+}
+
+template <typename TSpline>
+struct VelocityNormFunctor {
+	inline double eval(const TSpline & spline, typename TSpline::time_t t) const {
+		return spline.template getEvaluatorAt<1>(t).evalD(1).norm();
+	}
+	inline double getZeroValue(const TSpline & /* spline */) const {
+		return 0.0;
+	}
+};
+
+template <typename TAlgorithm, typename TFunctor>
+double getIntegrationError(const TestSpline & spline, const TFunctor & f, double t1, double t2, double exact, int numberOfPoints){
+	auto integrand = [&spline, &f](double t){ return f.eval(spline, t); };
+	return std::fabs(numeric_integrator::integrateFunctor<TAlgorithm>(t1, t2, integrand, numberOfPoints, 0.) - exact);
+}
+
+/// compares the accuracy of the integration algorithms for a given number of points on spline integrands (printed with SPEEDMEASURE). The knots limit the smoothness of such integrands.
+TEST(EuclideanBSplineTestSuite, integrationAlgorithmsAccuracyVersusPoints)
+{
+	using namespace numeric_integrator;
+	TestSpline spline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, zero);
+	for(auto it = spline.begin(); it != spline.end(); ++it) it->setControlVertex(TestSpline::point_t::Random());
+
+	const double t1 = minTime + duration * 0.13, t2 = maxTime - duration * 0.29;
+	const SquaredVelocityFunctor<TestSpline, false> squaredVelocity;
+	const VelocityNormFunctor<TestSpline> velocityNorm;
+	const double exactSquaredVelocity = spline.evalFunctorIntegralGaussLegendre<double>(t1, t2, squaredVelocity, 3);
+	// the velocity norm is not smooth where the velocity gets close to zero, hence the many points
+	const double exactVelocityNorm = spline.evalFunctorIntegralGaussLegendre<double>(t1, t2, velocityNorm, 400);
+	// the reference must be converged far below the errors compared against it
+	SM_ASSERT_NEAR(std::runtime_error, exactVelocityNorm, spline.evalFunctorIntegralGaussLegendre<double>(t1, t2, velocityNorm, 800), 1E-12, "");
+
+	const int numbersOfPoints[] = {15, 30, 60, 120, 240, 480};
+	const int numberOfRuns = sizeof(numbersOfPoints) / sizeof(numbersOfPoints[0]);
+	enum { Trapezoidal, Simpson, GaussLegendre, CompositeGaussLegendre, GaussKronrod, NumberOfRules };
+	double squaredVelocityErrors[numberOfRuns][NumberOfRules], velocityNormErrors[numberOfRuns][NumberOfRules];
+	for(int r = 0; r < numberOfRuns; r++){
+		const int n = numbersOfPoints[r];
+		squaredVelocityErrors[r][Trapezoidal] = getIntegrationError<algorithms::TrapezoidalRule>(spline, squaredVelocity, t1, t2, exactSquaredVelocity, n);
+		squaredVelocityErrors[r][Simpson] = getIntegrationError<algorithms::SimpsonRule>(spline, squaredVelocity, t1, t2, exactSquaredVelocity, n);
+		squaredVelocityErrors[r][GaussLegendre] = getIntegrationError<algorithms::GaussLegendreRule<> >(spline, squaredVelocity, t1, t2, exactSquaredVelocity, n);
+		squaredVelocityErrors[r][CompositeGaussLegendre] = getIntegrationError<algorithms::GaussLegendreRule<4> >(spline, squaredVelocity, t1, t2, exactSquaredVelocity, n);
+		squaredVelocityErrors[r][GaussKronrod] = getIntegrationError<algorithms::GaussKronrodRule>(spline, squaredVelocity, t1, t2, exactSquaredVelocity, n);
+		velocityNormErrors[r][Trapezoidal] = getIntegrationError<algorithms::TrapezoidalRule>(spline, velocityNorm, t1, t2, exactVelocityNorm, n);
+		velocityNormErrors[r][Simpson] = getIntegrationError<algorithms::SimpsonRule>(spline, velocityNorm, t1, t2, exactVelocityNorm, n);
+		velocityNormErrors[r][GaussLegendre] = getIntegrationError<algorithms::GaussLegendreRule<> >(spline, velocityNorm, t1, t2, exactVelocityNorm, n);
+		velocityNormErrors[r][CompositeGaussLegendre] = getIntegrationError<algorithms::GaussLegendreRule<4> >(spline, velocityNorm, t1, t2, exactVelocityNorm, n);
+		velocityNormErrors[r][GaussKronrod] = getIntegrationError<algorithms::GaussKronrodRule>(spline, velocityNorm, t1, t2, exactVelocityNorm, n);
+#ifdef SPEEDMEASURE
+		// with a point budget instead of a tolerance the error estimate is only indicative (see the tolerance driven run below)
+		double adaptiveErrorEstimate;
+		const double adaptive = std::fabs(integrateFunctorAdaptive<double>(t1, t2, [&](double t){ return squaredVelocity.eval(spline, t); }, 0, n, 0., &adaptiveErrorEstimate) - exactSquaredVelocity);
+		std::cout << "squared velocity integral errors with " << n << " points : Trapezoidal " << squaredVelocityErrors[r][Trapezoidal] << ", Simpson " << squaredVelocityErrors[r][Simpson] << ", Gauss-Legendre " << squaredVelocityErrors[r][GaussLegendre] << ", composite Gauss-Legendre (4) " << squaredVelocityErrors[r][CompositeGaussLegendre] << ", Gauss-Kronrod " << squaredVelocityErrors[r][GaussKronrod] << ", adaptive Gauss-Kronrod " << adaptive << " (estimate " << adaptiveErrorEstimate << ")" << std::endl;
+		std::cout << "velocity norm integral errors with " << n << " points : Trapezoidal " << velocityNormErrors[r][Trapezoidal] << ", Simpson " << velocityNormErrors[r][Simpson] << ", Gauss-Legendre " << velocityNormErrors[r][GaussLegendre] << ", composite Gauss-Legendre (4) " << velocityNormErrors[r][CompositeGaussLegendre] << ", Gauss-Kronrod " << velocityNormErrors[r][GaussKronrod]
+				<< ", adaptive Gauss-Kronrod " << std::fabs(integrateFunctorAdaptive<double>(t1, t2, [&](double t){ return velocityNorm.eval(spline, t); }, 0, n, 0.) - exactVelocityNorm) << std::endl;
+#endif
+	}
+
+	// every rule converges, although the kinks of the integrands at the knots and the velocity norm's kinks at zero velocity make the convergence erratic between neighbouring runs
+	for(int rule = 0; rule < NumberOfRules; rule++){
+		SM_ASSERT_LT(std::runtime_error, squaredVelocityErrors[numberOfRuns - 1][rule] * 10, squaredVelocityErrors[0][rule], "rule " << rule);
+		SM_ASSERT_LT(std::runtime_error, velocityNormErrors[numberOfRuns - 1][rule] * 10, velocityNormErrors[0][rule], "rule " << rule);
+	}
+
+	// the knot aligned rule integrates the piecewise polynomial squared velocity exactly with 3 points per segment, where the other rules need many times more points for a fraction of that accuracy
+	const algorithms::KnotAlignedGaussLegendreRule<TestSpline::time_t> knotAligned(spline.getKnots());
+	auto squaredVelocityIntegrand = [&](double t){ return squaredVelocity.eval(spline, t); };
+	auto velocityNormIntegrand = [&](double t){ return velocityNorm.eval(spline, t); };
+	const int pointsPerSegment = numeric_integrator::internal::getNumberOfGaussLegendrePointsForDegree(4);
+	const int numberOfKnotAlignedPoints = knotAligned.getIntegrator<double>(t1, t2, pointsPerSegment).getNIntegrationPoints();
+	SM_ASSERT_NEAR(std::runtime_error, integrateFunctor(knotAligned, t1, t2, squaredVelocityIntegrand, pointsPerSegment, 0.), exactSquaredVelocity, 1E-10, "");
+	SM_ASSERT_NEAR(std::runtime_error, integrateFunctor(knotAligned, t2, t1, squaredVelocityIntegrand, pointsPerSegment, 0.), -exactSquaredVelocity, 1E-10, "");
+	SM_ASSERT_GT(std::runtime_error, getIntegrationError<algorithms::SimpsonRule>(spline, squaredVelocity, t1, t2, exactSquaredVelocity, 4 * numberOfKnotAlignedPoints), 1E-8, "");
+	SM_ASSERT_GT(std::runtime_error, getIntegrationError<algorithms::GaussKronrodRule>(spline, squaredVelocity, t1, t2, exactSquaredVelocity, 4 * numberOfKnotAlignedPoints), 1E-8, "");
+#ifdef SPEEDMEASURE
+	for(int p = 1; p <= 6; p++){
+		std::cout << "velocity norm integral error with " << p << " knot aligned Gauss-Legendre points per segment : " << std::fabs(integrateFunctor(knotAligned, t1, t2, velocityNormIntegrand, p, 0.) - exactVelocityNorm) << std::endl;
+	}
+#else
+	(void) velocityNormIntegrand;
+#endif
+
+	// the adaptive rule reaches a given tolerance with the points spent where the knots disturb the smoothness
+	double errorEstimate;
+	const double adaptive = integrateFunctorAdaptive<double>(t1, t2, [&](double t){ return velocityNorm.eval(spline, t); }, 1E-10, 100000, 0., &errorEstimate);
+	SM_ASSERT_LE(std::runtime_error, errorEstimate, 1E-10, "");
+	SM_ASSERT_NEAR(std::runtime_error, adaptive, exactVelocityNorm, 1E-9, "");
+}
+
 } //namespace bsplines
@@ -7,6 +7,8 @@
 #include "gtest/gtest.h"
 #include "bsplines/NodeDistributedCache.hpp"
 #include <sm/assert_macros.hpp>
+#include <atomic>
+#include <thread>
 
 using namespace nodecache;
 
@@ -27,6 +29,11 @@ struct TestValue{
 	TestValue(const TestValue & v) : i (v.i){
 	}
 
+	TestValue & operator=(const TestValue & v){
+		i = v.i;
+		return *this;
+	}
+
 	~TestValue(){
 	}
 };
@@ -48,3 +55,85 @@ TEST(NodeDistributedCacheTestSuite, testInitialization)
 		SM_ASSERT_EQ(std::runtime_error, testSlot->accessValue(testNode).i , val, "");
 	}
 }
+
+TEST(NodeDistributedCacheTestSuite, testInvalidation)
+{
+	TestCache cache;
+	auto testSlot = cache.registerCacheableValue<TestValue>();
+
+	TestNode testNode;
+	int updates = 0;
+	auto updater = [&updates](TestValue & v){ v.i = ++updates; };
+	SM_ASSERT_EQ(std::runtime_error, testSlot->accessNodeCache(testNode).get(updater).i, 1, "");
+	SM_ASSERT_EQ(std::runtime_error, testSlot->accessNodeCache(testNode).get(updater).i, 1, "");
+
+	testNode.accessCache().handleUpdatedValueEvent();
+	SM_ASSERT_FALSE(std::runtime_error, testSlot->accessNodeCache(testNode).isValid(), "");
+	SM_ASSERT_EQ(std::runtime_error, testSlot->accessNodeCache(testNode).get(updater).i, 2, "");
+	SM_ASSERT_EQ(std::runtime_error, testNode.accessCache().getUpdateCount(), 1u, "");
+
+	// copies must not share the entries
+	TestNode copy(testNode);
+	SM_ASSERT_FALSE(std::runtime_error, testSlot->accessNodeCache(copy).isValid(), "");
+	SM_ASSERT_TRUE(std::runtime_error, testSlot->accessNodeCache(testNode).isValid(), "");
+}
+
+TEST(NodeDistributedCacheTestSuite, testSlotReuse)
+{
+	TestCache cache;
+	TestNode testNode;
+	{
+		auto testSlot = cache.registerCacheableValue<TestValue>();
+		testSlot->accessValue(testNode) = TestValue(7);
+		testSlot->accessNodeCache(testNode).setValid(true);
+	}
+	// the freed index gets reused, the old entry must not be reinterpreted
+	auto otherSlot = cache.registerCacheableValue<Eigen::Vector3d>();
+	SM_ASSERT_FALSE(std::runtime_error, otherSlot->accessNodeCache(testNode).isValid(), "");
+	otherSlot->accessValue(testNode) = Eigen::Vector3d::Ones();
+	SM_ASSERT_EQ(std::runtime_error, otherSlot->accessValue(testNode)[2], 1.0, "");
+}
+
+TEST(NodeDistributedCacheTestSuite, testGlobalInvalidation)
+{
+	TestCache cache;
+	auto testSlot = cache.registerCacheableValue<TestValue>();
+	std::vector<TestNode> nodes(10);
+
+	int updates = 0;
+	auto updater = [&updates](TestValue & v){ v.i = ++updates; };
+	for(auto & node : nodes) testSlot->get(node, updater);
+	for(auto & node : nodes) testSlot->get(node, updater);
+	SM_ASSERT_EQ(std::runtime_error, updates, 10, "");
+
+	cache.invalidateAll();
+	for(auto & node : nodes) SM_ASSERT_FALSE(std::runtime_error, testSlot->accessNodeCache(node).isValid(), "");
+	for(auto & node : nodes) testSlot->get(node, updater);
+	SM_ASSERT_EQ(std::runtime_error, updates, 20, "");
+
+	// a changed dependency stamp invalidates, too
+	testSlot->get(nodes[0], updater, 1);
+	testSlot->get(nodes[0], updater, 1);
+	SM_ASSERT_EQ(std::runtime_error, updates, 21, "");
+}
+
+TEST(NodeDistributedCacheTestSuite, testConcurrentReaders)
+{
+	TestCache cache;
+	auto testSlot = cache.registerCacheableValue<TestValue>();
+	std::vector<TestNode> nodes(100);
+	std::atomic<int> updates(0);
+
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 4; t++){
+		threads.emplace_back([&](){
+			for(int i = 0; i < 100; i++){
+				for(size_t j = 0; j < nodes.size(); j++){
+					SM_ASSERT_EQ(std::runtime_error, testSlot->get(nodes[j], [&updates, j](TestValue & v){ v.i = j; updates++; }).i, (int)j, "");
+				}
+			}
+		});
+	}
+	for(auto & thread : threads) thread.join();
+	SM_ASSERT_EQ(std::runtime_error, updates.load(), (int)nodes.size(), "");
+}
@@ -45,8 +45,11 @@ template <typename TFunctor>
 void checkIntegral(TFunctor & f){
 	checkIntegral<typename TFunctor::ValueT, algorithms::TrapezoidalRule, 200>(f);
 	checkIntegral<typename TFunctor::ValueT, algorithms::SimpsonRule, 50>(f);
-//	checkIntegral<DOUBLE_EXPONENTIAL3>(f);
-//	checkIntegral<DOUBLE_EXPONENTIAL5>(f);
+	checkIntegral<typename TFunctor::ValueT, algorithms::GaussLegendreRule<>, 20>(f);
+	checkIntegral<typename TFunctor::ValueT, algorithms::GaussLegendreRule<5>, 40>(f);
+	checkIntegral<typename TFunctor::ValueT, algorithms::GaussKronrodRule, 30>(f);
+	checkIntegral<typename TFunctor::ValueT, algorithms::RombergRule, 65>(f);
+	checkIntegral<typename TFunctor::ValueT, algorithms::TanhSinhRule, 61>(f);
 }
 
 
@@ -152,3 +155,113 @@ TEST(NumericIntegratorTestSuite, testFunctionInterface)
 
 	integrateFunction(0., 1., Integrand::integrand, 100, 0.);
 }
+
+TEST(NumericIntegratorTestSuite, gaussLegendreIsExactForPolynomials)
+{
+	// n points integrate polynomials of degree 2n - 1 exactly
+	for(int i = 0; i < numberOfBounds; i ++){
+		for(int j = 0; j < numberOfBounds; j ++){
+			SM_ASSERT_NEAR(std::runtime_error, integrateFunctor<algorithms::GaussLegendreRule<> >(bounds[i], bounds[j], xCubic, 3, 0.), xCubic.calcIntegral(bounds[i], bounds[j]), 1E-10, "");
+			SM_ASSERT_NEAR(std::runtime_error, integrateFunctor<algorithms::GaussLegendreRule<3> >(bounds[i], bounds[j], xCubic, 12, 0.), xCubic.calcIntegral(bounds[i], bounds[j]), 1E-10, "");
+			SM_ASSERT_NEAR(std::runtime_error, integrateFunctor<algorithms::GaussKronrodRule>(bounds[i], bounds[j], xSquaredInR3, 15, Eigen::Vector3d::Zero().eval()), xSquaredInR3.calcIntegral(bounds[i], bounds[j]), 1E-10, "");
+		}
+	}
+}
+
+TEST(NumericIntegratorTestSuite, adaptiveGaussKronrod)
+{
+	struct SqrtAbs {
+		inline double operator () (double x) const {
+			return sqrt(std::fabs(x));
+		}
+	} sqrtAbs;
+	const double exact = 2. / 3. * (1 + 2 * sqrt(2.));
+
+	double errorEstimate;
+	const double value = integrateFunctorAdaptive<double>(-1., 2., sqrtAbs, 1E-9, 10000, 0., &errorEstimate);
+	SM_ASSERT_LE(std::runtime_error, errorEstimate, 1E-9, "");
+	SM_ASSERT_NEAR(std::runtime_error, value, exact, 1E-9, "");
+	SM_ASSERT_NEAR(std::runtime_error, integrateFunctorAdaptive<double>(2., -1., sqrtAbs, 1E-9, 10000, 0.), -exact, 1E-9, "");
+
+	// the same points through the integrator interface with the function as guide
+	SM_ASSERT_NEAR(std::runtime_error, integrateFunctor(algorithms::createAdaptiveGaussKronrodRule(sqrtAbs, 1E-9), -1., 2., sqrtAbs, 10000, 0.), value, 1E-12, "");
+	// limited number of points
+	SM_ASSERT_NEAR(std::runtime_error, integrateFunctor(algorithms::createAdaptiveGaussKronrodRule(sqrtAbs, 1E-9), -1., 2., sqrtAbs, 45, 0.), exact, 1E-2, "");
+}
+
+TEST(NumericIntegratorTestSuite, batchIntegrand)
+{
+	struct BatchXSquared : public XSquared {
+		mutable int numberOfBatches = 0;
+		inline void evalBatch(const std::vector<double> & points, std::vector<double, Eigen::aligned_allocator<double> > & values) const {
+			numberOfBatches++;
+			values.resize(points.size());
+			for(size_t i = 0; i < points.size(); i++) values[i] = points[i] * points[i];
+		}
+	} batchXSquared;
+	static_assert(internal::HasEvalBatch<BatchXSquared, double, double>::value, "");
+	static_assert(!internal::HasEvalBatch<XSquared, double, double>::value, "");
+
+	checkIntegral(batchXSquared);
+	SM_ASSERT_GT(std::runtime_error, batchXSquared.numberOfBatches, 0, "");
+	const int numberOfBatches = batchXSquared.numberOfBatches;
+	SM_ASSERT_NEAR(std::runtime_error, integrateFunctor<algorithms::SimpsonRule>(-2., 0.5, batchXSquared, 51, 0.), integrateFunctor<algorithms::SimpsonRule>(-2., 0.5, xSquared, 51, 0.), 1E-12, "");
+	SM_ASSERT_EQ(std::runtime_error, batchXSquared.numberOfBatches, numberOfBatches + 1, "");
+}
+
+TEST(NumericIntegratorTestSuite, integrateToTolerance)
+{
+	struct InverseSqrt {
+		inline double operator () (double x) const {
+			return 1 / sqrt(x);
+		}
+	} inverseSqrt;
+
+	double errorEstimate;
+	// tanh-sinh copes with the endpoint singularity
+	const double tanhSinhValue = integrateFunctorToTolerance<algorithms::TanhSinhRule, double>(0., 1., inverseSqrt, 1E-10, 0, 1025, 0., &errorEstimate);
+	SM_ASSERT_NEAR(std::runtime_error, tanhSinhValue, 2, 1E-9, "");
+	SM_ASSERT_LE(std::runtime_error, errorEstimate, 1E-10, "");
+
+	// singularities at either bound, also of a shifted interval, where nodes near the bound would round onto it
+	struct InverseSqrtDistance {
+		double bound;
+		inline double operator () (double x) const {
+			const double value = 1 / sqrt(std::fabs(x - bound));
+			SM_ASSERT_TRUE(std::runtime_error, std::isfinite(value), "evaluated at the singularity " << bound);
+			return value;
+		}
+	};
+	const double singularityBounds[][2] = { { 0, 1 }, { 1, 3 }, { -3, -1 }, { 1E3, 1E3 + 2 } };
+	for(auto & b : singularityBounds){
+		const double exact = 2 * sqrt(b[1] - b[0]);
+		for(int i = 0; i < 2; i++){
+			const InverseSqrtDistance f = { b[i] };
+			SM_ASSERT_NEAR(std::runtime_error, (integrateFunctorToTolerance<algorithms::TanhSinhRule, double>(b[0], b[1], f, 1E-10, 0, 1025, 0.)), exact, 1E-6 * sqrt(std::fabs(b[i]) + 1), "singularity at " << b[i] << " of [" << b[0] << ", " << b[1] << "]");
+		}
+	}
+
+	for(int i = 0; i < numberOfBounds; i ++){
+		for(int j = 0; j < numberOfBounds; j ++){
+			const double exact = expX.calcIntegral(bounds[i], bounds[j]);
+			const double rombergValue = integrateFunctorToTolerance<algorithms::RombergRule, double>(bounds[i], bounds[j], expX, 0, 1E-12, 1025, 0., &errorEstimate);
+			SM_ASSERT_NEAR(std::runtime_error, rombergValue, exact, std::fabs(exact) * 1E-10 + 1E-12, "");
+			SM_ASSERT_LE(std::runtime_error, errorEstimate, std::fabs(exact) * 1E-12 + 1E-15, "");
+			const double tanhSinhValue = integrateFunctorToTolerance<algorithms::TanhSinhRule, double>(bounds[i], bounds[j], expX, 0, 1E-12, 1025, 0.);
+			SM_ASSERT_NEAR(std::runtime_error, tanhSinhValue, exact, std::fabs(exact) * 1E-10 + 1E-12, "");
+			// other algorithms double their number of points
+			const Eigen::Vector3d simpsonValue = integrateFunctorToTolerance<algorithms::SimpsonRule, Eigen::Vector3d>(bounds[i], bounds[j], xSquaredInR3, 1E-9, 0, 1025, Eigen::Vector3d::Zero());
+			SM_ASSERT_NEAR(std::runtime_error, simpsonValue, xSquaredInR3.calcIntegral(bounds[i], bounds[j]), 1E-8, "");
+		}
+	}
+
+	// the point budget bounds the refinement
+	struct Sqrt {
+		inline double operator () (double x) const {
+			return sqrt(x);
+		}
+	} sqrtX;
+	const double rombergValue = integrateFunctorToTolerance<algorithms::RombergRule, double>(0., 1., sqrtX, 1E-12, 0, 33, 0., &errorEstimate);
+	SM_ASSERT_NEAR(std::runtime_error, rombergValue, 2. / 3., 1E-2, "");
+	SM_ASSERT_GT(std::runtime_error, errorEstimate, 1E-12, "");
+}
@@ -0,0 +1,128 @@
+#include "DiffManifoldBSplineTests.hpp"
+
+namespace bsplines {
+
+typedef manifolds::SE3ManifoldConf<>::Manifold SE3Manifold;
+
+namespace {
+	SE3Manifold::transformation_matrix_t matrixExponential(const SE3Manifold::transformation_matrix_t & X){
+		SE3Manifold::transformation_matrix_t result = SE3Manifold::transformation_matrix_t::Identity(), term = result;
+		for(int k = 1; k < 40; k++){
+			term = term * X / k;
+			result += term;
+		}
+		return result;
+	}
+
+	void randomizeSplineControlVertices(SE3TestSpline & spline){
+		for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it) spline.getManifold().randomizePoint(it->getControlVertex());
+	}
+}
+
+TEST(SE3BSplineTestSuite, testManifoldOperations)
+{
+	SE3Manifold manifold;
+	for(int i = 0; i < 100; i++){
+		SE3Manifold::point_t a, b;
+		manifold.randomizePoint(a);
+		manifold.randomizePoint(b);
+		const SE3Manifold::tangent_vector_t v = SE3Manifold::tangent_vector_t::Random() * (i % 10 == 0 ? 1e-3 : 2.0);
+
+		sm::eigen::assertNear(SE3Manifold::getTransformationMatrix(manifold.mult(a, b)), SE3Manifold::getTransformationMatrix(a) * SE3Manifold::getTransformationMatrix(b), 1E-12, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(SE3Manifold::getTransformationMatrix(manifold.invert(a)), SE3Manifold::getTransformationMatrix(a).inverse(), 1E-12, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(SE3Manifold::getTransformationMatrix(manifold.expAtId(v)), matrixExponential(SE3Manifold::hat(v)), 1E-12, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(manifold.logAtId(manifold.expAtId(v)), v, 1E-9, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(SE3Manifold::hat(SE3Manifold::adjoint(a) * v), SE3Manifold::getTransformationMatrix(a) * SE3Manifold::hat(v) * SE3Manifold::getTransformationMatrix(a).inverse(), 1E-9, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(SE3Manifold::leftJacobian(v) * SE3Manifold::inverseLeftJacobian(v), SE3Manifold::tangent_map_t::Identity(), 1E-12, SM_SOURCE_FILE_POS);
+
+		// expAtId(v + d) ~= expAtId(J * d) * expAtId(v)
+		const double eps = 1E-6;
+		for(int c = 0; c < 6; c++){
+			const SE3Manifold::tangent_vector_t d = SE3Manifold::tangent_vector_t::Unit(c) * eps;
+			const SE3Manifold::transformation_matrix_t exact = SE3Manifold::getTransformationMatrix(manifold.expAtId(v + d)), linearized = SE3Manifold::getTransformationMatrix(manifold.mult(manifold.expAtId(SE3Manifold::leftJacobian(v) * d), manifold.expAtId(v)));
+			sm::eigen::assertNear(exact, linearized, 1E-10, SM_SOURCE_FILE_POS);
+		}
+
+		// dlog is the inverse of dexp in the tangent directions
+		SE3Manifold::point_t p = manifold.expAtId(v);
+		sm::eigen::assertNear(manifold.dlogAtId(p) * SE3Manifold::dLeftPerturbation(p), SE3Manifold::inverseLeftJacobian(v), 1E-5, SM_SOURCE_FILE_POS);
+	}
+}
+
+TEST(SE3BSplineTestSuite, testDExp)
+{
+	DExpTester<SE3Manifold>::testFunc(100, 10);
+}
+
+TEST(SE3BSplineTestSuite, evalD1)
+{
+	SplineEvalDTester<SE3TestSpline, 1>::testFunc(10, 10);
+}
+
+TEST(SE3BSplineTestSuite, evalD2)
+{
+	SplineEvalDTester<SE3TestSpline, 2>::testFunc(10, 10);
+}
+
+TEST(SE3BSplineTestSuite, testBSplineJacobianD0)
+{
+	BSplineJacobianTester<SE3TestSpline, 0>::testFunc(10, 1);
+}
+TEST(SE3BSplineTestSuite, testBSplineJacobianD1)
+{
+	BSplineJacobianTester<SE3TestSpline, 1>::testFunc(10, 1);
+}
+TEST(SE3BSplineTestSuite, testBSplineJacobianD2)
+{
+	BSplineJacobianTester<SE3TestSpline, 2>::testFunc(10, 1);
+}
+
+template <typename TSpline>
+struct TwistJacobianEvaluator : public BSplineJacobianEvaluator<TSpline, 1> {
+	typedef typename BSplineJacobianEvaluator<TSpline, 1>::input_t input_t;
+
+	inline void eval(const input_t & input, typename TSpline::twist_t & result) {
+		this->updateSpline(input);
+		result = this->spline.template getEvaluatorAt<1>(this->_t).evalTwist();
+	}
+
+	inline void evalJac(const input_t & input, typename TSpline::twist_jacobian_t & result) {
+		this->updateSpline(input);
+		this->spline.template getEvaluatorAt<1>(this->_t).evalTwistJacobian(result);
+	}
+};
+
+TEST(SE3BSplineTestSuite, testTwistJacobian)
+{
+	JacobianTester<Eigen::Matrix<double, multiplyEigenSize(SE3TestSpline::Dimension, SE3TestSpline::SplineOrder), 1>, SE3TestSpline::twist_t, SE3TestSpline::twist_jacobian_t, TwistJacobianEvaluator<SE3TestSpline> >::testFunc(10, 1);
+}
+
+TEST(SE3BSplineTestSuite, rotationAgreesWithUnitQuaternionSpline)
+{
+	SE3TestSpline spline;
+	UQTestSpline uqSpline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, spline.getManifold().getIdentity());
+	uqSpline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	randomizeSplineControlVertices(spline);
+	auto uqIt = uqSpline.getAbsoluteBegin();
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it, ++uqIt) uqIt->getControlVertex() = it->getControlVertex().head<4>();
+
+	for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+		const double t = minTime + duration * i / numberOfTimeSteps;
+		auto eval = spline.getEvaluatorAt<2>(t);
+		auto uqEval = uqSpline.getEvaluatorAt<2>(t);
+		for(int d = 0; d <= 2; d++){
+			sm::eigen::assertNear(SE3TestSpline::point_t(eval.evalD(d)).head<4>(), uqEval.evalD(d), 1E-9, SM_SOURCE_FILE_POS);
+		}
+
+		const SE3TestSpline::twist_t twist = eval.evalTwist(), twistDerivative = eval.evalTwistDerivative();
+		sm::eigen::assertNear(twist.head<3>(), uqEval.evalAngularVelocity(), 1E-9, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(twistDerivative.head<3>(), uqEval.evalAngularAcceleration(), 1E-9, SM_SOURCE_FILE_POS);
+
+		const SE3TestSpline::transformation_matrix_t T = eval.evalTransformation();
+		sm::eigen::assertNear(twist.tail<3>(), T.topLeftCorner<3, 3>().transpose() * eval.evalD(1).tail<3>(), 1E-9, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(T, SE3Manifold::getTransformationMatrix(eval.eval()), 1E-12, SM_SOURCE_FILE_POS);
+	}
+}
+
+} // namespace bsplines
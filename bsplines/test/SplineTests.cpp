@@ -174,6 +174,61 @@ TEST(SplineTestSuite, testGetBi)
 	}
 }
 
+TEST(SplineTestSuite, testRemoveCurveSegment)
+{
+	const int order = 4;
+	const int segments = 10;
+	BSpline bs(order);
+	std::vector<double> knots;
+	for(int i = 0; i < bs.numKnotsRequired(segments); i++)
+	{
+		knots.push_back(i + 0.3 * sin(i));
+	}
+	bs.setKnotsAndCoefficients(knots, Eigen::MatrixXd::Random(2, bs.numCoefficientsRequired(segments)));
+	BSpline reference = bs;
+
+	bs.removeCurveSegment();
+	ASSERT_EQ(segments - 1, bs.numValidTimeSegments());
+	for(double t = bs.t_min(); t <= bs.t_max(); t += 0.1)
+	{
+		sm::eigen::assertNear(bs.eval(t), reference.eval(t), 1e-12, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(bs.evalD(t, 2), reference.evalD(t, 2), 1e-10, SM_SOURCE_FILE_POS);
+	}
+}
+
+TEST(SplineTestSuite, testEvalDs)
+{
+	const int order = 4;
+	const int segments = 5;
+	BSpline bs(order);
+	std::vector<double> knots;
+	for(int i = 0; i < bs.numKnotsRequired(segments); i++)
+	{
+		knots.push_back(i + 0.3 * sin(i));
+	}
+	bs.setKnotsAndCoefficients(knots, Eigen::MatrixXd::Random(3, bs.numCoefficientsRequired(segments)));
+
+	for(double t = bs.t_min(); t <= bs.t_max(); t += 0.1)
+	{
+		Eigen::MatrixXd Ds = bs.evalDs(t, 2);
+		ASSERT_EQ(3, Ds.cols());
+		Eigen::MatrixXd J;
+		Eigen::VectorXi coefficientIndices;
+		sm::eigen::assertEqual(Ds, bs.evalDsAndJacobian(t, 2, &J, &coefficientIndices), SM_SOURCE_FILE_POS);
+		ASSERT_EQ(9, J.rows());
+		for(int i = 0; i < 3; i++)
+		{
+			sm::eigen::assertNear(Ds.col(i), bs.evalD(t, i), 1e-12, SM_SOURCE_FILE_POS);
+
+			Eigen::MatrixXd Ji;
+			Eigen::VectorXi indices;
+			bs.evalDAndJacobian(t, i, &Ji, &indices);
+			sm::eigen::assertNear(J.middleRows(i * 3, 3), Ji, 1e-12, SM_SOURCE_FILE_POS);
+			ASSERT_TRUE(coefficientIndices == indices);
+		}
+	}
+}
+
 // TEST(SplineTestSuite, testBSplineCubic)
 // {
 //   double knots_d[] = {-2.0, -1.0, 0.0, 1.0, 2.0, 3.0, 4.0, 5.0 };
@@ -53,6 +53,195 @@ TEST(UnitQuaternionBSplineTestSuite, differentEvalMethodsEvalTheSame)
 	}
 }
 
+TEST(UnitQuaternionBSplineTestSuite, evalBatch)
+{
+	UQTestSpline spline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it) spline.getManifold().randomizePoint(it->getControlVertex());
+
+	testEvalBatchAgainstEvaluator<UQTestSpline, 0>(spline, 0);
+	testEvalBatchAgainstEvaluator<UQTestSpline, 1>(spline, 1);
+	testEvalBatchAgainstEvaluator<UQTestSpline, 2>(spline, 2);
+}
+
+TEST(UnitQuaternionBSplineTestSuite, batchedManifoldOperationsEqualScalarOnes)
+{
+	typedef UnitQuaternionManifoldConf<>::Manifold Manifold;
+	Manifold manifold;
+
+	for(int batchSize = 1; batchSize <= 37; batchSize += batchSize < 8 ? 1 : 29){
+		Manifold::point_batch_t a(batchSize, 4), b(batchSize, 4), product;
+		Manifold::tangent_vector_batch_t vecs(batchSize, 3);
+		for(int i = 0; i < batchSize; i++){
+			Manifold::point_t p, q;
+			manifold.randomizePoint(p);
+			manifold.randomizePoint(q);
+			a.row(i) = p.transpose();
+			b.row(i) = q.transpose();
+			// cover the series expansions for tiny rotations, too
+			vecs.row(i) = Manifold::tangent_vector_t::Random().transpose() * (i % 3 == 0 ? 1e-7 : 2.0);
+		}
+
+		Manifold::point_batch_t exps;
+		Manifold::multBatchInto(a, b, product);
+		Manifold::expAtIdBatchInto(vecs, exps);
+
+		for(int i = 0; i < batchSize; i++){
+			const Manifold::point_t p = a.row(i).transpose(), q = b.row(i).transpose();
+			const Manifold::tangent_vector_t v = vecs.row(i).transpose();
+			sm::eigen::assertNear(Manifold::point_t(product.row(i).transpose()), manifold.mult(p, q), 1E-12, SM_SOURCE_FILE_POS);
+			sm::eigen::assertNear(Manifold::point_t(exps.row(i).transpose()), manifold.expAtId(v), 1E-12, SM_SOURCE_FILE_POS);
+		}
+	}
+}
+
+TEST(UnitQuaternionBSplineTestSuite, evalBatchVectorized)
+{
+	UQTestSpline spline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it) spline.getManifold().randomizePoint(it->getControlVertex());
+
+	std::vector<double> times;
+	for(int i = 0, n = numberOfTimeSteps * 3; i <= n; i++) times.push_back(minTime + duration * i / n);
+	for(unsigned int i = 0; i < numberOfTimeSteps; i++) times.push_back(times[std::rand() % times.size()]);
+
+	std::vector<UQTestSpline::point_t, Eigen::aligned_allocator<UQTestSpline::point_t> > values;
+	spline.evalBatchVectorized(times, values);
+	SM_ASSERT_EQ(std::runtime_error, values.size(), times.size(), "");
+	for(size_t i = 0; i < times.size(); i++){
+		sm::eigen::assertNear(values[i], spline.getEvaluatorAt<0>(times[i]).eval(), 1E-12, SM_SOURCE_FILE_POS);
+	}
+
+#ifdef SPEEDMEASURE
+	for(int j = 0; j < 100; j++){
+		double w = 0;
+		{
+			sm::timing::Timer timer("UQ evalBatch with evaluators");
+			spline.evalBatch<0>(times, 0, values);
+			w += values.back()[0];
+			timer.stop();
+		}
+		{
+			sm::timing::Timer timer("UQ evalBatch vectorized");
+			spline.evalBatchVectorized(times, values);
+			w -= values.back()[0];
+			timer.stop();
+		}
+		SM_ASSERT_NEAR(std::runtime_error, w, 0, 1E-12, "");
+	}
+#endif
+}
+
+TEST(UnitQuaternionBSplineTestSuite, evalBatchVectorizedWithRepeatedKnots)
+{
+	// repeated knots collapse into one, so the batch has to pick the same segments and basis as the evaluators
+	UQTestSpline spline;
+	Eigen::VectorXd knots(15);
+	knots << 0, 0, 0, 1, 2, 2, 3, 4, 4, 4, 5, 6, 7, 8, 9;
+	spline.initWithKnots(knots);
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it) spline.getManifold().randomizePoint(it->getControlVertex());
+
+	std::vector<double> times;
+	for(int i = 0, n = numberOfTimeSteps; i <= n; i++) times.push_back(spline.getMinTime() + (spline.getMaxTime() - spline.getMinTime()) * i / n);
+	for(int k = 0; k <= 9; k++) if(k >= spline.getMinTime() && k <= spline.getMaxTime()) times.push_back(k);
+	times.push_back(spline.getMaxTime());
+
+	std::vector<UQTestSpline::point_t, Eigen::aligned_allocator<UQTestSpline::point_t> > values;
+	spline.evalBatchVectorized(times, values);
+	SM_ASSERT_EQ(std::runtime_error, values.size(), times.size(), "");
+	for(size_t i = 0; i < times.size(); i++){
+		sm::eigen::assertNear(values[i], spline.getEvaluatorAt<0>(times[i]).eval(), 1E-12, SM_SOURCE_FILE_POS);
+	}
+}
+
+TEST(UnitQuaternionBSplineTestSuite, logVectorCachingFollowsControlVertexUpdates)
+{
+	UQTestSpline spline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it) spline.getManifold().randomizePoint(it->getControlVertex());
+	UQTestSpline cachingSpline(spline);
+	cachingSpline.setLogVectorCaching(true);
+	SM_ASSERT_TRUE(std::runtime_error, cachingSpline.isLogVectorCaching() && !spline.isLogVectorCaching(), "");
+
+	UQTestSpline::full_jacobian_t jac, cachedJac;
+	for(int update = 0; update < 4; update++){
+		for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+			const double t = minTime + duration * i / numberOfTimeSteps;
+			auto eval = spline.getEvaluatorAt<2>(t);
+			auto cachedEval = cachingSpline.getEvaluatorAt<2>(t);
+			for(int d = 0; d <= 2; d++){
+				sm::eigen::assertEqual(cachedEval.evalD(d), eval.evalD(d), SM_SOURCE_FILE_POS);
+			}
+			eval.evalJacobian(1, jac);
+			cachedEval.evalJacobian(1, cachedJac);
+			sm::eigen::assertEqual(cachedJac, jac, SM_SOURCE_FILE_POS);
+		}
+
+		// change one control vertex through the mutable access followed by an update event and one through setControlVertex; both influence the cached vectors of their own and the next segment
+		auto it = spline.getAbsoluteBegin(), cachedIt = cachingSpline.getAbsoluteBegin();
+		for(int i = 0, n = std::rand() % numberOfSegments; i < n; i++, ++it, ++cachedIt);
+		spline.getManifold().randomizePoint(it->getControlVertex());
+		cachedIt->getControlVertex() = it->getControlVertex();
+		cachedIt->accessCache().handleUpdatedValueEvent();
+		++it; ++cachedIt;
+		UQTestSpline::point_t p;
+		spline.getManifold().randomizePoint(p);
+		it->setControlVertex(p);
+		cachedIt->setControlVertex(p);
+	}
+
+	// copies share the cache slot but start with invalid values
+	UQTestSpline copy(cachingSpline);
+	SM_ASSERT_TRUE(std::runtime_error, copy.isLogVectorCaching(), "");
+	copy.getAbsoluteBegin()->setControlVertex(UQTestSpline::point_t(0, 0, 0, 1));
+	spline.getAbsoluteBegin()->setControlVertex(UQTestSpline::point_t(0, 0, 0, 1));
+	sm::eigen::assertEqual(copy.getEvaluatorAt<0>(minTime).eval(), spline.getEvaluatorAt<0>(minTime).eval(), SM_SOURCE_FILE_POS);
+
+	// concurrent evaluation fills the cache of every segment once
+	copy.invalidateSegmentCaches();
+	std::vector<double> times;
+	for(int i = 0, n = numberOfTimeSteps * 3; i <= n; i++) times.push_back(minTime + duration * i / n);
+	std::vector<UQTestSpline::point_t, Eigen::aligned_allocator<UQTestSpline::point_t> > values, cachedValues;
+	spline.evalBatch<1>(times, 1, values);
+	copy.evalBatch<1>(times, 1, cachedValues, 4);
+	for(size_t i = 0; i < times.size(); i++){
+		sm::eigen::assertEqual(cachedValues[i], values[i], SM_SOURCE_FILE_POS);
+	}
+
+	// reading the control vertices of a non-const spline does not invalidate them, setting them does
+	const size_t updateCount = copy.getAbsoluteBegin()->accessCache().getUpdateCount();
+	Eigen::VectorXd coefficients;
+	copy.getLocalCoefficientVector(minTime, coefficients, 4);
+	copy.evalBatch<1>(times, 1, cachedValues);
+	SM_ASSERT_EQ(std::runtime_error, copy.getAbsoluteBegin()->accessCache().getUpdateCount(), updateCount, "");
+	copy.setLocalCoefficientVector(minTime, coefficients, 4);
+	SM_ASSERT_GT(std::runtime_error, copy.getAbsoluteBegin()->accessCache().getUpdateCount(), updateCount, "");
+
+	cachingSpline.setLogVectorCaching(false);
+	SM_ASSERT_FALSE(std::runtime_error, cachingSpline.isLogVectorCaching(), "");
+
+#ifdef SPEEDMEASURE
+	copy.getAbsoluteBegin()->setControlVertex(UQTestSpline::point_t(0, 0, 0, 1));
+	for(int j = 0; j < 100; j++){
+		double w = 0;
+		for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+			const double t = minTime + duration * i / numberOfTimeSteps;
+			{
+				sm::timing::Timer timer("UQ eval without log vector cache");
+				w += spline.getEvaluatorAt<1>(t).evalD(1)[0];
+				timer.stop();
+			}
+			{
+				sm::timing::Timer timer("UQ eval with log vector cache");
+				w -= copy.getEvaluatorAt<1>(t).evalD(1)[0];
+				timer.stop();
+			}
+		}
+		SM_ASSERT_NEAR(std::runtime_error, w, 0, 1E-9, "");
+	}
+#endif
+}
+
 TEST(UnitQuaternionBSplineTestSuite, testDExp)
 {
 	DExpTester<UnitQuaternionManifoldConf<>::Manifold >::testFunc(100, 10);
@@ -159,6 +348,62 @@ TEST(UnitQuaternionBSplineTestSuite, testAngularAccelerationJacobian)
 	AngularDerivativeJacobianTestser<UQTestSpline, 2>::testFunc(10, 1);
 }
 
+TEST(UnitQuaternionBSplineTestSuite, evalAngularVelocityAndAccelerationFused)
+{
+	UQTestSpline spline;
+	spline.initConstantUniformSpline(minTime, maxTime, numberOfSegments, UQTestSpline::point_t(0, 0, 0, 1));
+	for(auto it = spline.getAbsoluteBegin(); it != spline.getAbsoluteEnd(); ++it) spline.getManifold().randomizePoint(it->getControlVertex());
+
+	UQTestSpline::tangent_vector_t omega, alpha;
+	UQTestSpline::angular_jacobian_t omegaJacobian, alphaJacobian, expectedJacobian;
+
+	for(unsigned int i = 0; i <= numberOfTimeSteps; i++){
+		const double t = minTime + duration * i / numberOfTimeSteps;
+		UQTestSpline::Evaluator<2> eval = spline.getEvaluatorAt<2>(t);
+
+		eval.evalAngularVelocityAndAcceleration(omega, alpha);
+		sm::eigen::assertNear(eval.evalAngularVelocity(), omega, 1E-12, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(eval.evalAngularAcceleration(), alpha, 1E-12, SM_SOURCE_FILE_POS);
+
+		eval.evalAngularVelocityAndAcceleration(omega, alpha, &omegaJacobian, &alphaJacobian);
+		sm::eigen::assertNear(eval.evalAngularVelocity(), omega, 1E-12, SM_SOURCE_FILE_POS);
+		sm::eigen::assertNear(eval.evalAngularAcceleration(), alpha, 1E-12, SM_SOURCE_FILE_POS);
+		eval.evalAngularVelocityJacobian(expectedJacobian);
+		sm::eigen::assertNear(expectedJacobian, omegaJacobian, 1E-12, SM_SOURCE_FILE_POS);
+		eval.evalAngularAccelerationJacobian(expectedJacobian);
+		sm::eigen::assertNear(expectedJacobian, alphaJacobian, 1E-12, SM_SOURCE_FILE_POS);
+	}
+
+#ifdef SPEEDMEASURE
+	const int repetitions = 100;
+	for(int j = 0; j < repetitions; j++){
+		double w = 0;
+		{
+			sm::timing::Timer timer("UQ angular velocity, acceleration and Jacobians separately");
+			for(int i = 0; i <= numberOfTimeSteps; i++){
+				UQTestSpline::Evaluator<2> eval = spline.getEvaluatorAt<2>(minTime + duration * i / numberOfTimeSteps);
+				omega = eval.evalAngularVelocity();
+				alpha = eval.evalAngularAcceleration();
+				eval.evalAngularVelocityJacobian(omegaJacobian);
+				eval.evalAngularAccelerationJacobian(alphaJacobian);
+				w += omega[0] + alpha[0] + omegaJacobian(0, 0) + alphaJacobian(0, 0);
+			}
+			timer.stop();
+		}
+		{
+			sm::timing::Timer timer("UQ angular velocity, acceleration and Jacobians fused");
+			for(int i = 0; i <= numberOfTimeSteps; i++){
+				UQTestSpline::Evaluator<2> eval = spline.getEvaluatorAt<2>(minTime + duration * i / numberOfTimeSteps);
+				eval.evalAngularVelocityAndAcceleration(omega, alpha, &omegaJacobian, &alphaJacobian);
+				w -= omega[0] + alpha[0] + omegaJacobian(0, 0) + alphaJacobian(0, 0);
+			}
+			timer.stop();
+		}
+		SM_ASSERT_NEAR(std::runtime_error, w, 0, 1E-6, "");
+	}
+#endif
+}
+
 TEST(UnitQuaternionBSplineTestSuite, testDiffManifoldBSplineFitting)
 {
 	double tolerance = 0.3; //TODO improve : the unit quaternion fitting is quite bad. this huge tolerance actually checks almost nothing apart from compilation and running without exceptions.